@@ -42,4 +42,6 @@ fn main() {
     // Links the C library to Rust
     println!("cargo:rustc-link-search=dependency=src/geosteiner");
     println!("cargo:rustc-link-lib=dylib=rs_geosteiner");
+    // The parallel phases of the C library use POSIX threads
+    println!("cargo:rustc-link-lib=dylib=pthread");
 }
@@ -0,0 +1,532 @@
+//! Safe wrappers around the stages of the GeoSteiner library.
+//!
+//! `rs_compute_esmt` runs the whole computation in one call.  The types
+//! here expose its stages separately instead: FSTs are generated once
+//! into a `Hypergraph`, which may then be pruned, saved, and solved any
+//! number of times under different `Param` sets.  Every object frees its
+//! C counterpart when dropped.
+//!
+//! Hypergraph edges and FST embeddings are borrowed directly from the C
+//! data structures, without copying.
+
+use std::ffi::CString;
+use std::fmt;
+use std::marker::PhantomData;
+use std::os::unix::ffi::OsStrExt;
+use std::os::raw::{c_char, c_double, c_int, c_void};
+use std::path::Path;
+use std::ptr;
+use std::slice;
+
+use crate::geosteiner::Point;
+
+// Values from geosteiner.h
+const GST_METRIC_L: c_int = 1;
+const GST_METRIC_UNIFORM: c_int = 2;
+const GST_ERR_UNDEFINED: c_int = 1000;
+
+type GstParamPtr = *mut c_void;
+type GstMetricPtr = *mut c_void;
+type GstHgPtr = *mut c_void;
+type GstSolverPtr = *mut c_void;
+
+#[repr(C)]
+struct C_HG {
+    nverts: c_int,
+    nedges: c_int,
+    edge_sizes: *const c_int,
+    costs: *const c_double,
+    vertices: *const c_int,
+}
+
+#[repr(C)]
+struct C_FST {
+    nterms: c_int,
+    tlist: *const c_int,
+    terms: *const Point,
+    nsps: c_int,
+    sps: *const Point,
+    nedges: c_int,
+    edges: *const FstEdge,
+}
+
+extern "C" {
+    fn gst_open_geosteiner() -> c_int;
+    fn gst_close_geosteiner() -> c_int;
+
+    fn gst_create_param(status: *mut c_int) -> GstParamPtr;
+    fn gst_copy_param(dst: GstParamPtr, src: GstParamPtr) -> c_int;
+    fn gst_free_param(param: GstParamPtr) -> c_int;
+    fn gst_set_int_param(param: GstParamPtr, which: c_int, value: c_int) -> c_int;
+    fn gst_set_dbl_param(param: GstParamPtr, which: c_int, value: c_double) -> c_int;
+
+    fn gst_create_metric(kind: c_int, parameter: c_int, status: *mut c_int) -> GstMetricPtr;
+    fn gst_free_metric(metric: GstMetricPtr) -> c_int;
+
+    fn gst_generate_fsts(
+        nterms: c_int,
+        terms: *const c_double,
+        metric: GstMetricPtr,
+        param: GstParamPtr,
+        status: *mut c_int,
+    ) -> GstHgPtr;
+    fn gst_hg_prune_edges(hg: GstHgPtr, param: GstParamPtr, status: *mut c_int) -> GstHgPtr;
+    fn gst_free_hg(hg: GstHgPtr) -> c_int;
+
+    fn gst_create_solver(hg: GstHgPtr, param: GstParamPtr, status: *mut c_int) -> GstSolverPtr;
+    fn gst_free_solver(solver: GstSolverPtr) -> c_int;
+    fn gst_hg_solve(solver: GstSolverPtr, reason: *mut c_int) -> c_int;
+    fn gst_get_solver_status(solver: GstSolverPtr, status: *mut c_int) -> c_int;
+    fn gst_hg_solution(
+        solver: GstSolverPtr,
+        nedges: *mut c_int,
+        edges: *mut c_int,
+        length: *mut c_double,
+        rank: c_int,
+    ) -> c_int;
+
+    fn rs_hg_info(hg: GstHgPtr, out: *mut C_HG) -> c_int;
+    fn rs_hg_fst(hg: GstHgPtr, e: c_int, out: *mut C_FST) -> c_int;
+    fn rs_save_hg(path: *const c_char, hg: GstHgPtr, param: GstParamPtr) -> c_int;
+    fn rs_load_hg(path: *const c_char, param: GstParamPtr, status: *mut c_int) -> GstHgPtr;
+}
+
+/// A non-zero status code returned by the GeoSteiner library
+/// (one of the `GST_ERR_...` values in `geosteiner.h`).
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct Error {
+    pub code: i32,
+}
+
+impl fmt::Display for Error {
+    fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
+        write!(f, "GeoSteiner error {}", self.code)
+    }
+}
+
+impl std::error::Error for Error {}
+
+fn check(status: c_int) -> Result<(), Error> {
+    if status == 0 { Ok(()) } else { Err(Error { code: status }) }
+}
+
+/// Keeps the GeoSteiner environment open for as long as it lives.
+/// The library counts how often it was opened, so every object simply
+/// holds one of these.
+struct Env;
+
+impl Env {
+    fn open() -> Result<Self, Error> {
+        check(unsafe { gst_open_geosteiner() })?;
+        Ok(Env)
+    }
+}
+
+impl Drop for Env {
+    fn drop(&mut self) {
+        unsafe { gst_close_geosteiner() };
+    }
+}
+
+/// A set of library parameters.  Parameters are identified by their
+/// `GST_PARAM_...` numbers from `geosteiner.h`.
+pub struct Param {
+    ptr: GstParamPtr,
+    _env: Env,
+}
+
+impl Param {
+    /// Creates a parameter set with every parameter at its default.
+    pub fn new() -> Result<Self, Error> {
+        let env = Env::open()?;
+        let mut status = 0;
+        let ptr = unsafe { gst_create_param(&mut status) };
+        if ptr.is_null() {
+            return Err(Error { code: if status != 0 { status } else { GST_ERR_UNDEFINED } });
+        }
+        Ok(Self { ptr, _env: env })
+    }
+
+    pub fn set_int(&mut self, which: i32, value: i32) -> Result<(), Error> {
+        check(unsafe { gst_set_int_param(self.ptr, which, value) })
+    }
+
+    pub fn set_dbl(&mut self, which: i32, value: f64) -> Result<(), Error> {
+        check(unsafe { gst_set_dbl_param(self.ptr, which, value) })
+    }
+
+    /// Returns an independent copy of this parameter set.
+    pub fn try_clone(&self) -> Result<Self, Error> {
+        let copy = Self::new()?;
+        check(unsafe { gst_copy_param(copy.ptr, self.ptr) })?;
+        Ok(copy)
+    }
+}
+
+impl Drop for Param {
+    fn drop(&mut self) {
+        unsafe { gst_free_param(self.ptr) };
+    }
+}
+
+fn param_ptr(param: Option<&Param>) -> GstParamPtr {
+    param.map_or(ptr::null_mut(), |p| p.ptr)
+}
+
+/// The metric used to generate FSTs.
+pub struct Metric {
+    pub(crate) ptr: GstMetricPtr,
+    _env: Env,
+}
+
+impl Metric {
+    pub(crate) fn create(kind: c_int, parameter: c_int) -> Result<Self, Error> {
+        let env = Env::open()?;
+        let mut status = 0;
+        let ptr = unsafe { gst_create_metric(kind, parameter, &mut status) };
+        if ptr.is_null() {
+            return Err(Error { code: if status != 0 { status } else { GST_ERR_UNDEFINED } });
+        }
+        Ok(Self { ptr, _env: env })
+    }
+
+    pub fn euclidean() -> Result<Self, Error> { Self::create(GST_METRIC_L, 2) }
+
+    pub fn rectilinear() -> Result<Self, Error> { Self::create(GST_METRIC_L, 1) }
+
+    /// The uniform orientation metric having `lambda` orientations
+    /// (4 is octilinear).
+    pub fn uniform(lambda: i32) -> Result<Self, Error> { Self::create(GST_METRIC_UNIFORM, lambda) }
+}
+
+impl Drop for Metric {
+    fn drop(&mut self) {
+        unsafe { gst_free_metric(self.ptr) };
+    }
+}
+
+/// One line segment of an FST.  Endpoints below the number of FST
+/// terminals refer to `Fst::terminal_points`, the others to
+/// `Fst::steiner_points` (after subtracting the number of terminals).
+#[derive(Clone, Copy, Debug)]
+#[repr(C)]
+pub struct FstEdge {
+    pub len: f64,
+    pub p1: i32,
+    pub p2: i32,
+}
+
+/// The geometric embedding of one hyperedge.
+#[derive(Clone, Copy, Debug)]
+pub struct Fst<'a> {
+    /// Hypergraph vertex of each FST terminal.
+    pub terminals: &'a [i32],
+    pub terminal_points: &'a [Point],
+    pub steiner_points: &'a [Point],
+    pub edges: &'a [FstEdge],
+}
+
+/// One hyperedge.
+#[derive(Clone, Copy, Debug)]
+pub struct HyperEdge<'a> {
+    pub index: usize,
+    pub vertices: &'a [i32],
+    pub cost: f64,
+}
+
+/// A run of consecutive hyperedges, starting with edge `first`.
+/// `vertices` holds the vertices of all of them, one edge after another.
+#[derive(Clone, Copy, Debug)]
+pub struct EdgeBatch<'a> {
+    pub first: usize,
+    pub sizes: &'a [i32],
+    pub costs: &'a [f64],
+    pub vertices: &'a [i32],
+}
+
+/// A hypergraph, usually holding the FSTs of a set of terminals.
+pub struct Hypergraph {
+    ptr: GstHgPtr,
+    _env: Env,
+}
+
+/// The path as a C string.  Its bytes are passed through unchanged, so
+/// paths that are not valid UTF-8 still name the right file.
+fn c_path(path: &Path) -> Result<CString, Error> {
+    CString::new(path.as_os_str().as_bytes()).map_err(|_| Error { code: GST_ERR_UNDEFINED })
+}
+
+unsafe fn borrow<'a, T>(p: *const T, n: c_int) -> &'a [T] {
+    if p.is_null() || n <= 0 { &[] } else { slice::from_raw_parts(p, n as usize) }
+}
+
+impl Hypergraph {
+    fn wrap(env: Env, ptr: GstHgPtr, status: c_int) -> Result<Self, Error> {
+        if ptr.is_null() || status != 0 {
+            if !ptr.is_null() {
+                unsafe { gst_free_hg(ptr) };
+            }
+            return Err(Error { code: if status != 0 { status } else { GST_ERR_UNDEFINED } });
+        }
+        Ok(Self { ptr, _env: env })
+    }
+
+    /// Generates the FSTs of the given terminals.
+    pub fn generate_fsts(terms: &[Point], metric: &Metric, param: Option<&Param>) -> Result<Self, Error> {
+        let env = Env::open()?;
+        let mut status = 0;
+        let ptr = unsafe {
+            gst_generate_fsts(
+                terms.len() as c_int,
+                terms.as_ptr() as *const c_double,
+                metric.ptr,
+                param_ptr(param),
+                &mut status,
+            )
+        };
+        Self::wrap(env, ptr, status)
+    }
+
+    /// Returns a new hypergraph holding only those FSTs that may be
+    /// part of an optimal solution.  This one is left unchanged.
+    pub fn prune(&self, param: Option<&Param>) -> Result<Self, Error> {
+        let env = Env::open()?;
+        let mut status = 0;
+        let ptr = unsafe { gst_hg_prune_edges(self.ptr, param_ptr(param), &mut status) };
+        Self::wrap(env, ptr, status)
+    }
+
+    /// Loads a hypergraph saved in any of the library's formats.
+    pub fn load(path: &Path, param: Option<&Param>) -> Result<Self, Error> {
+        let env = Env::open()?;
+        let cpath = c_path(path)?;
+        let mut status = 0;
+        let ptr = unsafe { rs_load_hg(cpath.as_ptr(), param_ptr(param), &mut status) };
+        Self::wrap(env, ptr, status)
+    }
+
+    /// Saves the hypergraph to the given file, in the format selected
+    /// by `GST_PARAM_SAVE_FORMAT`.
+    pub fn save(&self, path: &Path, param: Option<&Param>) -> Result<(), Error> {
+        let cpath = c_path(path)?;
+        check(unsafe { rs_save_hg(cpath.as_ptr(), self.ptr, param_ptr(param)) })
+    }
+
+    fn info(&self) -> C_HG {
+        let mut info = C_HG {
+            nverts: 0,
+            nedges: 0,
+            edge_sizes: ptr::null(),
+            costs: ptr::null(),
+            vertices: ptr::null(),
+        };
+        unsafe { rs_hg_info(self.ptr, &mut info) };
+        info
+    }
+
+    pub fn num_vertices(&self) -> usize { self.info().nverts as usize }
+
+    pub fn num_edges(&self) -> usize { self.info().nedges as usize }
+
+    /// The number of vertices of each edge.
+    pub fn edge_sizes(&self) -> &[i32] {
+        let info = self.info();
+        unsafe { borrow(info.edge_sizes, info.nedges) }
+    }
+
+    /// The cost of each edge.
+    pub fn costs(&self) -> &[f64] {
+        let info = self.info();
+        unsafe { borrow(info.costs, info.nedges) }
+    }
+
+    /// The vertices of every edge, one edge after another.
+    pub fn vertices(&self) -> &[i32] {
+        let info = self.info();
+        let total: i32 = unsafe { borrow(info.edge_sizes, info.nedges) }.iter().sum();
+        unsafe { borrow(info.vertices, total) }
+    }
+
+    /// Iterates over the edges in order.
+    pub fn edges(&self) -> impl Iterator<Item = HyperEdge<'_>> {
+        let sizes = self.edge_sizes();
+        let costs = self.costs();
+        let vertices = self.vertices();
+        let mut start = 0;
+        sizes.iter().enumerate().map(move |(i, &n)| {
+            let end = start + n as usize;
+            let e = HyperEdge { index: i, vertices: &vertices[start..end], cost: costs[i] };
+            start = end;
+            e
+        })
+    }
+
+    /// Iterates over the edges in batches of up to `batch_size` edges.
+    pub fn batches(&self, batch_size: usize) -> impl Iterator<Item = EdgeBatch<'_>> {
+        let batch_size = batch_size.max(1);
+        let sizes = self.edge_sizes();
+        let costs = self.costs();
+        let vertices = self.vertices();
+        let mut start = 0;
+        (0..sizes.len()).step_by(batch_size).map(move |first| {
+            let last = (first + batch_size).min(sizes.len());
+            let end = start + sizes[first..last].iter().sum::<i32>() as usize;
+            let b = EdgeBatch {
+                first,
+                sizes: &sizes[first..last],
+                costs: &costs[first..last],
+                vertices: &vertices[start..end],
+            };
+            start = end;
+            b
+        })
+    }
+
+    /// The embedding of edge `e`, or `None` if the hypergraph has no
+    /// embedding.
+    pub fn fst(&self, e: usize) -> Option<Fst<'_>> {
+        let mut f = C_FST {
+            nterms: 0,
+            tlist: ptr::null(),
+            terms: ptr::null(),
+            nsps: 0,
+            sps: ptr::null(),
+            nedges: 0,
+            edges: ptr::null(),
+        };
+        if unsafe { rs_hg_fst(self.ptr, e as c_int, &mut f) } != 0 {
+            return None;
+        }
+        unsafe {
+            Some(Fst {
+                terminals: borrow(f.tlist, f.nterms),
+                terminal_points: borrow(f.terms, f.nterms),
+                steiner_points: borrow(f.sps, f.nsps),
+                edges: borrow(f.edges, f.nedges),
+            })
+        }
+    }
+
+    /// Iterates over the embeddings of all edges.
+    pub fn fsts(&self) -> impl Iterator<Item = Fst<'_>> {
+        (0..self.num_edges()).map_while(move |e| self.fst(e))
+    }
+}
+
+impl Drop for Hypergraph {
+    fn drop(&mut self) {
+        unsafe { gst_free_hg(self.ptr) };
+    }
+}
+
+/// A solution found by a `Solver`.
+#[derive(Clone, Debug)]
+pub struct Solution {
+    pub length: f64,
+    pub edges: Vec<i32>,
+}
+
+/// Finds minimum spanning trees of a hypergraph.  The solver refers to
+/// its hypergraph and parameters, so both must outlive it.
+pub struct Solver<'a> {
+    ptr: GstSolverPtr,
+    _env: Env,
+    _refs: PhantomData<(&'a Hypergraph, &'a Param)>,
+}
+
+impl<'a> Solver<'a> {
+    pub fn new(hg: &'a Hypergraph, param: Option<&'a Param>) -> Result<Self, Error> {
+        let env = Env::open()?;
+        let mut status = 0;
+        let ptr = unsafe { gst_create_solver(hg.ptr, param_ptr(param), &mut status) };
+        if ptr.is_null() || status != 0 {
+            if !ptr.is_null() {
+                unsafe { gst_free_solver(ptr) };
+            }
+            return Err(Error { code: if status != 0 { status } else { GST_ERR_UNDEFINED } });
+        }
+        Ok(Self { ptr, _env: env, _refs: PhantomData })
+    }
+
+    /// Runs (or continues) the solver, and returns the reason it
+    /// stopped (a `GST_SOLVE_...` value).
+    pub fn solve(&mut self) -> Result<i32, Error> {
+        let mut reason = 0;
+        check(unsafe { gst_hg_solve(self.ptr, &mut reason) })?;
+        Ok(reason)
+    }
+
+    /// The state of the solution (a `GST_STATUS_...` value).
+    pub fn status(&self) -> Result<i32, Error> {
+        let mut status = 0;
+        check(unsafe { gst_get_solver_status(self.ptr, &mut status) })?;
+        Ok(status)
+    }
+
+    /// The solution of the given rank (0 being the best).
+    pub fn solution(&self, rank: i32) -> Result<Solution, Error> {
+        let mut n = 0;
+        let mut length = 0.0;
+        check(unsafe { gst_hg_solution(self.ptr, &mut n, ptr::null_mut(), ptr::null_mut(), rank) })?;
+        let mut edges = vec![0; n.max(0) as usize];
+        check(unsafe { gst_hg_solution(self.ptr, &mut n, edges.as_mut_ptr(), &mut length, rank) })?;
+        edges.truncate(n.max(0) as usize);
+        Ok(Solution { length, edges })
+    }
+}
+
+impl Drop for Solver<'_> {
+    fn drop(&mut self) {
+        unsafe { gst_free_solver(self.ptr) };
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    // Values from geosteiner.h
+    const GST_PARAM_SAVE_FORMAT: i32 = 1027;
+    const GST_PVAL_SAVE_FORMAT_VERSION3: i32 = 3;
+    const GST_PVAL_SAVE_FORMAT_BINARY: i32 = 5;
+
+    fn terminals() -> Vec<Point> {
+        (0..12)
+            .map(|i| {
+                let x = ((i * 37) % 101) as f64;
+                let y = ((i * 61) % 103) as f64;
+                Point { x, y }
+            })
+            .collect()
+    }
+
+    fn round_trip(format: i32) {
+        let metric = Metric::euclidean().unwrap();
+        let hg = Hypergraph::generate_fsts(&terminals(), &metric, None).unwrap();
+
+        let mut param = Param::new().unwrap();
+        param.set_int(GST_PARAM_SAVE_FORMAT, format).unwrap();
+        let path = std::env::temp_dir().join(format!("gst-round-trip-{}-{}", std::process::id(), format));
+        hg.save(&path, Some(&param)).unwrap();
+        let loaded = Hypergraph::load(&path, None);
+        std::fs::remove_file(&path).unwrap();
+        let loaded = loaded.unwrap();
+
+        assert_eq!(loaded.num_vertices(), hg.num_vertices());
+        assert_eq!(loaded.edge_sizes(), hg.edge_sizes());
+        assert_eq!(loaded.vertices(), hg.vertices());
+        for (a, b) in loaded.costs().iter().zip(hg.costs()) {
+            assert!((a - b).abs() <= 1e-9 * b.abs().max(1.0));
+        }
+    }
+
+    #[test]
+    fn save_load_text() {
+        round_trip(GST_PVAL_SAVE_FORMAT_VERSION3);
+    }
+
+    #[test]
+    fn save_load_binary() {
+        round_trip(GST_PVAL_SAVE_FORMAT_BINARY);
+    }
+}
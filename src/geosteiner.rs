@@ -4,9 +4,10 @@ use std::os::raw::{
 };
 
 #[derive(Clone, Copy, Debug)]
+#[repr(C)]
 pub struct Point {
-    x: f64,
-    y: f64,
+    pub x: f64,
+    pub y: f64,
 }
 
 impl Point {
@@ -15,8 +16,8 @@ impl Point {
 
 #[derive(Clone, Copy, Debug)]
 pub struct Edge {
-    p1: i32, // number of point 1
-    p2: i32, // number of point 2
+    pub p1: i32, // number of point 1
+    pub p2: i32, // number of point 2
 }
 
 impl Edge {
@@ -0,0 +1,699 @@
+/***********************************************************************
+
+	File:	anytime.c
+	Rev:	e-1
+	Date:	10/19/2026
+
+	This work is licensed under a Creative Commons
+	Attribution-NonCommercial 4.0 International License.
+
+************************************************************************
+
+	Anytime SMT solver: start from a quick heuristic tree, report
+	each improvement (and each better lower bound) as it is found,
+	and stop at a wall-clock deadline with the best tree so far.
+
+************************************************************************/
+
+#include "bb.h"
+#include "emst.h"
+#include <float.h>
+#include "fstfuncs.h"
+#include "geosteiner.h"
+#include "logic.h"
+#include "memory.h"
+#include "metric.h"
+#include "point.h"
+#include "prepostlude.h"
+#include "rmst.h"
+#include "solver.h"
+#include "steiner.h"
+#include <string.h>
+#include "threads.h"
+#include <time.h>
+
+
+/*
+ * Global Routines
+ */
+
+int		gst_anytime_smt (int			nterms,
+				 double *		terms,
+				 double			time_limit,
+				 gst_anytime_func_t *	cb_func,
+				 void *			cb_data,
+				 double *		length,
+				 double *		lower_bound,
+				 int *			nsps,
+				 double *		sps,
+				 int *			nedges,
+				 int *			edges,
+				 int *			soln_status,
+				 gst_metric_ptr		metric,
+				 gst_param_ptr		params);
+
+
+/*
+ * Local Equates
+ */
+
+/* Once the deadline has passed, the timer preempts the solver again	*/
+/* this often (in seconds), since the solver clears its preemption	*/
+/* flag when it starts.							*/
+#define	PREEMPT_INTERVAL	0.01
+
+
+/*
+ * Local Types
+ */
+
+struct anytime {
+	int			nterms;		/* number of terminals */
+	gst_hg_ptr		H;		/* FST hypergraph, if any */
+	gst_solver_ptr		solver;		/* solver, if any */
+	double			deadline;	/* wall clock time to stop, */
+						/* or 0 if none */
+	gst_anytime_func_t *	cb_func;	/* user's callback */
+	void *			cb_data;	/* user's callback data */
+
+	/* The best tree so far, and the best lower bound. */
+	double			length;		/* length of tree */
+	double			lower_bound;	/* lower bound on SMT length */
+	int			nsps;		/* number of Steiner points */
+	double *		sps;		/* Steiner point coordinates */
+	int			nedges;		/* number of tree edges */
+	int *			edges;		/* tree edges */
+	int			maxsps;		/* allocated size of sps */
+	int			maxedges;	/* allocated size of edges */
+
+	/* What was last passed to the callback. */
+	double			rep_length;
+	double			rep_lower_bound;
+
+	/* Shared with the timer thread, under the lock. */
+	struct gst_mutex	lock;
+	struct gst_cond		cond;		/* signalled when done */
+	bool			done;		/* no more work to stop */
+	int			expired;	/* deadline has passed */
+						/* (also read without lock) */
+};
+
+
+/*
+ * Local Routines
+ */
+
+static void		anytime_bb_callback (GST_BB_CALLBACK_ARGS);
+static void		free_tree (struct anytime *);
+static void		mst_tree (struct anytime *, double *, gst_metric_ptr);
+static void		report (struct anytime *);
+static void		run_timer (void *);
+static void		set_solver (struct anytime *, gst_solver_ptr);
+static void		set_tree (struct anytime *, int, int *, double);
+static double		steiner_ratio (gst_metric_ptr);
+static double		wall_clock (void);
+
+/*
+ * Construct an SMT for the given terminals, as gst_smt() does, but
+ * stop at the given wall-clock time limit with the best tree found so
+ * far.  A heuristic tree (the minimum spanning tree of the terminals)
+ * is available at once, together with the lower bound that the Steiner
+ * ratio gives.  The tree is then improved by the upper bound heuristics
+ * and the branch-and-cut.  Each better tree, and each better lower
+ * bound, is passed to the callback (if any) as soon as it is found.
+ */
+
+	int
+gst_anytime_smt (
+
+int			nterms,		/* IN - number of terminals */
+double *		terms,		/* IN - terminal coordinates */
+double			time_limit,	/* IN - seconds (0 = no limit) */
+gst_anytime_func_t *	cb_func,	/* IN - callback (or NULL) */
+void *			cb_data,	/* IN - callback data */
+double *		length,		/* OUT - length of tree */
+double *		lower_bound,	/* OUT - lower bound on SMT length */
+int *			nsps,		/* OUT - number of Steiner points */
+double *		sps,		/* OUT - Steiner point coordinates */
+int *			nedges,		/* OUT - number of tree edges */
+int *			edges,		/* OUT - tree edges */
+int *			soln_status,	/* OUT - solution status */
+gst_metric_ptr		metric,		/* IN - metric */
+gst_param_ptr		params		/* IN - parameters (NULL=default) */
+)
+{
+int			n;
+int			res;
+int			status;
+int			reason;
+int *			fsts;
+double			ub;
+double			len;
+gst_hg_ptr		H2;
+gst_param_ptr		myparams;
+struct gst_thread	timer;
+bool			have_timer;
+struct anytime		at;
+
+	GST_PRELUDE
+
+	res = 0;
+
+	if (length NE NULL)	 *length	= 0.0;
+	if (lower_bound NE NULL) *lower_bound	= 0.0;
+	if (nsps NE NULL)	 *nsps		= 0;
+	if (nedges NE NULL)	 *nedges	= 0;
+	if (soln_status NE NULL) *soln_status	= GST_STATUS_NO_SOLUTION;
+
+	if (nterms < 0) {
+		res = GST_ERR_INVALID_NUMBER_OF_TERMINALS;
+		goto end;
+	}
+	if (metric EQ NULL) {
+		res = GST_ERR_INVALID_METRIC;
+		goto end;
+	}
+
+	memset (&at, 0, sizeof (at));
+	at.nterms		= nterms;
+	at.H			= NULL;
+	at.solver		= NULL;
+	at.deadline		= 0.0;
+	if (time_limit > 0.0) {
+		at.deadline = wall_clock () + time_limit;
+	}
+	at.cb_func		= cb_func;
+	at.cb_data		= cb_data;
+	at.rep_length		= -1.0;
+	at.rep_lower_bound	= -1.0;
+	at.done			= FALSE;
+	at.expired		= FALSE;
+
+	status = GST_STATUS_FEASIBLE;
+
+	/* The heuristic tree. */
+	mst_tree (&at, terms, metric);
+	at.lower_bound = steiner_ratio (metric) * at.length;
+	if (nterms <= 2) {
+		/* The spanning tree is optimal. */
+		at.lower_bound = at.length;
+		status = GST_STATUS_OPTIMAL;
+	}
+	report (&at);
+
+	if (	(status EQ GST_STATUS_OPTIMAL)
+	    OR ((at.deadline > 0.0) AND (wall_clock () >= at.deadline))) {
+		goto done;
+	}
+
+	/* The timer stops the FST generation and the solver at the	*/
+	/* deadline.							*/
+	_gst_mutex_init (&at.lock);
+	_gst_cond_init (&at.cond);
+	have_timer = FALSE;
+	if (at.deadline > 0.0) {
+		have_timer = _gst_start_thread (&timer, run_timer, &at);
+	}
+	myparams = NULL;
+
+	_gst_fst_stop_flag = &at.expired;
+	at.H = gst_generate_fsts (nterms, terms, metric, params, &res);
+	if ((at.H NE NULL) AND LOAD_ACQUIRE (&at.expired)) {
+		/* Stopped part way: some FSTs are missing. */
+		gst_free_hg (at.H);
+		at.H = NULL;
+	}
+
+	/* Prune FSTs when instance is large, as gst_smt() does. */
+	if ((at.H NE NULL) AND (nterms >= 2000)) {
+		H2 = gst_hg_prune_edges (at.H, params, NULL);
+		if (H2 NE NULL) {
+			gst_free_hg (at.H);
+			at.H = H2;
+		}
+	}
+	_gst_fst_stop_flag = NULL;
+
+	if (	(at.H EQ NULL)
+	    OR ((at.deadline > 0.0) AND (wall_clock () >= at.deadline))) {
+		goto stop_timer;
+	}
+
+	/* The solver need only look for trees shorter than ours. */
+	myparams = gst_create_param (NULL);
+	if (params NE NULL) {
+		gst_copy_param (myparams, params);
+	}
+	gst_get_dbl_param (myparams, GST_PARAM_INITIAL_UPPER_BOUND, &ub);
+	if (at.length < ub) {
+		gst_set_dbl_param (myparams,
+				   GST_PARAM_INITIAL_UPPER_BOUND,
+				   at.length);
+	}
+
+	set_solver (&at, gst_create_solver (at.H, myparams, NULL));
+	gst_set_bb_callback_func (at.solver, anytime_bb_callback, &at);
+
+	res = gst_hg_solve (at.solver, &reason);
+
+	if (res EQ 0) {
+		/* Pick up the solver's best tree, which the callback	*/
+		/* does not see when the backtrack search finds it.	*/
+		fsts = NEWA (at.H -> num_edges, int);
+		if ((gst_hg_solution (at.solver, &n, fsts, &len, 0) EQ 0) AND
+		    (len < at.length)) {
+			set_tree (&at, n, fsts, len);
+		}
+		free ((char *) fsts);
+
+		gst_get_solver_status (at.solver, &status);
+		switch (status) {
+		case GST_STATUS_OPTIMAL:
+		case GST_STATUS_INFEASIBLE:
+			/* Nothing shorter than our tree exists. */
+			status = GST_STATUS_OPTIMAL;
+			at.lower_bound = at.length;
+			break;
+
+		default:
+			status = GST_STATUS_FEASIBLE;
+			if (at.solver -> lowerbound > at.lower_bound) {
+				at.lower_bound = at.solver -> lowerbound;
+			}
+			if (at.lower_bound > at.length) {
+				at.lower_bound = at.length;
+			}
+			break;
+		}
+		report (&at);
+	}
+
+stop_timer:
+	set_solver (&at, NULL);
+	gst_free_param (myparams);
+
+	_gst_mutex_lock (&at.lock);
+	at.done = TRUE;
+	_gst_cond_signal (&at.cond);
+	_gst_mutex_unlock (&at.lock);
+	if (have_timer) {
+		_gst_join_thread (&timer);
+	}
+	_gst_cond_destroy (&at.cond);
+	_gst_mutex_destroy (&at.lock);
+
+done:
+	if (length NE NULL) {
+		*length = at.length;
+	}
+	if (lower_bound NE NULL) {
+		*lower_bound = at.lower_bound;
+	}
+	if (nsps NE NULL) {
+		*nsps = at.nsps;
+	}
+	if ((sps NE NULL) AND (at.nsps > 0)) {
+		memcpy (sps, at.sps, 2 * at.nsps * sizeof (double));
+	}
+	if (nedges NE NULL) {
+		*nedges = at.nedges;
+	}
+	if ((edges NE NULL) AND (at.nedges > 0)) {
+		memcpy (edges, at.edges, 2 * at.nedges * sizeof (int));
+	}
+	if (soln_status NE NULL) {
+		*soln_status = status;
+	}
+
+	if (at.H NE NULL) {
+		gst_free_hg (at.H);
+	}
+	free_tree (&at);
+
+end:
+	GST_POSTLUDE
+	return (res);
+}
+
+/*
+ * Make the minimum spanning tree of the terminals the current tree.
+ * The Euclidean and rectilinear metrics have fast MST routines.  For
+ * any other metric we use Prim's algorithm on the complete graph.
+ */
+
+	static
+	void
+mst_tree (
+
+struct anytime *	ap,		/* IN/OUT - anytime solve */
+double *		terms,		/* IN - terminal coordinates */
+gst_metric_ptr		metric		/* IN - metric */
+)
+{
+int			i;
+int			j;
+int			k;
+int			n;
+int			nedges;
+int *			from;
+bool *			in_tree;
+double			d;
+double *		dist;
+struct edge *		mst;
+struct pset *		pts;
+
+	n = ap -> nterms;
+
+	ap -> length	= 0.0;
+	ap -> nsps	= 0;
+	ap -> nedges	= 0;
+	ap -> maxedges	= n;
+	ap -> edges	= NEWA (2 * ap -> maxedges, int);
+	ap -> maxsps	= 1;
+	ap -> sps	= NEWA (2 * ap -> maxsps, double);
+
+	if (n <= 1) return;
+
+	if (	(metric -> type EQ GST_METRIC_L)
+	    AND (	(metric -> parameter EQ 1)
+		 OR (metric -> parameter EQ 2))) {
+		pts = _gst_create_pset (n, terms);
+		mst = NEWA (n - 1, struct edge);
+		if (metric -> parameter EQ 1) {
+			nedges = _gst_rect_mst (pts, mst, NULL);
+		}
+		else {
+			nedges = _gst_euclidean_mst (pts, mst, 1);
+		}
+		for (i = 0; i < nedges; i++) {
+			ap -> length += mst [i].len;
+			ap -> edges [2*i]	= mst [i].p1;
+			ap -> edges [2*i + 1]	= mst [i].p2;
+		}
+		ap -> nedges = nedges;
+		free ((char *) mst);
+		free ((char *) pts);
+		return;
+	}
+
+	from	= NEWA (n, int);
+	in_tree	= NEWA (n, bool);
+	dist	= NEWA (n, double);
+
+	for (i = 0; i < n; i++) {
+		in_tree [i]	= FALSE;
+		dist [i]	= DBL_MAX;
+		from [i]	= 0;
+	}
+
+	k = 0;
+	in_tree [0] = TRUE;
+	for (i = 1; i < n; i++) {
+		for (j = 0; j < n; j++) {
+			if (in_tree [j]) continue;
+			d = gst_distance (metric,
+					  terms [2*k],
+					  terms [2*k + 1],
+					  terms [2*j],
+					  terms [2*j + 1]);
+			if (d < dist [j]) {
+				dist [j] = d;
+				from [j] = k;
+			}
+		}
+		k = -1;
+		for (j = 0; j < n; j++) {
+			if (in_tree [j]) continue;
+			if ((k < 0) OR (dist [j] < dist [k])) {
+				k = j;
+			}
+		}
+		in_tree [k] = TRUE;
+		ap -> length += dist [k];
+		ap -> edges [2 * ap -> nedges]		= from [k];
+		ap -> edges [2 * ap -> nedges + 1]	= k;
+		++(ap -> nedges);
+	}
+
+	free ((char *) dist);
+	free ((char *) in_tree);
+	free ((char *) from);
+}
+
+/*
+ * Make the given FSTs (edges of the hypergraph) the current tree.
+ */
+
+	static
+	void
+set_tree (
+
+struct anytime *	ap,		/* IN/OUT - anytime solve */
+int			nfsts,		/* IN - number of FSTs */
+int *			fsts,		/* IN - the FSTs */
+double			length		/* IN - length of tree */
+)
+{
+int			ns;
+int			ne;
+
+	gst_get_hg_edge_embedding (ap -> H, nfsts, fsts, &ns, NULL, &ne, NULL);
+
+	if (ns > ap -> maxsps) {
+		free ((char *) (ap -> sps));
+		ap -> maxsps	= ns;
+		ap -> sps	= NEWA (2 * ns, double);
+	}
+	if (ne > ap -> maxedges) {
+		free ((char *) (ap -> edges));
+		ap -> maxedges	= ne;
+		ap -> edges	= NEWA (2 * ne, int);
+	}
+
+	gst_get_hg_edge_embedding (ap -> H,
+				   nfsts,
+				   fsts,
+				   &(ap -> nsps),
+				   ap -> sps,
+				   &(ap -> nedges),
+				   ap -> edges);
+	ap -> length = length;
+}
+
+/*
+ * Free up the current tree.
+ */
+
+	static
+	void
+free_tree (
+
+struct anytime *	ap		/* IN/OUT - anytime solve */
+)
+{
+	free ((char *) (ap -> edges));
+	free ((char *) (ap -> sps));
+	ap -> edges	= NULL;
+	ap -> sps	= NULL;
+}
+
+/*
+ * Pass the current tree and lower bound to the user's callback, unless
+ * neither has changed since the last time.
+ */
+
+	static
+	void
+report (
+
+struct anytime *	ap		/* IN/OUT - anytime solve */
+)
+{
+	if (ap -> cb_func EQ NULL) return;
+
+	if (	(ap -> length EQ ap -> rep_length)
+	    AND (ap -> lower_bound EQ ap -> rep_lower_bound)) return;
+
+	ap -> rep_length	= ap -> length;
+	ap -> rep_lower_bound	= ap -> lower_bound;
+
+	ap -> cb_func (ap -> length,
+		       ap -> lower_bound,
+		       ap -> nsps,
+		       ap -> sps,
+		       ap -> nedges,
+		       ap -> edges,
+		       ap -> cb_data);
+}
+
+/*
+ * The branch-and-bound callback.  Pick up each new best solution and
+ * each better lower bound, and stop the solver once the deadline has
+ * passed.
+ */
+
+	static
+	void
+anytime_bb_callback (
+
+int			wherefrom,	/* IN - where called from */
+gst_node_ptr		node,		/* IN - node accessor */
+void *			cb_data		/* IN - the anytime solve */
+)
+{
+int			n;
+int *			fsts;
+double			len;
+double			lb;
+struct anytime *	ap;
+gst_solver_ptr		solver;
+
+	ap = (struct anytime *) cb_data;
+	solver = ap -> solver;
+
+	if (wherefrom EQ GST_CALLBACK_BB_NEW_UPPER_BOUND) {
+		/* The new solution is already the best one. */
+		fsts = NEWA (ap -> H -> num_edges, int);
+		if ((gst_hg_solution (solver, &n, fsts, &len, 0) EQ 0) AND
+		    (len < ap -> length)) {
+			set_tree (ap, n, fsts, len);
+		}
+		free ((char *) fsts);
+	}
+
+	if (solver -> bbip NE NULL) {
+		lb = solver -> bbip -> prevlb;
+		if (lb > ap -> length) {
+			lb = ap -> length;
+		}
+		if (lb > ap -> lower_bound) {
+			ap -> lower_bound = lb;
+		}
+	}
+
+	report (ap);
+
+	if ((ap -> deadline > 0.0) AND (wall_clock () >= ap -> deadline)) {
+		PREEMPT_SOLVER (solver, GST_SOLVE_TIME_LIMIT);
+	}
+}
+
+/*
+ * Make the given solver (or none) the one that the timer stops, and
+ * free the previous one.
+ */
+
+	static
+	void
+set_solver (
+
+struct anytime *	ap,		/* IN/OUT - anytime solve */
+gst_solver_ptr		solver		/* IN - new solver (or NULL) */
+)
+{
+gst_solver_ptr		old;
+
+	_gst_mutex_lock (&(ap -> lock));
+	old = ap -> solver;
+	ap -> solver = solver;
+	_gst_mutex_unlock (&(ap -> lock));
+
+	if (old NE NULL) {
+		gst_free_solver (old);
+	}
+}
+
+/*
+ * The timer thread.  It sleeps until the deadline, unless the work is
+ * done first.  It then stops the FST generation, and the solver.  The
+ * callback only gets to check the deadline between LPs, but the solver
+ * polls its preemption flag more often.  The solver resets this flag
+ * when it starts, so we keep setting it until the work is done.
+ */
+
+	static
+	void
+run_timer (
+
+void *		arg		/* IN - the anytime solve */
+)
+{
+double			left;
+struct anytime *	ap;
+
+	ap = (struct anytime *) arg;
+
+	_gst_mutex_lock (&(ap -> lock));
+	while (NOT ap -> done) {
+		left = ap -> deadline - wall_clock ();
+		if (left <= 0.0) {
+			STORE_RELEASE (&(ap -> expired), TRUE);
+			if (ap -> solver NE NULL) {
+				PREEMPT_SOLVER (ap -> solver,
+						GST_SOLVE_TIME_LIMIT);
+			}
+			left = PREEMPT_INTERVAL;
+		}
+		_gst_cond_timedwait (&(ap -> cond), &(ap -> lock), left);
+	}
+	_gst_mutex_unlock (&(ap -> lock));
+}
+
+/*
+ * Return a factor that, times the length of a minimum spanning tree,
+ * is a lower bound on the length of a Steiner minimal tree.  For the
+ * Euclidean metric this is the bound 0.824 of Chung and Graham, and
+ * for the rectilinear metric the Steiner ratio 2/3 of Hwang.  In any
+ * other metric, walking twice around an SMT visits every terminal,
+ * so an SMT is at least half as long as an MST.
+ */
+
+	static
+	double
+steiner_ratio (
+
+gst_metric_ptr		metric		/* IN - metric */
+)
+{
+	switch (metric -> type) {
+	case GST_METRIC_L:
+		if (metric -> parameter EQ 1) {
+			return (2.0 / 3.0);
+		}
+		if (metric -> parameter EQ 2) {
+			return (0.824);
+		}
+		break;
+
+	case GST_METRIC_UNIFORM:
+		if (metric -> parameter EQ 2) {
+			/* The rectilinear metric. */
+			return (2.0 / 3.0);
+		}
+		break;
+
+	default:
+		break;
+	}
+
+	return (0.5);
+}
+
+/*
+ * Return the current wall clock time in seconds.
+ */
+
+	static
+	double
+wall_clock (void)
+
+{
+#ifdef CLOCK_MONOTONIC
+struct timespec		ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return ((double) ts.tv_sec + 1.0e-9 * (double) ts.tv_nsec);
+#else
+	return ((double) time (NULL));
+#endif
+}
@@ -89,6 +89,7 @@
 #include "memory.h"
 #include "parmblk.h"
 #include "polltime.h"
+#include "portfolio.h"
 #include "sec2.h"
 #include "sec_comp.h"
 #include "sec_heur.h"
@@ -323,6 +324,7 @@ gst_param_ptr		params;
 	root -> bheur	= NEWA (nedges, double);
 	root -> next	= NULL;
 	root -> prev	= NULL;
+	root -> pack	= NULL;
 
 	for (i = 0; i < nedges; i++) {
 		root -> bheur [i] = 0.0;
@@ -368,7 +370,7 @@ gst_param_ptr		params;
 	bbip -> prevlb		= -DBL_MAX;
 	bbip -> ubip		= NULL;
 	bbip -> rcfile		= NULL;
-	bbip -> failed_fcomps	= NULL;
+	bbip -> lc_cache	= NULL;
 	bbip -> next_ckpt_time	= 0;
 
 	/* Make the root node inactive by putting it in the bbtree... */
@@ -549,27 +551,34 @@ double			save_objlim;
 		_gst_new_upper_bound (bbip -> solver -> upperbound, bbip);
 
 		if (params -> initial_primal_heur_stop EQ GST_PVAL_INITIAL_PRIMAL_HEUR_STOP_ENABLE) {
-			solver -> preempt = GST_SOLVE_BB_STOP_REQUESTED;
+			STORE_RELEASE (&(solver -> preempt),
+				       GST_SOLVE_BB_STOP_REQUESTED);
 		}
 	}
 
 	/* At this point, all nodes are inactive. */
 	for (;;) {
-		if (bbip -> solver -> preempt NE 0) {
+		if (LOAD_ACQUIRE (&(bbip -> solver -> preempt)) NE 0) {
 			/* Computation has been terminated for some reason. */
 			break;
 		}
 		/* Test time limit */
 		if (TIME_LIMIT_EXCEEDED (params -> cpu_time_limit,
 					 &(bbip -> mainpoll))) {
-			bbip -> solver -> preempt = GST_SOLVE_TIME_LIMIT;
+			STORE_RELEASE (&(bbip -> solver -> preempt),
+				       GST_SOLVE_TIME_LIMIT);
 			break;
 		}
 
+		_gst_spill_bbnodes (bbip);
+		_gst_note_node_memory (bbtree);
+
 		/* Select the next node to process. */
 		node = select_next_node (bbtree);
 		if (node EQ NULL) break;
 
+		_gst_unpack_bbnode (node, bbip);
+
 		/* This is perhaps a new lower bound... */
 		new_lower_bound (node -> z, bbip);
 
@@ -752,8 +761,9 @@ double			save_objlim;
 			/* branch variable, which can be expensive.	*/
 			if ((params -> bb_node_limit > 0) AND
 			    (statp -> num_nodes >= params -> bb_node_limit) AND
-			    (bbip -> solver -> preempt EQ 0)) {
-				bbip -> solver -> preempt = GST_SOLVE_BB_NODE_LIMIT;
+			    (LOAD_ACQUIRE (&(bbip -> solver -> preempt)) EQ 0)) {
+				PREEMPT_SOLVER (bbip -> solver,
+						GST_SOLVE_BB_NODE_LIMIT);
 				goto suspend;
 			}
 
@@ -822,6 +832,7 @@ suspend:
 
 			/* Deactivating this node -- remember the basis */
 			_gst_save_node_basis (node, bbip);
+			_gst_pack_bbnode (node, bbip);
 
 			if (_gst_checkpoint_needed (bbip)) {
 				/* No nodes are active, write out */
@@ -844,8 +855,9 @@ suspend:
 
 			if ((params -> bb_node_limit > 0) AND
 			    (statp -> num_nodes >= params -> bb_node_limit) AND
-			    (bbip -> solver -> preempt EQ 0)) {
-				bbip -> solver -> preempt = GST_SOLVE_BB_NODE_LIMIT;
+			    (LOAD_ACQUIRE (&(bbip -> solver -> preempt)) EQ 0)) {
+				PREEMPT_SOLVER (bbip -> solver,
+						GST_SOLVE_BB_NODE_LIMIT);
 			}
 		}
 
@@ -859,7 +871,8 @@ suspend:
 
 	if (bbip -> best_z < params -> initial_upper_bound) {
 		/* Feasible solution found */
-		if (solver -> preempt EQ 0) { /* If no preemption occured */
+		if (LOAD_ACQUIRE (&(solver -> preempt)) EQ 0) {
+			/* No preemption occurred */
 			new_lower_bound (bbip -> best_z, bbip);
 		}
 	}
@@ -2255,7 +2268,8 @@ gst_channel_ptr		param_print_solve_trace;
 
 		if (TIME_LIMIT_EXCEEDED (params -> cpu_time_limit,
 					 &(bbip -> cglbpoll))) {
-			bbip -> solver -> preempt = GST_SOLVE_TIME_LIMIT;
+			STORE_RELEASE (&(bbip -> solver -> preempt),
+				       GST_SOLVE_TIME_LIMIT);
 			return LB_PREEMPTED;
 		}
 
@@ -2268,7 +2282,7 @@ gst_channel_ptr		param_print_solve_trace;
 			return (LB_PREEMPTED);
 		}
 
-		if (bbip -> solver -> preempt NE 0) {
+		if (LOAD_ACQUIRE (&(bbip -> solver -> preempt)) NE 0) {
 			/* Something has happened that says we should	*/
 			/* stop / suspend the computation.		*/
 			return (LB_PREEMPTED);
@@ -2281,16 +2295,22 @@ gst_channel_ptr		param_print_solve_trace;
 			_gst_new_upper_bound (bbip -> solver -> upperbound, bbip);
 		}
 
+		/* Pick up any better solution found by the backtrack	*/
+		/* search, if it is racing us.				*/
+		if (_gst_portfolio_import (bbip -> solver)) {
+			_gst_new_upper_bound (bbip -> solver -> upperbound, bbip);
+		}
+
 		/* Check if LP limit reached.  (Note that we defer this	*/
 		/* test until after we have run the upper bound		*/
 		/* heuristic on this LP solution.)			*/
 		if ((params -> bb_lp_limit > 0) AND
 		    (bbip -> statp -> num_lps >= params -> bb_lp_limit) AND
-		    (bbip -> solver -> preempt EQ 0)) {
-			bbip -> solver -> preempt = GST_SOLVE_BB_LP_LIMIT;
+		    (LOAD_ACQUIRE (&(bbip -> solver -> preempt)) EQ 0)) {
+			PREEMPT_SOLVER (bbip -> solver, GST_SOLVE_BB_LP_LIMIT);
 		}
 
-		if (bbip -> solver -> preempt NE 0) {
+		if (LOAD_ACQUIRE (&(bbip -> solver -> preempt)) NE 0) {
 			/* Something has happened that says we should	*/
 			/* stop / suspend the computation.		*/
 			return (LB_PREEMPTED);
@@ -45,10 +45,12 @@
 #include "bitmaskmacros.h"
 #include "lpsolver.h"
 #include "polltime.h"
+#include <stdio.h>
 
 struct gst_hypergraph;
 struct gst_param;
 struct gst_solver;
+struct lc_cache;
 
 /*
  * Constants
@@ -116,6 +118,64 @@ struct bbnode {
 	double *	bheur;	/* Branch heuristic values */
 	struct bbnode *	next;	/* next unprocessed node in LIFO order */
 	struct bbnode *	prev;	/* previous unprocessed node in LIFO order */
+	/* The following must remain the last field, since checkpoint	*/
+	/* files contain everything before it.				*/
+	struct bbpack *	pack;	/* compact form of a suspended node, in */
+				/* which case the arrays above are NULL. */
+				/* For the node being branched on, the */
+				/* compact form shared by its children. */
+};
+
+/*
+ * Suspended nodes are kept in the following compact form, since there
+ * can be a great many of them.  LP solutions and the other vectors
+ * indexed by variable are stored sparsely (only the values differing
+ * from a default), and basis status codes take 2 bits each whenever
+ * they fit.  Both children of a node start out with the same LP
+ * solution, fixed variables and basis -- those of their parent -- so
+ * they share a single bbpack.  The only difference, the branch itself,
+ * is in the VAR and DIR fields of each child.
+ *
+ * When the BB_NODE_MEMORY_LIMIT parameter is set, the bbpacks of the
+ * worst nodes are written to an append-only spill file, and read back
+ * when one of their nodes is selected.  The binding rows stay in
+ * memory, so that nodes that are cut off are never read back.  A
+ * bbpack never changes once it has been created, so a bbpack that has
+ * been read back can be dropped again without writing it.
+ */
+
+struct sparse_vec {		/* values differing from a default value */
+	int		n;	/* number of values */
+	double		dflt;	/* the default value */
+	int *		index;	/* their indices, NULL if stored densely */
+	double *	value;	/* the values */
+};
+
+struct packed_stat {		/* basis status codes */
+	int		n;	/* number of codes */
+	int32u *	bits;	/* 2 bits per code, if they all fit */
+	int *		full;	/* the codes, otherwise */
+};
+
+struct bbpack {
+	int		refc;	/* number of nodes referring to this */
+	size_t		nbytes;	/* memory used by this bbpack */
+	struct sparse_vec x;	/* LP solution */
+	struct sparse_vec zlb;	/* lower bounds on branches */
+	struct sparse_vec bheur; /* branch heuristic values */
+	bitmap_t *	fixed;	/* variables fixed to some value */
+	bitmap_t *	value;	/* value variables are fixed at */
+	int		n_uids;	/* number of binding rows */
+	int *		bc_uids; /* unique IDs of binding rows */
+	int *		bc_row;	/* position of rows in LP tableaux */
+	struct packed_stat rstat; /* basis info for rows */
+	struct packed_stat cstat; /* basis info for columns */
+	bool		spilled; /* everything but the binding rows is */
+				/* only in the spill file */
+	long		spill_pos; /* position of copy in spill file, */
+				/* or -1 if there is none */
+	long		spill_len; /* size of that copy */
+	int		spill_gen; /* used when compacting spill file */
 };
 
 /*
@@ -162,6 +222,15 @@ struct bbtree {
 	int		node_policy;	/* Next node policy */
 	struct bbheap	heap [NUM_BB_HEAPS]; /* heaps used to access nodes */
 				/* in various orders */
+	double		pack_bytes;	/* memory used by all bbpacks */
+	double		peak_bytes;	/* peak memory used by suspended */
+					/* nodes */
+	int		peak_nodes;	/* number of them at that time */
+	FILE *		spill_fp;	/* spill file for suspended nodes */
+	bool		spill_failed;	/* unable to create spill file */
+	long		spill_end;	/* end of data in spill file */
+	long		spill_live;	/* data still referred to */
+	int		spill_gen;	/* spill file generation */
 };
 
 /*
@@ -220,8 +289,9 @@ struct bbinfo {
 			params; /* the parameter set for the problem */
 	FILE *		rcfile; /* pointer to root constraints file */
 
-	struct comp *	failed_fcomps; /* components that have been tried as a
-					  local cut before, with no success */
+	struct lc_cache *
+			lc_cache; /* components that have been tried as a
+				     local cut before, and the outcome */
 	cpu_time_t	next_ckpt_time; /* next checkpoint time */
 	volatile bool	force_branch_flag;
 	struct cpu_poll	mainpoll;
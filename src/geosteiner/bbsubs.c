@@ -44,11 +44,13 @@
 #include "cutset.h"
 #include "fatal.h"
 #include "geosteiner.h"
+#include "lccache.h"
 #include "logic.h"
 #include "memory.h"
 #include "parmblk.h"
 #include "sec_comp.h"
 #include "steiner.h"
+#include <stdlib.h>
 #include <string.h>
 #include "ub.h"
 
@@ -66,10 +68,22 @@ void			_gst_append_node_to_tree (struct bbnode *	p,
 void			_gst_bbheap_insert (struct bbnode *	p,
 					    struct bbtree *	tp,
 					    int			heap_no);
+void			_gst_collapse_bbnode (struct bbnode *	nodep,
+					      struct bbinfo *	bbip);
 struct bbtree *		_gst_create_bbtree (int nmasks);
 void			_gst_delete_node_from_bbtree (struct bbnode *	p,
 						      struct bbtree *	tp);
 void			_gst_destroy_bbinfo (struct bbinfo * bbip);
+void			_gst_expand_bbnode (struct bbnode *	nodep,
+					    struct bbinfo *	bbip);
+void			_gst_note_node_memory (struct bbtree * tp);
+void			_gst_pack_bbnode (struct bbnode *	nodep,
+					  struct bbinfo *	bbip);
+void			_gst_release_bbpack (struct bbnode *	nodep,
+					     struct bbinfo *	bbip);
+void			_gst_spill_bbnodes (struct bbinfo * bbip);
+void			_gst_unpack_bbnode (struct bbnode *	nodep,
+					    struct bbinfo *	bbip);
 
 
 /*
@@ -79,9 +93,28 @@ void			_gst_destroy_bbinfo (struct bbinfo * bbip);
 static void		bbheap_delete (struct bbnode *, struct bbtree *, int);
 static void		bbheap_free (struct bbheap *);
 static void		bbheap_init (struct bbheap *, bbheap_func_t *);
+static void		compact_spill_file (struct bbtree *);
+static int		compare_spill_order (const void *, const void *);
+static bool		copy_spill_data (FILE *, FILE *, long, long);
 static void		destroy_bbnode (struct bbnode *);
+static void		drop_pack (struct bbpack *, struct bbtree *);
+static void		free_node_arrays (struct bbnode *);
+static void		free_pack_arrays (struct bbpack *);
+static void *		get_array (FILE *, size_t);
+static void		load_pack (struct bbpack *, struct bbinfo *);
+static struct bbpack *	make_pack (struct bbnode *,
+				   bitmap_t *,
+				   bitmap_t *,
+				   struct bbinfo *);
+static size_t		pack_stat (struct packed_stat *, int *, int);
+static size_t		pack_vec (struct sparse_vec *, double *, int, double);
 static int		node_is_better (struct bbnode *, struct bbnode *);
 static int		node_is_worse (struct bbnode *, struct bbnode *);
+static bool		put_array (FILE *, void *, int, size_t);
+static size_t		resident_bytes (struct bbpack *);
+static bool		spill_pack (struct bbpack *, struct bbtree *);
+static void		unpack_stat (int *, struct packed_stat *);
+static void		unpack_vec (double *, struct sparse_vec *, int);
 
 /*
  * This routine adds a new node to the branch-and-bound tree.
@@ -96,9 +129,6 @@ int			dir,		/* IN - branch direction */
 double			z		/* IN - value to give to node */
 )
 {
-int			i;
-int			nedges;
-int			nmasks;
 struct bbnode *		parent;
 struct bbtree *		tp;
 struct bbnode *		p;
@@ -117,21 +147,19 @@ struct bbnode *		p1;
 		"@NC %4d %4d	x%d = %d	%f\n",
 		tp -> snum, parent -> num, var, dir, z);
 
-	nmasks	= tp -> nmasks;
-	nedges	= bbip -> cip -> num_edges;
-
 	/* Get a new tree node... */
 	p = tp -> free;
 	if (p NE NULL) {
 		tp -> free = p -> next;
+		free_node_arrays (p);
 	}
 	else {
 		p = NEW (struct bbnode);
-		p -> x	   = NEWA (nedges, double);
-		p -> zlb   = NEWA (2 * nedges, double);
-		p -> fixed = NEWA (nmasks, bitmap_t);
-		p -> value = NEWA (nmasks, bitmap_t);
-		p -> bheur = NEWA (nedges, double);
+		p -> x		= NULL;
+		p -> zlb	= NULL;
+		p -> fixed	= NULL;
+		p -> value	= NULL;
+		p -> bheur	= NULL;
 	}
 	p -> owner	= bbip;
 	p -> z		= z;
@@ -150,33 +178,30 @@ struct bbnode *		p1;
 		p -> br1cnt = parent -> br1cnt + 1;
 	}
 	p -> cpiter = -1;	/* force re-solve of LP. */
-
-	/* Get most up-to-date fixed variables... */
-	for (i = 0; i < nmasks; i++) {
-		p -> fixed [i] = bbip -> fixed [i];
-		p -> value [i] = bbip -> value [i];
-	}
-	SETBIT (p -> fixed, var);
-	if (dir EQ 0) {
-		CLRBIT (p -> value, var);
-	}
-	else {
-		SETBIT (p -> value, var);
-	}
 	p -> n_uids	= 0;
 	p -> bc_uids	= NULL;
 	p -> bc_row	= NULL;
 	p -> rstat	= NULL;
 	p -> cstat	= NULL;
 
-	/* Copy parent's LP solution, etc. */
-	memcpy (p -> x, parent -> x, nedges * sizeof (p -> x [0]));
-	memcpy (p -> zlb, parent -> zlb, nedges * (2 * sizeof (p -> zlb [0])));
-	memcpy (p -> bheur, parent -> bheur, nedges * sizeof (p -> bheur [0]));
-
-	/* Save the current basis (actually the parent's basis)	*/
-	/* into this node.					*/
-	_gst_save_node_basis (p, bbip);
+	/* The node starts out with the parent's LP solution, etc.,	*/
+	/* the most up-to-date fixed variables, and the current basis	*/
+	/* (actually the parent's basis).  Record these in compact form	*/
+	/* once, and share them with the other child.  The parent holds	*/
+	/* a reference too, until it is freed.				*/
+	if (parent -> pack EQ NULL) {
+		_gst_save_node_basis (parent, bbip);
+		parent -> pack = make_pack (parent,
+					    bbip -> fixed,
+					    bbip -> value,
+					    bbip);
+	}
+	p -> pack = parent -> pack;
+	++(p -> pack -> refc);
+	_gst_adjust_row_refc (bbip -> cpool,
+			      p -> pack -> n_uids,
+			      p -> pack -> bc_uids,
+			      1);
 
 	/* Insert node into depth-first list... */
 	p1 = tp -> first;
@@ -282,6 +307,14 @@ struct bbtree *		tp;
 	tp -> snum		= 0;
 	tp -> nmasks		= nmasks;
 	tp -> node_policy	= NN_BEST_NODE;
+	tp -> pack_bytes	= 0.0;
+	tp -> peak_bytes	= 0.0;
+	tp -> peak_nodes	= 0;
+	tp -> spill_fp		= NULL;
+	tp -> spill_failed	= FALSE;
+	tp -> spill_end		= 0;
+	tp -> spill_live	= 0;
+	tp -> spill_gen		= 0;
 
 	/* Initialize best and worst order heaps */
 	bbheap_init (&(tp -> heap [BEST_NODE_HEAP]), node_is_better);
@@ -570,6 +603,9 @@ struct bbnode *		p2;
 
 		/* Only free the array on this one, not the nodes... */
 		free ((char *) (bbtree -> heap [WORST_NODE_HEAP].array));
+		if (bbtree -> spill_fp NE NULL) {
+			fclose (bbtree -> spill_fp);
+		}
 		free ((char *) bbtree);
 	}
 
@@ -578,7 +614,9 @@ struct bbnode *		p2;
 	}
 
 	if (bbip -> lp NE NULL) {
+		_gst_lock_lp_solver ();
 		_gst_destroy_initial_formulation (bbip);
+		_gst_unlock_lp_solver ();
 	}
 
 	if (bbip -> lpmem NE NULL) {
@@ -592,8 +630,8 @@ struct bbnode *		p2;
 	bbip -> vert_mask	= NULL;
 	bbip -> edge_mask	= NULL;
 
-	/* Free failed components */
-	_gst_free_congested_component_list (bbip -> failed_fcomps);
+	/* Free the local cut cache */
+	_gst_free_lc_cache (bbip -> lc_cache);
 
 	free ((char *) bbip);
 }
@@ -610,15 +648,11 @@ destroy_bbnode (
 struct bbnode *		p		/* IN - node to destroy */
 )
 {
-	free ((char *) (p -> fixed));
-	free ((char *) (p -> value));
-
-	if (p -> x NE NULL) {
-		free ((char *) (p -> x));
-	}
-	if (p -> zlb NE NULL) {
-		free ((char *) (p -> zlb));
+	if (p -> pack NE NULL) {
+		_gst_release_bbpack (p, p -> owner);
 	}
+	free_node_arrays (p);
+
 	if (p -> bc_uids NE NULL) {
 		free ((char *) (p -> bc_uids));
 	}
@@ -631,6 +665,937 @@ struct bbnode *		p		/* IN - node to destroy */
 	if (p -> cstat NE NULL) {
 		free ((char *) (p -> cstat));
 	}
-	free ((char *) (p -> bheur));
 	free ((char *) p);
 }
+
+/*
+ * Free the arrays of the given node that are indexed by variable.
+ */
+
+	static
+	void
+free_node_arrays (
+
+struct bbnode *		p		/* IN - node */
+)
+{
+	if (p -> x NE NULL) {
+		free ((char *) (p -> x));
+	}
+	if (p -> zlb NE NULL) {
+		free ((char *) (p -> zlb));
+	}
+	if (p -> fixed NE NULL) {
+		free ((char *) (p -> fixed));
+	}
+	if (p -> value NE NULL) {
+		free ((char *) (p -> value));
+	}
+	if (p -> bheur NE NULL) {
+		free ((char *) (p -> bheur));
+	}
+	p -> x		= NULL;
+	p -> zlb	= NULL;
+	p -> fixed	= NULL;
+	p -> value	= NULL;
+	p -> bheur	= NULL;
+}
+
+/*
+ * Put a node that is being suspended into compact form.  Its basis
+ * must already have been saved.
+ */
+
+	void
+_gst_pack_bbnode (
+
+struct bbnode *		nodep,		/* IN - node to pack */
+struct bbinfo *		bbip		/* IN - branch-and-bound info */
+)
+{
+	FATAL_ERROR_IF (nodep -> pack NE NULL);
+
+	nodep -> pack = make_pack (nodep, nodep -> fixed, nodep -> value, bbip);
+
+	free_node_arrays (nodep);
+}
+
+/*
+ * Record the LP solution, etc., of the given node, the given fixed
+ * variables, and the node's saved basis in a new bbpack, to which the
+ * node holds the only reference.  The node's basis arrays are freed,
+ * but its reference counts on the binding rows now belong to its
+ * reference to the bbpack.
+ */
+
+	static
+	struct bbpack *
+make_pack (
+
+struct bbnode *		nodep,		/* IN - node to pack */
+bitmap_t *		fixed,		/* IN - fixed variables */
+bitmap_t *		value,		/* IN - values of fixed variables */
+struct bbinfo *		bbip		/* IN - branch-and-bound info */
+)
+{
+int			i;
+int			n;
+int			nedges;
+int			nmasks;
+size_t			nbytes;
+struct bbpack *		pack;
+
+	nedges	= bbip -> cip -> num_edges;
+	nmasks	= bbip -> bbtree -> nmasks;
+	n	= nodep -> n_uids;
+
+	FATAL_ERROR_IF ((nodep -> bc_uids EQ NULL) OR
+			(nodep -> rstat EQ NULL) OR
+			(nodep -> cstat EQ NULL));
+
+	pack = NEW (struct bbpack);
+
+	pack -> refc		= 1;
+	pack -> spilled		= FALSE;
+	pack -> spill_pos	= -1;
+	pack -> spill_len	= 0;
+	pack -> spill_gen	= 0;
+
+	nbytes = sizeof (*pack);
+	nbytes += pack_vec (&(pack -> x), nodep -> x, nedges, 0.0);
+	/* Every branch bound is at least the node's objective, and	*/
+	/* about half of them are equal to it.				*/
+	nbytes += pack_vec (&(pack -> zlb), nodep -> zlb, 2 * nedges, nodep -> z);
+	nbytes += pack_vec (&(pack -> bheur), nodep -> bheur, nedges, 0.0);
+
+	pack -> fixed	= NEWA (nmasks, bitmap_t);
+	pack -> value	= NEWA (nmasks, bitmap_t);
+	for (i = 0; i < nmasks; i++) {
+		pack -> fixed [i] = fixed [i];
+		pack -> value [i] = value [i];
+	}
+	nbytes += 2 * nmasks * sizeof (bitmap_t);
+
+	/* The row lists are taken over as they are. */
+	pack -> n_uids	= n;
+	pack -> bc_uids	= nodep -> bc_uids;
+	pack -> bc_row	= nodep -> bc_row;
+	nbytes += 2 * n * sizeof (int);
+
+	nbytes += pack_stat (&(pack -> rstat), nodep -> rstat, n);
+	nbytes += pack_stat (&(pack -> cstat), nodep -> cstat, nedges);
+
+	free ((char *) (nodep -> rstat));
+	free ((char *) (nodep -> cstat));
+
+	nodep -> n_uids		= 0;
+	nodep -> bc_uids	= NULL;
+	nodep -> bc_row		= NULL;
+	nodep -> rstat		= NULL;
+	nodep -> cstat		= NULL;
+
+	pack -> nbytes = nbytes;
+	bbip -> bbtree -> pack_bytes += nbytes;
+
+	return (pack);
+}
+
+/*
+ * Store the N values of VEC that differ from DEFAULT_VAL.  If there
+ * are so many of them that this saves nothing, store them all.
+ * Returns the memory used.
+ */
+
+	static
+	size_t
+pack_vec (
+
+struct sparse_vec *	sp,		/* OUT - packed vector */
+double *		vec,		/* IN - vector to pack */
+int			n,		/* IN - size of vector */
+double			default_val	/* IN - most common value */
+)
+{
+int		i;
+int		j;
+int		count;
+
+	count = 0;
+	for (i = 0; i < n; i++) {
+		if (vec [i] NE default_val) {
+			++count;
+		}
+	}
+
+	sp -> dflt	= default_val;
+
+	if (count * (sizeof (int) + sizeof (double)) >= n * sizeof (double)) {
+		sp -> n		= n;
+		sp -> index	= NULL;
+		sp -> value	= NEWA (n, double);
+		memcpy (sp -> value, vec, n * sizeof (double));
+		return (n * sizeof (double));
+	}
+
+	sp -> n		= count;
+	sp -> index	= NEWA (count, int);
+	sp -> value	= NEWA (count, double);
+	j = 0;
+	for (i = 0; i < n; i++) {
+		if (vec [i] NE default_val) {
+			sp -> index [j] = i;
+			sp -> value [j] = vec [i];
+			++j;
+		}
+	}
+
+	return (count * (sizeof (int) + sizeof (double)));
+}
+
+/*
+ * Store N basis status codes.  These take 2 bits each, unless one of
+ * them does not fit.  Returns the memory used.
+ */
+
+	static
+	size_t
+pack_stat (
+
+struct packed_stat *	sp,		/* OUT - packed codes */
+int *			stat,		/* IN - codes to pack */
+int			n		/* IN - number of codes */
+)
+{
+int		i;
+int		nwords;
+
+	sp -> n		= n;
+	sp -> bits	= NULL;
+	sp -> full	= NULL;
+
+	for (i = 0; i < n; i++) {
+		if ((stat [i] < 0) OR (stat [i] > 3)) {
+			sp -> full = NEWA (n, int);
+			memcpy (sp -> full, stat, n * sizeof (int));
+			return (n * sizeof (int));
+		}
+	}
+
+	nwords = (n + 15) / 16;
+	sp -> bits = NEWA (nwords, int32u);
+	memset (sp -> bits, 0, nwords * sizeof (int32u));
+	for (i = 0; i < n; i++) {
+		sp -> bits [i >> 4] |= ((int32u) stat [i]) << (2 * (i & 15));
+	}
+
+	return (nwords * sizeof (int32u));
+}
+
+/*
+ * Restore a suspended node from its compact form, so that it can be
+ * processed.  The node keeps its reference counts on the binding rows.
+ */
+
+	void
+_gst_unpack_bbnode (
+
+struct bbnode *		nodep,		/* IN - node to unpack */
+struct bbinfo *		bbip		/* IN - branch-and-bound info */
+)
+{
+	if (nodep -> pack EQ NULL) return;
+
+	_gst_expand_bbnode (nodep, bbip);
+
+	_gst_release_bbpack (nodep, bbip);
+}
+
+/*
+ * Fill in the arrays of a suspended node from its compact form, which
+ * the node continues to refer to.  Undone by _gst_collapse_bbnode().
+ */
+
+	void
+_gst_expand_bbnode (
+
+struct bbnode *		nodep,		/* IN - node to expand */
+struct bbinfo *		bbip		/* IN - branch-and-bound info */
+)
+{
+int			i;
+int			n;
+int			nedges;
+int			nmasks;
+struct bbpack *		pack;
+
+	pack = nodep -> pack;
+
+	FATAL_ERROR_IF (pack EQ NULL);
+
+	if (pack -> spilled) {
+		load_pack (pack, bbip);
+	}
+
+	nedges	= bbip -> cip -> num_edges;
+	nmasks	= bbip -> bbtree -> nmasks;
+	n	= pack -> n_uids;
+
+	FATAL_ERROR_IF (nodep -> bc_uids NE NULL);
+
+	free_node_arrays (nodep);
+
+	nodep -> x	= NEWA (nedges, double);
+	nodep -> zlb	= NEWA (2 * nedges, double);
+	nodep -> bheur	= NEWA (nedges, double);
+	nodep -> fixed	= NEWA (nmasks, bitmap_t);
+	nodep -> value	= NEWA (nmasks, bitmap_t);
+
+	unpack_vec (nodep -> x, &(pack -> x), nedges);
+	unpack_vec (nodep -> zlb, &(pack -> zlb), 2 * nedges);
+	unpack_vec (nodep -> bheur, &(pack -> bheur), nedges);
+
+	for (i = 0; i < nmasks; i++) {
+		nodep -> fixed [i] = pack -> fixed [i];
+		nodep -> value [i] = pack -> value [i];
+	}
+	if (nodep -> var >= 0) {
+		/* Apply this node's own branch. */
+		SETBIT (nodep -> fixed, nodep -> var);
+		if (nodep -> dir EQ 0) {
+			CLRBIT (nodep -> value, nodep -> var);
+		}
+		else {
+			SETBIT (nodep -> value, nodep -> var);
+		}
+	}
+
+	nodep -> n_uids		= n;
+	nodep -> bc_uids	= NEWA (n, int);
+	nodep -> bc_row		= NEWA (n, int);
+	nodep -> rstat		= NEWA (n, int);
+	nodep -> cstat		= NEWA (pack -> cstat.n, int);
+	memcpy (nodep -> bc_uids, pack -> bc_uids, n * sizeof (int));
+	memcpy (nodep -> bc_row, pack -> bc_row, n * sizeof (int));
+	unpack_stat (nodep -> rstat, &(pack -> rstat));
+	unpack_stat (nodep -> cstat, &(pack -> cstat));
+}
+
+/*
+ * Discard the arrays filled in by _gst_expand_bbnode(), leaving the
+ * node in compact form again.  The bbpack goes back to the spill file
+ * if it was read from there.
+ */
+
+	void
+_gst_collapse_bbnode (
+
+struct bbnode *		nodep,		/* IN - node to collapse */
+struct bbinfo *		bbip		/* IN - branch-and-bound info */
+)
+{
+struct bbpack *		pack;
+
+	pack = nodep -> pack;
+
+	FATAL_ERROR_IF (pack EQ NULL);
+
+	free_node_arrays (nodep);
+	free ((char *) (nodep -> bc_uids));
+	free ((char *) (nodep -> bc_row));
+	free ((char *) (nodep -> rstat));
+	free ((char *) (nodep -> cstat));
+	nodep -> n_uids		= 0;
+	nodep -> bc_uids	= NULL;
+	nodep -> bc_row		= NULL;
+	nodep -> rstat		= NULL;
+	nodep -> cstat		= NULL;
+
+	if ((pack -> spill_pos >= 0) AND (NOT pack -> spilled)) {
+		drop_pack (pack, bbip -> bbtree);
+	}
+}
+
+/*
+ * Undo pack_vec().
+ */
+
+	static
+	void
+unpack_vec (
+
+double *		vec,		/* OUT - unpacked vector */
+struct sparse_vec *	sp,		/* IN - packed vector */
+int			n		/* IN - size of vector */
+)
+{
+int		i;
+
+	if (sp -> index EQ NULL) {
+		memcpy (vec, sp -> value, n * sizeof (double));
+		return;
+	}
+
+	for (i = 0; i < n; i++) {
+		vec [i] = sp -> dflt;
+	}
+	for (i = 0; i < sp -> n; i++) {
+		vec [sp -> index [i]] = sp -> value [i];
+	}
+}
+
+/*
+ * Undo pack_stat().
+ */
+
+	static
+	void
+unpack_stat (
+
+int *			stat,		/* OUT - unpacked codes */
+struct packed_stat *	sp		/* IN - packed codes */
+)
+{
+int		i;
+
+	if (sp -> full NE NULL) {
+		memcpy (stat, sp -> full, sp -> n * sizeof (int));
+		return;
+	}
+
+	for (i = 0; i < sp -> n; i++) {
+		stat [i] = (sp -> bits [i >> 4] >> (2 * (i & 15))) & 0x03;
+	}
+}
+
+/*
+ * Drop the given node's reference to its bbpack, freeing the bbpack
+ * when no other node refers to it.  The caller takes care of the
+ * reference counts on the binding rows.
+ */
+
+	void
+_gst_release_bbpack (
+
+struct bbnode *		nodep,		/* IN - node */
+struct bbinfo *		bbip		/* IN - branch-and-bound info */
+)
+{
+struct bbtree *		tp;
+struct bbpack *		pack;
+
+	pack = nodep -> pack;
+	nodep -> pack = NULL;
+
+	FATAL_ERROR_IF ((pack EQ NULL) OR (pack -> refc <= 0));
+
+	--(pack -> refc);
+	if (pack -> refc > 0) return;
+
+	tp = bbip -> bbtree;
+
+	if (pack -> spilled) {
+		tp -> pack_bytes -= resident_bytes (pack);
+	}
+	else {
+		tp -> pack_bytes -= pack -> nbytes;
+	}
+
+	if (pack -> spill_pos >= 0) {
+		tp -> spill_live -= pack -> spill_len;
+		if (tp -> spill_live <= 0) {
+			/* Nothing in the spill file is needed any more. */
+			tp -> spill_live = 0;
+			tp -> spill_end	 = 0;
+		}
+	}
+
+	free_pack_arrays (pack);
+	free ((char *) (pack -> bc_uids));
+	free ((char *) pack);
+}
+
+/*
+ * Free the arrays of the given bbpack, except for the binding rows.
+ */
+
+	static
+	void
+free_pack_arrays (
+
+struct bbpack *		pack		/* IN - bbpack */
+)
+{
+	if (pack -> x.index NE NULL) {
+		free ((char *) (pack -> x.index));
+	}
+	if (pack -> x.value NE NULL) {
+		free ((char *) (pack -> x.value));
+	}
+	if (pack -> zlb.index NE NULL) {
+		free ((char *) (pack -> zlb.index));
+	}
+	if (pack -> zlb.value NE NULL) {
+		free ((char *) (pack -> zlb.value));
+	}
+	if (pack -> bheur.index NE NULL) {
+		free ((char *) (pack -> bheur.index));
+	}
+	if (pack -> bheur.value NE NULL) {
+		free ((char *) (pack -> bheur.value));
+	}
+	if (pack -> fixed NE NULL) {
+		free ((char *) (pack -> fixed));
+	}
+	if (pack -> value NE NULL) {
+		free ((char *) (pack -> value));
+	}
+	if (pack -> bc_row NE NULL) {
+		free ((char *) (pack -> bc_row));
+	}
+	if (pack -> rstat.bits NE NULL) {
+		free ((char *) (pack -> rstat.bits));
+	}
+	if (pack -> rstat.full NE NULL) {
+		free ((char *) (pack -> rstat.full));
+	}
+	if (pack -> cstat.bits NE NULL) {
+		free ((char *) (pack -> cstat.bits));
+	}
+	if (pack -> cstat.full NE NULL) {
+		free ((char *) (pack -> cstat.full));
+	}
+	pack -> x.index		= NULL;
+	pack -> x.value		= NULL;
+	pack -> zlb.index	= NULL;
+	pack -> zlb.value	= NULL;
+	pack -> bheur.index	= NULL;
+	pack -> bheur.value	= NULL;
+	pack -> fixed		= NULL;
+	pack -> value		= NULL;
+	pack -> bc_row		= NULL;
+	pack -> rstat.bits	= NULL;
+	pack -> rstat.full	= NULL;
+	pack -> cstat.bits	= NULL;
+	pack -> cstat.full	= NULL;
+}
+
+/*
+ * Keep track of the peak memory used by the suspended nodes of the
+ * given tree.  Called when all nodes are suspended.
+ */
+
+	void
+_gst_note_node_memory (
+
+struct bbtree *		tp		/* IN - branch-and-bound tree */
+)
+{
+int		nodes;
+double		bytes;
+
+	nodes = tp -> heap [BEST_NODE_HEAP].nheap;
+	bytes = tp -> pack_bytes + nodes * sizeof (struct bbnode);
+
+	if (bytes > tp -> peak_bytes) {
+		tp -> peak_bytes = bytes;
+		tp -> peak_nodes = nodes;
+	}
+}
+
+/*
+ * Enforce the BB_NODE_MEMORY_LIMIT parameter.  When the suspended
+ * nodes use more memory than this, the bbpacks of the worst nodes are
+ * moved to the spill file.  Called when all nodes are suspended.
+ */
+
+	void
+_gst_spill_bbnodes (
+
+struct bbinfo *		bbip		/* IN - branch-and-bound info */
+)
+{
+int			i;
+int			n;
+int			num_spilled;
+double			limit;
+double			target;
+double			bytes;
+struct bbtree *		tp;
+struct bbnode **	nodes;
+struct bbnode *		p;
+struct bbpack *		pack;
+gst_param_ptr		params;
+
+	params	= bbip -> params;
+	tp	= bbip -> bbtree;
+
+	if (params -> bb_node_memory_limit <= 0) return;
+
+	limit = params -> bb_node_memory_limit * 1048576.0;
+
+	if ((tp -> spill_fp NE NULL) AND
+	    (tp -> spill_end - tp -> spill_live > tp -> spill_live) AND
+	    (tp -> spill_end - tp -> spill_live >= limit)) {
+		/* Most of the spill file is no longer needed. */
+		compact_spill_file (tp);
+	}
+
+	n = tp -> heap [WORST_NODE_HEAP].nheap;
+	bytes = tp -> pack_bytes + n * sizeof (struct bbnode);
+	if (bytes <= limit) return;
+
+	if (tp -> spill_fp EQ NULL) {
+		if (tp -> spill_failed) return;
+		tp -> spill_fp = tmpfile ();
+		if (tp -> spill_fp EQ NULL) {
+			gst_channel_printf (params -> print_solve_trace,
+				"Unable to create node spill file.\n");
+			tp -> spill_failed = TRUE;
+			return;
+		}
+	}
+
+	/* Spill down to 3/4 of the limit, so that we do not have to	*/
+	/* do this again after every node.				*/
+	target = 0.75 * limit;
+
+	nodes = NEWA (n, struct bbnode *);
+	memcpy (nodes, tp -> heap [WORST_NODE_HEAP].array,
+		n * sizeof (struct bbnode *));
+	qsort (nodes, n, sizeof (struct bbnode *), compare_spill_order);
+
+	num_spilled = 0;
+	for (i = 0; (i < n) AND (bytes > target); i++) {
+		p = nodes [i];
+		if (p -> pack EQ NULL) {
+			/* Nodes read from a checkpoint file are not	*/
+			/* in compact form until we make them so.	*/
+			if (p -> bc_uids EQ NULL) continue;
+			_gst_pack_bbnode (p, bbip);
+		}
+		pack = p -> pack;
+		if (pack -> spilled) continue;
+		if (NOT spill_pack (pack, tp)) {
+			gst_channel_printf (params -> print_solve_trace,
+				"Unable to write node spill file.\n");
+			break;
+		}
+		num_spilled += pack -> refc;
+		bytes = tp -> pack_bytes + n * sizeof (struct bbnode);
+	}
+
+	free ((char *) nodes);
+
+	if (num_spilled > 0) {
+		gst_channel_printf (params -> print_solve_trace,
+				    " 	=== %d nodes spilled ===\n",
+				    num_spilled);
+	}
+}
+
+/*
+ * Sort nodes into the order in which they are spilled: worst first.
+ * Ties are broken by node number, so that the order is reproducible.
+ */
+
+	static
+	int
+compare_spill_order (
+
+const void *		p1,		/* IN - first node */
+const void *		p2		/* IN - second node */
+)
+{
+struct bbnode *		n1;
+struct bbnode *		n2;
+
+	n1 = *((struct bbnode **) p1);
+	n2 = *((struct bbnode **) p2);
+
+	if (n1 -> z > n2 -> z) return (-1);
+	if (n1 -> z < n2 -> z) return (1);
+	if (n1 -> num > n2 -> num) return (-1);
+	if (n1 -> num < n2 -> num) return (1);
+	return (0);
+}
+
+/*
+ * Move the given bbpack to the spill file, unless it already has a
+ * copy there.  Returns FALSE if the file could not be written, in
+ * which case the bbpack stays in memory.
+ */
+
+	static
+	bool
+spill_pack (
+
+struct bbpack *		pack,		/* IN - bbpack to spill */
+struct bbtree *		tp		/* IN - branch-and-bound tree */
+)
+{
+int		nmasks;
+FILE *		fp;
+bool		ok;
+
+	if (pack -> spill_pos < 0) {
+		fp	= tp -> spill_fp;
+		nmasks	= tp -> nmasks;
+
+		if (fseek (fp, tp -> spill_end, SEEK_SET) NE 0) {
+			return (FALSE);
+		}
+
+		ok = put_array (fp, pack -> x.index, pack -> x.n, sizeof (int))
+		  AND put_array (fp, pack -> x.value, pack -> x.n, sizeof (double))
+		  AND put_array (fp, pack -> zlb.index, pack -> zlb.n, sizeof (int))
+		  AND put_array (fp, pack -> zlb.value, pack -> zlb.n, sizeof (double))
+		  AND put_array (fp, pack -> bheur.index, pack -> bheur.n, sizeof (int))
+		  AND put_array (fp, pack -> bheur.value, pack -> bheur.n, sizeof (double))
+		  AND put_array (fp, pack -> fixed, nmasks, sizeof (bitmap_t))
+		  AND put_array (fp, pack -> value, nmasks, sizeof (bitmap_t))
+		  AND put_array (fp, pack -> bc_row, pack -> n_uids, sizeof (int))
+		  AND put_array (fp, pack -> rstat.bits,
+				 (pack -> rstat.n + 15) / 16, sizeof (int32u))
+		  AND put_array (fp, pack -> rstat.full,
+				 pack -> rstat.n, sizeof (int))
+		  AND put_array (fp, pack -> cstat.bits,
+				 (pack -> cstat.n + 15) / 16, sizeof (int32u))
+		  AND put_array (fp, pack -> cstat.full,
+				 pack -> cstat.n, sizeof (int))
+		  AND (fflush (fp) EQ 0);
+		if (NOT ok) return (FALSE);
+
+		pack -> spill_pos	= tp -> spill_end;
+		pack -> spill_len	= ftell (fp) - tp -> spill_end;
+		pack -> spill_gen	= tp -> spill_gen;
+		tp -> spill_end		+= pack -> spill_len;
+		tp -> spill_live	+= pack -> spill_len;
+	}
+
+	drop_pack (pack, tp);
+
+	return (TRUE);
+}
+
+/*
+ * Free the memory of a bbpack that has a copy in the spill file.
+ */
+
+	static
+	void
+drop_pack (
+
+struct bbpack *		pack,		/* IN - bbpack */
+struct bbtree *		tp		/* IN - branch-and-bound tree */
+)
+{
+	FATAL_ERROR_IF ((pack -> spilled) OR (pack -> spill_pos < 0));
+
+	free_pack_arrays (pack);
+
+	pack -> spilled = TRUE;
+	tp -> pack_bytes -= pack -> nbytes - resident_bytes (pack);
+}
+
+/*
+ * Read a spilled bbpack back into memory.  Its copy in the spill file
+ * remains valid.
+ */
+
+	static
+	void
+load_pack (
+
+struct bbpack *		pack,		/* IN - bbpack to load */
+struct bbinfo *		bbip		/* IN - branch-and-bound info */
+)
+{
+FILE *		fp;
+struct bbtree *	tp;
+
+	tp = bbip -> bbtree;
+	fp = tp -> spill_fp;
+
+	FATAL_ERROR_IF ((NOT pack -> spilled) OR (fp EQ NULL));
+
+	FATAL_ERROR_IF (fseek (fp, pack -> spill_pos, SEEK_SET) NE 0);
+
+	pack -> x.index		= get_array (fp, sizeof (int));
+	pack -> x.value		= get_array (fp, sizeof (double));
+	pack -> zlb.index	= get_array (fp, sizeof (int));
+	pack -> zlb.value	= get_array (fp, sizeof (double));
+	pack -> bheur.index	= get_array (fp, sizeof (int));
+	pack -> bheur.value	= get_array (fp, sizeof (double));
+	pack -> fixed		= get_array (fp, sizeof (bitmap_t));
+	pack -> value		= get_array (fp, sizeof (bitmap_t));
+	pack -> bc_row		= get_array (fp, sizeof (int));
+	pack -> rstat.bits	= get_array (fp, sizeof (int32u));
+	pack -> rstat.full	= get_array (fp, sizeof (int));
+	pack -> cstat.bits	= get_array (fp, sizeof (int32u));
+	pack -> cstat.full	= get_array (fp, sizeof (int));
+
+	pack -> spilled = FALSE;
+	tp -> pack_bytes += pack -> nbytes - resident_bytes (pack);
+}
+
+/*
+ * Write an array of N elements, preceded by its length (-1 for a
+ * NULL array).
+ */
+
+	static
+	bool
+put_array (
+
+FILE *		fp,		/* IN - spill file */
+void *		array,		/* IN - array to write, or NULL */
+int		n,		/* IN - number of elements */
+size_t		size		/* IN - size of each element */
+)
+{
+	if (array EQ NULL) {
+		n = -1;
+	}
+	if (fwrite (&n, sizeof (n), 1, fp) NE 1) {
+		return (FALSE);
+	}
+	if (n <= 0) {
+		return (TRUE);
+	}
+	return (fwrite (array, size, n, fp) EQ (size_t) n);
+}
+
+/*
+ * Read an array written by put_array().
+ */
+
+	static
+	void *
+get_array (
+
+FILE *		fp,		/* IN - spill file */
+size_t		size		/* IN - size of each element */
+)
+{
+int		n;
+char *		array;
+
+	FATAL_ERROR_IF (fread (&n, sizeof (n), 1, fp) NE 1);
+
+	if (n < 0) {
+		return (NULL);
+	}
+
+	array = NEWA (n * size, char);
+	FATAL_ERROR_IF ((n > 0) AND (fread (array, size, n, fp) NE (size_t) n));
+
+	return (array);
+}
+
+/*
+ * The memory a bbpack uses while it is spilled.
+ */
+
+	static
+	size_t
+resident_bytes (
+
+struct bbpack *		pack		/* IN - bbpack */
+)
+{
+	return (sizeof (*pack) + pack -> n_uids * sizeof (int));
+}
+
+/*
+ * Copy the live part of the spill file to a new spill file.  The
+ * spill file is left as is if this fails.
+ */
+
+	static
+	void
+compact_spill_file (
+
+struct bbtree *		tp		/* IN - branch-and-bound tree */
+)
+{
+int			i;
+int			n;
+long			pos;
+long *			newpos;
+FILE *			fp;
+struct bbnode **	nodes;
+struct bbpack *		pack;
+
+	fp = tmpfile ();
+	if (fp EQ NULL) return;
+
+	n	= tp -> heap [WORST_NODE_HEAP].nheap;
+	nodes	= tp -> heap [WORST_NODE_HEAP].array;
+	newpos	= NEWA (n, long);
+
+	/* Siblings share a bbpack.  Copy each bbpack only once. */
+	++(tp -> spill_gen);
+
+	pos = 0;
+	for (i = 0; i < n; i++) {
+		newpos [i] = -1;
+		pack = nodes [i] -> pack;
+		if ((pack EQ NULL) OR
+		    (pack -> spill_pos < 0) OR
+		    (pack -> spill_gen EQ tp -> spill_gen)) continue;
+		pack -> spill_gen = tp -> spill_gen;
+		if (NOT copy_spill_data (fp,
+					 tp -> spill_fp,
+					 pack -> spill_pos,
+					 pack -> spill_len)) {
+			fclose (fp);
+			free ((char *) newpos);
+			return;
+		}
+		newpos [i] = pos;
+		pos += pack -> spill_len;
+	}
+
+	for (i = 0; i < n; i++) {
+		if (newpos [i] >= 0) {
+			nodes [i] -> pack -> spill_pos = newpos [i];
+		}
+	}
+
+	fclose (tp -> spill_fp);
+	tp -> spill_fp		= fp;
+	tp -> spill_end		= pos;
+	tp -> spill_live	= pos;
+
+	free ((char *) newpos);
+}
+
+/*
+ * Append LEN bytes at position POS of one file to another file.
+ */
+
+	static
+	bool
+copy_spill_data (
+
+FILE *		dst,		/* IN - file to append to */
+FILE *		src,		/* IN - file to copy from */
+long		pos,		/* IN - position of data in SRC */
+long		len		/* IN - length of data */
+)
+{
+size_t		k;
+char		buf [8192];
+
+	if (fseek (src, pos, SEEK_SET) NE 0) {
+		return (FALSE);
+	}
+	while (len > 0) {
+		k = (len < (long) sizeof (buf)) ? len : sizeof (buf);
+		if (fread (buf, 1, k, src) NE k) return (FALSE);
+		if (fwrite (buf, 1, k, dst) NE k) return (FALSE);
+		len -= k;
+	}
+
+	return (fflush (dst) EQ 0);
+}
@@ -45,9 +45,21 @@ extern void		_gst_append_node_to_tree (struct bbnode *	p,
 extern void		_gst_bbheap_insert (struct bbnode *	p,
 					    struct bbtree *	tp,
 					    int			heap_no);
+extern void		_gst_collapse_bbnode (struct bbnode *	nodep,
+					      struct bbinfo *	bbip);
 extern struct bbtree *	_gst_create_bbtree (int nmasks);
 extern void		_gst_delete_node_from_bbtree (struct bbnode *	p,
 						      struct bbtree *	tp);
 extern void		_gst_destroy_bbinfo (struct bbinfo * bbip);
+extern void		_gst_expand_bbnode (struct bbnode *	nodep,
+					    struct bbinfo *	bbip);
+extern void		_gst_note_node_memory (struct bbtree * tp);
+extern void		_gst_pack_bbnode (struct bbnode *	nodep,
+					  struct bbinfo *	bbip);
+extern void		_gst_release_bbpack (struct bbnode *	nodep,
+					     struct bbinfo *	bbip);
+extern void		_gst_spill_bbnodes (struct bbinfo * bbip);
+extern void		_gst_unpack_bbnode (struct bbnode *	nodep,
+					    struct bbinfo *	bbip);
 
 #endif
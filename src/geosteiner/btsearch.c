@@ -42,17 +42,20 @@
 
 #include "btsearch.h"
 
-#include "environment.h"
 #include "fatal.h"
+#include "fputils.h"
 #include "geosteiner.h"
+#include "gsttypes.h"
 #include <limits.h>
 #include "logic.h"
 #include "memory.h"
 #include "parmblk.h"
+#include "portfolio.h"
 #include "solver.h"
 #include <stdlib.h>
 #include "steiner.h"
 #include <string.h>
+#include "threads.h"
 
 
 /*
@@ -77,21 +80,109 @@ struct full_set *	sort_full_trees (struct full_set *);
  * Local Constants
  */
 
-#define MAX_TERMINALS	32
+#define MAX_TERMINALS	BACKTRACK_MAX_SIZE
 
 #define BT_CUTOFF	0	/* No solution possible - backtrack */
 #define BT_PREEMPTED	1	/* Solution process preempted
 				   (not really needed) */
 #define BT_SOLUTION	2	/* Solution found */
 
+/*
+ * All vertex and edge sets used by the search are fixed-width masks of
+ * BT_WORDS 64-bit words.  The operations done at every search node only
+ * look at the first NWORDS words, however, which are enough to hold
+ * every vertex and edge of the problem -- small problems (the usual
+ * case) thus cost one or two words per operation.  Bits are visited
+ * using count-trailing-zeros rather than byte tables.
+ */
+
+#define	BT_WORD_BITS	64
+#define	BT_WORDS	(BACKTRACK_MAX_SIZE / BT_WORD_BITS)
+
+#if defined(__GNUC__)
+#define	BT_CTZ(w)	__builtin_ctzll (w)
+#define	BT_POPCOUNT(w)	__builtin_popcountll (w)
+#else
+#define	BT_CTZ(w)	bt_ctz (w)
+#define	BT_POPCOUNT(w)	bt_popcount (w)
+#endif
+
+#define	BT_BIT(i)	(((int64u) 1) << ((i) % BT_WORD_BITS))
+#define	BT_SET(m, i)	((m).w [(i) / BT_WORD_BITS] |= BT_BIT (i))
+#define	BT_CLR(m, i)	((m).w [(i) / BT_WORD_BITS] &= ~BT_BIT (i))
+#define	BT_TEST(m, i)	(((m).w [(i) / BT_WORD_BITS] & BT_BIT (i)) NE 0)
+
+/*
+ * The parallel search first expands the top levels of the search tree
+ * into a list of independent subtrees ("tasks"), going one level deeper
+ * at a time until there are at least BT_TASKS_PER_THREAD tasks for each
+ * thread, or until BT_MAX_SPLIT_LEVEL is reached.  Each worker adds its
+ * node count to the total, and picks up the current bound, once every
+ * BT_SYNC_NODES nodes.  The sequential search likewise picks up any
+ * better solution found by a racing branch-and-cut.
+ */
+
+#define	BT_TASKS_PER_THREAD	16
+#define	BT_MAX_SPLIT_LEVEL	6
+#define	BT_SYNC_NODES		256
+
 /*
  * Local Types
  */
 
+struct bt_mask {
+	int64u		w [BT_WORDS];
+};
+
+/*
+ * A subtree of the search, as recorded by the parallel search.  The
+ * tasks are numbered in the order that the sequential search would
+ * visit them.
+ */
+
+struct bt_task {
+	int		level;		/* level of subtree root */
+	int		nleft;		/* terminals left to connect */
+	dist_t		length;		/* length of partial solution */
+	struct bt_mask	solution;	/* partial solution */
+	struct bt_mask	terms_left;	/* search stacks at LEVEL */
+	struct bt_mask	compat;
+	struct bt_mask	incompat;
+};
+
+/*
+ * State shared by the workers of the parallel search.  The bound used
+ * for pruning is the pair (BOUND_LENGTH, BOUND_TASK): a node of task T
+ * having partial length L is cut off if L > BOUND_LENGTH, or if
+ * L = BOUND_LENGTH and BOUND_TASK <= T.  Ties are thereby broken in
+ * favor of the task that comes first, so the solution found does not
+ * depend upon the number of threads or upon their timing.
+ */
+
+struct bt_shared {
+	struct gst_mutex	lock;		/* protects what follows */
+	struct sinfo *		master;		/* the original search info */
+	struct bt_task *	tasks;		/* subtrees to search */
+	int			ntasks;		/* number of tasks */
+	int			task_size;	/* allocated size of tasks */
+	int			ndeep;		/* tasks at the split level */
+	int			next_task;	/* next task to hand out */
+	int			count;		/* total nodes searched */
+	dist_t			bound_length;	/* length of pruning bound */
+	int			bound_task;	/* task of pruning bound */
+	bool			found;		/* a solution has been found */
+	dist_t			best_length;	/* length of best solution */
+	int			best_task;	/* task of best solution */
+	struct bt_mask		best;		/* best solution */
+};
+
 struct sinfo {
 	struct gst_hypergraph *	cip;
 	gst_solver_ptr		solver;
 
+	/* number of mask words actually in use */
+	int			nwords;
+
 	/* the best solution so far... */
 	int			best_count;
 
@@ -99,18 +190,29 @@ struct sinfo {
 	int			count;
 
 	/* current partial solution... */
-	bitmap_t		solution;
+	struct bt_mask		solution;
+
+	/* the same, in the format expected by the solver */
+	bitmap_t *		smt;
 
 	/* arrays accessed in stack fashion during backtrack... */
-	bitmap_t *		terms_left;
-	bitmap_t *		compat;
-	bitmap_t *		incompat;
+	struct bt_mask *	terms_left;
+	struct bt_mask *	compat;
+	struct bt_mask *	incompat;
 
 	/* new ones we have to initialize */
-	bitmap_t *		edge_vmasks;
-	bitmap_t *		vert_emasks;
-	bitmap_t *		cmasks;
-	bitmap_t *		incmasks;
+	struct bt_mask *	edge_vmasks;
+	struct bt_mask *	vert_emasks;
+	struct bt_mask *	cmasks;
+	struct bt_mask *	incmasks;
+
+	/* parallel search only... */
+	struct bt_shared *	shared;		/* shared state, or NULL */
+	int			split_level;	/* record tasks at this level */
+	int			task;		/* task being searched */
+	int			synced;		/* count at last sync */
+	dist_t			bound_length;	/* copy of shared bound */
+	int			bound_task;
 };
 
 
@@ -119,7 +221,30 @@ struct sinfo {
  */
 
 static void			allocate_search_stacks (struct sinfo *);
+static bool			cutoff_node (struct sinfo *,
+					     int, int, dist_t, int);
+static void			bt_and_not (struct bt_mask *,
+					    const struct bt_mask *,
+					    const struct bt_mask *,
+					    int);
+static void			bt_clear (struct bt_mask *);
+static int			bt_count (const struct bt_mask *);
+#ifndef __GNUC__
+static int			bt_ctz (int64u);
+static int			bt_popcount (int64u);
+#endif
+static void			bt_from_bitmap (struct bt_mask *,
+						bitmap_t *,
+						int);
+static bool			bt_single_bit (const struct bt_mask *, int);
+static bool			bt_subset (const struct bt_mask *,
+					   const struct bt_mask *,
+					   int);
+static void			bt_to_bitmap (bitmap_t *,
+					      const struct bt_mask *,
+					      int);
 static bool			find_inaccessible_terminal (struct sinfo *,
+							    int,
 							    int);
 static int			find_starting_point (struct gst_hypergraph *);
 static void			free_search_stacks (struct sinfo *);
@@ -127,9 +252,22 @@ static void			init_compat_incompat_masks (struct sinfo *);
 static void			init_edge_vmasks (struct sinfo *);
 static void			init_vert_emasks (struct sinfo *);
 static bool			negative_edge_costs (struct gst_hypergraph * H);
+static void			offer_solution (struct sinfo *);
+static bool			parallel_cutoff_node (struct sinfo *,
+						      int, int, dist_t, int);
+static void			parallel_search (struct sinfo *, int);
 static void			perform_search (struct sinfo *);
+static void			record_task (struct sinfo *,
+					     int, int, dist_t);
+static void			search_node (struct sinfo *,
+					     int, int, dist_t);
 static void			search_recurse (struct sinfo *,
-						int, int, dist_t);
+						int, int, dist_t, int);
+static void			search_recurse_1 (struct sinfo *,
+						  int, int, dist_t);
+static void			search_top (struct sinfo *);
+static void			search_worker (int, void *);
+static void			sync_worker (struct sinfo *);
 
 /*
  * This routine performs a backtrack search for a Steiner Minimal Tree of
@@ -148,11 +286,9 @@ gst_hg_ptr		H;
 
 	H = solver -> H;
 
-#if 0	/* This check has already been done in gst_hg_solve() */
-	if ((H -> num_vert_masks NE 1) OR (H -> num_edge_masks NE 1)) {
-		FATAL_ERROR;
-	}
-#endif
+	/* This check has already been done in gst_hg_solve() */
+	FATAL_ERROR_IF ((H -> num_verts > BACKTRACK_MAX_SIZE) OR
+			(H -> num_edges > BACKTRACK_MAX_SIZE));
 
 	if (negative_edge_costs (H)) {
 		/* This code does not support negative edge costs!	*/
@@ -161,7 +297,8 @@ gst_hg_ptr		H;
 		/* of a complete tree, and it incorrectly cuts off	*/
 		/* good feasible solutions.				*/
 
-		solver -> preempt = GST_SOLVE_BACKTRACK_BAD_COSTS;
+		STORE_RELEASE (&(solver -> preempt),
+			       GST_SOLVE_BACKTRACK_BAD_COSTS);
 		return;
 	}
 
@@ -169,6 +306,11 @@ gst_hg_ptr		H;
 	/* worst-case memory allocations...				*/
 	sinfo.solver	= solver;
 	sinfo.cip	= H;
+	sinfo.shared	= NULL;
+	sinfo.split_level = 0;
+	sinfo.nwords	= (((H -> num_verts > H -> num_edges)
+			    ? H -> num_verts : H -> num_edges)
+			   + BT_WORD_BITS - 1) / BT_WORD_BITS;
 	allocate_search_stacks (&sinfo);
 
 	init_edge_vmasks (&sinfo);
@@ -231,24 +373,22 @@ int			nedges;
 struct gst_hypergraph *	cip;
 int *			vp1;
 int *			vp2;
-bitmap_t *		array;
-bitmap_t		mask;
+struct bt_mask *	array;
 
 	cip = sip -> cip;
 
 	nedges	= cip -> num_edges;
 
-	array = NEWA (nedges, bitmap_t);
+	array = NEWA (nedges, struct bt_mask);
 
 	for (i = 0; i < nedges; i++) {
-		mask = 0;
+		bt_clear (&array [i]);
 		vp1 = cip -> edge [i];
 		vp2 = cip -> edge [i + 1];
 		while (vp1 < vp2) {
 			j = *vp1++;
-			mask |= (1 << j);
+			BT_SET (array [i], j);
 		}
-		array [i] = mask;
 	}
 
 	sip -> edge_vmasks = array;
@@ -272,24 +412,22 @@ int			nverts;
 struct gst_hypergraph *	cip;
 int *			ep1;
 int *			ep2;
-bitmap_t *		array;
-bitmap_t		mask;
+struct bt_mask *	array;
 
 	cip = sip -> cip;
 
 	nverts	= cip -> num_verts;
 
-	array = NEWA (nverts, bitmap_t);
+	array = NEWA (nverts, struct bt_mask);
 
 	for (i = 0; i < nverts; i++) {
-		mask = 0;
+		bt_clear (&array [i]);
 		ep1 = cip -> term_trees [i];
 		ep2 = cip -> term_trees [i + 1];
 		while (ep1 < ep2) {
 			j = *ep1++;
-			mask |= (1 << j);
+			BT_SET (array [i], j);
 		}
-		array [i] = mask;
 	}
 
 	sip -> vert_emasks = array;
@@ -308,8 +446,8 @@ init_compat_incompat_masks (
 struct sinfo *	sip		/* IN/OUT - search/compatibility info */
 )
 {
+int			i;
 int			j;
-int			k;
 int			e1;
 int			e2;
 int			nedges;
@@ -318,29 +456,25 @@ int *			vp1;
 int *			vp2;
 int *			ep1;
 int *			ep2;
-bitmap_t *		carray;
-bitmap_t *		iarray;
-bitmap_t		edges_seen;
-bitmap_t		e1_vmask;
-bitmap_t		cmask;
-bitmap_t		imask;
-bitmap_t		mask;
-bitmap_t *		vmasks;
+struct bt_mask *	carray;
+struct bt_mask *	iarray;
+struct bt_mask		edges_seen;
+struct bt_mask		mask;
+struct bt_mask *	vmasks;
 
 	cip = sip -> cip;
 
 	nedges	= cip -> num_edges;
 
-	carray = NEWA (nedges, bitmap_t);
-	iarray = NEWA (nedges, bitmap_t);
+	carray = NEWA (nedges, struct bt_mask);
+	iarray = NEWA (nedges, struct bt_mask);
 
 	vmasks = sip -> edge_vmasks;
 
 	for (e1 = 0; e1 < nedges; e1++) {
-		imask = 0;
-		cmask = 0;
-		edges_seen = 0;
-		e1_vmask = vmasks [e1];
+		bt_clear (&carray [e1]);
+		bt_clear (&iarray [e1]);
+		bt_clear (&edges_seen);
 		vp1 = cip -> edge [e1];
 		vp2 = cip -> edge [e1 + 1];
 		while (vp1 < vp2) {
@@ -349,21 +483,21 @@ bitmap_t *		vmasks;
 			ep2 = cip -> term_trees [j + 1];
 			while (ep1 < ep2) {
 				e2 = *ep1++;
-				if ((edges_seen & (1 << e2)) NE 0) continue;
-				edges_seen |= (1 << e2);
-				mask = e1_vmask & vmasks [e2];
-				k = NBITSON (mask);
-				if (k EQ 1) {
-					cmask |= (1 << e2);
+				if (BT_TEST (edges_seen, e2)) continue;
+				BT_SET (edges_seen, e2);
+				for (i = 0; i < BT_WORDS; i++) {
+					mask.w [i] =   vmasks [e1].w [i]
+						     & vmasks [e2].w [i];
+				}
+				if (bt_count (&mask) EQ 1) {
+					BT_SET (carray [e1], e2);
 				}
 				else {
 					/* k should be > 1 here! */
-					imask |= (1 << e2);
+					BT_SET (iarray [e1], e2);
 				}
 			}
 		}
-		carray [e1] = cmask;
-		iarray [e1] = imask;
 	}
 
 	sip -> cmasks	= carray;
@@ -461,9 +595,48 @@ perform_search (
 struct sinfo *		sip		/* IN - search/compatibility info */
 )
 {
+int			nthreads;
+gst_solver_ptr		solver;
+gst_param_ptr		params;
+
+	solver = sip -> solver;
+	params = solver -> params;
+
+	/* Set up initial state of best solution so far... */
+	sip -> best_count	= 0;
+
+	sip -> count		= 0; /* Keep track of number of backtracks */
+
+	/* The parallel search keeps only the single best solution, and	*/
+	/* hands it to the solver at the very end.			*/
+	nthreads = _gst_effective_threads (params -> num_threads);
+	if ((nthreads > 1) AND
+	    (solver -> solsize EQ 1) AND
+	    (params -> max_feasible_updates EQ 0)) {
+		parallel_search (sip, nthreads);
+	}
+	else {
+		search_top (sip);
+	}
+}
+
+
+/*
+ * Do the search once for each full-tree that contains the starting
+ * point.
+ */
+
+	static
+	void
+search_top (
+
+struct sinfo *		sip		/* IN - search/compatibility info */
+)
+{
+int			i;
 int			nterms;
-bitmap_t		omit;
-bitmap_t		mask;
+struct bt_mask		omit;
+struct bt_mask		all_edges;
 int			first_point;
 struct gst_hypergraph *	cip;
 int			t;
@@ -472,26 +645,23 @@ int *			endp;
 
 	cip = sip -> cip;
 
-	_gst_initialize_one_bits_in_byte_tables ();
+	bt_from_bitmap (&(sip -> terms_left [0]),
+			cip -> initial_vert_mask,
+			cip -> num_verts);
 
-	/* Set up initial state of best solution so far... */
-	sip -> best_count	= 0;
+	nterms = bt_count (&(sip -> terms_left [0]));
 
-	sip -> terms_left [0] = cip -> initial_vert_mask [0];
+	bt_from_bitmap (&all_edges, cip -> initial_edge_mask, cip -> num_edges);
 
-	mask = sip -> terms_left [0];
-	nterms = NBITSON (mask);
-
-	sip -> compat [0]	= 0;
-	sip -> count		= 0; /* Keep track of number of backtracks */
-	sip -> incompat [0]	= 0;
-	sip -> solution		= 0;
+	bt_clear (&(sip -> compat [0]));
+	bt_clear (&(sip -> incompat [0]));
+	bt_clear (&(sip -> solution));
 
 	/* Do the search once for each full-tree that contains the */
 	/* starting point...					   */
 	first_point = find_starting_point (cip);
 
-	omit = 0;
+	bt_clear (&omit);
 
 	tp1	= cip -> term_trees [first_point];
 	endp	= cip -> term_trees [first_point + 1];
@@ -501,30 +671,344 @@ int *			endp;
 		/* Skip trees that are not part of this component... */
 		if (NOT BITON (cip -> initial_edge_mask, t)) continue;
 
-		sip -> solution |= (1 << t);
+		BT_SET (sip -> solution, t);
 
-		sip -> terms_left [1] =
-			sip -> terms_left [0] & ~(sip -> edge_vmasks [t]);
+		bt_and_not (&(sip -> terms_left [1]),
+			    &(sip -> terms_left [0]),
+			    &(sip -> edge_vmasks [t]),
+			    BT_WORDS);
 
 		sip -> compat [1] = sip -> cmasks [t];
 
-		sip -> incompat [1] =	sip -> incmasks [t]
-				      | omit
-				      | ~ (cip -> initial_edge_mask [0]);
+		for (i = 0; i < BT_WORDS; i++) {
+			sip -> incompat [1].w [i] =   sip -> incmasks [t].w [i]
+						    | omit.w [i]
+						    | ~ all_edges.w [i];
+		}
 
-		search_recurse (sip,
-				1,
-				nterms - cip -> edge_size [t],
-				cip -> cost [t]);
-		if (sip -> solver -> preempt) {
+		search_node (sip,
+			     1,
+			     nterms - cip -> edge_size [t],
+			     cip -> cost [t]);
+		if (LOAD_ACQUIRE (&(sip -> solver -> preempt)) NE 0) {
 			break; /* preempted */
 		}
 
-		sip -> solution &= ~(1 << t);
-		omit |= (1 << t);
+		BT_CLR (sip -> solution, t);
+		BT_SET (omit, t);
+	}
+}
+
+
+/*
+ * Search the subtree rooted at the given node, using the search
+ * routine that suits the size of the problem.
+ */
+
+	static
+	void
+search_node (
+
+struct sinfo *	sip,		/* IN/OUT - search/compatibility info */
+int		level,		/* IN - recursion level */
+int		nleft,		/* IN - number of terminals left to connect */
+dist_t		length		/* IN - length of current partial soln */
+)
+{
+	if (sip -> nwords EQ 1) {
+		search_recurse_1 (sip, level, nleft, length);
+	}
+	else {
+		search_recurse (sip, level, nleft, length, sip -> nwords);
+	}
+}
+
+
+/*
+ * Search using several threads.  We first run the top levels of the
+ * search (ignoring any solutions), recording each subtree below them
+ * as a task.  The workers then search these subtrees, taking the next
+ * unsearched task each time they finish one, and pruning against a
+ * shared bound.  Once all are done, the best solution is handed to
+ * the solver.
+ */
+
+	static
+	void
+parallel_search (
+
+struct sinfo *		sip,		/* IN - search/compatibility info */
+int			nthreads	/* IN - number of threads to use */
+)
+{
+int			split;
+gst_solver_ptr		solver;
+struct bt_shared	shared;
+
+	solver = sip -> solver;
+
+	_gst_mutex_init (&(shared.lock));
+	shared.master		= sip;
+	shared.task_size	= 64;
+	shared.tasks		= NEWA (shared.task_size, struct bt_task);
+	shared.found		= FALSE;
+	shared.best_length	= 0.0;
+	shared.best_task	= -1;
+	bt_clear (&(shared.best));
+
+	sip -> shared = &shared;
+
+	/* Record the tasks, going deeper until there are enough of	*/
+	/* them.  The nodes above the tasks get counted once more each	*/
+	/* time, just as they would be if the search were repeated.	*/
+	for (split = 1; ; split++) {
+		shared.ntasks	= 0;
+		shared.ndeep	= 0;
+		sip -> count	= 0;
+		sip -> split_level = split;
+		search_top (sip);
+		if (LOAD_ACQUIRE (&(solver -> preempt)) NE 0) break;
+		if (shared.ndeep EQ 0) break;
+		if (shared.ntasks >= BT_TASKS_PER_THREAD * nthreads) break;
+		if (split >= BT_MAX_SPLIT_LEVEL) break;
+	}
+	sip -> split_level = 0;
+
+	shared.next_task	= 0;
+	shared.count		= sip -> count;
+	shared.bound_length	= solver -> upperbound;
+	shared.bound_task	= -1;
+
+	if (nthreads > shared.ntasks) {
+		nthreads = shared.ntasks;
+	}
+	if ((LOAD_ACQUIRE (&(solver -> preempt)) EQ 0) AND (nthreads > 0)) {
+		_gst_run_workers (nthreads, search_worker, &shared);
+	}
+	sip -> count = shared.count;
+
+	if (shared.found) {
+		bt_to_bitmap (sip -> smt,
+			      &(shared.best),
+			      sip -> cip -> num_edge_masks);
+		_gst_update_best_solution_set (solver, NULL, 0, NULL,
+					       sip -> smt);
+	}
+
+	sip -> shared = NULL;
+	free ((char *) shared.tasks);
+	_gst_mutex_destroy (&(shared.lock));
+}
+
+
+/*
+ * Record the given node as a task for the parallel search.
+ */
+
+	static
+	void
+record_task (
+
+struct sinfo *	sip,		/* IN/OUT - search/compatibility info */
+int		level,		/* IN - recursion level */
+int		nleft,		/* IN - number of terminals left to connect */
+dist_t		length		/* IN - length of current partial soln */
+)
+{
+struct bt_shared *	shp;
+struct bt_task *	tp;
+
+	shp = sip -> shared;
+
+	if (shp -> ntasks >= shp -> task_size) {
+		tp = NEWA (2 * shp -> task_size, struct bt_task);
+		memcpy (tp, shp -> tasks, shp -> ntasks * sizeof (*tp));
+		free ((char *) (shp -> tasks));
+		shp -> tasks = tp;
+		shp -> task_size *= 2;
+	}
+
+	tp = &(shp -> tasks [(shp -> ntasks)++]);
+	tp -> level		= level;
+	tp -> nleft		= nleft;
+	tp -> length		= length;
+	tp -> solution		= sip -> solution;
+	tp -> terms_left	= sip -> terms_left [level];
+	tp -> compat		= sip -> compat [level];
+	tp -> incompat		= sip -> incompat [level];
+
+	if (level >= sip -> split_level) {
+		++(shp -> ndeep);
+	}
+}
+
+
+/*
+ * The worker routine of the parallel search.  Each worker has its own
+ * search stacks, and searches one task after another until none remain.
+ */
+
+	static
+	void
+search_worker (
+
+int		id,		/* IN - worker number */
+void *		arg		/* IN - shared search state */
+)
+{
+int			i;
+int			level;
+struct bt_shared *	shp;
+struct bt_task *	tp;
+struct sinfo		sinfo;
+
+	shp = (struct bt_shared *) arg;
+
+	sinfo = *(shp -> master);
+	sinfo.count	= 0;
+	sinfo.synced	= 0;
+	allocate_search_stacks (&sinfo);
+
+	for (;;) {
+		_gst_mutex_lock (&(shp -> lock));
+		i = (shp -> next_task)++;
+		sinfo.bound_length	= shp -> bound_length;
+		sinfo.bound_task	= shp -> bound_task;
+		_gst_mutex_unlock (&(shp -> lock));
+
+		if (i >= shp -> ntasks) break;
+		if (LOAD_ACQUIRE (&(sinfo.solver -> preempt)) NE 0) break;
+
+		tp = &(shp -> tasks [i]);
+		level = tp -> level;
+		sinfo.task			= i;
+		sinfo.solution			= tp -> solution;
+		sinfo.terms_left [level]	= tp -> terms_left;
+		sinfo.compat [level]		= tp -> compat;
+		sinfo.incompat [level]		= tp -> incompat;
+
+		search_node (&sinfo, level, tp -> nleft, tp -> length);
 	}
+
+	sync_worker (&sinfo);
+
+	free_search_stacks (&sinfo);
 }
+
 
+/*
+ * Add this worker's recent nodes to the total, and pick up the
+ * current bound.
+ */
+
+	static
+	void
+sync_worker (
+
+struct sinfo *	sip		/* IN/OUT - search/compatibility info */
+)
+{
+dist_t			bound;
+struct bt_shared *	shp;
+gst_solver_ptr		solver;
+
+	shp	= sip -> shared;
+	solver	= sip -> solver;
+
+	bound = _gst_portfolio_bound (solver);
+
+	_gst_mutex_lock (&(shp -> lock));
+
+	shp -> count += (sip -> count - sip -> synced);
+	sip -> synced = sip -> count;
+	if (shp -> count > solver -> params -> max_backtracks) {
+		/* Stop backtracking immediately! */
+		PREEMPT_SOLVER (solver, GST_SOLVE_MAX_BACKTRACKS);
+	}
+
+	if (bound < shp -> bound_length) {
+		/* A racing branch-and-cut found a better solution,	*/
+		/* which takes precedence over every task.		*/
+		shp -> bound_length	= bound;
+		shp -> bound_task	= -1;
+	}
+
+	sip -> bound_length	= shp -> bound_length;
+	sip -> bound_task	= shp -> bound_task;
+
+	_gst_mutex_unlock (&(shp -> lock));
+}
+
+
+/*
+ * Offer the current (complete) solution of a worker as the best one.
+ * Its length is summed in edge order, exactly as the solver does.  A
+ * new best solution is also posted for any racing branch-and-cut.
+ */
+
+	static
+	void
+offer_solution (
+
+struct sinfo *	sip		/* IN/OUT - search/compatibility info */
+)
+{
+int			i;
+int			nedges;
+int			nmasks;
+bool			best;
+dist_t			length;
+dist_t *		cost;
+bitmap_t *		smt;
+struct bt_shared *	shp;
+
+	shp	= sip -> shared;
+	nedges	= sip -> cip -> num_edges;
+	cost	= sip -> cip -> cost;
+
+	length = 0.0;
+	for (i = 0; i < nedges; i++) {
+		if (BT_TEST (sip -> solution, i)) {
+			length += cost [i];
+		}
+	}
+	_gst_store_double (&length, length);
+
+	_gst_mutex_lock (&(shp -> lock));
+
+	best = FALSE;
+	if ((NOT shp -> found) OR
+	    (length < shp -> best_length) OR
+	    ((length EQ shp -> best_length) AND
+	     (sip -> task < shp -> best_task))) {
+		shp -> found		= TRUE;
+		shp -> best_length	= length;
+		shp -> best_task	= sip -> task;
+		shp -> best		= sip -> solution;
+		best = TRUE;
+	}
+	if ((length < shp -> bound_length) OR
+	    ((length EQ shp -> bound_length) AND
+	     (sip -> task < shp -> bound_task))) {
+		shp -> bound_length	= length;
+		shp -> bound_task	= sip -> task;
+	}
+
+	sip -> bound_length	= shp -> bound_length;
+	sip -> bound_task	= shp -> bound_task;
+
+	_gst_mutex_unlock (&(shp -> lock));
+
+	if (best AND (sip -> solver -> portfolio NE NULL)) {
+		/* The solver's own buffer is shared by all workers. */
+		nmasks = sip -> cip -> num_edge_masks;
+		smt = NEWA (nmasks, bitmap_t);
+		bt_to_bitmap (smt, &(sip -> solution), nmasks);
+		_gst_portfolio_export (sip -> solver, length, smt);
+		free ((char *) smt);
+	}
+}
+
 /*
  * This routine allocates all of the search stacks needed.
  */
@@ -545,9 +1029,11 @@ struct gst_hypergraph *	cip;
 
 	n = (nedges + 1);
 
-	sip -> terms_left	= NEWA (n, bitmap_t);
-	sip -> compat		= NEWA (n, bitmap_t);
-	sip -> incompat		= NEWA (n, bitmap_t);
+	sip -> terms_left	= NEWA (n, struct bt_mask);
+	sip -> compat		= NEWA (n, struct bt_mask);
+	sip -> incompat		= NEWA (n, struct bt_mask);
+
+	sip -> smt		= NEWA (cip -> num_edge_masks, bitmap_t);
 }
 
 /*
@@ -561,6 +1047,7 @@ free_search_stacks (
 struct sinfo *		sip		/* IN - search info. */
 )
 {
+	free ((char *) sip -> smt);
 	free ((char *) sip -> incompat);
 	free ((char *) sip -> compat);
 	free ((char *) sip -> terms_left);
@@ -568,6 +1055,7 @@ struct sinfo *		sip		/* IN - search info. */
 	sip -> terms_left	= NULL;
 	sip -> compat		= NULL;
 	sip -> incompat		= NULL;
+	sip -> smt		= NULL;
 }
 
 /*
@@ -640,63 +1128,28 @@ search_recurse (
 struct sinfo *	sip,		/* IN/OUT - search/compatibility info */
 int		level,		/* IN - recursion level */
 int		nleft,		/* IN - number of terminals left to connect */
-dist_t		length		/* IN - length of current partial soln */
+dist_t		length,		/* IN - length of current partial soln */
+int		nw		/* IN - number of mask words in use */
 )
 {
+int			i;
+int			j;
 int			k;
-bitmap_t *		terms_left;
-bitmap_t *		compat;
-bitmap_t *		incompat;
-bitmap_t		omit;
-bitmap_t		mask;
-int			i1;
-bitmap_t		word;
-int			bitno;
-int8u *			p1;
-int8u *			p2;
-int			byte;
+struct bt_mask *	terms_left;
+struct bt_mask *	compat;
+struct bt_mask *	incompat;
+struct bt_mask		omit;
+struct bt_mask		feasible;
+struct bt_mask		mask;
+int64u			word;
 struct gst_hypergraph *	cip;
 gst_solver_ptr		solver;
-gst_param_ptr	  	params;
-
-	solver = sip -> solver;
-	params = solver -> params;
 
-	/* Chalk up another backtrack search "node"... */
-	++(sip -> count);
-	if (sip -> count > params -> max_backtracks) {
-		/* Stop backtracking immediately! */
-		PREEMPT_SOLVER (solver, GST_SOLVE_MAX_BACKTRACKS);
+	if (cutoff_node (sip, level, nleft, length, nw)) {
 		return;
 	}
 
-	if (nleft > 0) {
-		if (length >= solver -> upperbound) {
-			/* Current partial solution is already too long	*/
-			/* to ever become the best seen so far...	*/
-			return;
-		}
-	}
-	else {
-		FATAL_ERROR_IF (nleft < 0);
-
-		/* All terminals have been connected!  We have	*/
-		/* a new solution!  Save it off.		*/
-
-		if (_gst_update_best_solution_set (solver, NULL, 0, NULL,
-					      &sip -> solution)) {
-			/* It is a new BEST solution */
-		}
-		return;
-	}
-
-	if ((nleft >= 10) AND
-	    find_inaccessible_terminal (sip, level)) {
-		/* There is a terminal still to be hooked up such that	*/
-		/* none of its full-trees is compatible with the	*/
-		/* current partial solution!  Early cutoff!		*/
-		return;
-	}
+	solver = sip -> solver;
 
 	terms_left	= &(sip -> terms_left [level]);
 
@@ -755,54 +1208,271 @@ gst_param_ptr	  	params;
 	/* Determine the set of trees we will try to add to the	*/
 	/* partial solution.					*/
 
-	word = compat [0] & ~incompat [0];
+	bt_and_not (&feasible, &compat [0], &incompat [0], nw);
 
-	omit = 0;
+	for (i = 0; i < nw; i++) {
+		omit.w [i] = 0;
+	}
 
 	/* Loop over each feasible full-tree. */
 
-	for (bitno = 0; word NE 0; bitno += 8, word >>= 8) {
-		byte = (word & 0xFF);
-		if (byte EQ 0) continue;
-		p1 = gst_env -> one_bits_in_byte [byte];
-		p2 = gst_env -> one_bits_in_byte [byte + 1];
-		while (p1 < p2) {
-			k = bitno + *p1++;
+	for (i = 0; i < nw; i++) {
+		word = feasible.w [i];
+		while (word NE 0) {
+			k = i * BT_WORD_BITS + BT_CTZ (word);
+			word &= (word - 1);
+
 			/* Full-set K is feasible.  Test to see	*/
 			/* if it is truly compatible...		*/
 
-			mask = sip -> edge_vmasks [k] & ~terms_left [0];
-			i1 = NBITSON (mask);
-			if (i1 NE 1) continue;
+			bt_and_not (&mask,
+				    &(sip -> edge_vmasks [k]),
+				    &terms_left [0],
+				    nw);
+			if (NOT bt_single_bit (&mask, nw)) continue;
 
 			/* Tree K intersects the current partial */
 			/* solution at exactly one point!	 */
 
-			compat [1] = compat [0] | sip -> cmasks [k];
-
-			incompat [1] =	  incompat [0]
-					| sip -> incmasks [k]
-					| omit;
+			for (j = 0; j < nw; j++) {
+				compat [1].w [j] =   compat [0].w [j]
+						   | sip -> cmasks [k].w [j];
+				incompat [1].w [j] =   incompat [0].w [j]
+						     | sip -> incmasks [k].w [j]
+						     | omit.w [j];
+			}
 
-			terms_left [1] =
-				terms_left [0] & ~ sip -> edge_vmasks [k];
+			bt_and_not (&terms_left [1],
+				    &terms_left [0],
+				    &(sip -> edge_vmasks [k]),
+				    nw);
 
-			sip -> solution |= (1 << k);
+			BT_SET (sip -> solution, k);
 
 			search_recurse (sip,
 					level + 1,
 					nleft - cip -> edge_size [k] + 1,
-					length + cip -> cost [k]);
+					length + cip -> cost [k],
+					nw);
 
-			if (solver -> preempt) {
+			if (LOAD_ACQUIRE (&(solver -> preempt)) NE 0) {
 				return;
 			}
 
-			sip -> solution &= ~(1 << k);
-			omit |= (1 << k);
+			BT_CLR (sip -> solution, k);
+			BT_SET (omit, k);
 		}
 	}
 }
+
+/*
+ * The same as search_recurse(), for problems whose vertex and edge
+ * masks all fit within a single word.  This is the usual case, and
+ * handling it separately lets every mask live in a register.
+ */
+
+	static
+	void
+search_recurse_1 (
+
+struct sinfo *	sip,		/* IN/OUT - search/compatibility info */
+int		level,		/* IN - recursion level */
+int		nleft,		/* IN - number of terminals left to connect */
+dist_t		length		/* IN - length of current partial soln */
+)
+{
+int			k;
+int64u			omit;
+int64u			feasible;
+int64u			mask;
+struct bt_mask *	terms_left;
+struct bt_mask *	compat;
+struct bt_mask *	incompat;
+struct gst_hypergraph *	cip;
+gst_solver_ptr		solver;
+
+	if (cutoff_node (sip, level, nleft, length, 1)) {
+		return;
+	}
+
+	solver = sip -> solver;
+
+	terms_left	= &(sip -> terms_left [level]);
+
+	compat		= &(sip -> compat [level]);
+	incompat	= &(sip -> incompat [level]);
+
+	cip = sip -> cip;
+
+	feasible = compat [0].w [0] & ~(incompat [0].w [0]);
+
+	omit = 0;
+
+	while (feasible NE 0) {
+		k = BT_CTZ (feasible);
+		feasible &= (feasible - 1);
+
+		/* Full-set K is feasible.  Test to see if it is truly	*/
+		/* compatible...					*/
+
+		mask = sip -> edge_vmasks [k].w [0] & ~(terms_left [0].w [0]);
+		if ((mask EQ 0) OR ((mask & (mask - 1)) NE 0)) continue;
+
+		/* Tree K intersects the current partial solution at	*/
+		/* exactly one point!					*/
+
+		compat [1].w [0]	=   compat [0].w [0]
+					  | sip -> cmasks [k].w [0];
+		incompat [1].w [0]	=   incompat [0].w [0]
+					  | sip -> incmasks [k].w [0]
+					  | omit;
+		terms_left [1].w [0]	=   terms_left [0].w [0]
+					  & ~(sip -> edge_vmasks [k].w [0]);
+
+		sip -> solution.w [0] |= BT_BIT (k);
+
+		search_recurse_1 (sip,
+				  level + 1,
+				  nleft - cip -> edge_size [k] + 1,
+				  length + cip -> cost [k]);
+
+		if (LOAD_ACQUIRE (&(solver -> preempt)) NE 0) {
+			return;
+		}
+
+		sip -> solution.w [0] &= ~BT_BIT (k);
+		omit |= BT_BIT (k);
+	}
+}
+
+
+/*
+ * This routine does the work common to every node of the search:
+ * it counts the node, records complete solutions, and checks the
+ * simple cutoff conditions.  It returns TRUE if there is nothing more
+ * to do at this node.
+ */
+
+	static
+	bool
+cutoff_node (
+
+struct sinfo *	sip,		/* IN/OUT - search/compatibility info */
+int		level,		/* IN - recursion level */
+int		nleft,		/* IN - number of terminals left to connect */
+dist_t		length,		/* IN - length of current partial soln */
+int		nw		/* IN - number of mask words in use */
+)
+{
+gst_solver_ptr		solver;
+gst_param_ptr	  	params;
+
+	if (sip -> split_level > 0) {
+		/* Recording tasks for the parallel search. */
+		if ((level >= sip -> split_level) OR (nleft <= 0)) {
+			record_task (sip, level, nleft, length);
+			return (TRUE);
+		}
+	}
+	else if (sip -> shared NE NULL) {
+		return (parallel_cutoff_node (sip, level, nleft, length, nw));
+	}
+
+	solver = sip -> solver;
+	params = solver -> params;
+
+	/* Chalk up another backtrack search "node"... */
+	++(sip -> count);
+	if (sip -> count > params -> max_backtracks) {
+		/* Stop backtracking immediately! */
+		PREEMPT_SOLVER (solver, GST_SOLVE_MAX_BACKTRACKS);
+		return (TRUE);
+	}
+	if ((sip -> count % BT_SYNC_NODES) EQ 0) {
+		_gst_portfolio_import (solver);
+	}
+
+	if (nleft > 0) {
+		if (length >= solver -> upperbound) {
+			/* Current partial solution is already too long	*/
+			/* to ever become the best seen so far...	*/
+			return (TRUE);
+		}
+	}
+	else {
+		FATAL_ERROR_IF (nleft < 0);
+
+		/* All terminals have been connected!  We have	*/
+		/* a new solution!  Save it off.		*/
+
+		bt_to_bitmap (sip -> smt,
+			      &(sip -> solution),
+			      sip -> cip -> num_edge_masks);
+		if (_gst_update_best_solution_set (solver, NULL, 0, NULL,
+					      sip -> smt)) {
+			/* It is a new BEST solution */
+		}
+		return (TRUE);
+	}
+
+	if ((nleft >= 10) AND
+	    find_inaccessible_terminal (sip, level, nw)) {
+		/* There is a terminal still to be hooked up such that	*/
+		/* none of its full-trees is compatible with the	*/
+		/* current partial solution!  Early cutoff!		*/
+		return (TRUE);
+	}
+
+	return (FALSE);
+}
+
+
+/*
+ * The same as cutoff_node(), for a worker of the parallel search.
+ */
+
+	static
+	bool
+parallel_cutoff_node (
+
+struct sinfo *	sip,		/* IN/OUT - search/compatibility info */
+int		level,		/* IN - recursion level */
+int		nleft,		/* IN - number of terminals left to connect */
+dist_t		length,		/* IN - length of current partial soln */
+int		nw		/* IN - number of mask words in use */
+)
+{
+	++(sip -> count);
+	if (sip -> count - sip -> synced >= BT_SYNC_NODES) {
+		sync_worker (sip);
+		if (LOAD_ACQUIRE (&(sip -> solver -> preempt)) NE 0) {
+			return (TRUE);
+		}
+	}
+
+	if (nleft > 0) {
+		if ((length > sip -> bound_length) OR
+		    ((length EQ sip -> bound_length) AND
+		     (sip -> bound_task <= sip -> task))) {
+			/* Cannot beat the best solution seen so far. */
+			return (TRUE);
+		}
+	}
+	else {
+		FATAL_ERROR_IF (nleft < 0);
+
+		offer_solution (sip);
+		return (TRUE);
+	}
+
+	if ((nleft >= 10) AND
+	    find_inaccessible_terminal (sip, level, nw)) {
+		return (TRUE);
+	}
+
+	return (FALSE);
+}
+
 
 /*
  * This routine checks the given node level to see if there are any
@@ -814,33 +1484,26 @@ gst_param_ptr	  	params;
 find_inaccessible_terminal (
 
 struct sinfo *	sip,		/* IN - search/compatibility info */
-int		level		/* IN - recursion level */
+int		level,		/* IN - recursion level */
+int		nw		/* IN - number of mask words in use */
 )
 {
+int			i;
 int			t;
-int			bitno;
-int			byte;
-bitmap_t		cur_incompat;
-bitmap_t		word;
-bitmap_t		mask;
-int8u *			p1;
-int8u *			p2;
-
-	cur_incompat = sip -> incompat [level];
+int64u			word;
+struct bt_mask *	cur_incompat;
 
-	word = sip -> terms_left [level];
+	cur_incompat = &(sip -> incompat [level]);
 
-	for (bitno = 0; word NE 0; bitno += 8, word >>= 8) {
-		byte = (word & 0xFF);
-		if (byte EQ 0) continue;
+	for (i = 0; i < nw; i++) {
+		word = sip -> terms_left [level].w [i];
+		while (word NE 0) {
+			t = i * BT_WORD_BITS + BT_CTZ (word);
+			word &= (word - 1);
 
-		p1 = gst_env -> one_bits_in_byte [byte];
-		p2 = gst_env -> one_bits_in_byte [byte + 1];
-		while (p1 < p2) {
-			t = bitno + *p1++;
-
-			mask = sip -> vert_emasks [t];
-			if (mask EQ (mask & cur_incompat)) {
+			if (bt_subset (&(sip -> vert_emasks [t]),
+				       cur_incompat,
+				       nw)) {
 				/* EVERY edge containing T has been	*/
 				/* found to be incompatible with >= 1	*/
 				/* edge in the current partial tree	*/
@@ -852,3 +1515,232 @@ int8u *			p2;
 
 	return (FALSE);
 }
+
+/*
+ * Operations on fixed-width masks.
+ */
+
+	static
+	void
+bt_clear (
+
+struct bt_mask *	m		/* OUT - mask to clear */
+)
+{
+int		i;
+
+	for (i = 0; i < BT_WORDS; i++) {
+		m -> w [i] = 0;
+	}
+}
+
+
+
+/*
+ * Compute R = A & ~B over the first NWORDS words.
+ */
+
+	static
+	void
+bt_and_not (
+
+struct bt_mask *	r,		/* OUT - result */
+const struct bt_mask *	a,		/* IN - first operand */
+const struct bt_mask *	b,		/* IN - second operand */
+int			nwords		/* IN - number of words to do */
+)
+{
+int		i;
+
+	for (i = 0; i < nwords; i++) {
+		r -> w [i] = a -> w [i] & ~(b -> w [i]);
+	}
+}
+
+
+
+/*
+ * Return the number of bits set in the given mask.
+ */
+
+	static
+	int
+bt_count (
+
+const struct bt_mask *	m		/* IN - mask to count */
+)
+{
+int		i;
+int		n;
+
+	n = 0;
+	for (i = 0; i < BT_WORDS; i++) {
+		if (m -> w [i] NE 0) {
+			n += BT_POPCOUNT (m -> w [i]);
+		}
+	}
+
+	return (n);
+}
+
+
+
+/*
+ * Return TRUE if-and-only-if exactly one bit is set in the first
+ * NWORDS words of the mask.
+ */
+
+	static
+	bool
+bt_single_bit (
+
+const struct bt_mask *	m,		/* IN - mask to test */
+int			nwords		/* IN - number of words to test */
+)
+{
+int		i;
+int64u		word;
+bool		found;
+
+	found = FALSE;
+	for (i = 0; i < nwords; i++) {
+		word = m -> w [i];
+		if (word EQ 0) continue;
+		if (found OR ((word & (word - 1)) NE 0)) {
+			return (FALSE);
+		}
+		found = TRUE;
+	}
+
+	return (found);
+}
+
+
+
+/*
+ * Return TRUE if-and-only-if every bit in the first NWORDS words of A
+ * is also set in B.
+ */
+
+	static
+	bool
+bt_subset (
+
+const struct bt_mask *	a,		/* IN - first mask */
+const struct bt_mask *	b,		/* IN - second mask */
+int			nwords		/* IN - number of words to test */
+)
+{
+int		i;
+int64u		diff;
+
+	diff = 0;
+	for (i = 0; i < nwords; i++) {
+		diff |= (a -> w [i] & ~(b -> w [i]));
+	}
+
+	return (diff EQ 0);
+}
+
+
+
+/*
+ * Convert the first N bits of an ordinary bit-map into a mask.
+ */
+
+	static
+	void
+bt_from_bitmap (
+
+struct bt_mask *	m,		/* OUT - mask */
+bitmap_t *		bm,		/* IN - bit-map to convert */
+int			n		/* IN - number of bits */
+)
+{
+int		i;
+
+	FATAL_ERROR_IF (n > BACKTRACK_MAX_SIZE);
+
+	bt_clear (m);
+	for (i = 0; i < n; i++) {
+		if (BITON (bm, i)) {
+			BT_SET (*m, i);
+		}
+	}
+}
+
+
+
+/*
+ * Convert a mask into an ordinary bit-map of NWORDS words.
+ */
+
+	static
+	void
+bt_to_bitmap (
+
+bitmap_t *		bm,		/* OUT - bit-map */
+const struct bt_mask *	m,		/* IN - mask to convert */
+int			nwords		/* IN - size of bit-map in words */
+)
+{
+int		i;
+
+	FATAL_ERROR_IF (nwords * BPW > BACKTRACK_MAX_SIZE);
+
+	for (i = 0; i < nwords; i++) {
+		bm [i] = (bitmap_t) (m -> w [(i * BPW) / BT_WORD_BITS]
+				     >> ((i * BPW) % BT_WORD_BITS));
+	}
+}
+
+
+
+/*
+ * Portable versions of count-trailing-zeros and population count.
+ */
+
+#ifndef __GNUC__
+
+	static
+	int
+bt_ctz (
+
+int64u		word		/* IN - non-zero word */
+)
+{
+int		n;
+
+	n = 0;
+	while ((word & 0xFF) EQ 0) {
+		word >>= 8;
+		n += 8;
+	}
+	while ((word & 1) EQ 0) {
+		word >>= 1;
+		++n;
+	}
+
+	return (n);
+}
+
+
+	static
+	int
+bt_popcount (
+
+int64u		word		/* IN - word to count */
+)
+{
+int		n;
+
+	n = 0;
+	while (word NE 0) {
+		n += _gst_nbits [word & 0xFF];
+		word >>= 8;
+	}
+
+	return (n);
+}
+
+#endif
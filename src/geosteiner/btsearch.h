@@ -35,6 +35,13 @@
 
 struct gst_solver;
 
+/*
+ * The largest number of vertices, and of edges, that the backtrack
+ * search can handle.  Must be a multiple of 64.
+ */
+
+#define	BACKTRACK_MAX_SIZE	256
+
 
 /*
  * Function Prototypes
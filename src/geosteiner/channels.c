@@ -36,6 +36,7 @@
 #include "memory.h"
 #include "prepostlude.h"
 #include "steiner.h"
+#include "threads.h"
 #include <errno.h>
 #include <stdarg.h>
 #include <string.h>
@@ -55,6 +56,16 @@ static const gst_channel_options	default_channel_options = {
 
 #define GST_CHNTYPE_FILE	1
 #define GST_CHNTYPE_FUNCTION	2
+#define GST_CHNTYPE_ASYNC	3
+
+#define DEFAULT_ASYNC_BUFSIZE	(1 << 20)
+#define	CACHE_LINE_SIZE		64
+#define	ASYNC_BATCH_TIME	0.001	/* seconds to gather text */
+
+/* States of the consumer of an asynchronous destination */
+#define	ASYNC_BUSY		0	/* writing the file */
+#define	ASYNC_ASLEEP		1	/* waiting for any text */
+#define	ASYNC_GATHERING		2	/* waiting for more text */
 
 /*
  * Local Types
@@ -65,6 +76,46 @@ struct funcdest {
 	void *			handle;		/* data to pass */
 };
 
+/*
+ * An asynchronous file destination.  Writing to it just copies the
+ * text into a ring buffer, from which a background thread writes it
+ * to the file.  Writers are serialized by the channel lock, so the
+ * buffer has a single producer and a single consumer: the producer
+ * alone advances HEAD, and the consumer TAIL.  Both are running byte
+ * counts, reduced modulo the (power of two) buffer size when
+ * indexing.  A write that does not fit into the free space is dropped
+ * entirely, and counted.
+ *
+ * When the buffer is empty, the consumer sleeps on WAKEUP until text
+ * arrives.  It then lets more text gather for a moment, unless the
+ * buffer is half full, so that it writes the file in large pieces.
+ * WAITING tells the producer which of these it is doing.  The
+ * producer takes LOCK only to wake the consumer, so most writes are
+ * just a copy.
+ */
+
+struct asyncdest {
+	FILE *		filehandle;	/* file to write to */
+	char *		buffer;		/* the ring buffer */
+	size_t		mask;		/* buffer size - 1 */
+
+	size_t		head;		/* bytes written to buffer */
+	size_t		ndropped;	/* writes dropped */
+	size_t		nbytes_dropped;	/* bytes dropped */
+	char		pad1 [CACHE_LINE_SIZE];
+
+	size_t		tail;		/* bytes written to file */
+	int		error;		/* errno of failed file write */
+	int		waiting;	/* what the consumer waits for */
+	char		pad2 [CACHE_LINE_SIZE];
+
+	int		stop;		/* producer is gone */
+	bool		started;	/* background thread is running */
+	struct gst_mutex lock;		/* protects the sleep/wakeup */
+	struct gst_cond	wakeup;		/* signalled when text arrives */
+	struct gst_thread thread;	/* the background thread */
+};
+
 struct gst_destination {
 	gst_channel_ptr		channel;	/* channel that owns us */
 	gst_dest_ptr		prev;		/* previous dest */
@@ -74,6 +125,7 @@ struct gst_destination {
 	union {
 		FILE *		filehandle;	/* open file output stream */
 		struct funcdest	func;		/* function destination */
+		struct asyncdest * async;	/* asynchronous destination */
 	} u;
 };
 
@@ -81,11 +133,14 @@ struct gst_destination {
  * Local Routines
  */
 
-static size_t	count_actual_bytes (gst_channel_ptr	chan,
-				    const char *	text,
-				    size_t		nbytes);
-static void	edit_string (char *		buffer,
-			     int		col,
+static void	async_drain (void * arg);
+static void	async_stop (struct asyncdest * ap);
+static void	async_wait (struct asyncdest * ap, size_t tail);
+static void	async_wake (struct asyncdest * ap);
+static int	async_write (struct asyncdest *	ap,
+			     const char *	text,
+			     size_t		nbytes);
+static size_t	edit_string (char *		buffer,
 			     gst_channel_ptr	chan,
 			     const char *	text,
 			     size_t		nbytes);
@@ -114,6 +169,9 @@ struct gst_channel *	chan;
 
 	chan = NEW (struct gst_channel);
 	chan -> head = NULL;
+	chan -> editbuf = NULL;
+	chan -> editsize = 0;
+	_gst_mutex_init (&(chan -> lock));
 
 	if (opts EQ NULL) {
 		opts = &default_channel_options;
@@ -152,10 +210,17 @@ gst_dest_ptr	next;
 		while (dest NE NULL) {
 			next = dest -> next;
 			/* Note: it is not our job to close streams, etc. */
+			if (dest -> type EQ GST_CHNTYPE_ASYNC) {
+				async_stop (dest -> u.async);
+			}
 			free (dest);
 			dest = next;
 		}
 
+		_gst_mutex_destroy (&(chan -> lock));
+		if (chan -> editbuf NE NULL) {
+			free ((char *) (chan -> editbuf));
+		}
 		free (chan);
 	}
 
@@ -273,6 +338,122 @@ struct gst_destination *	p2;
 	return dest;
 }
 
+/*
+ * Add an asynchronous file destination to a channel.  Text written to
+ * the channel is copied into a ring buffer of (at least) BUFSIZE bytes,
+ * and written to the file by a background thread.  Text that does not
+ * fit into the buffer is dropped.
+ */
+
+	gst_dest_ptr
+gst_channel_add_async_file (
+
+gst_channel_ptr		chan,
+FILE *			fp,
+size_t			bufsize,
+int *			status
+)
+{
+int				res;
+size_t				size;
+struct asyncdest *		ap;
+struct gst_destination *	dest;
+struct gst_destination *	p2;
+
+	GST_PRELUDE
+
+	res = 0;
+	dest = NULL;
+
+	do {		/* Used only for "break" */
+		if (chan EQ NULL) {
+			res = GST_ERR_INVALID_CHANNEL;
+			break;
+		}
+
+		if (bufsize EQ 0) {
+			bufsize = DEFAULT_ASYNC_BUFSIZE;
+		}
+		size = 1;
+		while (size < bufsize) {
+			size <<= 1;
+		}
+
+		ap = NEW (struct asyncdest);
+
+		memset (ap, 0, sizeof (*ap));
+
+		ap -> filehandle	= fp;
+		ap -> buffer		= NEWA (size, char);
+		ap -> mask		= size - 1;
+		_gst_mutex_init (&(ap -> lock));
+		_gst_cond_init (&(ap -> wakeup));
+		ap -> started		= _gst_start_thread (&(ap -> thread),
+							     async_drain,
+							     ap);
+
+		dest = NEW (struct gst_destination);
+
+		memset (dest, 0, sizeof (*dest));
+
+		p2 = chan -> head;
+
+		dest -> channel		= chan;
+		dest -> prev		= NULL;
+		dest -> next		= p2;
+		dest -> type		= GST_CHNTYPE_ASYNC;
+		dest -> u.async		= ap;
+
+		if (p2 NE NULL) {
+			p2 -> prev = dest;
+		}
+
+		chan -> head		= dest;
+	} while (FALSE);
+
+	if (status NE NULL) {
+		*status = res;
+	}
+
+	GST_POSTLUDE
+	return dest;
+}
+
+/*
+ * Get the number of writes (and bytes) that an asynchronous
+ * destination had to drop because its buffer was full.
+ */
+
+	int
+gst_channel_get_dropped (
+
+gst_dest_ptr	dest,
+size_t *	nwrites,
+size_t *	nbytes
+)
+{
+int		res;
+
+	GST_PRELUDE
+
+	res = 0;
+
+	if ((dest EQ NULL) OR (dest -> type NE GST_CHNTYPE_ASYNC)) {
+		res = GST_ERR_INVALID_CHANNEL;
+	}
+	else {
+		if (nwrites NE NULL) {
+			*nwrites = dest -> u.async -> ndropped;
+		}
+		if (nbytes NE NULL) {
+			*nbytes = dest -> u.async -> nbytes_dropped;
+		}
+	}
+
+	GST_POSTLUDE
+	return res;
+}
+
 /*
  * Remove a destination from a channel.
  */
@@ -302,6 +483,9 @@ gst_dest_ptr	p2;
 			p2 -> prev	= p1;
 		}
 
+		if (dest -> type EQ GST_CHNTYPE_ASYNC) {
+			async_stop (dest -> u.async);
+		}
 		free (dest);
 	}
 
@@ -310,7 +494,8 @@ gst_dest_ptr	p2;
 }
 
 /*
- * Write a string to all destinations in a channel.
+ * Write a string to all destinations in a channel.  Writers are
+ * serialized, so that text from different threads is never mixed up.
  */
 
 	int
@@ -323,11 +508,11 @@ size_t			nbytes
 {
 int				i;
 int				res;
-int				column;
+int				indent;
 size_t				nactual;
+size_t				maxbytes;
 gst_channel_options *		opts;
 struct gst_destination *	dest;
-char *				buffer;
 const char *			wbuf;
 
 	GST_PRELUDE
@@ -335,30 +520,36 @@ const char *			wbuf;
 	res = 0;
 
 	if (chan NE NULL) {
-		opts = &(chan -> options);
-
-		column = opts -> column;
+		_gst_mutex_lock (&(chan -> lock));
 
-		/* Count the actual number of bytes we will need to	*/
-		/* write, including indentation, postscript comment	*/
-		/* prefixes, etc.					*/
-		nactual = count_actual_bytes (chan, text, nbytes);
-
-		buffer = NULL;
-		if (nactual > nbytes) {
-			/* We need to edit the text being written.	*/
-			/* Allocate a correctly sized buffer.		*/
-			buffer = NEWA (nactual, char);
-
-			/* Now edit the text, using the original	*/
-			/* starting column.				*/
-			edit_string (buffer, column, chan, text, nbytes);
+		opts = &(chan -> options);
 
-			wbuf = buffer;
+		if ((opts -> indent <= 0) AND
+		    ((opts -> flags & GST_CHFLG_POSTSCRIPT) EQ 0)) {
+			/* No indent and no postscript.  Output is	*/
+			/* unedited, so just write user's buffer.	*/
+			wbuf	= text;
+			nactual	= nbytes;
 		}
 		else {
-			/* No editing.  Just write user's buffer. */
-			wbuf = text;
+			/* Each byte may start a line, and gain the	*/
+			/* indentation and "% " prefix.  Make sure the	*/
+			/* edit buffer can hold the worst case.  It is	*/
+			/* kept, so that it rarely needs to grow.	*/
+			indent = opts -> indent;
+			maxbytes = nbytes * (1 + indent / 8 + indent % 8 + 2);
+			if (maxbytes > chan -> editsize) {
+				if (chan -> editbuf NE NULL) {
+					free ((char *) (chan -> editbuf));
+				}
+				chan -> editsize = 2 * maxbytes;
+				chan -> editbuf = NEWA (chan -> editsize, char);
+			}
+			nactual = edit_string (chan -> editbuf,
+					       chan,
+					       text,
+					       nbytes);
+			wbuf = chan -> editbuf;
 		}
 
 		for (dest = chan -> head; dest NE NULL; dest = dest -> next) {
@@ -368,100 +559,36 @@ const char *			wbuf;
 			}
 		}
 
-		if (buffer NE NULL) {
-			free (buffer);
-		}
+		_gst_mutex_unlock (&(chan -> lock));
 	}
 
 	GST_POSTLUDE
 	return res;
 }
-
-/*
- * Count the actual number of bytes we will be writing.  This is normally
- * just nbytes, except that in certain cases (i.e., in column 0 and we
- * are either indenting or generating postscript comments) we need to
- * write extra stuff.
- */
-
-	size_t
-count_actual_bytes (
-
-gst_channel_ptr		chan,
-const char *		text,
-size_t			nbytes
-)
-{
-int			i;
-int			col;
-size_t			count;
-char			c;
-gst_channel_options *	opts;
-const char *		p;
-const char *		endp;
-
-	opts = &(chan -> options);
-
-	if ((opts -> indent <= 0) AND
-	    (opts -> flags & GST_CHFLG_POSTSCRIPT) EQ 0) {
-		/* No indent and no postscript.  Output is unedited. */
-		return (nbytes);
-	}
 
-	/* Scan the string and count up the chars. */
-
-	col = opts -> column;
-	count = 0;
-
-	p = text;
-	endp = &text [nbytes];
-	while (p < endp) {
-		c = *p++;
-		if ((col <= 0) AND (c NE '\n')) {
-			/* Start of a new line.  Check for indent. */
-			i = opts -> indent;
-			while (i >= 8) {
-				++count;	/* tab char */
-				i -= 8;
-			}
-			count += i;		/* space chars */
-			if ((opts -> flags & GST_CHFLG_POSTSCRIPT) NE 0) {
-				count += 2;	/* "% " */
-			}
-		}
-		++count;
-		switch (c) {
-		case '\n':	col = 0;			break;
-		case '\f':	col = 0;			break;
-		case '\t':	col = (col + 8) & ~0x07;	break;
-		default:	++col;				break;
-		}
-	}
-
-	opts -> column = col;
-
-	return (count);
-}
-
 /*
- * Edit the given string (assuming the given starting column), inserting
- * all indentation and postscript comments required.
+ * Edit the given string (starting in the channel's current column),
+ * inserting all indentation and postscript comments required.  This
+ * is needed only in certain cases (i.e., in column 0 and we are either
+ * indenting or generating postscript comments).  Returns the number of
+ * bytes in the edited string.
  */
 
 	static
-	void
+	size_t
 edit_string (
 
 char *		buffer,		/* IN/OUT - buf to put edited string into */
-int		col,		/* IN - starting column number */
 gst_channel_ptr	chan,		/* IN - channel we are editing for */
 const char *	text,		/* IN - text string to edit */
 size_t		nbytes		/* IN - number of bytes in text string */
 )
 {
 int			i;
+int			col;
 char			c;
 gst_channel_options *	opts;
+char *			start;
 const char *		p;
 const char *		endp;
 
@@ -469,6 +596,8 @@ const char *		endp;
 
 	/* Edit the string. */
 
+	start = buffer;
+	col = opts -> column;
 	p = text;
 	endp = &text [nbytes];
 	while (p < endp) {
@@ -497,8 +626,12 @@ const char *		endp;
 		default:	++col;				break;
 		}
 	}
+
+	opts -> column = col;
+
+	return (buffer - start);
 }
-
+
 /*
  * Write the given string to a single destination.
  */
@@ -536,6 +669,10 @@ gst_channel_func *	funcp;
 		(*funcp) (text, nbytes, dest -> u.func.handle);
 		break;
 
+	case GST_CHNTYPE_ASYNC:
+		res = async_write (dest -> u.async, text, nbytes);
+		break;
+
 	default:
 		FATAL_ERROR;
 	}
@@ -543,6 +680,207 @@ gst_channel_func *	funcp;
 	return (res);
 }
 
+/*
+ * Copy the given string into the ring buffer of an asynchronous
+ * destination.  Without a background thread, write it directly.
+ */
+
+	static
+	int
+async_write (
+
+struct asyncdest *	ap,	/* IN - destination to write to */
+const char *		text,	/* IN - text buffer to write */
+size_t			nbytes	/* IN - number of bytes to write */
+)
+{
+size_t		head;
+size_t		pos;
+size_t		n;
+
+	if (NOT ap -> started) {
+		if (fwrite (text, sizeof (char), nbytes, ap -> filehandle)
+		    NE nbytes) {
+			return (errno);
+		}
+		return (0);
+	}
+
+	head = ap -> head;
+	if (nbytes > ap -> mask + 1 - (head - LOAD_ACQUIRE (&(ap -> tail)))) {
+		++(ap -> ndropped);
+		ap -> nbytes_dropped += nbytes;
+		return (0);
+	}
+
+	pos = head & ap -> mask;
+	n = ap -> mask + 1 - pos;
+	if (n >= nbytes) {
+		memcpy (&(ap -> buffer [pos]), text, nbytes);
+	}
+	else {
+		memcpy (&(ap -> buffer [pos]), text, n);
+		memcpy (ap -> buffer, text + n, nbytes - n);
+	}
+
+	STORE_RELEASE (&(ap -> head), head + nbytes);
+
+	/* The barrier orders the store to HEAD before the load of	*/
+	/* WAITING, pairing with the one in async_wait().  Either the	*/
+	/* consumer sees the new text, or we see that it is asleep.	*/
+	MEMORY_BARRIER ();
+	switch (LOAD_ACQUIRE (&(ap -> waiting))) {
+	case ASYNC_ASLEEP:
+		async_wake (ap);
+		break;
+
+	case ASYNC_GATHERING:
+		if (2 * (head + nbytes - LOAD_ACQUIRE (&(ap -> tail)))
+		    > ap -> mask + 1) {
+			async_wake (ap);
+		}
+		break;
+	}
+
+	/* Report errors from earlier writes to the file. */
+	return (LOAD_ACQUIRE (&(ap -> error)));
+}
+
+/*
+ * The background thread of an asynchronous destination.  Write
+ * whatever is in the ring buffer to the file, until the destination
+ * is removed and the buffer is empty.
+ */
+
+	static
+	void
+async_drain (
+
+void *		arg		/* IN - the asynchronous destination */
+)
+{
+int			stop;
+size_t			head;
+size_t			tail;
+size_t			pos;
+size_t			n;
+struct asyncdest *	ap;
+
+	ap = (struct asyncdest *) arg;
+
+	tail = ap -> tail;
+	for (;;) {
+		/* Look at STOP first: the producer stores it only	*/
+		/* after all of its text is in the buffer.		*/
+		stop = LOAD_ACQUIRE (&(ap -> stop));
+		head = LOAD_ACQUIRE (&(ap -> head));
+		if (head EQ tail) {
+			if (stop) {
+				break;
+			}
+			async_wait (ap, tail);
+			continue;
+		}
+		while (tail NE head) {
+			pos = tail & ap -> mask;
+			n = ap -> mask + 1 - pos;
+			if (n > head - tail) {
+				n = head - tail;
+			}
+			if (fwrite (&(ap -> buffer [pos]),
+				    sizeof (char),
+				    n,
+				    ap -> filehandle) NE n) {
+				STORE_RELEASE (&(ap -> error), errno);
+			}
+			tail += n;
+			STORE_RELEASE (&(ap -> tail), tail);
+		}
+		fflush (ap -> filehandle);
+	}
+}
+
+/*
+ * Put the background thread of an asynchronous destination to sleep
+ * until there is text past TAIL in the buffer, or it must stop.  Then
+ * let more text gather, for at most ASYNC_BATCH_TIME seconds.
+ */
+
+	static
+	void
+async_wait (
+
+struct asyncdest *	ap,	/* IN - the asynchronous destination */
+size_t			tail	/* IN - bytes written to the file */
+)
+{
+	_gst_mutex_lock (&(ap -> lock));
+
+	STORE_RELEASE (&(ap -> waiting), ASYNC_ASLEEP);
+	MEMORY_BARRIER ();
+
+	/* Test again, now that a producer will see WAITING.  Since we	*/
+	/* hold the lock, it cannot signal before we wait.		*/
+	while ((LOAD_ACQUIRE (&(ap -> head)) EQ tail) AND
+	       NOT LOAD_ACQUIRE (&(ap -> stop))) {
+		_gst_cond_wait (&(ap -> wakeup), &(ap -> lock));
+	}
+
+	/* A missed wakeup here only ends the wait at its timeout. */
+	STORE_RELEASE (&(ap -> waiting), ASYNC_GATHERING);
+	MEMORY_BARRIER ();
+	if ((2 * (LOAD_ACQUIRE (&(ap -> head)) - tail) <= ap -> mask + 1) AND
+	    NOT LOAD_ACQUIRE (&(ap -> stop))) {
+		_gst_cond_timedwait (&(ap -> wakeup),
+				     &(ap -> lock),
+				     ASYNC_BATCH_TIME);
+	}
+
+	STORE_RELEASE (&(ap -> waiting), ASYNC_BUSY);
+
+	_gst_mutex_unlock (&(ap -> lock));
+}
+
+/*
+ * Wake the background thread of an asynchronous destination.
+ */
+
+	static
+	void
+async_wake (
+
+struct asyncdest *	ap	/* IN - the asynchronous destination */
+)
+{
+	_gst_mutex_lock (&(ap -> lock));
+	_gst_cond_signal (&(ap -> wakeup));
+	_gst_mutex_unlock (&(ap -> lock));
+}
+
+/*
+ * Stop the background thread of an asynchronous destination, after
+ * it has written everything in the ring buffer.  Then free it.
+ */
+
+	static
+	void
+async_stop (
+
+struct asyncdest *	ap	/* IN - destination to stop */
+)
+{
+	if (ap -> started) {
+		STORE_RELEASE (&(ap -> stop), TRUE);
+		async_wake (ap);
+		_gst_join_thread (&(ap -> thread));
+	}
+	_gst_cond_destroy (&(ap -> wakeup));
+	_gst_mutex_destroy (&(ap -> lock));
+
+	free ((char *) (ap -> buffer));
+	free ((char *) ap);
+}
+
 /*
  * 'printf' a string to all destinations in a channel.
  */
@@ -32,6 +32,7 @@
 #define CHANNELS_H
 
 #include "geosteiner.h"
+#include "threads.h"
 
 /*
  * Global Types
@@ -40,6 +41,9 @@
 struct gst_channel {
 	gst_channel_options	options;
 	gst_dest_ptr		head;
+	struct gst_mutex	lock;		/* serializes writers */
+	char *			editbuf;	/* buffer for edited text */
+	size_t			editsize;	/* size of editbuf */
 };
 
 /*
@@ -50,8 +50,10 @@
 #include "fatal.h"
 #include <float.h>
 #include "geosteiner.h"
+#include "lccache.h"
 #include "logic.h"
 #include <math.h>
+#include <stddef.h>
 #include "memory.h"
 #include "parmblk.h"
 #include "solver.h"
@@ -78,7 +80,15 @@ void		_gst_write_upper_bound_checkpoint (struct bbinfo * bbip);
 
 #define	MAGIC_NUMBER	0xC3CBD0D4	/* 'CKPT' with top bits on... */
 
-#define	LATEST_CHECKPOINT_VERSION	1
+/* Version 2 adds the local cut cache. */
+#define	LATEST_CHECKPOINT_VERSION	2
+
+/*
+ * Checkpoint files contain the fields of a bbnode up to its compact
+ * form, which is never written.
+ */
+
+#define	BBNODE_CKPT_SIZE	offsetof (struct bbnode, pack)
 
 
 /*
@@ -245,6 +255,11 @@ gst_channel_ptr	trace;
 		write_bbtree (fp, bbip, version);
 		if (check_error (fp, tname, trace)) break;
 
+		if (version >= 2) {
+			_gst_write_lc_cache (fp, bbip -> lc_cache);
+			if (check_error (fp, tname, trace)) break;
+		}
+
 		if (fflush (fp) NE 0) {
 			gst_channel_printf (trace,
 				"_gst_write_checkpoint: %s - %s\n",
@@ -380,6 +395,13 @@ int			version;
 
 		if (NOT read_bbtree (fp, bbip, version)) break;
 
+		if (version >= 2) {
+			if (feof (fp)) break;
+			if (NOT _gst_read_lc_cache (fp,
+						    params -> local_cuts_cache_size,
+						    &(bbip -> lc_cache))) break;
+		}
+
 		rval = bbip;
 
 	} while (FALSE);
@@ -630,7 +652,7 @@ struct bbinfo *		bbip;
 	bbip -> ubip		= NULL;
 	bbip -> params		= NULL;
 	bbip -> rcfile		= NULL;
-	bbip -> failed_fcomps	= NULL;
+	bbip -> lc_cache	= NULL;
 	bbip -> next_ckpt_time	= 0;
 	bbip -> force_branch_flag = FALSE;
 
@@ -872,7 +894,14 @@ struct bbnode *		nodep;
 	put_int (tp -> node_policy, fp);
 
 	for (nodep = tp -> first; nodep NE NULL; nodep = nodep -> next) {
-		write_bbnode (fp, nodep, bbip, version);
+		if (nodep -> pack NE NULL) {
+			_gst_expand_bbnode (nodep, bbip);
+			write_bbnode (fp, nodep, bbip, version);
+			_gst_collapse_bbnode (nodep, bbip);
+		}
+		else {
+			write_bbnode (fp, nodep, bbip, version);
+		}
 	}
 }
 
@@ -940,7 +969,7 @@ struct gst_hypergraph *	cip;
 
 	do {	/* Only for "breaking". */
 		/* First, write out the basic node structure. */
-		fwrite (nodep, 1, sizeof (*nodep), fp);
+		fwrite (nodep, 1, BBNODE_CKPT_SIZE, fp);
 
 		if (ferror (fp)) break;
 
@@ -1032,12 +1061,13 @@ struct gst_hypergraph *	cip;
 	do {	/* Only for "breaking". */
 		/* First, read in the basic node structure. */
 		nodep = NEW (struct bbnode);
-		n = fread (nodep, 1, sizeof (*nodep), fp);
-		if (n NE sizeof (*nodep)) break;
+		n = fread (nodep, 1, BBNODE_CKPT_SIZE, fp);
+		if (n NE BBNODE_CKPT_SIZE) break;
 		if (ferror (fp)) break;
 
 		/* Force in the proper owner. */
 		nodep -> owner = bbip;
+		nodep -> pack = NULL;
 
 		/* Allocate the various sub-arrays. */
 		nodep -> x		= NEWA (ncols, double);
@@ -59,6 +59,9 @@
 /* Define if have GMP library available. */
 /* #undef HAVE_GMP */
 
+/* Define if POSIX threads are available. */
+#define HAVE_PTHREADS 1
+
 /* Define if need to work around older CPLEX referencing old <ctype.h> */
 /* stuff that newer glibc's do not define. */
 /* #undef NEED_CTYPE_C */
@@ -94,6 +97,9 @@
 /* Define this if the unlink() function is available */
 #define HAVE_UNLINK 1
 
+/* Define this if the mmap() function is available */
+#define HAVE_MMAP 1
+
 /* Define this if popen is available */
 #define HAVE_POPEN 1
 
@@ -54,8 +54,10 @@
 #include "constrnt.h"
 
 #include "bb.h"
+#include "bbsubs.h"
 #include "channels.h"
 #include "config.h"
+#include "cutrepo.h"
 #include "expand.h"
 #include "fatal.h"
 #include <float.h>
@@ -78,6 +80,10 @@ bool		_gst_add_constraint_to_pool (struct cpool *	pool,
 int		_gst_add_constraints (struct bbinfo *		bbip,
 				      struct constraint *	lcp);
 void		_gst_add_pending_rows_to_LP (struct bbinfo * bbip);
+void		_gst_adjust_row_refc (struct cpool *	pool,
+				      int		n_uids,
+				      int *		bc_uids,
+				      int		delta);
 LP_t *		_gst_build_initial_formulation (
 					struct cpool *		pool,
 					bitmap_t *		vert_mask,
@@ -109,22 +115,32 @@ void		_gst_save_node_basis (struct bbnode *		nodep,
 				      struct bbinfo *		bbip);
 int		_gst_solve_LP_over_constraint_pool (struct bbinfo * bbip);
 
+/*
+ * Local Equates
+ */
+
+	/* Maximum number of coefficient blocks that one garbage	*/
+	/* collection of the constraint pool may compact.		*/
+#define	GC_SLICE_BLOCKS		4
+
+
 /*
  * Local Routines
  */
 
 static double		compute_slack_value (struct rcoef *, double *);
 static void		garbage_collect_pool (struct cpool *, int, int, gst_param_ptr);
+static void		heapify_gc_candidates (int *, int32u *, int);
+static int		pop_gc_candidate (int *, int32u *, int);
 static void		print_pool_memory_usage (struct cpool *,
 						 gst_channel_ptr);
 static void		prune_pending_rows (struct bbinfo *, bool);
 static void		reduce_constraint (struct rcoef *);
-static struct rblk *	reverse_rblks (struct rblk *);
 static int		solve_single_LP (struct bbinfo *,
 					 double *,
 					 double *,
 					 int);
-static void		sort_gc_candidates (int *, int32u *, int);
+static void		sift_gc_candidate (int *, int32u *, int, int);
 static bool		sprint_term (char *, bool, int, int);
 static void		update_lp_solution_history (double *,
 						    double *,
@@ -1238,6 +1254,13 @@ double			prev_z;
 	ncols	= GET_LP_NUM_COLS (lp);
 	nrows	= GET_LP_NUM_ROWS (lp);
 
+	/* Pick up the cuts that other solvers have found. */
+	i = _gst_import_shared_cuts (bbip);
+	if (i > 0) {
+		gst_channel_printf (bbip -> params -> print_solve_trace,
+			"	Imported %d shared constraints.\n", i);
+	}
+
 	if (nodep -> cpiter EQ pool -> uid) {
 		/* nodep -> x is already the optimal solution	*/
 		/* over this constraint pool.			*/
@@ -2234,6 +2257,9 @@ int			num_con;
 		if (newly_added AND violation) {
 			++num_con;
 		}
+		if (newly_added) {
+			_gst_publish_cut (bbip, pool -> cbuf);
+		}
 
 		lcp = lcp -> next;
 	}
@@ -2489,6 +2515,13 @@ double			sum;
  * would never be found by the separation algorithms.  Neither do we
  * remove constraints that have been binding sometime during the most
  * recent few iterations.
+ *
+ * The collection is incremental: the candidates are kept in a heap, so
+ * that only those we actually delete are ordered, and each call deletes
+ * rows from at most GC_SLICE_BLOCKS coefficient blocks.  Only these
+ * blocks are compacted (or freed, when nothing is left in them), so the
+ * coefficients of all other blocks stay where they are.  When one slice
+ * does not bring the pool under its target, the next call continues.
  */
 
 	static
@@ -2504,6 +2537,7 @@ gst_param_ptr		params
 int			i;
 int			j;
 int			k;
+int			b;
 int			maxsize;
 int			minrow;
 int			count;
@@ -2512,18 +2546,23 @@ int			nz;
 int			target;
 int			impending_size;
 int			min_recover;
+int			nblks;
+int			nslice;
+int			len;
 struct rcon *		rcp;
 int *			cnum;
 int32u *		cost;
 bool *			delflags;
 int *			renum;
+int *			rowblk;
 int *			ihookp;
+int *			need;
+bool *			slice;
 struct rblk *		blkp;
+struct rblk **		blks;
+struct rcoef **		newbase;
+struct rcoef **		fill;
 struct rcoef *		p1;
-struct rcoef *		p2;
-struct rcoef *		p3;
-struct rblk *		tmp1;
-struct rblk *		tmp2;
 
 	gst_channel_printf (params -> print_solve_trace, "Entering garbage_collect_pool\n");
 	print_pool_memory_usage (pool, params -> print_solve_trace);
@@ -2629,35 +2668,62 @@ struct rblk *		tmp2;
 		min_recover = impending_size - target;
 	}
 
-	/* Sort candidate rows by cost... */
-	sort_gc_candidates (cnum, cost, count);
+	/* Number the coefficient blocks, oldest first.  The rows are	*/
+	/* allocated from the blocks in sequence, so walking the rows	*/
+	/* in order visits the blocks in this order too.		*/
+	nblks = 0;
+	for (blkp = pool -> blocks; blkp NE NULL; blkp = blkp -> next) {
+		++nblks;
+	}
+	blks = NEWA (nblks, struct rblk *);
+	b = nblks;
+	for (blkp = pool -> blocks; blkp NE NULL; blkp = blkp -> next) {
+		blks [--b] = blkp;
+	}
+
+	rowblk = NEWA (pool -> nrows, int);
+	b = 0;
+	for (i = 0; i < pool -> nrows; i++) {
+		p1 = pool -> rows [i].coefs;
+		while ((p1 < blks [b] -> base) OR (p1 >= blks [b] -> ptr)) {
+			++b;
+			FATAL_ERROR_IF (b >= nblks);
+		}
+		rowblk [i] = b;
+	}
+
+	/* Take the most-costly rows off the heap until we achieve the	*/
+	/* target pool size, or have used up the slice of blocks we	*/
+	/* may touch this time.						*/
+	heapify_gc_candidates (cnum, cost, count);
+
+	slice = NEWA (nblks, bool);
+	memset (slice, 0, nblks * sizeof (bool));
+	delflags = NEWA (pool -> nrows, bool);
+	memset (delflags, 0, pool -> nrows * sizeof (bool));
 
-	/* Find most-costly rows to delete that will achieve	*/
-	/* the target pool size.				*/
+	nslice = 0;
 	minrow = pool -> nrows;
 	nz = 0;
-	i = count - 1;
-	for (;;) {
-		k = cnum [i];
+	while ((count > 0) AND (nz < min_recover)) {
+		k = pop_gc_candidate (cnum, cost, count);
+		--count;
+		b = rowblk [k];
+		if (NOT slice [b]) {
+			if (nslice >= GC_SLICE_BLOCKS) continue;
+			slice [b] = TRUE;
+			++nslice;
+		}
+		delflags [k] = TRUE;
 		nz += pool -> rows [k].len;
 		if (k < minrow) {
 			minrow = k;
 		}
-		if (nz >= min_recover) break;
-		if (i EQ 0) break;
-		--i;
 	}
 
 	/* We are deleting this many non-zeros from the pool... */
 	pool -> num_nz -= nz;
 
-	/* We want to delete constraints numbered cnum [i..count-1]. */
-	delflags = NEWA (pool -> nrows, bool);
-	memset (delflags, 0, pool -> nrows);
-	for (; i < count; i++) {
-		delflags [cnum [i]] = TRUE;
-	}
-
 	/* Compute a map for renumbering the constraints that remain.	*/
 	renum = NEWA (pool -> nrows, int);
 	j = 0;
@@ -2694,131 +2760,181 @@ struct rblk *		tmp2;
 		}
 	}
 
-	/* Delete proper row headers... */
+	/* Delete proper row headers (and their block numbers)... */
 	j = minrow;
 	for (i = minrow; i < pool -> nrows; i++) {
 		if (delflags [i]) continue;
 		pool -> rows [j] = pool -> rows [i];
+		rowblk [j] = rowblk [i];
 		++j;
 	}
 	pool -> nrows = j;
 
-	/* Temporarily reverse the order of the coefficient blocks... */
-	blkp = reverse_rblks (pool -> blocks);
-	pool -> blocks = blkp;
+	/* Tally the space still needed in each block of the slice.	*/
+	need = NEWA (nblks, int);
+	memset (need, 0, nblks * sizeof (int));
+	for (i = 0; i < pool -> nrows; i++) {
+		b = rowblk [i];
+		if (slice [b]) {
+			need [b] += pool -> rows [i].len + 1;
+		}
+	}
+
+	/* Give each block of the slice a new home for its rows.  The	*/
+	/* block we are allocating from is compacted in place, keeping	*/
+	/* its space.  Every other block is trimmed to the exact size	*/
+	/* of what remains in it, since its free space never gets used.	*/
+	newbase = NEWA (nblks, struct rcoef *);
+	fill	= NEWA (nblks, struct rcoef *);
+	for (b = 0; b < nblks; b++) {
+		newbase [b] = blks [b] -> base;
+		if (NOT slice [b]) continue;
+		if ((b < nblks - 1) AND (need [b] > 0)) {
+			newbase [b] = NEWA (need [b], struct rcoef);
+		}
+		fill [b] = newbase [b];
+	}
 
-	/* Now compact the coefficient rows... */
-	p1 = blkp -> base;
-	p2 = blkp -> ptr + blkp -> nfree;
+	/* Now move the coefficient rows of the slice... */
 	for (i = 0; i < pool -> nrows; i++) {
+		b = rowblk [i];
+		if (NOT slice [b]) continue;
 		rcp = &(pool -> rows [i]);
-		p3 = rcp -> coefs;
-		j = rcp -> len + 1;
-		if (p1 + j > p2) {
-			/* Not enough room in current block -- on to next. */
-			blkp -> ptr = p1;
-			blkp -> nfree = p2 - p1;
-			blkp = blkp -> next;
-			p1 = blkp -> base;
-			p2 = blkp -> ptr + blkp -> nfree;
-		}
-		if (p3 NE p1) {
+		len = rcp -> len + 1;
+		p1 = fill [b];
+		if (rcp -> coefs NE p1) {
+			memmove (p1, rcp -> coefs, len * sizeof (*p1));
 			rcp -> coefs = p1;
-			memmove (p1, p3, j * sizeof (*p1));
 		}
-		p1 += j;
+		fill [b] = p1 + len;
 	}
-	blkp -> ptr = p1;
-	blkp -> nfree = p2 - p1;
 
-	/* Free up any blocks that are now unused.  Note: this	*/
-	/* code assumes the first rblk survives!		*/
-	tmp1 = blkp -> next;
-	blkp -> next = NULL;
-	while (tmp1 NE NULL) {
-		tmp2 = tmp1 -> next;
-		tmp1 -> next = NULL;
-		free ((char *) (tmp1 -> base));
-		free ((char *) tmp1);
-		tmp1 = tmp2;
+	/* Update the blocks of the slice, freeing any that are now	*/
+	/* empty, and relink them so that the one we are allocating	*/
+	/* from is first.  Note: the first rblk always survives!	*/
+	pool -> blocks = NULL;
+	for (b = 0; b < nblks; b++) {
+		blkp = blks [b];
+		if (slice [b]) {
+			if (b EQ nblks - 1) {
+				blkp -> nfree += (blkp -> ptr - fill [b]);
+				blkp -> ptr = fill [b];
+			}
+			else if (need [b] <= 0) {
+				free ((char *) (blkp -> base));
+				free ((char *) blkp);
+				continue;
+			}
+			else {
+				free ((char *) (blkp -> base));
+				blkp -> base	= newbase [b];
+				blkp -> ptr	= fill [b];
+				blkp -> nfree	= 0;
+			}
+		}
+		blkp -> next = pool -> blocks;
+		pool -> blocks = blkp;
 	}
 
-	/* Re-reverse list of coefficient blocks so that the one we are	*/
-	/* allocating from is first					*/
-	pool -> blocks = reverse_rblks (pool -> blocks);
-
+	free ((char *) fill);
+	free ((char *) newbase);
+	free ((char *) need);
 	free ((char *) renum);
 	free ((char *) delflags);
+	free ((char *) slice);
+	free ((char *) rowblk);
+	free ((char *) blks);
 	free ((char *) cost);
 	free ((char *) cnum);
 
 	print_pool_memory_usage (pool, params -> print_solve_trace);
 	gst_channel_printf (params -> print_solve_trace, "Leaving garbage_collect_pool\n");
 }
-
+
 /*
- * This routine sorts the candidate rows in order by cost (of retaining
- * them).
+ * This routine arranges the candidate rows into a heap, having the
+ * most costly one (to retain) on top.
  */
 
 	static
 	void
-sort_gc_candidates (
+heapify_gc_candidates (
 
-int *		cnum,		/* IN - constraint numbers within pool */
-int32u *	cost,		/* IN - constraint costs (mem*time products) */
+int *		cnum,		/* IN/OUT - constraint numbers within pool */
+int32u *	cost,		/* IN/OUT - constraint costs (mem*time products) */
 int		n		/* IN - number of candidates */
 )
 {
 int		i;
-int		j;
-int		h;
-int		tmp_cnum;
-int32u		tmp_cost;
 
-	for (h = 1; h <= n; h = 3*h+1) {
+	for (i = n / 2 - 1; i >= 0; i--) {
+		sift_gc_candidate (cnum, cost, i, n);
 	}
+}
 
-	do {
-		h = h / 3;
-		for (i = h; i < n; i++) {
-			tmp_cnum = cnum [i];
-			tmp_cost = cost [i];
-			for (j = i; j >= h; j -= h) {
-				if (cost [j - h] <= tmp_cost) break;
-				cnum [j] = cnum [j - h];
-				cost [j] = cost [j - h];
-			}
-			cnum [j] = tmp_cnum;
-			cost [j] = tmp_cost;
-		}
-	} while (h > 1);
+/*
+ * This routine removes the most costly candidate row from the heap,
+ * and returns its constraint number.  The heap shrinks by one.
+ */
+
+	static
+	int
+pop_gc_candidate (
+
+int *		cnum,		/* IN/OUT - constraint numbers within pool */
+int32u *	cost,		/* IN/OUT - constraint costs (mem*time products) */
+int		n		/* IN - number of candidates in heap */
+)
+{
+int		top;
+
+	FATAL_ERROR_IF (n <= 0);
+
+	top = cnum [0];
+	--n;
+	cnum [0] = cnum [n];
+	cost [0] = cost [n];
+	sift_gc_candidate (cnum, cost, 0, n);
+
+	return (top);
 }
-
+
 /*
- * This routine reverses a list of rblk structures.
+ * This routine moves the candidate at the given heap position down
+ * until neither of its children is more costly.
  */
 
 	static
-	struct rblk *
-reverse_rblks (
+	void
+sift_gc_candidate (
 
-struct rblk *		p		/* IN - list of rblk structures */
+int *		cnum,		/* IN/OUT - constraint numbers within pool */
+int32u *	cost,		/* IN/OUT - constraint costs (mem*time products) */
+int		i,		/* IN - heap position to sift down */
+int		n		/* IN - number of candidates in heap */
 )
 {
-struct rblk *		r;
-struct rblk *		tmp;
+int		j;
+int		tmp_cnum;
+int32u		tmp_cost;
 
-	r = NULL;
-	while (p NE NULL) {
-		tmp = p -> next;
-		p -> next = r;
-		r = p;
-		p = tmp;
+	tmp_cnum = cnum [i];
+	tmp_cost = cost [i];
+	for (;;) {
+		j = 2 * i + 1;
+		if (j >= n) break;
+		if ((j + 1 < n) AND (cost [j + 1] > cost [j])) {
+			++j;
+		}
+		if (cost [j] <= tmp_cost) break;
+		cnum [i] = cnum [j];
+		cost [i] = cost [j];
+		i = j;
 	}
-	return (r);
+	cnum [i] = tmp_cnum;
+	cost [i] = tmp_cost;
 }
-
+
 /*
  * This routine deletes all rows from the LP that are currently slack.
  * Note that these constraints remain in the pool.  This is purely an
@@ -3336,28 +3452,68 @@ struct bbnode *		nodep,		/* IN - BB node to restore */
 struct bbinfo *		bbip		/* IN - branch-and-bound info */
 )
 {
-int			i;
-int			uid;
-int			n_uids;
-struct cpool *		pool;
-struct rcon *		rcp;
-struct rcon *		rcp_endp;
+struct bbpack *		pack;
+
+	pack = nodep -> pack;
+	if (pack NE NULL) {
+		/* Node is in compact form, which holds the basis. */
+		_gst_adjust_row_refc (bbip -> cpool,
+				      pack -> n_uids,
+				      pack -> bc_uids,
+				      -1);
+		_gst_release_bbpack (nodep, bbip);
+		return;
+	}
 
 	if (nodep -> n_uids <= 0) return;
 
-	pool	= bbip -> cpool;
-
 	FATAL_ERROR_IF ((nodep -> bc_uids EQ NULL) OR
 			(nodep -> rstat EQ NULL) OR
 			(nodep -> cstat EQ NULL));
 
-	n_uids	= nodep -> n_uids;
+	_gst_adjust_row_refc (bbip -> cpool,
+			      nodep -> n_uids,
+			      nodep -> bc_uids,
+			      -1);
+
+	/* Free up the list of UIDs... */
+	nodep -> n_uids = 0;
+
+	free ((char *) (nodep -> bc_uids));
+	free ((char *) (nodep -> bc_row));
+	free ((char *) (nodep -> rstat));
+	free ((char *) (nodep -> cstat));
+
+	nodep -> bc_uids = NULL;
+	nodep -> bc_row	 = NULL;
+	nodep -> rstat	 = NULL;
+	nodep -> cstat	 = NULL;
+}
+
+/*
+ * Add DELTA to the reference count of each of the given rows, which
+ * are listed in order by unique ID.
+ */
+
+	void
+_gst_adjust_row_refc (
+
+struct cpool *		pool,		/* IN - constraint pool */
+int			n_uids,		/* IN - number of rows */
+int *			bc_uids,	/* IN - unique IDs of the rows */
+int			delta		/* IN - change in reference count */
+)
+{
+int			i;
+int			uid;
+struct rcon *		rcp;
+struct rcon *		rcp_endp;
 
 	rcp	 = pool -> rows;
 	rcp_endp = rcp + pool -> nrows;
 
 	for (i = 0; i < n_uids; i++) {
-		uid = nodep -> bc_uids [i];
+		uid = bc_uids [i];
 		for (;;) {
 			if (rcp >= rcp_endp) {
 				/* Row not found! */
@@ -3366,21 +3522,8 @@ struct rcon *		rcp_endp;
 			if (rcp -> uid EQ uid) break;
 			++rcp;
 		}
-		--(rcp -> refc);
+		rcp -> refc += delta;
 	}
-
-	/* Free up the list of UIDs... */
-	nodep -> n_uids = 0;
-
-	free ((char *) (nodep -> bc_uids));
-	free ((char *) (nodep -> bc_row));
-	free ((char *) (nodep -> rstat));
-	free ((char *) (nodep -> cstat));
-
-	nodep -> bc_uids = NULL;
-	nodep -> bc_row	 = NULL;
-	nodep -> rstat	 = NULL;
-	nodep -> cstat	 = NULL;
 }
 
 /*
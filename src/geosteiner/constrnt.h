@@ -164,6 +164,10 @@ extern bool	_gst_add_constraint_to_pool (struct cpool *	pool,
 extern int	_gst_add_constraints (struct bbinfo *		bbip,
 				      struct constraint *	lcp);
 extern void	_gst_add_pending_rows_to_LP (struct bbinfo * bbip);
+extern void	_gst_adjust_row_refc (struct cpool *	pool,
+				      int		n_uids,
+				      int *		bc_uids,
+				      int		delta);
 extern LP_t *	_gst_build_initial_formulation (
 					struct cpool *		pool,
 					bitmap_t *		vert_mask,
@@ -0,0 +1,881 @@
+/***********************************************************************
+
+	File:	cutrepo.c
+	Rev:	e-1
+	Date:	10/19/2026
+
+	This work is licensed under a Creative Commons
+	Attribution-NonCommercial 4.0 International License.
+
+************************************************************************
+
+	A repository of cuts shared in memory between solvers of the
+	same hypergraph, whether they run one after another or at the
+	same time.
+
+************************************************************************/
+
+#include "cutrepo.h"
+
+#include "bb.h"
+#include "constrnt.h"
+#include "fatal.h"
+#include "geosteiner.h"
+#include "logic.h"
+#include "memory.h"
+#include "prepostlude.h"
+#include "solver.h"
+#include "steiner.h"
+#include <string.h>
+
+
+/*
+ * Global Routines
+ */
+
+gst_cutrepo_ptr	gst_create_cut_repository (int * status);
+int		gst_free_cut_repository (gst_cutrepo_ptr repo);
+int		gst_get_cut_repository_stats (gst_cutrepo_ptr	repo,
+					      int *		nhypergraphs,
+					      int *		ncuts);
+int		gst_set_solver_cut_repository (gst_solver_ptr	solver,
+					       gst_cutrepo_ptr	repo);
+
+void		_gst_free_cutshare (struct gst_solver * solver);
+int		_gst_import_shared_cuts (struct bbinfo * bbip);
+int		_gst_move_cuts (struct gst_cutrepo *	repo,
+				struct gst_hypergraph *	from,
+				struct gst_hypergraph *	to,
+				int *			emap);
+void		_gst_publish_cut (struct bbinfo * bbip, struct rcoef * rp);
+void		_gst_start_cut_sharing (struct gst_solver * solver);
+
+
+/*
+ * Local Equates
+ */
+
+#define	CUT_HASH_SIZE		1009
+#define	INITIAL_MAX_CUTS	64
+
+#define	HASH_INIT		((int64u) 0xCBF29CE484222325UL)
+#define	HASH_PRIME		((int64u) 0x00000100000001B3UL)
+
+
+/*
+ * Local Types
+ */
+
+/* The cuts of one hypergraph, and what identifies it. */
+struct cutrepo_hg {
+	struct cutrepo_hg *	next;		/* next hypergraph */
+	int64u			hash;		/* hash of what follows */
+	int			nverts;		/* number of vertices */
+	int			nedges;		/* number of edges */
+	int			nvmasks;	/* size of vmask[] */
+	int			nemasks;	/* size of emask[] */
+	int *			edge_size;	/* size of each edge */
+	int *			verts;		/* vertices of all edges */
+	int *			first;		/* start of each edge in */
+						/* verts[] */
+	bitmap_t *		vmask;		/* initial vertex mask */
+	bitmap_t *		emask;		/* initial edge mask */
+
+	int			ncuts;		/* number of cuts */
+	int			maxcuts;	/* allocated size of arrays */
+	struct rcoef **		cuts;		/* coefficients of each cut */
+	int *			len;		/* length of each cut */
+	int *			owner;		/* solver that published it */
+	int *			chain;		/* next cut in hash chain */
+	int			buckets [CUT_HASH_SIZE];
+};
+
+
+/*
+ * Local Routines
+ */
+
+static bool			add_cut (struct cutrepo_hg *,
+					 struct rcoef *,
+					 int);
+static struct cutrepo_hg *	find_hg (struct gst_cutrepo *,
+					 struct gst_hypergraph *);
+static void			free_hg (struct cutrepo_hg *);
+static void			grow_cuts (struct cutrepo_hg *);
+static int			hash_cut (struct rcoef *, int *);
+static int64u			hash_hg (struct gst_hypergraph *);
+static struct cutrepo_hg *	lookup_hg (struct gst_cutrepo *,
+					   struct gst_hypergraph *);
+static bool			same_hg (struct cutrepo_hg *,
+					 struct gst_hypergraph *);
+static bool			sec_implies_cut (struct cutrepo_hg *,
+						 struct rcoef *,
+						 int,
+						 int *);
+static void			sort_cut (struct rcoef *, int);
+
+/*
+ * Create an empty cut repository.
+ */
+
+	gst_cutrepo_ptr
+gst_create_cut_repository (
+
+int *		status		/* OUT - status code */
+)
+{
+gst_cutrepo_ptr		repo;
+
+	GST_PRELUDE
+
+	repo = NEW (struct gst_cutrepo);
+	memset (repo, 0, sizeof (*repo));
+
+	_gst_mutex_init (&(repo -> lock));
+	repo -> hgs	= NULL;
+	repo -> nhgs	= 0;
+	repo -> ncuts	= 0;
+	repo -> next_id	= 0;
+
+	if (status NE NULL) {
+		*status = 0;
+	}
+
+	GST_POSTLUDE
+	return (repo);
+}
+
+/*
+ * Free a cut repository.  No solver may be using it any more.
+ */
+
+	int
+gst_free_cut_repository (
+
+gst_cutrepo_ptr		repo		/* IN - repository to free */
+)
+{
+struct cutrepo_hg *	hgp;
+struct cutrepo_hg *	next;
+
+	GST_PRELUDE
+
+	if (repo NE NULL) {
+		for (hgp = repo -> hgs; hgp NE NULL; hgp = next) {
+			next = hgp -> next;
+			free_hg (hgp);
+		}
+		_gst_mutex_destroy (&(repo -> lock));
+		free ((char *) repo);
+	}
+
+	GST_POSTLUDE
+	return (0);
+}
+
+/*
+ * Get the number of hypergraphs a cut repository has cuts for, and
+ * the total number of cuts.
+ */
+
+	int
+gst_get_cut_repository_stats (
+
+gst_cutrepo_ptr		repo,		/* IN - cut repository */
+int *			nhypergraphs,	/* OUT - number of hypergraphs */
+int *			ncuts		/* OUT - number of cuts */
+)
+{
+	GST_PRELUDE
+
+	_gst_mutex_lock (&(repo -> lock));
+	if (nhypergraphs NE NULL) {
+		*nhypergraphs = repo -> nhgs;
+	}
+	if (ncuts NE NULL) {
+		*ncuts = repo -> ncuts;
+	}
+	_gst_mutex_unlock (&(repo -> lock));
+
+	GST_POSTLUDE
+	return (0);
+}
+
+/*
+ * Make the solver share its cuts through the given repository (or
+ * stop sharing, if the repository is NULL).  The solver publishes
+ * each cut it separates, and imports those published by others each
+ * time it solves an LP over its constraint pool.
+ */
+
+	int
+gst_set_solver_cut_repository (
+
+gst_solver_ptr		solver,		/* IN - solver */
+gst_cutrepo_ptr		repo		/* IN - repository (or NULL) */
+)
+{
+struct cutshare *	csp;
+
+	GST_PRELUDE
+
+	if (solver EQ NULL) {
+		GST_POSTLUDE
+		return (GST_ERR_INVALID_SOLVER);
+	}
+
+	_gst_free_cutshare (solver);
+
+	if (repo NE NULL) {
+		csp = NEW (struct cutshare);
+		csp -> repo	= repo;
+		csp -> hg	= NULL;
+		csp -> next	= 0;
+		_gst_mutex_lock (&(repo -> lock));
+		csp -> id = (repo -> next_id)++;
+		_gst_mutex_unlock (&(repo -> lock));
+		solver -> cutshare = csp;
+	}
+
+	GST_POSTLUDE
+	return (0);
+}
+
+/*
+ * Stop sharing cuts.
+ */
+
+	void
+_gst_free_cutshare (
+
+struct gst_solver *	solver		/* IN - solver */
+)
+{
+	if (solver -> cutshare NE NULL) {
+		free ((char *) (solver -> cutshare));
+		solver -> cutshare = NULL;
+	}
+}
+
+/*
+ * Called before each branch-and-cut.  Look up the cuts for the
+ * solver's hypergraph, which may have changed since the last time.
+ */
+
+	void
+_gst_start_cut_sharing (
+
+struct gst_solver *	solver		/* IN - solver */
+)
+{
+struct cutshare *	csp;
+struct cutrepo_hg *	hgp;
+
+	csp = solver -> cutshare;
+	if (csp EQ NULL) return;
+
+	_gst_mutex_lock (&(csp -> repo -> lock));
+	hgp = find_hg (csp -> repo, solver -> H);
+	if (hgp NE csp -> hg) {
+		csp -> hg	= hgp;
+		csp -> next	= 0;
+	}
+	_gst_mutex_unlock (&(csp -> repo -> lock));
+}
+
+/*
+ * Publish a cut that has just been added to the solver's constraint
+ * pool, unless the repository already has it.  The cut must have been
+ * reduced to lowest terms, as the pool does.
+ */
+
+	void
+_gst_publish_cut (
+
+struct bbinfo *		bbip,		/* IN - branch-and-bound info */
+struct rcoef *		rp		/* IN - the cut */
+)
+{
+struct cutshare *	csp;
+struct cutrepo_hg *	hgp;
+struct gst_cutrepo *	repo;
+
+	csp = bbip -> solver -> cutshare;
+	if ((csp EQ NULL) OR (csp -> hg EQ NULL)) return;
+
+	repo	= csp -> repo;
+	hgp	= csp -> hg;
+
+	_gst_mutex_lock (&(repo -> lock));
+
+	/* Somebody else may have got here first. */
+	if (add_cut (hgp, rp, csp -> id)) {
+		++(repo -> ncuts);
+	}
+
+	_gst_mutex_unlock (&(repo -> lock));
+}
+
+/*
+ * Add the cuts published by other solvers since the last time to the
+ * constraint pool.  They go only into the pool, not the LP, which
+ * picks them up as they become violated.  Returns the number of
+ * constraints added.
+ */
+
+	int
+_gst_import_shared_cuts (
+
+struct bbinfo *		bbip		/* IN - branch-and-bound info */
+)
+{
+int			i;
+int			n;
+struct cutshare *	csp;
+struct cutrepo_hg *	hgp;
+struct cpool *		pool;
+
+	csp = bbip -> solver -> cutshare;
+	if ((csp EQ NULL) OR (csp -> hg EQ NULL)) return (0);
+
+	hgp	= csp -> hg;
+	pool	= bbip -> cpool;
+
+	n = 0;
+
+	_gst_mutex_lock (&(csp -> repo -> lock));
+
+	for (i = csp -> next; i < hgp -> ncuts; i++) {
+		if (hgp -> owner [i] EQ csp -> id) continue;
+
+		/* The pool may modify the row it is given. */
+		memcpy (pool -> cbuf,
+			hgp -> cuts [i],
+			(hgp -> len [i] + 1) * sizeof (struct rcoef));
+		if (_gst_add_constraint_to_pool (pool, pool -> cbuf, FALSE)) {
+			++n;
+		}
+	}
+	csp -> next = hgp -> ncuts;
+
+	_gst_mutex_unlock (&(csp -> repo -> lock));
+
+	return (n);
+}
+
+/*
+ * Move the cuts of hypergraph FROM over to hypergraph TO, after which
+ * the repository forgets FROM.  EMAP gives the edge of TO having the
+ * same vertices as each edge of FROM, or -1 if there is none.  Only
+ * cuts that are implied by a subtour elimination constraint can be
+ * moved: such a cut stays valid when the edges that TO lacks are left
+ * out, and when TO has edges that FROM lacks.  Returns the number of
+ * cuts moved.
+ */
+
+	int
+_gst_move_cuts (
+
+struct gst_cutrepo *	repo,		/* IN - cut repository */
+struct gst_hypergraph *	from,		/* IN - hypergraph having the cuts */
+struct gst_hypergraph *	to,		/* IN - hypergraph to get them */
+int *			emap		/* IN - edge of TO for each edge */
+					/*	of FROM (or -1) */
+)
+{
+int			i;
+int			j;
+int			n;
+int			len;
+int			maxlen;
+int			nmoved;
+int *			mark;
+struct rcoef *		rp;
+struct rcoef *		buf;
+struct cutrepo_hg *	src;
+struct cutrepo_hg *	dst;
+struct cutrepo_hg **	hookp;
+
+	_gst_mutex_lock (&(repo -> lock));
+
+	src = lookup_hg (repo, from);
+	if (src EQ NULL) {
+		_gst_mutex_unlock (&(repo -> lock));
+		return (0);
+	}
+
+	dst = find_hg (repo, to);
+
+	maxlen = 0;
+	for (i = 0; i < src -> ncuts; i++) {
+		if (src -> len [i] > maxlen) {
+			maxlen = src -> len [i];
+		}
+	}
+	buf = NEWA (maxlen + 1, struct rcoef);
+	mark = NEWA (src -> nverts, int);
+	memset (mark, 0, src -> nverts * sizeof (int));
+
+	nmoved = 0;
+	for (i = 0; i < src -> ncuts; i++) {
+		rp	= src -> cuts [i];
+		len	= src -> len [i];
+		if (NOT sec_implies_cut (src, rp, len, mark)) continue;
+
+		n = 0;
+		for (j = 0; j < len; j++) {
+			if (emap [rp [j].var - RC_VAR_BASE] >= 0) {
+				buf [n].var = emap [rp [j].var - RC_VAR_BASE]
+					      + RC_VAR_BASE;
+				buf [n].val = rp [j].val;
+				++n;
+			}
+		}
+		if (n < 2) continue;
+		buf [n] = rp [len];
+		sort_cut (buf, n);
+
+		/* Every solver of TO is to import these. */
+		if (add_cut (dst, buf, -1)) {
+			++nmoved;
+		}
+	}
+
+	free ((char *) mark);
+	free ((char *) buf);
+
+	hookp = &(repo -> hgs);
+	while (*hookp NE src) {
+		hookp = &((*hookp) -> next);
+	}
+	*hookp = src -> next;
+	--(repo -> nhgs);
+	repo -> ncuts += nmoved - src -> ncuts;
+	free_hg (src);
+
+	_gst_mutex_unlock (&(repo -> lock));
+
+	return (nmoved);
+}
+
+/*
+ * Check whether the given cut is implied by the subtour elimination
+ * constraint of some vertex set S, i.e., whether it is a "<=" cut
+ * having positive coefficients, each at most |e & S| - 1, and a
+ * right-hand side of at least |S| - 1.  We try the smallest S that can
+ * do: the vertices of those edges whose coefficient is |e| - 1.  MARK
+ * must be all zero, and is left that way.
+ */
+
+	static
+	bool
+sec_implies_cut (
+
+struct cutrepo_hg *	hgp,		/* IN - entry the cut belongs to */
+struct rcoef *		rp,		/* IN - the cut */
+int			len,		/* IN - number of coefficients */
+int *			mark		/* IN/OUT - scratch, one per vertex */
+)
+{
+int			j;
+int			e;
+int			k;
+int			nset;
+int *			vp1;
+int *			vp2;
+int *			first;
+bool			ok;
+
+	if (rp [len].var NE RC_OP_LE) {
+		return (FALSE);
+	}
+
+	first = hgp -> first;
+
+	ok = TRUE;
+	nset = 0;
+	for (j = 0; j < len; j++) {
+		e = rp [j].var - RC_VAR_BASE;
+		if (rp [j].val <= 0) {
+			ok = FALSE;
+			break;
+		}
+		if (rp [j].val < hgp -> edge_size [e] - 1) continue;
+		vp1 = &(hgp -> verts [first [e]]);
+		vp2 = &(hgp -> verts [first [e + 1]]);
+		while (vp1 < vp2) {
+			if (mark [*vp1] EQ 0) {
+				mark [*vp1] = 1;
+				++nset;
+			}
+			++vp1;
+		}
+	}
+
+	for (j = 0; ok AND (j < len); j++) {
+		e = rp [j].var - RC_VAR_BASE;
+		k = 0;
+		vp1 = &(hgp -> verts [first [e]]);
+		vp2 = &(hgp -> verts [first [e + 1]]);
+		while (vp1 < vp2) {
+			k += mark [*vp1++];
+		}
+		if (rp [j].val > k - 1) {
+			ok = FALSE;
+		}
+	}
+	if (nset - 1 > rp [len].val) {
+		ok = FALSE;
+	}
+
+	for (j = 0; j < len; j++) {
+		e = rp [j].var - RC_VAR_BASE;
+		vp1 = &(hgp -> verts [first [e]]);
+		vp2 = &(hgp -> verts [first [e + 1]]);
+		while (vp1 < vp2) {
+			mark [*vp1++] = 0;
+		}
+	}
+
+	return (ok);
+}
+
+/*
+ * Sort the coefficients of a cut by variable, as the pool has them.
+ */
+
+	static
+	void
+sort_cut (
+
+struct rcoef *		rp,		/* IN/OUT - the cut */
+int			len		/* IN - number of coefficients */
+)
+{
+int			i;
+int			j;
+struct rcoef		tmp;
+
+	for (i = 1; i < len; i++) {
+		tmp = rp [i];
+		for (j = i; (j > 0) AND (rp [j - 1].var > tmp.var); j--) {
+			rp [j] = rp [j - 1];
+		}
+		rp [j] = tmp;
+	}
+}
+
+/*
+ * Add a cut to an entry, unless the entry already has it.  The caller
+ * must hold the lock.  Returns TRUE if the cut was added.
+ */
+
+	static
+	bool
+add_cut (
+
+struct cutrepo_hg *	hgp,		/* IN/OUT - entry */
+struct rcoef *		rp,		/* IN - the cut */
+int			owner		/* IN - solver publishing it */
+)
+{
+int			i;
+int			len;
+int			hval;
+
+	hval = hash_cut (rp, &len);
+
+	for (i = hgp -> buckets [hval]; i >= 0; i = hgp -> chain [i]) {
+		if ((hgp -> len [i] EQ len) AND
+		    (memcmp (hgp -> cuts [i],
+			     rp,
+			     (len + 1) * sizeof (*rp)) EQ 0)) {
+			return (FALSE);
+		}
+	}
+
+	if (hgp -> ncuts >= hgp -> maxcuts) {
+		grow_cuts (hgp);
+	}
+
+	i = (hgp -> ncuts)++;
+	hgp -> cuts [i] = NEWA (len + 1, struct rcoef);
+	memcpy (hgp -> cuts [i], rp, (len + 1) * sizeof (*rp));
+	hgp -> len [i]		= len;
+	hgp -> owner [i]	= owner;
+	hgp -> chain [i]	= hgp -> buckets [hval];
+	hgp -> buckets [hval]	= i;
+
+	return (TRUE);
+}
+
+/*
+ * Find the entry for the given hypergraph, if there is one.  The
+ * caller must hold the lock.
+ */
+
+	static
+	struct cutrepo_hg *
+lookup_hg (
+
+struct gst_cutrepo *	repo,		/* IN - repository */
+struct gst_hypergraph *	H		/* IN - hypergraph */
+)
+{
+int64u			hash;
+struct cutrepo_hg *	hgp;
+
+	hash = hash_hg (H);
+
+	for (hgp = repo -> hgs; hgp NE NULL; hgp = hgp -> next) {
+		if ((hgp -> hash EQ hash) AND same_hg (hgp, H)) {
+			return (hgp);
+		}
+	}
+
+	return (NULL);
+}
+
+/*
+ * Find the entry for the given hypergraph, creating one if there is
+ * none.  The caller must hold the lock.
+ */
+
+	static
+	struct cutrepo_hg *
+find_hg (
+
+struct gst_cutrepo *	repo,		/* IN - repository */
+struct gst_hypergraph *	H		/* IN - hypergraph */
+)
+{
+int			i;
+int			nverts;
+struct cutrepo_hg *	hgp;
+
+	hgp = lookup_hg (repo, H);
+	if (hgp NE NULL) {
+		return (hgp);
+	}
+
+	nverts = H -> edge [H -> num_edges] - H -> edge [0];
+
+	hgp = NEW (struct cutrepo_hg);
+	hgp -> hash	= hash_hg (H);
+	hgp -> nverts	= H -> num_verts;
+	hgp -> nedges	= H -> num_edges;
+	hgp -> nvmasks	= H -> num_vert_masks;
+	hgp -> nemasks	= H -> num_edge_masks;
+
+	hgp -> edge_size = NEWA (H -> num_edges + 1, int);
+	memcpy (hgp -> edge_size, H -> edge_size, H -> num_edges * sizeof (int));
+	hgp -> verts = NEWA (nverts + 1, int);
+	memcpy (hgp -> verts, H -> edge [0], nverts * sizeof (int));
+	hgp -> first = NEWA (H -> num_edges + 1, int);
+	for (i = 0; i <= H -> num_edges; i++) {
+		hgp -> first [i] = H -> edge [i] - H -> edge [0];
+	}
+	hgp -> vmask = NEWA (hgp -> nvmasks + 1, bitmap_t);
+	memcpy (hgp -> vmask,
+		H -> initial_vert_mask,
+		hgp -> nvmasks * sizeof (bitmap_t));
+	hgp -> emask = NEWA (hgp -> nemasks + 1, bitmap_t);
+	memcpy (hgp -> emask,
+		H -> initial_edge_mask,
+		hgp -> nemasks * sizeof (bitmap_t));
+
+	hgp -> ncuts	= 0;
+	hgp -> maxcuts	= INITIAL_MAX_CUTS;
+	hgp -> cuts	= NEWA (INITIAL_MAX_CUTS, struct rcoef *);
+	hgp -> len	= NEWA (INITIAL_MAX_CUTS, int);
+	hgp -> owner	= NEWA (INITIAL_MAX_CUTS, int);
+	hgp -> chain	= NEWA (INITIAL_MAX_CUTS, int);
+	for (i = 0; i < CUT_HASH_SIZE; i++) {
+		hgp -> buckets [i] = -1;
+	}
+
+	hgp -> next = repo -> hgs;
+	repo -> hgs = hgp;
+	++(repo -> nhgs);
+
+	return (hgp);
+}
+
+/*
+ * Free an entry, and all of its cuts.
+ */
+
+	static
+	void
+free_hg (
+
+struct cutrepo_hg *	hgp		/* IN - entry to free */
+)
+{
+int			i;
+
+	for (i = 0; i < hgp -> ncuts; i++) {
+		free ((char *) (hgp -> cuts [i]));
+	}
+	free ((char *) (hgp -> chain));
+	free ((char *) (hgp -> owner));
+	free ((char *) (hgp -> len));
+	free ((char *) (hgp -> cuts));
+	free ((char *) (hgp -> emask));
+	free ((char *) (hgp -> vmask));
+	free ((char *) (hgp -> first));
+	free ((char *) (hgp -> verts));
+	free ((char *) (hgp -> edge_size));
+	free ((char *) hgp);
+}
+
+/*
+ * Double the room for cuts in an entry.
+ */
+
+	static
+	void
+grow_cuts (
+
+struct cutrepo_hg *	hgp		/* IN/OUT - entry */
+)
+{
+int			n;
+int *			ip;
+struct rcoef **		cuts;
+
+	n = 2 * hgp -> maxcuts;
+
+	cuts = NEWA (n, struct rcoef *);
+	memcpy (cuts, hgp -> cuts, hgp -> ncuts * sizeof (cuts [0]));
+	free ((char *) (hgp -> cuts));
+	hgp -> cuts = cuts;
+
+	ip = NEWA (n, int);
+	memcpy (ip, hgp -> len, hgp -> ncuts * sizeof (int));
+	free ((char *) (hgp -> len));
+	hgp -> len = ip;
+
+	ip = NEWA (n, int);
+	memcpy (ip, hgp -> owner, hgp -> ncuts * sizeof (int));
+	free ((char *) (hgp -> owner));
+	hgp -> owner = ip;
+
+	ip = NEWA (n, int);
+	memcpy (ip, hgp -> chain, hgp -> ncuts * sizeof (int));
+	free ((char *) (hgp -> chain));
+	hgp -> chain = ip;
+
+	hgp -> maxcuts = n;
+}
+
+/*
+ * Check whether an entry is for the given hypergraph.
+ */
+
+	static
+	bool
+same_hg (
+
+struct cutrepo_hg *	hgp,		/* IN - entry */
+struct gst_hypergraph *	H		/* IN - hypergraph */
+)
+{
+int		nverts;
+
+	if ((hgp -> nverts NE H -> num_verts) OR
+	    (hgp -> nedges NE H -> num_edges)) {
+		return (FALSE);
+	}
+	nverts = H -> edge [H -> num_edges] - H -> edge [0];
+	if (memcmp (hgp -> edge_size,
+		    H -> edge_size,
+		    H -> num_edges * sizeof (int)) NE 0) {
+		return (FALSE);
+	}
+	if (memcmp (hgp -> verts, H -> edge [0], nverts * sizeof (int)) NE 0) {
+		return (FALSE);
+	}
+	if (memcmp (hgp -> vmask,
+		    H -> initial_vert_mask,
+		    hgp -> nvmasks * sizeof (bitmap_t)) NE 0) {
+		return (FALSE);
+	}
+	if (memcmp (hgp -> emask,
+		    H -> initial_edge_mask,
+		    hgp -> nemasks * sizeof (bitmap_t)) NE 0) {
+		return (FALSE);
+	}
+
+	return (TRUE);
+}
+
+/*
+ * Hash the vertices, edges and initial masks of a hypergraph (FNV-1a).
+ */
+
+	static
+	int64u
+hash_hg (
+
+struct gst_hypergraph *	H		/* IN - hypergraph */
+)
+{
+int		i;
+int		n;
+int64u		h;
+int *		vp;
+
+	h = HASH_INIT;
+	h = (h ^ (int64u) H -> num_verts) * HASH_PRIME;
+	h = (h ^ (int64u) H -> num_edges) * HASH_PRIME;
+
+	n = H -> edge [H -> num_edges] - H -> edge [0];
+	vp = H -> edge [0];
+	for (i = 0; i < n; i++) {
+		h = (h ^ (int64u) vp [i]) * HASH_PRIME;
+	}
+	for (i = 0; i < H -> num_edges; i++) {
+		h = (h ^ (int64u) H -> edge_size [i]) * HASH_PRIME;
+	}
+	for (i = 0; i < H -> num_vert_masks; i++) {
+		h = (h ^ (int64u) H -> initial_vert_mask [i]) * HASH_PRIME;
+	}
+	for (i = 0; i < H -> num_edge_masks; i++) {
+		h = (h ^ (int64u) H -> initial_edge_mask [i]) * HASH_PRIME;
+	}
+
+	return (h);
+}
+
+/*
+ * Hash the coefficients of a cut, and get its length (not counting
+ * the operator and right-hand side).
+ */
+
+	static
+	int
+hash_cut (
+
+struct rcoef *		rp,		/* IN - the cut */
+int *			len		/* OUT - number of coefficients */
+)
+{
+int			n;
+int64u			h;
+struct rcoef *		p;
+
+	h = HASH_INIT;
+	n = 0;
+	for (p = rp; p -> var >= RC_VAR_BASE; p++) {
+		h = (h ^ (int64u) p -> var) * HASH_PRIME;
+		h = (h ^ (int64u) p -> val) * HASH_PRIME;
+		++n;
+	}
+	h = (h ^ (int64u) p -> var) * HASH_PRIME;
+	h = (h ^ (int64u) p -> val) * HASH_PRIME;
+
+	*len = n;
+
+	return ((int) (h % CUT_HASH_SIZE));
+}
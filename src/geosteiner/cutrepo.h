@@ -0,0 +1,68 @@
+/***********************************************************************
+
+	File:	cutrepo.h
+	Rev:	e-1
+	Date:	10/19/2026
+
+	This work is licensed under a Creative Commons
+	Attribution-NonCommercial 4.0 International License.
+
+************************************************************************
+
+	Declarations for the repository of cuts shared between
+	solvers.
+
+************************************************************************/
+
+#ifndef	CUTREPO_H
+#define	CUTREPO_H
+
+#include "geosteiner.h"
+#include "gsttypes.h"
+#include "threads.h"
+
+struct bbinfo;
+struct cutrepo_hg;
+struct gst_hypergraph;
+struct gst_solver;
+struct rcoef;
+
+
+/*
+ * A cut repository holds the constraints that solvers have separated,
+ * so that other solvers of the same hypergraph can use them without
+ * separating them again.  The cuts are kept per hypergraph, keyed by
+ * its vertices, edges and initial masks.  A repository may be shared
+ * by any number of solvers, on any number of threads.
+ */
+
+struct gst_cutrepo {
+	struct gst_mutex	lock;		/* protects what follows */
+	struct cutrepo_hg *	hgs;		/* hypergraphs having cuts */
+	int			nhgs;		/* number of hypergraphs */
+	int			ncuts;		/* total number of cuts */
+	int			next_id;	/* next solver ID to hand out */
+};
+
+/*
+ * The link between a solver and the repository it shares cuts in.
+ */
+
+struct cutshare {
+	struct gst_cutrepo *	repo;		/* the repository */
+	struct cutrepo_hg *	hg;		/* solver's hypergraph in it */
+	int			id;		/* our ID as publisher */
+	int			next;		/* first cut not yet imported */
+};
+
+
+extern void	_gst_free_cutshare (struct gst_solver * solver);
+extern int	_gst_import_shared_cuts (struct bbinfo * bbip);
+extern int	_gst_move_cuts (struct gst_cutrepo *	repo,
+				struct gst_hypergraph *	from,
+				struct gst_hypergraph *	to,
+				int *			emap);
+extern void	_gst_publish_cut (struct bbinfo * bbip, struct rcoef * rp);
+extern void	_gst_start_cut_sharing (struct gst_solver * solver);
+
+#endif
@@ -53,10 +53,6 @@
  #include "triangle.h"
 #endif
 
-#ifdef HAVE_GMP
- #include <gmp.h>
-#endif
-
 #define	TEST_DRIVER	0
 
 
@@ -64,6 +60,8 @@
  * Global Routines
  */
 
+int		_gst_delaunay_edges (struct pset *	pts,
+				     struct edge **	edges_out);
 void		_gst_delaunay_triangulation (
 				struct pset *	pts,
 				int *		numberofedges,
@@ -76,15 +74,12 @@ void		_gst_delaunay_triangulation (
  * Local Types
  */
 
-#ifndef USE_TRIANGLE
-
 struct E {				/* A directed edge */
 	int		src;		/* Source node */
 	int		dst;		/* Destination node */
 	struct E *	vnext;		/* Next edge CCW around src vertex */
 	struct E *	vprev;		/* Prev edge CCW around src vertex */
 	struct E *	rev;		/* Oppositely directed edge */
-	struct E *	snext;		/* Next edge on stack */
 	int		flags;		/* Various flags */
 	int		face;		/* Face number of edge */
 };
@@ -93,29 +88,21 @@ struct E {				/* A directed edge */
 
 #define	XF		0x01		/* Edge is part of exterior face */
 #define ONX		0x02		/* Edge is on exterior of triangulation */
-#define INSTACK		0x04		/* Edge is on the stack */
+#define DEAD		0x04		/* Edge has been deleted */
 #define MARK		0x08		/* Edge has been traversed */
 
 struct DTinfo {
 	struct pset *	pts;		/* The input point set */
-	int		num_edges;	/* Number of edges */
+	struct pset *	spts;		/* Distinct points, sorted by X, Y */
+	int *		verts;		/* Input index of each sorted point */
+	int		num_edges;	/* Number of edge slots used */
 	int		num_tri;	/* Number of triangles */
 	struct E *	edges;		/* Array of edge structures */
-	struct E **	vfirst;		/* First edge for each vertex */
+	struct E *	free_edges;	/* Deleted edge pairs, linked by vnext */
 };
 
 typedef struct E *	Eptr;
 
-#ifdef HAVE_GMP
- /* A point structure that uses GMP arbitrary precision integers */
- /* in a "fixed point" mode. */
-
- struct gmp_point {
-	mpz_t	x;
-	mpz_t	y;
- };
-#endif
-
 
 /*
  * Local Routines
@@ -124,18 +111,27 @@ typedef struct E *	Eptr;
 static bool	bends_left (struct pset * pts, int p1, int p2, int p3);
 static bool	bends_right (struct pset * pts, int p1, int p2, int p3);
 static int	bend_primitive (struct pset * pts, int p1, int p2, int p3);
+static int	bend_primitive_exact (struct pset * pts,
+				      int p1, int p2, int p3);
+static void	build_triangulation (struct DTinfo * dt);
 static int	circle_test (struct pset * pts, int p1, int p2, int p3, int p4);
+static int	circle_test_exact (struct pset * pts,
+				   int p1, int p2, int p3, int p4);
 static void	clean_up (struct DTinfo * dt);
-static void	delaunay_flip (struct DTinfo * dt);
-static void	triangulate (struct DTinfo * dt);
-
-#ifdef HAVE_GMP
- static int	bend_primitive_gmp (struct pset * pts, int p1, int p2, int p3);
- static int	circle_test_gmp (struct pset * pts, int p1, int p2, int p3, int p4);
- static void	convert_into_gmp_fixed_point (struct point **	  dbl_pts,
-					      struct gmp_point ** gmp_pts,
-					      int		  n);
-#endif
+static Eptr	connect_edges (struct DTinfo * dt, Eptr a, Eptr b);
+static void	delete_edge (struct DTinfo * dt, Eptr e);
+static void	divide_and_conquer (struct DTinfo * dt,
+				    int lo, int hi, Eptr * le, Eptr * re);
+static int	fast_expansion_sum (int elen, const double * e,
+				    int flen, const double * f, double * h);
+static Eptr	make_edge (struct DTinfo * dt, int src, int dst);
+static void	mark_exterior_face (Eptr e);
+static int	scale_expansion (int elen, const double * e,
+				 double b, double * h);
+static int	sort_vertices (struct DTinfo * dt, struct edge * zedges);
+static void	splice (Eptr a, Eptr b);
+static void	two_two_diff (double a1, double a0, double b1, double b0,
+			      double * x);
 
 #if TEST_DRIVER
  #define PLOT(dt,title)	plot_triangulation (dt, title)
@@ -145,8 +141,90 @@ static void	triangulate (struct DTinfo * dt);
  #define PLOT(dt,title)
 #endif
 
-#endif	/* NOT USE_TRIANGLE */
-
+/*
+ * Navigation within the triangulation.  Each vertex has a circular
+ * doubly-linked list of its outgoing edges in counter-clockwise order.
+ * These are the "Onext" and "Oprev" operators of the Guibas-Stolfi
+ * quad-edge structure.  The face operators derive from them.
+ */
+
+#define	ONEXT(e)	((e) -> vnext)
+#define	OPREV(e)	((e) -> vprev)
+#define	LNEXT(e)	((e) -> rev -> vprev)
+#define	RPREV(e)	((e) -> rev -> vnext)
+
+/*
+ * Construct the Delaunay triangulation of the given point set, and
+ * return all of its edges as a list of edges with their Euclidean
+ * lengths.  This is the form needed by the Euclidean MST, which uses
+ * neither triangles nor neighbors -- we therefore emit the edges
+ * directly from the triangulation without building any intermediate
+ * lists.
+ *
+ * Unlike _gst_delaunay_triangulation(), this routine handles coincident
+ * points: copies 2 through K of a point each receive a single zero-length
+ * edge to the first copy of the point (the one having lowest index),
+ * so that every point is incident to at least one edge.
+ *
+ * This routine always uses our own triangulator, regardless of whether
+ * the "triangle" package is configured.
+ */
+
+	int
+_gst_delaunay_edges (
+
+struct pset *	pts,			/* IN - point set to triangulate */
+struct edge **	edges_out		/* OUT - list of DT edges */
+)
+{
+int		n;
+int		ndup;
+int		nedges;
+struct edge *	edges;
+struct edge *	ep;
+Eptr		e1, e2;
+struct DTinfo	dtinfo;
+
+	n = pts -> n;
+
+	/* A planar graph on N vertices has at most 3N-6 edges.  Any	*/
+	/* zero-length edges to duplicate points take the place of the	*/
+	/* Delaunay edges those points would otherwise have had.	*/
+	edges = NEWA ((n < 3) ? 1 : 3 * n, struct edge);
+	*edges_out = edges;
+
+	if (n <= 1) {
+		return (0);
+	}
+
+	memset (&dtinfo, 0, sizeof (dtinfo));
+	dtinfo.pts = pts;
+
+	ndup = sort_vertices (&dtinfo, edges);
+	ep = &edges [ndup];
+
+	build_triangulation (&dtinfo);
+
+	e1 = dtinfo.edges;
+	e2 = e1 + dtinfo.num_edges;
+	for (; e1 < e2; e1 += 2) {
+		if ((e1 -> flags & DEAD) NE 0) continue;
+		ep -> len	= EDIST (&(dtinfo.spts -> a [e1 -> src]),
+					 &(dtinfo.spts -> a [e1 -> dst]));
+		ep -> p1	= dtinfo.verts [e1 -> src];
+		ep -> p2	= dtinfo.verts [e1 -> dst];
+		++ep;
+	}
+
+	nedges = ep - edges;
+
+	FATAL_ERROR_IF (nedges > ((n < 3) ? 1 : 3 * n));
+
+	clean_up (&dtinfo);
+
+	return (nedges);
+}
+
 /*
  * Construction of Delaunay triangulation (DT) using "Triangle"
  */
@@ -213,20 +291,18 @@ struct triangulateio	in, out, vorout;
 }
 
 #endif
-
+
 /*
  * Construct a (correct) Delaunay triangulation of the given point set.
  *
- * NOTE: THIS CODE ASSUMES THE INPUT CONTAINS NO DUPLICATE POINTS!!!
+ * Duplicate points are ignored: only the first copy of each point
+ * (the one having lowest index) appears in the triangulation.
  *
  * This version is our own version, not as "souped up" as Shewchuk's
- * "triangle" package.  We use a simple two-phase algorithm:
- *
- *	1. Compute a valid planar triangulation,
- *	2. Perform edge flips until it becomes Delaunay.
- *
- * This algorithm is not asymptotically fast, but it is relatively
- * simple, and achieves good average-case performance.
+ * "triangle" package.  We use the divide-and-conquer algorithm of
+ * Guibas and Stolfi ("Primitives for the Manipulation of General
+ * Subdivisions and the Computation of Voronoi Diagrams", ACM TOG 4(2),
+ * 1985), which runs in O(N log N) time.
  *
  * We use two "geometric primitives":
  *	a. Do 3 points A, B, C bend left, right, or are they collinear?
@@ -235,7 +311,10 @@ struct triangulateio	in, out, vorout;
  *
  * We implement these primitives using floating point, but with a "filter"
  * that determines when the results should not be trusted.  Whenever this
- * happens, we switch over to using GMP arbitrary precision arithmetic.
+ * happens, we switch over to exact floating point expansion arithmetic
+ * (see Shewchuk, "Adaptive Precision Floating-Point Arithmetic and Fast
+ * Robust Geometric Predicates", Discrete & Computational Geometry 18,
+ * 1997), so the results are always exact.
  *
  * The parameters pts, and numberofedges must always be non-NULL.
  * Regarding the remaining parameters, there are two valid ways to call
@@ -301,38 +380,38 @@ struct DTinfo	dtinfo;
 	memset (&dtinfo, 0, sizeof (dtinfo));
 	dtinfo.pts = pts;
 
-	triangulate (&dtinfo);
-	PLOT (&dtinfo, "Initial Triangulation");
-
-	/* Now perform Delaunay flips until we are fully Delaunay. */
+	(void) sort_vertices (&dtinfo, NULL);
 
-	delaunay_flip (&dtinfo);
+	build_triangulation (&dtinfo);
 	PLOT (&dtinfo, "Delaunay Triangulation");
 
-	nedges = dtinfo.num_edges;
-	*numberofedges = nedges / 2;
+	nedges = 0;
+	e1 = dtinfo.edges;
+	e3 = e1 + dtinfo.num_edges;
+	for (; e1 < e3; e1 += 2) {
+		if ((e1 -> flags & DEAD) EQ 0) {
+			++nedges;
+		}
+	}
+	*numberofedges = nedges;
 	if (edgelist NE NULL) {
 		/* Retrieving the list of edges. */
-		ip1 = NEWA (nedges, int);
-		e1 = dtinfo.edges;
-		e2 = e1 + nedges;
+		ip1 = NEWA (2 * nedges, int);
 		*edgelist = ip1;
-		for (; e1 < e2; e1 += 2) {
-			*ip1++ = e1 -> src;
-			*ip1++ = e1 -> dst;
+		for (e1 = dtinfo.edges; e1 < e3; e1 += 2) {
+			if ((e1 -> flags & DEAD) NE 0) continue;
+			*ip1++ = dtinfo.verts [e1 -> src];
+			*ip1++ = dtinfo.verts [e1 -> dst];
 		}
 	}
 	else {
 		/* Retrieving the triangles and neighbors. */
-		ntri = dtinfo.num_tri;
-		*numberoftriangles = ntri;
 
 		/* Traverse each edge and identify all the faces. */
 		e1 = dtinfo.edges;
-		e3 = e1 + nedges;
 		tindex = 0;
 		for (; e1 < e3; e1++) {
-			if ((e1 -> flags & MARK) NE 0) continue;
+			if ((e1 -> flags & (MARK | DEAD)) NE 0) continue;
 			face = -1;
 			if ((e1 -> flags & XF) EQ 0) {
 				face = tindex++;
@@ -342,8 +421,7 @@ struct DTinfo	dtinfo;
 			do {
 				e2 -> face = face;
 				e2 -> flags |= MARK;
-				/* e2 = next_face_edge (e2); */
-				e2 = e2 -> rev -> vprev;
+				e2 = LNEXT (e2);
 				++k;
 			} while (e2 NE e1);
 			if ((face >= 0) AND (k NE 3)) {
@@ -352,10 +430,9 @@ struct DTinfo	dtinfo;
 				FATAL_ERROR;
 			}
 		}
-		if (tindex NE ntri) {
-			/* Found wrong number of triangles! */
-			FATAL_ERROR;
-		}
+		ntri = tindex;
+		dtinfo.num_tri = ntri;
+		*numberoftriangles = ntri;
 
 		/* Allocate buffers */
 		ip1 = NEWA (3 * ntri, int);
@@ -374,11 +451,10 @@ struct DTinfo	dtinfo;
 			e2 = e1;
 			k = 0;
 			do {
-				*ip1++ = e2 -> src;
+				*ip1++ = dtinfo.verts [e2 -> src];
 				*ip2++ = e2 -> rev -> face;
 				e2 -> flags &= ~MARK;
-				/* e2 = next_face_edge (e2); */
-				e2 = e2 -> rev -> vprev;
+				e2 = LNEXT (e2);
 				++k;
 			} while (e2 NE e1);
 			if (k NE 3) {
@@ -394,308 +470,425 @@ struct DTinfo	dtinfo;
 
 	clean_up (&dtinfo);
 }
-
+
+#endif	/* NOT USE_TRIANGLE */
+
 /*
- * Construct an initial triangulation using a simple sweep-line algorithm.
+ * Sort the points by X (then Y) coordinate and retain only the first
+ * copy of each distinct point.  If ZEDGES is non-NULL, we also emit a
+ * zero-length edge from each omitted duplicate to the retained copy.
+ * Return the number of duplicates omitted.
+ *
+ * The triangulator works on a sorted copy of the distinct points.  The
+ * divide-and-conquer then touches memory sequentially, which matters a
+ * great deal for large inputs.
  */
 
 	static
-	void
-triangulate (
+	int
+sort_vertices (
 
-struct DTinfo *		dt	/* IN/OUT - global Delaunay triang data */
+struct DTinfo *		dt,	/* IN/OUT - global Delaunay triang data */
+struct edge *		zedges	/* OUT - zero-length edges, or NULL */
 )
 {
 int		i;
 int		j;
 int		n;
-int		idx;
-int		p;
-int		prev_p;
-int		max_edges;
-int		ntri;
-Eptr		e1, e2, e3, e4, e5, e6;
-struct pset *	pts;
-struct E *	edges;
-struct E **	vfirst;
+int		ndup;
 int *		order;
+struct point *	p1;
+struct point *	p2;
+struct pset *	pts;
 
 	pts = dt -> pts;
 	n   = pts -> n;
 
-	/* Compute the maximum number of edges and triangles we can have. */
-	/* This routine is only called when N >= 3.			  */
-	max_edges	= 3 * n - 6;
+	/* The sort guarantees that duplicates appear in order of	*/
+	/* increasing index.						*/
+	order = _gst_sort_points_x (pts, 1);
+
+	ndup = 0;
+	j = 0;
+	for (i = 1; i < n; i++) {
+		p1 = &(pts -> a [order [j]]);
+		p2 = &(pts -> a [order [i]]);
+		if ((p1 -> x EQ p2 -> x) AND (p1 -> y EQ p2 -> y)) {
+			/* Point order [i] is a duplicate of order [j]. */
+			if (zedges NE NULL) {
+				zedges -> len	= 0.0;
+				zedges -> p1	= order [j];
+				zedges -> p2	= order [i];
+				++zedges;
+			}
+			++ndup;
+			continue;
+		}
+		order [++j] = order [i];
+	}
+
+	n = j + 1;
+	dt -> verts	= order;
+	dt -> spts	= NEW_PSET (n);
+	dt -> spts -> n	= n;
+	for (i = 0; i < n; i++) {
+		dt -> spts -> a [i] = pts -> a [order [i]];
+	}
+
+	return (ndup);
+}
+
+/*
+ * Triangulate the sorted, distinct vertices, leaving the Delaunay
+ * triangulation in the edge array.  The edges of the exterior face
+ * are flagged.
+ */
+
+	static
+	void
+build_triangulation (
+
+struct DTinfo *		dt	/* IN/OUT - global Delaunay triang data */
+)
+{
+int		i;
+int		n;
+int		max_edges;
+Eptr		le, re;
+
+	n = dt -> spts -> n;
+
+	/* Compute the maximum number of edges we can have.  Deleted	*/
+	/* edges are recycled, and the triangulation is planar at all	*/
+	/* times, so this bound holds throughout.			*/
+	max_edges	= (n < 3) ? 1 : 3 * n - 6;
 	max_edges	= 2 * max_edges;	/* edges are bi-directed */
 
-	edges  = NEWA (max_edges, struct E);
-	vfirst = NEWA (n, struct E *);
+	dt -> edges	 = NEWA (max_edges, struct E);
+	dt -> num_edges	 = 0;
+	dt -> num_tri	 = 0;
+	dt -> free_edges = NULL;
+
+	if (n < 2) {
+		/* All input points are identical! */
+		return;
+	}
+
+	divide_and_conquer (dt, 0, n, &le, &re);
 
-	dt -> edges	= edges;
-	dt -> vfirst	= vfirst;
+	FATAL_ERROR_IF (dt -> num_edges > max_edges);
 
-	/* Initialize each vertex to be incident to an empty list of edges. */
-	for (i = 0; i < n; i++) {
-		vfirst [i]	= NULL;
+	/* The exterior face lies to the right of the convex hull edge	*/
+	/* out of the leftmost vertex.					*/
+	mark_exterior_face (le -> rev);
+
+	/* Clear out the deleted edges so that nobody trips over	*/
+	/* stale links.							*/
+	for (i = 0; i < dt -> num_edges; i++) {
+		if ((dt -> edges [i].flags & DEAD) NE 0) {
+			dt -> edges [i].vnext = NULL;
+			dt -> edges [i].vprev = NULL;
+		}
 	}
+}
+
+/*
+ * The recursive step of the Guibas-Stolfi algorithm.  Triangulate the
+ * sorted points lo through hi-1, returning LE, the CCW convex
+ * hull edge out of the leftmost vertex, and RE, the CW convex hull edge
+ * out of the rightmost vertex.
+ */
 
-	/* Use a sweep-line algorithm to triangulate the point set. */
-	order = _gst_heapsort_x (pts);
+	static
+	void
+divide_and_conquer (
+
+struct DTinfo *		dt,	/* IN/OUT - global Delaunay triang data */
+int			lo,	/* IN - first vertex to triangulate */
+int			hi,	/* IN - one past last vertex */
+Eptr *			le,	/* OUT - left hull edge */
+Eptr *			re	/* OUT - right hull edge */
+)
+{
+int		s1, s2, s3;
+int		mid;
+int		ct;
+Eptr		a, b, c;
+Eptr		ldo, ldi, rdi, rdo;
+Eptr		basel, lcand, rcand, t;
+bool		lvalid, rvalid;
+struct pset *	pts;
+
+	pts = dt -> spts;
+
+	if (hi - lo EQ 2) {
+		s1 = lo;
+		s2 = lo + 1;
+		a = make_edge (dt, s1, s2);
+		*le = a;
+		*re = a -> rev;
+		return;
+	}
 
-	/* Find the first two points (skip any duplicates). */
-	i = order [0];
-	idx = 1;
+	if (hi - lo EQ 3) {
+		s1 = lo;
+		s2 = lo + 1;
+		s3 = lo + 2;
+		a = make_edge (dt, s1, s2);
+		b = make_edge (dt, s2, s3);
+		splice (a -> rev, b);
+		ct = bend_primitive (pts, s1, s2, s3);
+		if (ct > 0) {
+			(void) connect_edges (dt, b, a);
+			*le = a;
+			*re = b -> rev;
+		}
+		else if (ct < 0) {
+			c = connect_edges (dt, b, a);
+			*le = c -> rev;
+			*re = c;
+		}
+		else {
+			/* Three collinear points. */
+			*le = a;
+			*re = b -> rev;
+		}
+		return;
+	}
+
+	mid = lo + (hi - lo) / 2;
+	divide_and_conquer (dt, lo, mid, &ldo, &ldi);
+	divide_and_conquer (dt, mid, hi, &rdi, &rdo);
+
+	/* Compute the lower common tangent of the two halves. */
 	for (;;) {
-		j = order [idx++];
-		if (pts -> a [i].x NE pts -> a [j].x) break;
-		if (pts -> a [i].y NE pts -> a [j].y) break;
-		if (idx >= n) {
-			/* All input points are identical! */
-			dt -> num_edges	= 0;
-			dt -> num_tri	= 0;
-			return;
+		if (bends_left (pts, rdi -> src, ldi -> src, ldi -> dst)) {
+			ldi = LNEXT (ldi);
+		}
+		else if (bends_right (pts, ldi -> src, rdi -> src, rdi -> dst)) {
+			rdi = RPREV (rdi);
+		}
+		else break;
+	}
+
+	/* Create the first cross edge from rdi.src to ldi.src. */
+	basel = connect_edges (dt, rdi -> rev, ldi);
+	if (ldi -> src EQ ldo -> src) {
+		ldo = basel -> rev;
+	}
+	if (rdi -> src EQ rdo -> src) {
+		rdo = basel;
+	}
+
+	/* Now zip the two halves together from bottom to top. */
+	for (;;) {
+		/* Locate the first left candidate to be encountered	*/
+		/* by the rising bubble, deleting any left edges that	*/
+		/* fail the circle test.				*/
+		lcand = ONEXT (basel -> rev);
+		lvalid = bends_right (pts, lcand -> dst,
+					   basel -> src, basel -> dst);
+		if (lvalid) {
+			while (circle_test (pts,
+					    basel -> dst,
+					    basel -> src,
+					    lcand -> dst,
+					    ONEXT (lcand) -> dst) > 0) {
+				t = ONEXT (lcand);
+				delete_edge (dt, lcand);
+				lcand = t;
+			}
+		}
+
+		/* Symmetrically, locate the first right candidate. */
+		rcand = OPREV (basel);
+		rvalid = bends_right (pts, rcand -> dst,
+					   basel -> src, basel -> dst);
+		if (rvalid) {
+			while (circle_test (pts,
+					    basel -> dst,
+					    basel -> src,
+					    rcand -> dst,
+					    OPREV (rcand) -> dst) > 0) {
+				t = OPREV (rcand);
+				delete_edge (dt, rcand);
+				rcand = t;
+			}
+		}
+
+		/* Deleting edges can invalidate a candidate. */
+		lvalid = bends_right (pts, lcand -> dst,
+					   basel -> src, basel -> dst);
+		rvalid = bends_right (pts, rcand -> dst,
+					   basel -> src, basel -> dst);
+
+		if ((NOT lvalid) AND (NOT rvalid)) {
+			/* Basel is the upper common tangent. */
+			break;
+		}
+
+		/* The next cross edge connects to whichever candidate	*/
+		/* has an empty circumcircle.				*/
+		if ((NOT lvalid) OR
+		    (rvalid AND
+		     (circle_test (pts,
+				   lcand -> dst,
+				   lcand -> src,
+				   rcand -> src,
+				   rcand -> dst) > 0))) {
+			basel = connect_edges (dt, rcand, basel -> rev);
+		}
+		else {
+			basel = connect_edges (dt, basel -> rev, lcand -> rev);
 		}
 	}
 
-	/* Initialize first two points with a single edge between them. */
-		 
-	e1 = edges++;
-	e2 = edges++;
+	*le = ldo;
+	*re = rdo;
+}
+
+/*
+ * Create a new edge from SRC to DST that is not connected to anything
+ * else.  Edges always come in oppositely directed pairs occupying
+ * adjacent slots, the first of which has an even index.
+ */
+
+	static
+	Eptr
+make_edge (
+
+struct DTinfo *		dt,	/* IN/OUT - global Delaunay triang data */
+int			src,	/* IN - source vertex */
+int			dst	/* IN - destination vertex */
+)
+{
+Eptr		e1, e2;
+
+	e1 = dt -> free_edges;
+	if (e1 NE NULL) {
+		dt -> free_edges = e1 -> vnext;
+	}
+	else {
+		e1 = &(dt -> edges [dt -> num_edges]);
+		dt -> num_edges += 2;
+	}
+	e2 = e1 + 1;
 
-	e1 -> src	= i;
-	e1 -> dst	= j;
+	e1 -> src	= src;
+	e1 -> dst	= dst;
 	e1 -> vnext	= e1;
 	e1 -> vprev	= e1;
 	e1 -> rev	= e2;
 	e1 -> flags	= 0;
+	e1 -> face	= -1;
 
-	e2 -> src	= j;
-	e2 -> dst	= i;
+	e2 -> src	= dst;
+	e2 -> dst	= src;
 	e2 -> vnext	= e2;
 	e2 -> vprev	= e2;
 	e2 -> rev	= e1;
 	e2 -> flags	= 0;
+	e2 -> face	= -1;
 
-	vfirst [i]	= e1;
-	vfirst [j]	= e2;
-
-	ntri = 0;
-
-	prev_p = j;
-
-	while (idx < n) {
-		p = order [idx++];
-		if ((pts -> a [p].x EQ pts -> a [prev_p].x) AND
-		    (pts -> a [p].y EQ pts -> a [prev_p].y)) {
-			/* Skip duplicate points. */
-			continue;
-		}
-
-		/* Starting from last vertex, traverse up to non-left bend. */
-		e1 = vfirst [prev_p] -> vprev;
-		prev_p = p;
-		do {
-			/* e1 = prev_face_edge (e1); */
-			e1 = e1 -> vnext -> rev;
-		} while (bends_left (pts, p, e1 -> src, e1 -> dst));
-
-		/* Traverse down to non-left bend, triangulating as we go. */
-		do {
-			/* e2 = next_face_edge (e1); */
-			e2 = e1 -> rev -> vprev;
-			j = e2 -> src;
-			/* Create a new edge (2 opposing edges) from p	*/
-			/* to j.  This may or may not produce a new	*/
-			/* triangle (we don't really care right now).	*/
-
-			e3 = edges++;
-			e4 = edges++;
-
-			e3 -> src	= p;
-			e3 -> dst	= j;
-			e3 -> rev	= e4;
-			e3 -> flags	= 0;
-
-			e4 -> src	= j;
-			e4 -> dst	= p;
-			e4 -> rev	= e3;
-			e4 -> flags	= 0;
-
-			if (vfirst [p] EQ NULL) {
-				/* First edge to/from p... */
-				vfirst [p]	= e3;
-				e3 -> vnext	= e3;
-				e3 -> vprev	= e3;
-				e5 = e1 -> rev;
-				e4 -> vnext	= e5;
-				e4 -> vprev	= e2;
-				e2 -> vnext	= e4;
-				e5 -> vprev	= e4;
-			}
-			else {
-				e6 = vfirst [p];
-				e5 = e6 -> vprev;
-				e3 -> vnext	= e6;
-				e3 -> vprev	= e5;
-				e6 -> vprev	= e3;
-				e5 -> vnext	= e3;
-
-				e5 = e1 -> rev;
-				e4 -> vnext	= e5;
-				e4 -> vprev	= e2;
-				e2 -> vnext	= e4;
-				e5 -> vprev	= e4;
-
-				++ntri;
-			}
+	return (e1);
+}
 
-			e1 = e2;
-		} while (bends_left (pts, p, e1 -> src, e1 -> dst));
-	}
+/*
+ * The Guibas-Stolfi "splice" operator.  If edges A and B have the same
+ * source vertex, this splits their vertex ring into two.  Otherwise it
+ * merges the two vertex rings into one.
+ */
 
-	FATAL_ERROR_IF (edges > &(dt -> edges [max_edges]));
+	static
+	void
+splice (
 
-	dt -> num_edges = edges - dt -> edges;
-	dt -> num_tri	= ntri;
+Eptr		a,		/* IN - first edge */
+Eptr		b		/* IN - second edge */
+)
+{
+Eptr		an, bn;
 
-	free (order);
+	an = a -> vnext;
+	bn = b -> vnext;
 
-	/* Mark the edges of the exterior face.  The last edge added to	*/
-	/* the last vertex is one of the edges on this face.  Mark the	*/
-	/* opposing edges as being "on the exterior".			*/
-	e1 = vfirst [prev_p] -> vprev;
-	e2 = e1;
-	do {
-		e2 -> flags |= (XF | ONX);
-		e2 -> rev -> flags |= ONX;
-		/* e2 = next_face_edge (e2); */
-		e2 = e2 -> rev -> vprev;
-	} while (e2 NE e1);
+	a -> vnext	= bn;
+	b -> vnext	= an;
+	bn -> vprev	= a;
+	an -> vprev	= b;
 }
-
+
 /*
- * Perform Delaunay flips on edges until the triangulation is fully Delaunay.
+ * Add a new edge from the destination of A to the source of B, such
+ * that A, the new edge and B all have the same left face.
  */
 
 	static
-	void
-delaunay_flip (
+	Eptr
+connect_edges (
 
-struct DTinfo *		dt	/* IN/OUT - global Delaunay triang data */
+struct DTinfo *		dt,	/* IN/OUT - global Delaunay triang data */
+Eptr			a,	/* IN - edge ending where new edge starts */
+Eptr			b	/* IN - edge starting where new edge ends */
 )
 {
-int		i;
-int		nedges;
-int		p1, p2, p3, p4;
-Eptr		e1, e2, e3, e4, e5, e6, e7, e8;
-Eptr		stack;
-struct E **	vfirst;
-struct pset *	pts;
+Eptr		e;
 
-#define CONDITIONAL_PUSH(e)					\
-	if (((e) -> flags & INSTACK) EQ 0) {			\
-		(e) -> snext = stack;				\
-		stack = (e);					\
-		(e) -> flags |= INSTACK;			\
-	}
+	e = make_edge (dt, a -> dst, b -> src);
+	splice (e, LNEXT (a));
+	splice (e -> rev, b);
 
-	pts	= dt -> pts;
-	vfirst	= dt -> vfirst;
+	return (e);
+}
 
-	nedges = dt -> num_edges;
+/*
+ * Remove the given edge (and its reverse) from the triangulation, and
+ * recycle the pair.
+ */
 
-	/* Make a stack that initially contains all edges that are	*/
-	/* NOT on the exterior boundary of the triangulation.		*/
-	stack = NULL;
-	e1 = dt -> edges;
-	for (i = 0; i < nedges; i++, e1++) {
-		if ((e1 -> flags & ONX) NE 0) continue;
-		e1 -> snext = stack;
-		stack = e1;
-		e1 -> flags |= INSTACK;
-	}
+	static
+	void
+delete_edge (
 
-	while (stack NE NULL) {
-		e1 = stack;
-		stack = stack -> snext;
-		FATAL_ERROR_IF ((e1 -> flags & INSTACK) EQ 0);
-		e1 -> flags &= ~INSTACK;
-		e2 = e1 -> rev;
-		/* e3 = next_face_edge (e1); */
-		e3 = e1 -> rev -> vprev;
-		/* e5 = next_face_edge (e2); */
-		e5 = e2 -> rev -> vprev;
-
-		p1 = e3 -> src;
-		p2 = e3 -> dst;
-		p3 = e5 -> src;
-		p4 = e5 -> dst;
-
-		if (NOT (bends_left (pts, p2, p4, p1) AND
-			 bends_right (pts, p2, p4, p3))) {
-			/* This is not a well-formed quadrilateral... */
-			continue;
-		}
+struct DTinfo *		dt,	/* IN/OUT - global Delaunay triang data */
+Eptr			e	/* IN - edge to delete */
+)
+{
+Eptr		e1;
 
-		i = circle_test (pts, p1, p2, p3, p4);
+	splice (e, OPREV (e));
+	splice (e -> rev, OPREV (e -> rev));
 
-		if (i <= 0) {
-			/* This diagonal fine -- don't flip it. */
-			continue;
-		}
+	e1 = &(dt -> edges [(e - dt -> edges) & ~1]);
+	e1 -> flags		= DEAD;
+	e1 -> rev -> flags	= DEAD;
+	e1 -> vnext		= dt -> free_edges;
+	dt -> free_edges	= e1;
+}
 
-		/* e4 = next_face_edge (e3); */
-		e4 = e3 -> rev -> vprev;
-		/* e6 = next_face_edge (e5); */
-		e6 = e5 -> rev -> vprev;
-
-		CONDITIONAL_PUSH (e3);
-		CONDITIONAL_PUSH (e4);
-		CONDITIONAL_PUSH (e5);
-		CONDITIONAL_PUSH (e6);
-
-		/* Unthread edge e1 */
-		e7 = e1 -> vprev;
-		e8 = e1 -> vnext;
-		e7 -> vnext = e8;
-		e8 -> vprev = e7;
-		if (vfirst [p3] EQ e1) {
-			vfirst [p3] = e8;
-		}
+/*
+ * Flag each edge of the exterior face as being part of the exterior
+ * face, and both it and its reverse as being on the exterior of the
+ * triangulation.
+ */
 
-		/* Unthread edge e2 */
-		e7 = e2 -> vprev;
-		e8 = e2 -> vnext;
-		e7 -> vnext = e8;
-		e8 -> vprev = e7;
-		if (vfirst [p1] EQ e2) {
-			vfirst [p1] = e8;
-		}
+	static
+	void
+mark_exterior_face (
 
-		/* Edge e1 was p3->p1.  Make it be p2->p4 by inserting	*/
-		/* it into p2's list between e4 and e3->rev.		*/
-		e1 -> src	= p2;
-		e1 -> dst	= p4;
-		e7 = e3 -> rev;
-		e1 -> vprev	= e4;
-		e1 -> vnext	= e7;
-		e4 -> vnext	= e1;
-		e7 -> vprev	= e1;
-
-		/* Edge e2 was p1->p3.  Make it be p4->p2 by inserting	*/
-		/* it into p4's list between e6 and e5->rev.		*/
-		e2 -> src	= p4;
-		e2 -> dst	= p2;
-		e7 = e5 -> rev;
-		e2 -> vprev	= e6;
-		e2 -> vnext	= e7;
-		e6 -> vnext	= e2;
-		e7 -> vprev	= e2;
-	}
+Eptr		e1		/* IN - an edge of the exterior face */
+)
+{
+Eptr		e2;
 
-#undef CONDITIONAL_PUSH
+	e2 = e1;
+	do {
+		e2 -> flags |= (XF | ONX);
+		e2 -> rev -> flags |= ONX;
+		e2 = LNEXT (e2);
+	} while (e2 NE e1);
 }
-
+
 /*
  * Free up all of the memory we might have allocated.
  */
@@ -710,11 +903,14 @@ struct DTinfo *		dt	/* IN/OUT - global Delaunay triang data */
 	if (dt -> edges NE NULL) {
 		free (dt -> edges);
 	}
-	if (dt -> vfirst NE NULL) {
-		free (dt -> vfirst);
+	if (dt -> verts NE NULL) {
+		free (dt -> verts);
+	}
+	if (dt -> spts NE NULL) {
+		free (dt -> spts);
 	}
 }
-
+
 /*
  * Return TRUE if-and-only-if the point sequence p1, p2, p3 bends to
  * the left.
@@ -751,7 +947,7 @@ int			p3	/* IN - index of point p3 */
 {
 	return (bend_primitive (pts, p1, p2, p3) < 0);
 }
-
+
 /*
  * Return +1 if-and-only-if p1, p2, p3 bends to the left.
  * Return -1 if-and-only-if p1, p2, p3 bends to the right.
@@ -774,8 +970,8 @@ struct point *		pp2;
 struct point *		pp3;
 double			ax, ay, bx, by;
 double			prod1, prod2, Z;
+double			norm, bound;
 
-#ifdef HAVE_GMP
 	/* We hope the compiler does this computation at compile time	*/
 	/* and puts the result into memory that is read-only at run	*/
 	/* time...							*/
@@ -784,13 +980,11 @@ double			prod1, prod2, Z;
 	/* be DBL_EPS/2.  We use the "ANSI-C" epsilon, just to be a	*/
 	/* "bit" more careful.  :^>					*/
 	static const double	tolerance = (3.0 + 16.0 * DBL_EPSILON) * DBL_EPSILON;
-#endif
 
 	pp1 = &(pts -> a [p1]);
 	pp2 = &(pts -> a [p2]);
 	pp3 = &(pts -> a [p3]);
 
-	/* These subtractions always yield the correct sign, at least... */
 	ax = pp2 -> x - pp1 -> x;
 	ay = pp2 -> y - pp1 -> y;
 	bx = pp3 -> x - pp1 -> x;
@@ -811,90 +1005,32 @@ double			prod1, prod2, Z;
 		result = 0;
 	}
 
-#if HAVE_GMP
-	{ double norm, bound;
-		if (prod1 > 0.0) {
-			if (prod2 <= 0.0) {
-				return (result);	/* tentative result OK. */
-			}
-			norm = prod1 + prod2;
-		}
-		else if (prod1 < 0.0) {
-			if (prod2 >= 0.0) {
-				return (result);	/* tentative result OK. */
-			}
-			norm = -prod1 - prod2;
+	if (prod1 > 0.0) {
+		if (prod2 <= 0.0) {
+			return (result);	/* tentative result OK. */
 		}
-		else {
+		norm = prod1 + prod2;
+	}
+	else if (prod1 < 0.0) {
+		if (prod2 >= 0.0) {
 			return (result);	/* tentative result OK. */
 		}
-
-		/* When we get here, cancellation is occurring in the final	*/
-		/* subtraction.  Need to check numeric tolerances...		*/
-		bound = norm * tolerance;
-
-		if (Z >  bound) return (+1);
-		if (Z < -bound) return (-1);
+		norm = -prod1 - prod2;
+	}
+	else {
+		return (result);	/* tentative result OK. */
 	}
-	result = bend_primitive_gmp (pts, p1, p2, p3);
-#endif
-
-	return (result);
-}
-
-/*
- * Exact "bend primitive" using GMP arithmetic.
- */
-
-#ifdef HAVE_GMP
-
-	static
-	int
-bend_primitive_gmp (
-
-struct pset *		pts,	/* IN - the point set */
-int			p1,	/* IN - index of point p1 */
-int			p2,	/* IN - index of point p2 */
-int			p3	/* IN - index of point p3 */
-)
-{
-int			result;
-struct gmp_point	A, B, C;
-struct point *		dbl_pts [3];
-struct gmp_point *	gmp_pts [3];
-
-	dbl_pts [0] = &(pts -> a [p1]);
-	dbl_pts [1] = &(pts -> a [p2]);
-	dbl_pts [2] = &(pts -> a [p3]);
-
-	gmp_pts [0] = &A;
-	gmp_pts [1] = &B;
-	gmp_pts [2] = &C;
-
-	convert_into_gmp_fixed_point (&dbl_pts [0], &gmp_pts [0], 3);
-
-	/* At this point, we are working with exact integers. */
-
-	mpz_sub (B.x, B.x, A.x);
-	mpz_sub (B.y, B.y, A.y);
-	mpz_sub (C.x, C.x, A.x);
-	mpz_sub (C.y, C.y, A.y);
-
-	mpz_mul (A.x, B.x, C.y);
-	mpz_mul (A.y, B.y, C.x);
-	mpz_sub (A.x, A.x, A.y);
 
-	result = mpz_sgn (A.x);
+	/* When we get here, cancellation is occurring in the final	*/
+	/* subtraction.  Need to check numeric tolerances...		*/
+	bound = norm * tolerance;
 
-	mpz_clear (C.y);	mpz_clear (C.x);
-	mpz_clear (B.y);	mpz_clear (B.x);
-	mpz_clear (A.y);	mpz_clear (A.x);
+	if (Z >  bound) return (+1);
+	if (Z < -bound) return (-1);
 
-	return (result);
+	return (bend_primitive_exact (pts, p1, p2, p3));
 }
 
-#endif
-
 /*
  * Consider the *directed* circle through points p1, p2 and p3.
  *
@@ -966,23 +1102,66 @@ struct point *		pp3;
 struct point *		pp4;
 double			ax, bx, cx, dx;
 double			ay, by, cy, dy;
-double			bmag2, cmag2, dmag2;
+double			amag2, bmag2, cmag2, dmag2;
 double			DxC, BxD, CxB;
 double			Z;
+double			bound, Zmax, dmag, cmag, bmag;
 
-#ifdef HAVE_GMP
 	/* We hope the compiler does this computation at compile time	*/
 	/* and puts the result into memory that is read-only at run	*/
 	/* time...							*/
-	static double	tolerance1 = (19.0 + 159.0 * DBL_EPSILON) * DBL_EPSILON;
-	static double	tolerance2 = (22.0 + 223.0 * DBL_EPSILON) * DBL_EPSILON;
-#endif
+	static const double	tolerance1 = (10.0 + 96.0 * DBL_EPSILON) * DBL_EPSILON;
+	static const double	tolerance2 = (22.0 + 223.0 * DBL_EPSILON) * DBL_EPSILON;
+
+	if ((p4 EQ p1) OR (p4 EQ p2) OR (p4 EQ p3)) {
+		/* Trivially on the circle.  The divide-and-conquer	*/
+		/* asks this whenever a candidate edge is the last one	*/
+		/* around its vertex.					*/
+		return (0);
+	}
 
 	pp1 = &(pts -> a [p1]);
 	pp2 = &(pts -> a [p2]);
 	pp3 = &(pts -> a [p3]);
 	pp4 = &(pts -> a [p4]);
 
+	/* We start with the bound that Shewchuk provides in his robust	*/
+	/* geometric primitives paper.  It does not contain any square-	*/
+	/* roots, so it is pretty fast to compute, and it screens out	*/
+	/* the vast majority of cases with little effort.  His bound	*/
+	/* applies to the same determinant translated so that p4 (not	*/
+	/* p1) is at the origin, and is the "permanent" of the		*/
+	/* determinant (its magnitude if no cancellation occurs) scaled	*/
+	/* by the relative error.  As above, we use the "ANSI-C"	*/
+	/* epsilon to be a bit more careful.				*/
+
+	ax = pp1 -> x - pp4 -> x;
+	ay = pp1 -> y - pp4 -> y;
+	bx = pp2 -> x - pp4 -> x;
+	by = pp2 -> y - pp4 -> y;
+	cx = pp3 -> x - pp4 -> x;
+	cy = pp3 -> y - pp4 -> y;
+
+	amag2 = ax*ax + ay*ay;
+	bmag2 = bx*bx + by*by;
+	cmag2 = cx*cx + cy*cy;
+
+	Z =	  amag2 * (bx*cy - cx*by)
+		+ bmag2 * (cx*ay - ax*cy)
+		+ cmag2 * (ax*by - bx*ay);
+
+	Zmax =	  amag2 * (fabs (bx*cy) + fabs (cx*by))
+		+ bmag2 * (fabs (cx*ay) + fabs (ax*cy))
+		+ cmag2 * (fabs (ax*by) + fabs (bx*ay));
+
+	bound = Zmax * tolerance1;
+
+	if (Z >  bound) return (+1);
+	if (Z < -bound) return (-1);
+
+	/* Too close to call.  Now evaluate the formula derived above	*/
+	/* (with p1 at the origin).					*/
+
 	ax = pp1 -> x;
 	ay = pp1 -> y;
 
@@ -1005,7 +1184,14 @@ double			Z;
 
 	Z = bmag2 * DxC + cmag2 * BxD + dmag2 * CxB;
 
-#ifdef HAVE_GMP
+	/* We now apply a second bound that is sometimes much tighter	*/
+	/* -- but it requires 3 square roots, so it is more costly to	*/
+	/* compute.  This bound derives from the observation that the	*/
+	/* formula for Z contains "cross products" -- for which we	*/
+	/* have:							*/
+	/*								*/
+	/*	|A x B| = |A|*|B|*|sin(theta)| <= |A|*|B|.		*/
+	/*								*/
 	/* If we assume the following relative error for primitive ops:	*/
 	/*								*/
 	/*		A+B		2*eps				*/
@@ -1014,347 +1200,413 @@ double			Z;
 	/*		A*B		eps				*/
 	/*		sqrt()		eps				*/
 	/*								*/
-	/* then the total relative error of the above formula for Z is:	*/
-	/*								*/
-	/* R =	256*eps^10 + 1600*eps^9 + 4416*eps^8 + 7088*eps^7	*/
-	/*	+ 7328*eps^6 + 5100*eps^5 + 2420*eps^4 + 773*eps^3	*/
-	/*	+159*eps^2 + 19*eps					*/
+	/* then the exact relative error of this bound is:		*/
 	/*								*/
+	/* R = (1+eps)^6 * (1+2*eps)^8 - 1				*/
+	/*   =	256*eps^14 + 2560*eps^13 + 11776*eps^12 + 33024*eps^11	*/
+	/*	+ 63072*eps^10 + 86784*eps^9 + 88720*eps^8		*/
+	/*	+ 68464*eps^7 + 40081*eps^6 + 17718*eps^5 + 5823*eps^4	*/
+	/*	+ 1380*eps^3 + 223*eps^2 + 22*eps.			*/
 
-	/* We start with a coarse bound -- it is not a very tight	*/
-	/* bound, but it does not contain any square-roots, so it is	*/
-	/* pretty fast to compute, and it screens out the vast majority	*/
-	/* of cases with little effort.  This bound is essentially an	*/
-	/* "L-infinity" bound that computes the maximum magnitude of	*/
-	/* the result if no cancellation occurs.			*/
+	bmag = sqrt (bmag2);
+	cmag = sqrt (cmag2);
+	dmag = sqrt (dmag2);
 
-	ax = fabs (ax);
-	ay = fabs (ay);
+	Zmax =	  bmag2 * cmag  * dmag
+		+ bmag  * cmag2 * dmag
+		+ bmag  * cmag  * dmag2;
+	Zmax += (Zmax * tolerance2);
 
-	bx = fabs (pp2 -> x) + ax;
-	by = fabs (pp2 -> y) + ay;
+	bound = Zmax * tolerance2;
 
-	cx = fabs (pp3 -> x) + ax;
-	cy = fabs (pp3 -> y) + ay;
+	if (Z >  bound) return (+1);
+	if (Z < -bound) return (-1);
 
-	dx = fabs (pp4 -> x) + ax;
-	dy = fabs (pp4 -> y) + ay;
+	/* Both floating point filters failed -- compute it exactly. */
 
-	DxC = dx*cy + dy*cx;
-	BxD = bx*dy + by*dx;
-	CxB = cx*by + cy*bx;
+	return (circle_test_exact (pts, p1, p2, p3, p4));
+}
 
-	{ double bound, Zmax, dmag, cmag, bmag;
-	  int result;
+/*
+ * Exact floating point arithmetic.  A value is represented as an
+ * "expansion": an array of doubles, sorted by increasing magnitude and
+ * non-overlapping, whose exact (unrounded) sum is the value.  The sign
+ * of an expansion is the sign of its last (most significant) component.
+ * These are the basic building blocks from Shewchuk's paper.  They are
+ * exact provided that no overflow or underflow occurs.
+ */
 
-		Zmax = bmag2 * DxC + cmag2 * BxD + dmag2 * CxB;
-		Zmax += (Zmax * tolerance1);
+/* 2^ceiling(p/2) + 1, where p = 53 is the IEEE double mantissa size. */
+#define	SPLITTER	134217729.0
+
+/* Compute X + Y = A + B exactly, given that |A| >= |B|. */
+#define FAST_TWO_SUM(a, b, x, y) \
+	do { double _bv; \
+		(x) = (a) + (b); \
+		_bv = (x) - (a); \
+		(y) = (b) - _bv; \
+	} while (0)
+
+/* Compute X + Y = A + B exactly. */
+#define TWO_SUM(a, b, x, y) \
+	do { double _bv, _av; \
+		(x) = (a) + (b); \
+		_bv = (x) - (a); \
+		_av = (x) - _bv; \
+		(y) = ((a) - _av) + ((b) - _bv); \
+	} while (0)
+
+/* Compute X + Y = A - B exactly. */
+#define TWO_DIFF(a, b, x, y) \
+	do { double _bv, _av; \
+		(x) = (a) - (b); \
+		_bv = (a) - (x); \
+		_av = (x) + _bv; \
+		(y) = ((a) - _av) + (_bv - (b)); \
+	} while (0)
+
+/* Split A into two non-overlapping halves of 26 bits each. */
+#define SPLIT(a, hi, lo) \
+	do { double _c, _ab; \
+		_c = SPLITTER * (a); \
+		_ab = _c - (a); \
+		(hi) = _c - _ab; \
+		(lo) = (a) - (hi); \
+	} while (0)
+
+/* Compute X + Y = A * B exactly. */
+#define TWO_PRODUCT(a, b, x, y) \
+	do { double _ahi, _alo, _bhi, _blo, _e1, _e2, _e3; \
+		(x) = (a) * (b); \
+		SPLIT ((a), _ahi, _alo); \
+		SPLIT ((b), _bhi, _blo); \
+		_e1 = (x) - (_ahi * _bhi); \
+		_e2 = _e1 - (_alo * _bhi); \
+		_e3 = _e2 - (_ahi * _blo); \
+		(y) = (_alo * _blo) - _e3; \
+	} while (0)
 
-		bound = Zmax * tolerance1;
+/*
+ * Compute the 4-component expansion X = (A1 + A0) - (B1 + B0), where
+ * each of the arguments is a 2-component expansion.
+ */
 
-		if (Z >  bound) return (+1);
-		if (Z < -bound) return (-1);
+	static
+	void
+two_two_diff (
 
-		/* The result is too close to call using the first numeric	*/
-		/* bound, so we now apply a second bound that is virtually	*/
-		/* always much tighter -- but it requires 3 square roots, so it	*/
-		/* is more costly to compute.  This bound derives from the	*/
-		/* observation that the formula for Z contains "cross products"	*/
-		/* -- for which we have:					*/
-		/*								*/
-		/*	|A x B| = |A|*|B|*|sin(theta)| <= |A|*|B|.		*/
-		/*								*/
-		/* The exact relative error of this bound is:			*/
-		/*								*/
-		/* R = (1+eps)^6 * (1+2*eps)^8 - 1				*/
-		/*   =	256*eps^14 + 2560*eps^13 + 11776*eps^12 + 33024*eps^11	*/
-		/*	+ 63072*eps^10 + 86784*eps^9 + 88720*eps^8		*/
-		/*	+ 68464*eps^7 + 40081*eps^6 + 17718*eps^5 + 5823*eps^4	*/
-		/*	+ 1380*eps^3 + 223*eps^2 + 22*eps.			*/
+double		a1,		/* IN - high part of A */
+double		a0,		/* IN - low part of A */
+double		b1,		/* IN - high part of B */
+double		b0,		/* IN - low part of B */
+double *	x		/* OUT - 4-component expansion */
+)
+{
+double		i, j, k, m;
 
-		bmag = sqrt (bmag2);
-		cmag = sqrt (cmag2);
-		dmag = sqrt (dmag2);
+	/* (A1 + A0) - B0 */
+	TWO_DIFF (a0, b0, i, x [0]);
+	TWO_SUM (a1, i, j, k);
 
-		Zmax =	  bmag2 * cmag  * dmag
-			+ bmag  * cmag2 * dmag
-			+ bmag  * cmag  * dmag2;
-		Zmax += (Zmax * tolerance2);
+	/* (J + K) - B1 */
+	TWO_DIFF (k, b1, m, x [1]);
+	TWO_SUM (j, m, x [3], x [2]);
+}
 
-		bound = Zmax * tolerance2;
+/*
+ * Sum the expansions E and F into H, eliminating zero components.
+ * H must have room for ELEN + FLEN components.  Return the number of
+ * components in H.
+ */
 
-		if (Z >  bound) return (+1);
-		if (Z < -bound) return (-1);
+	static
+	int
+fast_expansion_sum (
 
-		/* Both floating point filters failed -- use GMP to get it right. */
+int		elen,		/* IN - number of components in E */
+const double *	e,		/* IN - first expansion */
+int		flen,		/* IN - number of components in F */
+const double *	f,		/* IN - second expansion */
+double *	h		/* OUT - sum of E and F */
+)
+{
+int		ei, fi, hi;
+double		Q, Qnew, hh;
+double		enow, fnow;
+
+	ei = 0;
+	fi = 0;
+	enow = e [0];
+	fnow = f [0];
+
+#define NEXT_E	enow = (++ei < elen) ? e [ei] : 0.0
+#define NEXT_F	fnow = (++fi < flen) ? f [fi] : 0.0
+
+	/* Merge the components in order of increasing magnitude. */
+	if ((fnow > enow) EQ (fnow > -enow)) {
+		Q = enow;
+		NEXT_E;
+	}
+	else {
+		Q = fnow;
+		NEXT_F;
+	}
+	hi = 0;
+	if ((ei < elen) AND (fi < flen)) {
+		if ((fnow > enow) EQ (fnow > -enow)) {
+			FAST_TWO_SUM (enow, Q, Qnew, hh);
+			NEXT_E;
+		}
+		else {
+			FAST_TWO_SUM (fnow, Q, Qnew, hh);
+			NEXT_F;
+		}
+		Q = Qnew;
+		if (hh NE 0.0) {
+			h [hi++] = hh;
+		}
+		while ((ei < elen) AND (fi < flen)) {
+			if ((fnow > enow) EQ (fnow > -enow)) {
+				TWO_SUM (Q, enow, Qnew, hh);
+				NEXT_E;
+			}
+			else {
+				TWO_SUM (Q, fnow, Qnew, hh);
+				NEXT_F;
+			}
+			Q = Qnew;
+			if (hh NE 0.0) {
+				h [hi++] = hh;
+			}
+		}
+	}
+	while (ei < elen) {
+		TWO_SUM (Q, enow, Qnew, hh);
+		NEXT_E;
+		Q = Qnew;
+		if (hh NE 0.0) {
+			h [hi++] = hh;
+		}
+	}
+	while (fi < flen) {
+		TWO_SUM (Q, fnow, Qnew, hh);
+		NEXT_F;
+		Q = Qnew;
+		if (hh NE 0.0) {
+			h [hi++] = hh;
+		}
+	}
+	if ((Q NE 0.0) OR (hi EQ 0)) {
+		h [hi++] = Q;
+	}
+
+#undef NEXT_E
+#undef NEXT_F
+
+	return (hi);
+}
 
-		result = circle_test_gmp (pts, p1, p2, p3, p4);
+/*
+ * Multiply the expansion E by the scalar B, eliminating zero components.
+ * H must have room for 2 * ELEN components.  Return the number of
+ * components in H.
+ */
+
+	static
+	int
+scale_expansion (
 
-		return (result);
+int		elen,		/* IN - number of components in E */
+const double *	e,		/* IN - expansion to scale */
+double		b,		/* IN - scale factor */
+double *	h		/* OUT - product of E and B */
+)
+{
+int		i, hi;
+double		Q, sum, hh;
+double		p1, p0;
+
+	hi = 0;
+	TWO_PRODUCT (e [0], b, Q, hh);
+	if (hh NE 0.0) {
+		h [hi++] = hh;
+	}
+	for (i = 1; i < elen; i++) {
+		TWO_PRODUCT (e [i], b, p1, p0);
+		TWO_SUM (Q, p0, sum, hh);
+		if (hh NE 0.0) {
+			h [hi++] = hh;
+		}
+		FAST_TWO_SUM (p1, sum, Q, hh);
+		if (hh NE 0.0) {
+			h [hi++] = hh;
+		}
+	}
+	if ((Q NE 0.0) OR (hi EQ 0)) {
+		h [hi++] = Q;
 	}
-#else
-	/* We do not have GMP.  Use raw floating point result. */
-	if (Z > 0.0) return (+1);
-	if (Z < 0.0) return (-1);
 
-	return (0);
-#endif
+	return (hi);
 }
-
+
 /*
- * Exact "circle test primitive" using GMP arithmetic.
+ * Exact "bend primitive" using expansion arithmetic.  We expand the
+ * determinant without translating, so that every product is of two
+ * input coordinates and is therefore exactly a 2-component expansion.
  */
 
-#ifdef HAVE_GMP
-
 	static
 	int
-circle_test_gmp (
+bend_primitive_exact (
 
 struct pset *		pts,	/* IN - the point set */
 int			p1,	/* IN - index of point p1 */
 int			p2,	/* IN - index of point p2 */
-int			p3,	/* IN - index of point p3 */
-int			p4	/* IN - index of point p4 */
+int			p3	/* IN - index of point p3 */
 )
 {
-int			result;
-struct gmp_point	A, B, C, D;
-mpz_t			bmag2, cmag2, dmag2;
-mpz_t			DxC, BxD, CxB;
-mpz_t			Z;
-struct point *		dbl_pts [4];
-struct gmp_point *	gmp_pts [4];
-
-	dbl_pts [0] = &(pts -> a [p1]);
-	dbl_pts [1] = &(pts -> a [p2]);
-	dbl_pts [2] = &(pts -> a [p3]);
-	dbl_pts [3] = &(pts -> a [p4]);
-
-	gmp_pts [0] = &A;
-	gmp_pts [1] = &B;
-	gmp_pts [2] = &C;
-	gmp_pts [3] = &D;
-
-	convert_into_gmp_fixed_point (&dbl_pts [0], &gmp_pts [0], 4);
-
-	/* At this point, we are working with exact integers. */
-
-	mpz_sub (B.x, B.x, A.x);
-	mpz_sub (B.y, B.y, A.y);
-	mpz_sub (C.x, C.x, A.x);
-	mpz_sub (C.y, C.y, A.y);
-	mpz_sub (D.x, D.x, A.x);
-	mpz_sub (D.y, D.y, A.y);
-
-	mpz_init (bmag2);
-	mpz_init (cmag2);
-	mpz_init (dmag2);
-	mpz_init (DxC);
-	mpz_init (BxD);
-	mpz_init (CxB);
-	mpz_init (Z);
-
-	mpz_mul (bmag2, B.x, B.x);
-	mpz_mul (Z, B.y, B.y);
-	mpz_add (bmag2, bmag2, Z);
-
-	mpz_mul (cmag2, C.x, C.x);
-	mpz_mul (Z, C.y, C.y);
-	mpz_add (cmag2, cmag2, Z);
-
-	mpz_mul (dmag2, D.x, D.x);
-	mpz_mul (Z, D.y, D.y);
-	mpz_add (dmag2, dmag2, Z);
-
-	mpz_mul (DxC, D.x, C.y);
-	mpz_mul (Z, D.y, C.x);
-	mpz_sub (DxC, DxC, Z);
-
-	mpz_mul (BxD, B.x, D.y);
-	mpz_mul (Z, B.y, D.x);
-	mpz_sub (BxD, BxD, Z);
-
-	mpz_mul (CxB, C.x, B.y);
-	mpz_mul (Z, C.y, B.x);
-	mpz_sub (CxB, CxB, Z);
-
-	mpz_mul (bmag2, bmag2, DxC);
-	mpz_mul (cmag2, cmag2, BxD);
-	mpz_mul (dmag2, dmag2, CxB);
-
-	mpz_add (Z, bmag2, cmag2);
-	mpz_add (Z, Z, dmag2);
-
-	result = mpz_sgn (Z);
-
-	mpz_clear (Z);
-	mpz_clear (CxB);
-	mpz_clear (BxD);
-	mpz_clear (DxC);
-	mpz_clear (dmag2);
-	mpz_clear (cmag2);
-	mpz_clear (bmag2);
-
-	mpz_clear (D.y);	mpz_clear (D.x);
-	mpz_clear (C.y);	mpz_clear (C.x);
-	mpz_clear (B.y);	mpz_clear (B.x);
-	mpz_clear (A.y);	mpz_clear (A.x);
-
-	return (result);
+int			vlen, wlen;
+struct point *		pa;
+struct point *		pb;
+struct point *		pc;
+double			x1, x0, y1, y0;
+double			aterms [4], bterms [4], cterms [4];
+double			v [8], w [12];
+
+	pa = &(pts -> a [p1]);
+	pb = &(pts -> a [p2]);
+	pc = &(pts -> a [p3]);
+
+	TWO_PRODUCT (pa -> x, pb -> y, x1, x0);
+	TWO_PRODUCT (pa -> x, pc -> y, y1, y0);
+	two_two_diff (x1, x0, y1, y0, aterms);
+
+	TWO_PRODUCT (pb -> x, pc -> y, x1, x0);
+	TWO_PRODUCT (pb -> x, pa -> y, y1, y0);
+	two_two_diff (x1, x0, y1, y0, bterms);
+
+	TWO_PRODUCT (pc -> x, pa -> y, x1, x0);
+	TWO_PRODUCT (pc -> x, pb -> y, y1, y0);
+	two_two_diff (x1, x0, y1, y0, cterms);
+
+	vlen = fast_expansion_sum (4, aterms, 4, bterms, v);
+	wlen = fast_expansion_sum (vlen, v, 4, cterms, w);
+
+	if (w [wlen - 1] > 0.0) return (+1);
+	if (w [wlen - 1] < 0.0) return (-1);
+	return (0);
 }
 
-#endif
-
 /*
- * Convert the given array of "double precision points" into an
- * equivalent array of "GMP arbitrary precision integer points".
- * We choose a smallest reasonable integer K so that when every
- * "double" coordinate value is multiplied by 2**K we get a value that
- * is an integer.
+ * Exact "circle test primitive" using expansion arithmetic.  This is
+ * the 4-by-4 "lifted" determinant
+ *
+ *	| ax  ay  ax^2+ay^2  1 |
+ *	| bx  by  bx^2+by^2  1 |
+ *	| cx  cy  cx^2+cy^2  1 |
+ *	| dx  dy  dx^2+dy^2  1 |
  *
- * In the current implementation, K is always a multiple of 32 (or 64 --
- * whatever the GMP "limb" size is).  We do not attempt to cancel extra
- * powers of two by shifting the GMP integers to the right to eliminate
- * trailing zero bits -- this take too much time to justify the very rare
- * cases in which it might actually help.
+ * expanded by cofactors along the third column, using the 2-by-2 minors
+ * of the first two columns -- each of which is exactly representable as
+ * a 4-component expansion.  Its sign agrees with circle_test().
  */
 
-#ifdef HAVE_GMP
-
 	static
-	void
-convert_into_gmp_fixed_point (
+	int
+circle_test_exact (
 
-struct point **		dbl_pts,	/* IN - array of "double" points */
-struct gmp_point **	gmp_pts,	/* OUT - array of "GMP" points */
-int			n		/* IN - number of points to convert */
+struct pset *		pts,	/* IN - the point set */
+int			p1,	/* IN - index of point p1 */
+int			p2,	/* IN - index of point p2 */
+int			p3,	/* IN - index of point p3 */
+int			p4	/* IN - index of point p4 */
 )
 {
-int			i;
-int			size;
-mp_exp_t		expon;
-mp_exp_t		min_scale;
-struct point *		dp;
-struct gmp_point *	gp;
-mpf_t			coord;
-mpz_t			tmp;
-mp_exp_t		xscale [4];
-mp_exp_t		yscale [4];
-bool			scale_seen;
-
-	/* Set a precision of 3 GMP limbs.  This should give us up to	*/
-	/* 96 bits of mantissa (at least 65 bits).  Since an IEEE 754	*/
-	/* double is 53 bits, this should never lose any significant	*/
-	/* bits.							*/
-
-	mpf_init2 (coord, 3);
-
-	scale_seen = FALSE;
-	min_scale = 0;
-
-	for (i = 0; i < n; i++) {
-		dp = dbl_pts [i];
-		gp = gmp_pts [i];
-
-		/* Convert X coordinate... */
-		if (dp -> x EQ 0.0) {
-			/* Initialize to zero. */
-			mpz_init (gp -> x);
-		}
-		else {
-			mpf_set_d (coord, dp -> x);
-
-			/* Access mantissa as an mpz_t... */
-			tmp [0]._mp_alloc	= coord [0]._mp_prec + 1;
-			tmp [0]._mp_size	= coord [0]._mp_size;
-			tmp [0]._mp_d		= coord [0]._mp_d;
-
-			/* Copy off mantissa as an integer. */
-			mpz_init_set (gp -> x, tmp);
-
-			/* Compute scale factor for this coordinate. */
-			/* The mantissa is fractional (i.e., binary point */
-			/* is at the most-significant end of the buffer), */
-			/* so we need to adjust the exponent by the size  */
-			/* of the mantissa.				  */
-			size = coord [0]._mp_size;
-			if (size < 0) {
-				/* This just means the mantissa is negative. */
-				size = -size;
-			}
-			expon = coord [0]._mp_exp - size;
-			xscale [i] = expon;
-			if ((NOT scale_seen) OR (expon < min_scale)) {
-				min_scale = expon;
-				scale_seen = TRUE;
-			}
-		}
-
-		/* Convert Y coordinate... */
-		if (dp -> y EQ 0.0) {
-			/* Initialize to zero. */
-			mpz_init (gp -> y);
-		}
-		else {
-			mpf_set_d (coord, dp -> y);
-
-			/* Access mantissa as an mpz_t... */
-			tmp [0]._mp_alloc	= coord [0]._mp_prec + 1;
-			tmp [0]._mp_size	= coord [0]._mp_size;
-			tmp [0]._mp_d		= coord [0]._mp_d;
-
-			/* Copy off mantissa as an integer. */
-			mpz_init_set (gp -> y, tmp);
-
-			/* Compute scale factor for this coordinate. */
-			/* The mantissa is fractional (i.e., binary point */
-			/* is at the most-significant end of the buffer), */
-			/* so we need to adjust the exponent by the size  */
-			/* of the mantissa.				  */
-			size = coord [0]._mp_size;
-			if (size < 0) {
-				/* This just means the mantissa is negative. */
-				size = -size;
-			}
-			expon = coord [0]._mp_exp - size;
-			yscale [i] = expon;
-			if ((NOT scale_seen) OR (expon < min_scale)) {
-				min_scale = expon;
-				scale_seen = TRUE;
-			}
-		}
-	}
-
-	mpf_clear (coord);
-
-	/* Pass 2 -- properly scale all of the integer coordinates. */
-	for (i = 0; i < n; i++) {
-		dp = dbl_pts [i];
-		gp = gmp_pts [i];
-
-		if (dp -> x NE 0.0) {
-			expon = xscale [i] - min_scale;
-			if (expon > 0) {
-				mpz_mul_2exp (gp -> x,
-					      gp -> x,
-					      GMP_LIMB_BITS * expon);
-			}
-		}
-
-		if (dp -> y NE 0.0) {
-			expon = yscale [i] - min_scale;
-			if (expon > 0) {
-				mpz_mul_2exp (gp -> y,
-					      gp -> y,
-					      GMP_LIMB_BITS * expon);
-			}
-		}
+int			i, templen;
+int			abclen, bcdlen, cdalen, dablen;
+int			xlen, ylen, alen, blen, clen, dlen;
+int			ablen, cdlen, detlen;
+struct point *		pa;
+struct point *		pb;
+struct point *		pc;
+struct point *		pd;
+double			x1, x0, y1, y0;
+double			ab [4], bc [4], cd [4], da [4], ac [4], bd [4];
+double			temp8 [8];
+double			abc [12], bcd [12], cda [12], dab [12];
+double			det24x [24], det24y [24];
+double			det48x [48], det48y [48];
+double			adet [96], bdet [96], cdet [96], ddet [96];
+double			abdet [192], cddet [192];
+double			deter [384];
+
+	pa = &(pts -> a [p1]);
+	pb = &(pts -> a [p2]);
+	pc = &(pts -> a [p3]);
+	pd = &(pts -> a [p4]);
+
+#define MINOR(p, q, m)						\
+	TWO_PRODUCT ((p) -> x, (q) -> y, x1, x0);		\
+	TWO_PRODUCT ((q) -> x, (p) -> y, y1, y0);		\
+	two_two_diff (x1, x0, y1, y0, (m))
+
+	MINOR (pa, pb, ab);
+	MINOR (pb, pc, bc);
+	MINOR (pc, pd, cd);
+	MINOR (pd, pa, da);
+	MINOR (pa, pc, ac);
+	MINOR (pb, pd, bd);
+
+#undef MINOR
+
+	/* The four 3-by-3 minors. */
+	templen = fast_expansion_sum (4, cd, 4, da, temp8);
+	cdalen = fast_expansion_sum (templen, temp8, 4, ac, cda);
+	templen = fast_expansion_sum (4, da, 4, ab, temp8);
+	dablen = fast_expansion_sum (templen, temp8, 4, bd, dab);
+	for (i = 0; i < 4; i++) {
+		bd [i] = -bd [i];
+		ac [i] = -ac [i];
 	}
+	templen = fast_expansion_sum (4, ab, 4, bc, temp8);
+	abclen = fast_expansion_sum (templen, temp8, 4, ac, abc);
+	templen = fast_expansion_sum (4, bc, 4, cd, temp8);
+	bcdlen = fast_expansion_sum (templen, temp8, 4, bd, bcd);
+
+	/* Multiply each by the corresponding lifted coordinate. */
+	xlen = scale_expansion (bcdlen, bcd, pa -> x, det24x);
+	xlen = scale_expansion (xlen, det24x, pa -> x, det48x);
+	ylen = scale_expansion (bcdlen, bcd, pa -> y, det24y);
+	ylen = scale_expansion (ylen, det24y, pa -> y, det48y);
+	alen = fast_expansion_sum (xlen, det48x, ylen, det48y, adet);
+
+	xlen = scale_expansion (cdalen, cda, pb -> x, det24x);
+	xlen = scale_expansion (xlen, det24x, -pb -> x, det48x);
+	ylen = scale_expansion (cdalen, cda, pb -> y, det24y);
+	ylen = scale_expansion (ylen, det24y, -pb -> y, det48y);
+	blen = fast_expansion_sum (xlen, det48x, ylen, det48y, bdet);
+
+	xlen = scale_expansion (dablen, dab, pc -> x, det24x);
+	xlen = scale_expansion (xlen, det24x, pc -> x, det48x);
+	ylen = scale_expansion (dablen, dab, pc -> y, det24y);
+	ylen = scale_expansion (ylen, det24y, pc -> y, det48y);
+	clen = fast_expansion_sum (xlen, det48x, ylen, det48y, cdet);
+
+	xlen = scale_expansion (abclen, abc, pd -> x, det24x);
+	xlen = scale_expansion (xlen, det24x, -pd -> x, det48x);
+	ylen = scale_expansion (abclen, abc, pd -> y, det24y);
+	ylen = scale_expansion (ylen, det24y, -pd -> y, det48y);
+	dlen = fast_expansion_sum (xlen, det48x, ylen, det48y, ddet);
+
+	ablen = fast_expansion_sum (alen, adet, blen, bdet, abdet);
+	cdlen = fast_expansion_sum (clen, cdet, dlen, ddet, cddet);
+	detlen = fast_expansion_sum (ablen, abdet, cdlen, cddet, deter);
+
+	if (deter [detlen - 1] > 0.0) return (+1);
+	if (deter [detlen - 1] < 0.0) return (-1);
+	return (0);
 }
 
-#endif
-
 /*
  * A quick test driver.
  */
@@ -1398,11 +1650,13 @@ int *		neigh;
 
 	if (argc <= 1) {
 		/* Get DT edges only. */
-		delaunay_triangulation_2 (pts, &nedges, &edges, NULL, NULL, NULL);
+		_gst_delaunay_triangulation (pts, &nedges, &edges,
+					     NULL, NULL, NULL);
 	}
 	else {
 		/* Get DT triangles and neighbors only. */
-		delaunay_triangulation_2 (pts, &nedges, NULL, &ntri, &tri, &neigh);
+		_gst_delaunay_triangulation (pts, &nedges, NULL,
+					     &ntri, &tri, &neigh);
 	}
 
 	gst_free_channel (chan);
@@ -1411,7 +1665,7 @@ int *		neigh;
 
 	exit (0);
 }
-
+
 /*
  * Generate a postscript plot of the given triangulation.
  */
@@ -1435,9 +1689,10 @@ Eptr		e1, e2, e3;
 	/* Print internal edges lightly. */
 	gst_channel_printf (chan, "\t0.8 setgray\n"); 
 	for (e2 = e1; e2 < e3; e2 += 2) {
-		if ((e2 -> flags & ONX) NE 0) continue;
+		if ((e2 -> flags & (ONX | DEAD)) NE 0) continue;
 		gst_channel_printf (chan, "\t%d T %d T S\n",
-				    e2 -> src, e2 -> dst);
+				    dt -> verts [e2 -> src],
+				    dt -> verts [e2 -> dst]);
 	}
 
 	/* Print external face in bold. */
@@ -1445,7 +1700,8 @@ Eptr		e1, e2, e3;
 	for (e2 = e1; e2 < e3; e2 += 2) {
 		if ((e2 -> flags & ONX) EQ 0) continue;
 		gst_channel_printf (chan, "\t%d T %d T S\n",
-				    e2 -> src, e2 -> dst);
+				    dt -> verts [e2 -> src],
+				    dt -> verts [e2 -> dst]);
 	}
 	gst_channel_printf (chan, "\tPlot_Terminals\n");
 
@@ -1453,5 +1709,3 @@ Eptr		e1, e2, e3;
 }
 
 #endif	/* TEST_DRIVER */
-
-#endif	/* NOT USE_TRIANGLE */
@@ -26,8 +26,11 @@
 #ifndef DT_H_INCLUDED
 #define	DT_H_INCLUDED
 
+struct edge;
 struct pset;
 
+extern int	_gst_delaunay_edges (struct pset *	pts,
+				     struct edge **	edges_out);
 extern void	_gst_delaunay_triangulation (
 				struct pset *	pts,
 				int *		numberofedges,
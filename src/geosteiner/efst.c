@@ -179,7 +179,7 @@ struct gst_proplist *	plist;
 	T0 = _gst_get_cpu_time ();
 	Tn = T0;
 
-	einfo.x_order = _gst_heapsort_x (pts);
+	einfo.x_order = _gst_sort_points_x (pts, params -> num_threads);
 
 	if (timing NE NULL) {
 		_gst_convert_delta_cpu_time (buf1, &Tn);
@@ -265,6 +265,16 @@ struct gst_proplist *	plist;
 			      GST_PROP_HG_GENERATION_TIME,
 			      _gst_cpu_time_t_to_double_seconds (Tn - T0));
 	gst_set_int_property (plist, GST_PROP_HG_HALF_FST_COUNT, neqpoints);
+#ifdef HAVE_GMP
+	if (params -> multiple_precision > 0) {
+		gst_set_int_property (plist,
+				      GST_PROP_HG_MP_FILTERED_COUNT,
+				      einfo.mp_filtered);
+		gst_set_int_property (plist,
+				      GST_PROP_HG_MP_ESCALATED_COUNT,
+				      einfo.mp_escalated);
+	}
+#endif
 
 	count = 0;
 	for (i = 0; i < einfo.ntrees; i++) {
@@ -1953,7 +1963,9 @@ gst_channel_ptr		timing;
 	/* Compute minimum spanning tree */
 
 	mst_edges = NEWA (n - 1, struct edge);
-	nedges = _gst_euclidean_mst (pts, mst_edges);
+	nedges = _gst_euclidean_mst (pts,
+				     mst_edges,
+				     eip -> params -> num_threads);
 	FATAL_ERROR_IF (nedges NE n - 1);
 
 	mst_len = 0.0;
@@ -2031,6 +2043,9 @@ gst_channel_ptr		timing;
 	if (eip->params->multiple_precision > 0) {
 		_gst_qr3_init (&(eip -> cur_eqp.x));
 		_gst_qr3_init (&(eip -> cur_eqp.y));
+		eip -> cur_eqp_src	= NULL;
+		eip -> mp_filtered	= 0;
+		eip -> mp_escalated	= 0;
 	}
 #endif
 
@@ -2066,6 +2081,7 @@ gst_channel_ptr		timing;
 	if (max_fst_size EQ 0) max_fst_size = n;
 
 	for (size = 2; size <= max_fst_size-1; size++) {
+		if (_gst_fst_generation_stopped ()) break;
 		starti = eip -> size_start[(size-1)/2 + 1];
 		endi   = k;
 		if (size EQ 2) endi = n-1; /* skip last terminal */
@@ -2079,6 +2095,7 @@ gst_channel_ptr		timing;
 		}
 
 		for (i = starti; i < endi; i++) {
+			if (_gst_fst_generation_stopped ()) break;
 			eqpi = &(eip -> eqp[i]);
 			set_member_arr(eip, eqpi, TRUE);
 			generate_compatible_eqp(eip, size - eqpi -> S, eqpi, eqp_list);
@@ -2225,6 +2242,12 @@ gst_channel_ptr		timing;
 	if (eip->params->multiple_precision > 0) {
 		_gst_qr3_clear (&(eip -> cur_eqp.y));
 		_gst_qr3_clear (&(eip -> cur_eqp.x));
+		if (timing NE NULL) {
+			gst_channel_printf (timing,
+				"Multiple precision: %d values filtered,"
+				" %d needed GMP.\n",
+				eip -> mp_filtered, eip -> mp_escalated);
+		}
 	}
 #endif
 
@@ -2422,6 +2445,7 @@ found_efst:
 	fsp -> steiners		= new_steiners;
 	fsp -> nedges		= nedges;
 	fsp -> edges		= edges;
+	fsp -> refcount		= 1;
 
 	rp = NEW (struct elist);
 
@@ -2647,6 +2671,7 @@ int *			tlist;
 			fsp -> steiners	 = NULL;
 			fsp -> nedges	 = 1;
 			fsp -> edges	 = edges;
+			fsp -> refcount	 = 1;
 
 			*(eip -> hookp) = fsp;
 			eip -> hookp	= &(fsp -> next);
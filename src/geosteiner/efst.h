@@ -188,6 +188,11 @@ struct einfo {
 
 #ifdef HAVE_GMP
 	struct qr3_point cur_eqp;	/* Exact pos of current eq-point */
+	struct ddf_point cur_ddf;	/* Approx pos of current eq-point */
+	struct eqp_t *	cur_eqp_src;	/* Eq-point whose exact pos is */
+					/* not yet in cur_eqp (or NULL) */
+	int		mp_filtered;	/* Num values found without GMP */
+	int		mp_escalated;	/* Num values that needed GMP */
 #endif
 };
 
@@ -83,6 +83,13 @@ struct cost_extension *
 
 #define DEBUG_PRINT	0
 
+/* Error bounds for double-double arithmetic (see ddf_set()). */
+#define DDF_ADD_ERR	9.860761315262648e-32	/* 2^(-103) */
+#define DDF_MUL_ERR	3.944304526105059e-31	/* 2^(-101) */
+#define DDF_NEWTON_ERR	2.168404344971009e-19	/* 2^(-62) > 2^(-EPS) */
+#define DDF_ROUND	1.0000000001
+#define DDF_SPLITTER	134217729.0		/* 2^27 + 1 */
+
 struct ExEqp;
 struct GceInfo;
 
@@ -102,6 +109,8 @@ static void	compute_edges_for_fst (struct GceInfo *		gcp,
 static void	compute_eqpoint (struct qr3_point *	p,
 				 struct einfo *		eip,
 				 struct eqp_t *		eqpk);
+static void	compute_eqpoint_ddf (struct ddf_point *	p,
+				     struct eqp_t *	eqpk);
 static void	compute_qr3_length_squared (qr3_t *		result,
 					    struct qr3_point *	p1,
 					    struct qr3_point *	p2);
@@ -116,6 +125,20 @@ static void	compute_sqrt_scaled_qr3 (mpf_ptr	res,
 					 const qr3_t *	A,
 					 mpq_srcptr	scale);
 static void	count_graph_items (struct GceInfo * gcp);
+static void	ddf_add (ddf_t * r, const ddf_t * a, const ddf_t * b);
+static void	ddf_half (ddf_t * r);
+static void	ddf_mul (ddf_t * r, const ddf_t * a, const ddf_t * b);
+static void	ddf_set (ddf_t * r, double x);
+static void	ddf_sub (ddf_t * r, const ddf_t * a, const ddf_t * b);
+static bool	ddf_to_double (struct einfo *	eip,
+			       const ddf_t *	v,
+			       double *		result);
+static double	ddf_trunc (double s, double t);
+static struct qr3_point *
+		exact_cur_eqp (struct einfo * eip);
+static double	exact_difference (struct einfo *	eip,
+				  const qr3_t *		p,
+				  double		q);
 static void	free_graph_arrays (struct GceInfo * gcp);
 static void	print_qr3 (const qr3_t * x);
 static void	process_fst (struct GceInfo * gcp, int i);
@@ -129,6 +152,7 @@ static void	qr3_dot_product (qr3_t *			RES,
 				 const struct qr3_point *	B);
 static void	qr3_mul (qr3_t * dst, const qr3_t * p1, const qr3_t * p2);
 static double	qr3_to_double (struct einfo *, qr3_t *);
+static double	quick_two_sum (double a, double b, double * err);
 static void	r_to_q (mpq_t q_dst, double r_src);
 static void	traverse_compute_exact_steiner_points (
 				struct GceInfo *	gcp,
@@ -141,6 +165,18 @@ static struct ExEqp *	traverse_fst_graph (
 				int			v1,
 				int			e1,
 				int			v2);
+static double	two_prod (double a, double b, double * err);
+static double	two_sum (double a, double b, double * err);
+
+
+/*
+ * Local Variables
+ */
+
+/* sqrt(3) as a double-double number. */
+static const ddf_t	ddf_root3 = {
+	1.7320508075688772, 1.0035084221806903e-16, 1.0e-32
+};
 
 /*
  * A routine to recompute the coordinates of the given eq-point and its
@@ -150,6 +186,10 @@ static struct ExEqp *	traverse_fst_graph (
  * call this routine that re-computes these quantities correct to within
  * 1/2 ULP of the floating point arithmetic -- thus preventing the
  * accumulation of such errors.
+ *
+ * We first try to get each result from a double-double approximation
+ * having a rigorous error bound.  The exact position of the eq-point
+ * is only computed (using GMP) when the approximation does not suffice.
  */
 
 	void
@@ -161,17 +201,21 @@ struct eqp_t *		eqpk		/* IN - eq-point to recompute */
 {
 double			nx;
 double			ny;
-mpq_t			rtmp;
+double			dvx;
+double			dvy;
 struct point *		tp;
+struct ddf_point *	ap;
+ddf_t			t;
+#if DEBUG_PRINT
 struct qr3_point *	ep;
-qr3_t			dv_tmp;
+#endif
 
-	mpq_init (rtmp);
-	_gst_qr3_init (&dv_tmp);
+	ap = &(eip -> cur_ddf);
 
-	ep = &(eip -> cur_eqp);
+	compute_eqpoint_ddf (ap, eqpk);
 
-	compute_eqpoint (ep, eip, eqpk);
+	/* Exact position will be computed only if needed. */
+	eip -> cur_eqp_src = eqpk;
 
 #if DEBUG_PRINT
 	printf ("\nPoint %3d: original = (%24.20f, %24.20f)\n",
@@ -180,8 +224,12 @@ qr3_t			dv_tmp;
 		eqpk -> E.y);
 #endif
 
-	nx = qr3_to_double (eip, &(ep -> x));
-	ny = qr3_to_double (eip, &(ep -> y));
+	if (NOT ddf_to_double (eip, &(ap -> x), &nx)) {
+		nx = qr3_to_double (eip, &(exact_cur_eqp (eip) -> x));
+	}
+	if (NOT ddf_to_double (eip, &(ap -> y), &ny)) {
+		ny = qr3_to_double (eip, &(exact_cur_eqp (eip) -> y));
+	}
 
 #if DEBUG_PRINT
 	printf ("\tNew:          (%24.20f, %24.20f)\n", nx, ny);
@@ -193,6 +241,8 @@ qr3_t			dv_tmp;
 		printf ("\tErrors:\t%d\t(%14g, %14g)\n", eqpk -> S, ex, ey);
 	}
 
+	ep = exact_cur_eqp (eip);
+
 	printf ("\tSymbolic: X = ");
 	mpz_out_str (stdout, 10, mpq_numref (ep -> x.a));
 	printf (" / ");
@@ -214,23 +264,24 @@ qr3_t			dv_tmp;
 	printf ("\n");
 #endif
 
-	eqpk -> E.x = nx;
-	eqpk -> E.y = ny;
-
 	tp = &(eip -> eqp [eqpk -> origin_term].E);
 
-	r_to_q (rtmp, tp -> x);
-	mpq_sub (dv_tmp.a, ep -> x.a, rtmp);
-	mpq_set (dv_tmp.b, ep -> x.b);
-	eqpk -> DV.x = qr3_to_double (eip, &dv_tmp);
+	ddf_set (&t, tp -> x);
+	ddf_sub (&t, &(ap -> x), &t);
+	if (NOT ddf_to_double (eip, &t, &dvx)) {
+		dvx = exact_difference (eip, &(exact_cur_eqp (eip) -> x), tp -> x);
+	}
 
-	r_to_q (rtmp, tp -> y);
-	mpq_sub (dv_tmp.a, ep -> y.a, rtmp);
-	mpq_set (dv_tmp.b, ep -> y.b);
-	eqpk -> DV.y = qr3_to_double (eip, &dv_tmp);
+	ddf_set (&t, tp -> y);
+	ddf_sub (&t, &(ap -> y), &t);
+	if (NOT ddf_to_double (eip, &t, &dvy)) {
+		dvy = exact_difference (eip, &(exact_cur_eqp (eip) -> y), tp -> y);
+	}
 
-	_gst_qr3_clear (&dv_tmp);
-	mpq_clear (rtmp);
+	eqpk -> E.x	= nx;
+	eqpk -> E.y	= ny;
+	eqpk -> DV.x	= dvx;
+	eqpk -> DV.y	= dvy;
 }
 
 /*
@@ -582,8 +633,8 @@ double		xf;
  * Routine to compute the length of a given EFST (i.e., Simpson line)
  * to within 1/2 ULP.  (Modulo good behavior of the sqrt() function...)
  *
- * The exact position of the eq-point end of the Simpson line has already
- * been stored in eip -> cur_eqp.
+ * The position of the eq-point end of the Simpson line has already been
+ * stored in eip -> cur_ddf (and eip -> cur_eqp, if it was needed).
  */
 
 	double
@@ -593,9 +644,29 @@ struct einfo *		eip,		/* IN - EFST generation info */
 struct eqp_t *		eqpt		/* IN - terminal end of Simpson line */
 )
 {
+double			len;
+double			len2;
 qr3_t			x;
 qr3_t			y;
-double			len;
+ddf_t			dx;
+ddf_t			dy;
+ddf_t			t;
+struct qr3_point *	ep;
+
+	ddf_set (&t, eqpt -> E.x);
+	ddf_sub (&dx, &(eip -> cur_ddf.x), &t);
+	ddf_set (&t, eqpt -> E.y);
+	ddf_sub (&dy, &(eip -> cur_ddf.y), &t);
+
+	ddf_mul (&dx, &dx, &dx);
+	ddf_mul (&dy, &dy, &dy);
+	ddf_add (&dx, &dx, &dy);
+
+	if (ddf_to_double (eip, &dx, &len2)) {
+		return (sqrt (len2));
+	}
+
+	ep = exact_cur_eqp (eip);
 
 	_gst_qr3_init (&x);
 	_gst_qr3_init (&y);
@@ -603,10 +674,10 @@ double			len;
 	r_to_q (x.a, - eqpt -> E.x);
 	r_to_q (y.a, - eqpt -> E.y);
 
-	mpq_add (x.a, x.a, eip -> cur_eqp.x.a);
-	mpq_add (y.a, y.a, eip -> cur_eqp.y.a);
-	mpq_set (x.b, eip -> cur_eqp.x.b);
-	mpq_set (y.b, eip -> cur_eqp.y.b);
+	mpq_add (x.a, x.a, ep -> x.a);
+	mpq_add (y.a, y.a, ep -> y.a);
+	mpq_set (x.b, ep -> x.b);
+	mpq_set (y.b, ep -> y.b);
 
 	qr3_mul (&x, &x, &x);
 	qr3_mul (&y, &y, &y);
@@ -622,6 +693,360 @@ double			len;
 	return (len);
 }
 
+/*
+ * Return the exact position of the current eq-point, computing it
+ * first if we have not yet done so.
+ */
+
+	static
+	struct qr3_point *
+exact_cur_eqp (
+
+struct einfo *		eip		/* IN - EFST generation info */
+)
+{
+	if (eip -> cur_eqp_src NE NULL) {
+		compute_eqpoint (&(eip -> cur_eqp), eip, eip -> cur_eqp_src);
+		eip -> cur_eqp_src = NULL;
+	}
+
+	return (&(eip -> cur_eqp));
+}
+
+/*
+ * Accurately translate the exact difference P - Q into a double, where
+ * P is an element of Q(sqrt(3)) and Q is a double.
+ */
+
+	static
+	double
+exact_difference (
+
+struct einfo *		eip,		/* IN - EFST generation info */
+const qr3_t *		p,		/* IN - minuend */
+double			q		/* IN - subtrahend */
+)
+{
+double			z;
+mpq_t			rtmp;
+qr3_t			tmp;
+
+	mpq_init (rtmp);
+	_gst_qr3_init (&tmp);
+
+	r_to_q (rtmp, q);
+	mpq_sub (tmp.a, p -> a, rtmp);
+	mpq_set (tmp.b, p -> b);
+	z = qr3_to_double (eip, &tmp);
+
+	_gst_qr3_clear (&tmp);
+	mpq_clear (rtmp);
+
+	return (z);
+}
+
+/*
+ * Approximate the position of the given eq-point, using the same
+ * construction as compute_eqpoint(), but in double-double arithmetic.
+ * For an eq-point P,Q (with R = Q - P) we have:
+ *
+ *	X = P.x + (R.x - sqrt(3) * R.y) / 2
+ *	Y = P.y + (R.y + sqrt(3) * R.x) / 2
+ */
+
+	static
+	void
+compute_eqpoint_ddf (
+
+struct ddf_point *	out,		/* OUT - approximate eq-point */
+struct eqp_t *		eqpk		/* IN - eq-point to calculate */
+)
+{
+struct ddf_point	P, Q, R;
+ddf_t			t;
+
+	if (eqpk -> L EQ NULL) {
+		/* Base case -- a terminal. */
+		ddf_set (&(out -> x), eqpk -> E.x);
+		ddf_set (&(out -> y), eqpk -> E.y);
+		return;
+	}
+
+	compute_eqpoint_ddf (&P, eqpk -> R);
+	compute_eqpoint_ddf (&Q, eqpk -> L);
+
+	ddf_sub (&R.x, &Q.x, &P.x);
+	ddf_sub (&R.y, &Q.y, &P.y);
+
+	ddf_mul (&t, &R.y, &ddf_root3);
+	ddf_sub (&t, &R.x, &t);
+	ddf_half (&t);
+	ddf_add (&(out -> x), &P.x, &t);
+
+	ddf_mul (&t, &R.x, &ddf_root3);
+	ddf_add (&t, &R.y, &t);
+	ddf_half (&t);
+	ddf_add (&(out -> y), &P.y, &t);
+}
+
+/*
+ * Determine the double that qr3_to_double() would produce for the
+ * value approximated by V -- i.e., the value truncated toward zero
+ * (which is what mpq_get_d() does), after Newton iteration to within a
+ * relative error of 2^(-EPS).  We succeed if every point of the error
+ * interval (widened to account for the Newton iteration) truncates to
+ * the same double.  Count the outcome either way.
+ */
+
+	static
+	bool
+ddf_to_double (
+
+struct einfo *		eip,		/* IN - EFST generation info */
+const ddf_t *		v,		/* IN - approximate value */
+double *		result		/* OUT - value as a double */
+)
+{
+double			e;
+double			s;
+double			t;
+double			lo;
+double			hi;
+
+	if (v -> err EQ 0.0) {
+		/* Value is known exactly. */
+		*result = ddf_trunc (v -> hi, v -> lo) + 0.0;
+		++(eip -> mp_filtered);
+		return (TRUE);
+	}
+
+	e = (v -> err + fabs (v -> hi) * DDF_NEWTON_ERR) * DDF_ROUND;
+
+	s = two_sum (v -> hi, v -> lo - e, &t);
+	lo = ddf_trunc (s, t);
+	s = two_sum (v -> hi, v -> lo + e, &t);
+	hi = ddf_trunc (s, t);
+
+	if (lo NE hi) {
+		++(eip -> mp_escalated);
+		return (FALSE);
+	}
+
+	/* Avoid returning -0.0, as mpq_get_d() would never do so. */
+	*result = lo + 0.0;
+	++(eip -> mp_filtered);
+	return (TRUE);
+}
+
+/*
+ * Truncate the exact sum S + T toward zero, where S = fl(S + T).
+ */
+
+	static
+	double
+ddf_trunc (
+
+double		s,		/* IN - rounded sum */
+double		t		/* IN - rounding error of sum */
+)
+{
+	if ((t EQ 0.0) OR ((t > 0.0) EQ (s > 0.0))) {
+		return (s);
+	}
+	return (nextafter (s, 0.0));
+}
+
+/*
+ * Double-double arithmetic, with error bounds.  The basic operations
+ * are those of Dekker and of Knuth, whose relative errors are bounded
+ * by a small multiple of 2^(-106) (see Joldes, Muller and Popescu,
+ * "Tight and Rigorous Error Bounds for Basic Building Blocks of
+ * Double-Word Arithmetic", ACM TOMS 44, 2017).  We use somewhat
+ * larger bounds, and inflate every error bound slightly to cover the
+ * rounding errors made while computing the bound itself.
+ */
+
+	static
+	void
+ddf_set (
+
+ddf_t *		r,		/* OUT - result */
+double		x		/* IN - value (exact) */
+)
+{
+	r -> hi		= x;
+	r -> lo		= 0.0;
+	r -> err	= 0.0;
+}
+
+
+	static
+	void
+ddf_add (
+
+ddf_t *		r,		/* OUT - A + B */
+const ddf_t *	a,		/* IN - first operand */
+const ddf_t *	b		/* IN - second operand */
+)
+{
+double		s1, s2, t1, t2;
+double		err;
+
+	s1 = two_sum (a -> hi, b -> hi, &s2);
+	t1 = two_sum (a -> lo, b -> lo, &t2);
+	s2 += t1;
+	s1 = quick_two_sum (s1, s2, &s2);
+	s2 += t2;
+	s1 = quick_two_sum (s1, s2, &s2);
+
+	err = (a -> err + b -> err + fabs (s1) * DDF_ADD_ERR) * DDF_ROUND;
+
+	r -> hi		= s1;
+	r -> lo		= s2;
+	r -> err	= err;
+}
+
+
+	static
+	void
+ddf_sub (
+
+ddf_t *		r,		/* OUT - A - B */
+const ddf_t *	a,		/* IN - first operand */
+const ddf_t *	b		/* IN - second operand */
+)
+{
+ddf_t		nb;
+
+	nb.hi	= - b -> hi;
+	nb.lo	= - b -> lo;
+	nb.err	= b -> err;
+
+	ddf_add (r, a, &nb);
+}
+
+
+	static
+	void
+ddf_mul (
+
+ddf_t *		r,		/* OUT - A * B */
+const ddf_t *	a,		/* IN - first operand */
+const ddf_t *	b		/* IN - second operand */
+)
+{
+double		p, e;
+double		err;
+
+	p = two_prod (a -> hi, b -> hi, &e);
+	e += a -> hi * b -> lo + a -> lo * b -> hi;
+	p = quick_two_sum (p, e, &e);
+
+	err = (  (fabs (a -> hi) + fabs (a -> lo)) * b -> err
+	       + (fabs (b -> hi) + fabs (b -> lo)) * a -> err
+	       + a -> err * b -> err
+	       + fabs (p) * DDF_MUL_ERR) * DDF_ROUND;
+
+	r -> hi		= p;
+	r -> lo		= e;
+	r -> err	= err;
+}
+
+
+	static
+	void
+ddf_half (
+
+ddf_t *		r		/* IN/OUT - value to divide by 2 */
+)
+{
+	/* Exact (barring underflow). */
+	r -> hi		*= 0.5;
+	r -> lo		*= 0.5;
+	r -> err	*= 0.5;
+}
+
+
+/*
+ * Return A + B, and the (exact) rounding error in *ERR.
+ */
+
+	static
+	double
+two_sum (
+
+double		a,		/* IN - first operand */
+double		b,		/* IN - second operand */
+double *	err		/* OUT - rounding error */
+)
+{
+double		s;
+double		bb;
+
+	s = a + b;
+	bb = s - a;
+	*err = (a - (s - bb)) + (b - bb);
+
+	return (s);
+}
+
+
+/*
+ * Same as two_sum(), but requires that |A| >= |B| (or A = 0).
+ */
+
+	static
+	double
+quick_two_sum (
+
+double		a,		/* IN - first operand */
+double		b,		/* IN - second operand */
+double *	err		/* OUT - rounding error */
+)
+{
+double		s;
+
+	s = a + b;
+	*err = b - (s - a);
+
+	return (s);
+}
+
+
+/*
+ * Return A * B, and the (exact) rounding error in *ERR.  We use
+ * Dekker's splitting rather than depending upon a hardware FMA.
+ */
+
+	static
+	double
+two_prod (
+
+double		a,		/* IN - first operand */
+double		b,		/* IN - second operand */
+double *	err		/* OUT - rounding error */
+)
+{
+double		p;
+double		t;
+double		ahi, alo;
+double		bhi, blo;
+
+	p = a * b;
+
+	t = DDF_SPLITTER * a;
+	ahi = t - (t - a);
+	alo = a - ahi;
+
+	t = DDF_SPLITTER * b;
+	bhi = t - (t - b);
+	blo = b - bhi;
+
+	*err = ((ahi * bhi - p) + ahi * blo + alo * bhi) + alo * blo;
+
+	return (p);
+}
+
 /*
  * Multiply two elements of Q(sqrt(3)).
  */
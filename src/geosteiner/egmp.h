@@ -61,6 +61,24 @@ struct qr3_point {
 	qr3_t		y;
 };
 
+/*
+ * Before resorting to exact arithmetic we approximate each quantity
+ * by a double-double number HI + LO that differs from the exact
+ * value by at most ERR.  Most of the time this interval is narrow
+ * enough to determine the final double result all by itself.
+ */
+
+typedef struct {			/* (hi + lo) +/- err */
+	double		hi;
+	double		lo;
+	double		err;
+} ddf_t;
+
+struct ddf_point {
+	ddf_t		x;
+	ddf_t		y;
+};
+
 
 /*
  * Global Routines
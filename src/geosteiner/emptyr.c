@@ -41,6 +41,7 @@
 #include "emptyr.h"
 
 #include <float.h>
+#include "fstfuncs.h"
 #include "logic.h"
 #include "memory.h"
 #include "point.h"
@@ -84,6 +85,10 @@ static void		set_bit (bitmap_t *, int, int);
  *
  * The succ0 array may be given as the NULL pointer in which case it is
  * computed by the the procedure.
+ *
+ * This takes O(N**2) time, so we give up early if FST generation is
+ * being stopped.  The matrix is then incomplete, but the FSTs grown
+ * from it are discarded anyway.
  */
 
 	bitmap_t *
@@ -116,7 +121,7 @@ double		top_x, bot_x;
 
 	/* Do we need to compute succ array? */
 	if (succ0 EQ NULL) {
-		x_order = _gst_heapsort_x (pts);
+		x_order = _gst_sort_points_x (pts, 1);
 		succ	= NEWA (n, int);
 
 		for (i = 1; i < n; i++) {
@@ -139,6 +144,7 @@ double		top_x, bot_x;
 
 	p = &(pts -> a [0]);
 	for (i = 0; i < n; i++, p++) {
+		if (_gst_fst_generation_stopped ()) break;
 		x = p -> x;
 		y = p -> y;
 
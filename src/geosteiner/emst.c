@@ -45,7 +45,6 @@
 #include "memory.h"
 #include "mst.h"
 #include "point.h"
-#include "sortfuncs.h"
 #include <stdlib.h>
 #include "steiner.h"
 #include <string.h>
@@ -55,7 +54,9 @@
  * Global Routines
  */
 
-int		_gst_euclidean_mst (struct pset * pts, struct edge * edges);
+int		_gst_euclidean_mst (struct pset *	pts,
+				    struct edge *	edges,
+				    int			nthreads);
 dist_t		_get_euclidean_mst_length (struct pset * pts);
 
 
@@ -92,7 +93,7 @@ struct edge *	edges;
 
 	edges = NEWA (pts -> n - 1, struct edge);
 
-	nedges = _gst_euclidean_mst (pts, &edges [0]);
+	nedges = _gst_euclidean_mst (pts, &edges [0], 1);
 
 	FATAL_ERROR_IF (nedges NE pts -> n - 1);
 
@@ -110,17 +111,20 @@ struct edge *	edges;
 
 /*
  * This routine computes an Euclidean Minimum Spanning Tree for the
- * given point set.  The output is a list of edges.
+ * given point set.  The output is a list of edges.  Large instances
+ * are done in parallel when NTHREADS > 1, yielding the same tree.
  *
- * The "Triangle" package by Jonathan Richard Shewchuk is used
- * to provide the Delaunay triangulation for the set of points.
+ * The Delaunay triangulation of the points provides the candidate
+ * edges.  We always use our own O(N log N) triangulator for this,
+ * even when the "Triangle" package is configured.
  */
 
 	int
 _gst_euclidean_mst (
 
 struct pset *		pts,		/* IN - point set. */
-struct edge *		edges		/* OUT - edge list. */
+struct edge *		edges,		/* OUT - edge list. */
+int			nthreads	/* IN - number of threads to use */
 )
 {
 int		nedges;
@@ -129,10 +133,11 @@ struct edge *	edge_array;
 
 	nedges = build_euclidean_edges (pts, &edge_array);
 
-	mst_edge_count = _gst_mst_edge_list (pts -> n,
-					     nedges,
-					     &edge_array [0],
-					     edges);
+	mst_edge_count = _gst_parallel_mst_edge_list (pts -> n,
+						      nedges,
+						      &edge_array [0],
+						      edges,
+						      nthreads);
 
 	free ((char *) edge_array);
 
@@ -152,22 +157,13 @@ struct pset *		pts,		/* IN - set of points */
 struct edge **		edges_out	/* OUT - edge list */
 )
 {
-int			i, i1;
-int			j, j1;
-int			k;
+int			i;
+int			j;
 int			n;
 int			nedges;
-int			ndup;
-int			numberofedges;
-int *			edgelist;
 struct edge *		edges;
 struct point *		p1;
 struct point *		p2;
-struct pset *		newpts;
-int *			order;
-int *			orig_vnum;
-bool *			dflags;
-struct edge *		zedges;
 
 	n = pts -> n;
 
@@ -189,105 +185,10 @@ struct edge *		zedges;
 		return (nedges);
 	}
 
-	/* Triangle does a "good" job when given duplicate points -- it	*/
-	/* emits edges to only one of the given coincident points.	*/
-	/* This is bad for us, however, since we want a fully connected	*/
-	/* MST, and cannot get one if there are vertices for which we	*/
-	/* have no incident edges.  Therefore we must detect all	*/
-	/* duplicate points and manually generate one zero-length edge	*/
-	/* for each (copies 2 through K of a point each have an edge to	*/
-	/* the first copy of the point).				*/
+	/* We want a fully connected MST, and cannot get one if there	*/
+	/* are vertices for which we have no incident edges.  The	*/
+	/* triangulator therefore gives copies 2 through K of each	*/
+	/* point a zero-length edge to the first copy of the point.	*/
 
-	order = _gst_heapsort_x (pts);
-
-	dflags = NEWA (n, bool);
-	memset (dflags, FALSE, n * sizeof (dflags [0]));
-
-	zedges = NEWA (n, struct edge);
-	memset (zedges, 0, n * sizeof (zedges));
-
-	ndup = 0;
-	for (i = 0; i < n - 1; ) {
-		i1 = order [i];
-		p1 = &(pts -> a [i1]);
-		for (j = i; ; ) {
-			++j;
-			if (j >= n) break;
-
-			j1 = order [j];
-			p2 = &(pts -> a [j1]);
-			if (p1 -> x NE p2 -> x) break;
-			if (p1 -> y NE p2 -> y) break;
-
-			/* Point j1 is a duplicate of point i1.  The	*/
-			/* sort also guarantees that i1 < j1.  Omit	*/
-			/* point j1.					*/
-
-			dflags [j1] = TRUE;
-
-			/* Generate zero-length edge (i1,j1). */
-
-			zedges [ndup].len	= 0.0;
-			zedges [ndup].p1	= i1;
-			zedges [ndup].p2	= j1;
-			++ndup;
-		}
-		i = j;
-	}
-
-	free (order);
-
-	/* Get array to map duplicate-free points back to originals. */
-	orig_vnum = NEWA (n, int);
-
-	/* Set up data structure to call triangle. */
-	newpts = NEW_PSET (n);
-	j = 0;
-	for (i = 0; i < n; i++) {
-		if (dflags [i]) continue;
-		newpts -> a [j].x	= pts -> a [i].x;
-		newpts -> a [j].y	= pts -> a [i].y;
-		orig_vnum [j] = i;
-		++j;
-	}
-	newpts -> n	= j;
-
-	free (dflags);
-
-	_gst_delaunay_triangulation (
-				newpts,
-				&numberofedges,
-				&edgelist,
-				NULL, 
-				NULL,
-				NULL);
-	free (newpts);
-
-	nedges = numberofedges;
-
-	edges = NEWA (nedges + ndup, struct edge);
-	*edges_out = edges;
-
-	for (k = 0; k < ndup; k++) {
-		*edges++ = zedges [k];
-	}
-
-	free (zedges);
-
-	for (k = 0; k < nedges; k++) {
-		i  = orig_vnum [edgelist [2*k    ]];
-		j  = orig_vnum [edgelist [2*k + 1]];
-		p1 = &(pts -> a [i]);
-		p2 = &(pts -> a [j]);
-
-		edges -> len	= EDIST (p1, p2);
-		edges -> p1	= i;
-		edges -> p2	= j;
-		++edges;
-	}
-
-	free (edgelist);
-	free (orig_vnum);
-
-	return (nedges + ndup);
+	return (_gst_delaunay_edges (pts, edges_out));
 }
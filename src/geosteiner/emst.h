@@ -31,7 +31,9 @@
 struct edge;
 struct pset;
 
-extern int	_gst_euclidean_mst (struct pset * pts, struct edge * edges);
+extern int	_gst_euclidean_mst (struct pset *	pts,
+				    struct edge *	edges,
+				    int			nthreads);
 extern dist_t	_gst_euclidean_mst_length (struct pset * pts);
 
 #endif
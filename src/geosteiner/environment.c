@@ -85,6 +85,7 @@ CPXENVptr	gst_detach_cplex (void);
  */
 
 struct environment *	gst_env;
+THREAD_LOCAL bool	_gst_fp_is_saved;
 
 enum { CPLEX_UNATTACHED, CPLEX_ATTACHED };
 
@@ -134,7 +135,7 @@ struct environment *	p;
 		p -> solver_open	= FALSE;
 		p -> solver_refcount	= 0;
 		p -> machine_string	= _gst_get_machine_string ();
-		p -> fp_saved		= FALSE;
+		_gst_mutex_init (&(p -> lp_lock));
 
 		INIT_LP_SOLVER (p);
 		_gst_initialize_cpu_time (p);
@@ -203,6 +204,7 @@ struct gst_parmdefs *	pdefs;
 	}
 	free (p -> machine_string);
 	p -> machine_string = NULL;
+	_gst_mutex_destroy (&(p -> lp_lock));
 }
 
 /*
@@ -215,11 +217,13 @@ gst_open_lpsolver (void)
 
 	GST_PRELUDE
 
+	_gst_lock_lp_solver ();
 	if (NOT (gst_env -> solver_open)) {
 		_gst_startup_lp_solver ();
 
 		gst_env -> solver_open = TRUE;
 	}
+	_gst_unlock_lp_solver ();
 	GST_POSTLUDE
 	return 0;
 }
@@ -237,6 +241,7 @@ int	res;
 
 	res = 0;
 
+	_gst_lock_lp_solver ();
 	if (gst_env -> solver_open) {
 		if (gst_env -> solver_refcount > 0) {
 			res = GST_ERR_LP_SOLVER_ACTIVE;
@@ -255,6 +260,7 @@ int	res;
 			gst_env -> solver_open = FALSE;
 		}
 	}
+	_gst_unlock_lp_solver ();
 
 	GST_POSTLUDE
 	return res;
@@ -270,7 +276,9 @@ _gst_begin_using_lp_solver (void)
 
 {
 	/* This prevents it from being closed... */
+	_gst_lock_lp_solver ();
 	++(gst_env -> solver_refcount);
+	_gst_unlock_lp_solver ();
 
 	gst_open_lpsolver ();
 }
@@ -286,9 +294,38 @@ _gst_begin_using_lp_solver (void)
 _gst_stop_using_lp_solver (void)
 
 {
+	_gst_lock_lp_solver ();
 	if (--(gst_env -> solver_refcount) < 0) {
 		FATAL_ERROR;
 	}
+	_gst_unlock_lp_solver ();
+}
+
+/*
+ * Get exclusive use of the LP solver.  lp_solve keeps much of its
+ * state in global variables, so only one thread at a time may build,
+ * solve, modify or destroy an LP, process wide.  The lock is not
+ * recursive: the holder must not call gst_open_lpsolver,
+ * gst_close_lpsolver, _gst_begin_using_lp_solver or
+ * _gst_stop_using_lp_solver.
+ */
+
+	void
+_gst_lock_lp_solver (void)
+
+{
+	_gst_mutex_lock (&(gst_env -> lp_lock));
+}
+
+/*
+ * Give up exclusive use of the LP solver.
+ */
+
+	void
+_gst_unlock_lp_solver (void)
+
+{
+	_gst_mutex_unlock (&(gst_env -> lp_lock));
 }
 
 /*
@@ -402,7 +439,7 @@ CPXENVptr tmp;
 #if 1
 void _gst_fp_saved()
 {
-	if (gst_env -> fp_saved) {
+	if (_gst_fp_is_saved) {
 		fprintf(stderr, "FPU not restored!!\n");
 	}
 }
@@ -40,6 +40,7 @@
 
 #include "config.h"
 #include "gsttypes.h"
+#include "threads.h"
 #include <time.h>
 
 #include "lpsolver.h"	/* Needed for CPXENVptr */
@@ -51,7 +52,7 @@ struct environment {
 	bool		solver_open;	/* TRUE iff solver is open */
 	int		solver_refcount; /* Reference count for LP solver */
 	char *		machine_string;	/* String describing the machine */
-	bool		fp_saved;
+	struct gst_mutex lp_lock;	/* Held while using the LP solver */
 #ifdef CPLEX
 	int		cplex_status;	/* CPLEX attached/unattached */
  #if CPLEX >= 40
@@ -74,8 +75,13 @@ struct environment {
 
 extern struct environment * gst_env;
 
+/* TRUE iff this thread has already saved the FPU configuration. */
+extern THREAD_LOCAL bool	_gst_fp_is_saved;
+
 extern void	_gst_begin_using_lp_solver (void);
+extern void	_gst_lock_lp_solver (void);
 extern void	_gst_stop_using_lp_solver (void);
+extern void	_gst_unlock_lp_solver (void);
 
 extern void	_gst_initialize_one_bits_in_byte_tables (void);
 
@@ -390,7 +390,8 @@ gst_hg_ptr	H2;
 
 	/* Compute map giving index of each terminal in sequence when	*/
 	/* sorted by increasing X coordinate.				*/
-	tmp = _gst_heapsort_x (cip -> pts);
+	tmp = _gst_sort_points_x (cip -> pts,
+				  params -> num_threads);
 
 	prev_coord = INF_DISTANCE;
 	prev_index = -1;
@@ -408,7 +409,8 @@ gst_hg_ptr	H2;
 
 	/* Compute map giving index of each terminal in sequence when	*/
 	/* sorted by increasing Y coordinate.				*/
-	tmp = _gst_heapsort_y (cip -> pts);
+	tmp = _gst_sort_points_y (cip -> pts,
+				  params -> num_threads);
 
 	prev_coord = INF_DISTANCE;
 	prev_index = -1;
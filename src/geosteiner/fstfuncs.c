@@ -42,6 +42,7 @@
 #include "steiner.h"
 #include <stdlib.h>
 #include <string.h>
+#include "threads.h"
 
 
 /*
@@ -49,6 +50,7 @@
  */
 
 struct pset *		_gst_create_pset (int nterms, double * terms);
+bool			_gst_fst_generation_stopped (void);
 int			_gst_generate_duplicate_terminal_groups (
 						struct pset *	pts,
 						int *		xorder,
@@ -65,6 +67,13 @@ struct pset *		_gst_remove_duplicates (
 					int **		list,
 					int **		fwd_map,
 					int **		rev_map);
+
+
+/*
+ * Global Variables
+ */
+
+THREAD_LOCAL int *	_gst_fst_stop_flag;
 
 /*
  * Create a point set from a simple array of (x,y) pairs.
@@ -100,6 +109,24 @@ struct pset *	pts;
 	return pts;
 }
 
+/*
+ * Return TRUE if the FST generator running on this thread should stop
+ * early.  A caller that wants to be able to stop the generation from
+ * another thread points _gst_fst_stop_flag at a word, which that
+ * thread sets to non-zero.  The generators then quit enumerating FSTs,
+ * and return a hypergraph that lacks some of them.  The caller must
+ * discard it.  Pruning likewise quits, but what it has pruned by then
+ * was pruned correctly.
+ */
+
+	bool
+_gst_fst_generation_stopped (void)
+
+{
+	return ((_gst_fst_stop_flag NE NULL) AND
+		(LOAD_ACQUIRE (_gst_fst_stop_flag) NE 0));
+}
+
 /*
  * Initialize various fields in a hypergraph.
  */
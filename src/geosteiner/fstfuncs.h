@@ -32,11 +32,17 @@
 #ifndef	FSTFUNCS_H
 #define	FSTFUNCS_H
 
+#include "gsttypes.h"
+#include "threads.h"
+
 struct full_set;
 struct gst_hypergraph;
 struct pset;
 
+extern THREAD_LOCAL int *	_gst_fst_stop_flag;
+
 extern struct pset *	_gst_create_pset (int, double *);
+extern bool		_gst_fst_generation_stopped (void);
 extern int		_gst_generate_duplicate_terminal_groups (struct pset *,
 						     int *,
 						     int ***);
@@ -95,8 +95,6 @@ static void		add_fst (struct pset *		pts,
 				 bool			mst_connected);
 static dist_t		fst_length (struct pset *, int *, int);
 static dist_t		mst_length (struct pset *, int *, int);
-static int		compare_edge_length (int, int, void *);
-static int		compare_fst_ratio (int, int, void *);
 
 
 
@@ -210,58 +208,6 @@ dist_t			mst_l;
 	return mst_l;
 }
 
-/*
- * Compares edges by length. Returns TRUE if the first edge is shorter than
- * the second edge or if they are equal in length but with first index smaller
- * than the second index. Otherwise FALSE is returned.
- */
-	static
-	int
-compare_edge_length
-(
-
-int	i1,	/* IN - first index */
-int	i2,	/* IN - second index */
-void *	array	/* IN - array to be sorted */
-)
-{
-dist_t			key1, key2;
-
-	key1 = ((struct greedy_edge *)array)[i1].len;
-	key2 = ((struct greedy_edge *)array)[i2].len;
-
-	if ((key1 < key2) OR
-	    ((key1 EQ key2) AND (i1 < i2)))
-		return (-1);
-
-	return (1);
-}
-
-/*
- * Compare fsts by ratio.
- */
-	static
-	int
-compare_fst_ratio
-(
-
-int	i1,	/* IN - first index */
-int	i2,	/* IN - second index */
-void *	array	/* IN - array to be sorted */
-)
-{
-dist_t			key1, key2;
-
-	key1 = ((struct greedy_fst *)array)[i1].ratio;
-	key2 = ((struct greedy_fst *)array)[i2].ratio;
-
-	if ((key1 < key2) OR
-	    ((key1 EQ key2) AND (i1 < i2)))
-		return (-1);
-
-	return (1);
-}
-
 /*
  * Add generated FST to list of FSTs
  */
@@ -328,6 +274,7 @@ int *			neighborlist;
 int *			triangleedges;
 int *			sortededges;
 int *			sortedfsts;
+dist_t *		keys;
 bool *			new_chosen;
 bool			convex_region;
 bool			in_same_block;
@@ -447,9 +394,12 @@ struct greedy_fst  *	greedy_fsts;
 
 	/* Sort edges */
 
-	sortededges = _gst_heapsort (numberofedges,
-				     greedy_edges,
-				     compare_edge_length);
+	keys = NEWA (numberofedges, dist_t);
+	for (i = 0; i < numberofedges; i++) {
+		keys [i] = greedy_edges [i].len;
+	}
+	sortededges = _gst_sort_keys (numberofedges, keys, 1);
+	free (keys);
 
 	/* Use Kruskal to find MST */
 
@@ -583,7 +533,12 @@ struct greedy_fst  *	greedy_fsts;
 
 	/* Sort FSTs */
 
-	sortedfsts = _gst_heapsort (fst_count, greedy_fsts, compare_fst_ratio);
+	keys = NEWA (fst_count, dist_t);
+	for (i = 0; i < fst_count; i++) {
+		keys [i] = greedy_fsts [i].ratio;
+	}
+	sortedfsts = _gst_sort_keys (fst_count, keys, 1);
+	free (keys);
 
 	/* Use greedy concatenation algorithm:
 	   1. Use FSTs that span connected subgraphs of MST
@@ -0,0 +1,718 @@
+/***********************************************************************
+
+	File:	hgblocks.c
+	Rev:	e-1
+	Date:	10/19/2026
+
+	This work is licensed under a Creative Commons
+	Attribution-NonCommercial 4.0 International License.
+
+************************************************************************
+
+	Split a hypergraph at its articulation vertices, and solve
+	each of the resulting blocks as an instance of its own.
+
+************************************************************************/
+
+#include "hgblocks.h"
+
+#include "btsearch.h"
+#include "fatal.h"
+#include <float.h>
+#include "geosteiner.h"
+#include "logic.h"
+#include "memory.h"
+#include "parmblk.h"
+#include "solver.h"
+#include <stdlib.h>
+#include "steiner.h"
+#include <string.h>
+#include "threads.h"
+
+
+/*
+ * Global Routines
+ */
+
+bool			_gst_solve_hg_blocks (struct gst_solver * solver);
+
+
+/*
+ * Local Types
+ */
+
+struct hgblock {
+	int		first;		/* index of first edge in bedges[] */
+	int		nedges;		/* number of edges in block */
+	int		nverts;		/* number of vertices in block */
+	int		reason;		/* why the sub-solver stopped */
+	int		nsol;		/* number of edges in solution, */
+					/* or -1 if there is none */
+	int *		sol;		/* solution edges, numbered as in */
+					/* the original hypergraph */
+	bool		solved;		/* block needs no further work */
+	bool		tried;		/* backtrack search gave up */
+};
+
+struct bcc {
+	struct gst_hypergraph *
+			H;		/* problem data */
+	int *		dfs;		/* DFS number of each vertex */
+	int *		low;		/* lowest DFS num in component */
+	int *		parent;		/* parents of vertices in DFS tree */
+	int *		vblock;		/* last block seen at each vertex */
+	int *		stack;		/* base-address of edge stack */
+	int *		sp;		/* current stack pointer */
+	int		counter;	/* DFS number generator */
+	bitmap_t *	edges_seen;	/* edges already pushed */
+	int *		bedges;		/* edges of all blocks, block by */
+					/* block */
+	int		nbedges;	/* number of edges in bedges[] */
+	struct hgblock * blocks;	/* the blocks found so far */
+	int		nblocks;	/* number of blocks found */
+};
+
+struct block_pool {
+	struct gst_mutex	lock;		/* protects next_job */
+	int			next_job;	/* next entry of jobs[] */
+	int			njobs;		/* number of jobs */
+	int *			jobs;		/* blocks to be solved */
+	struct hgblock *	blocks;		/* all blocks */
+	int *			bedges;		/* edges of all blocks */
+	struct gst_hypergraph *	H;		/* original hypergraph */
+	gst_param_ptr		params;		/* parameters for blocks */
+};
+
+
+/*
+ * Local Routines
+ */
+
+static void		bcc (struct bcc *, int);
+static void		block_worker (int, void *);
+static bool		can_decompose (struct gst_solver *);
+static int		find_blocks (struct bcc *);
+static bool		is_small_block (struct hgblock *, gst_param_ptr);
+static void		solve_block (struct gst_hypergraph *,
+				     struct hgblock *,
+				     int *,
+				     gst_param_ptr,
+				     int *);
+
+/*
+ * Every spanning tree of a hypergraph consists of a spanning tree of
+ * each of its blocks (bi-connected components).  Since blocks share
+ * no edges, and every vertex is a terminal, the optimal solutions of
+ * the blocks together make up an optimal solution of the whole.
+ *
+ * If the solver's hypergraph has two or more blocks, solve each of
+ * them separately and return TRUE.  Small blocks are solved by the
+ * backtrack search, using as many threads as the parameters allow.
+ * The remaining blocks are solved one at a time by the algorithm the
+ * user selected, since the LP solver is not reentrant.
+ *
+ * Returns FALSE if the hypergraph was not (or could not be)
+ * decomposed, in which case the caller solves it as a whole.
+ */
+
+	bool
+_gst_solve_hg_blocks (
+
+struct gst_solver *	solver		/* IN - solver to use */
+)
+{
+int			i;
+int			j;
+int			n;
+int			nblocks;
+int			ntrivial;
+int			nthreads;
+int			reason;
+int *			edges;
+int *			vmap;
+bool			complete;
+struct hgblock *	bp;
+struct gst_hypergraph *	H;
+gst_param_ptr		params;
+gst_param_ptr		bparams;
+struct bcc		bc;
+struct block_pool	pool;
+
+	if (NOT can_decompose (solver)) {
+		return (FALSE);
+	}
+
+	H	= solver -> H;
+	params	= solver -> params;
+
+	bc.H = H;
+	nblocks = find_blocks (&bc);
+	if (nblocks < 2) {
+		free ((char *) bc.blocks);
+		free ((char *) bc.bedges);
+		return (FALSE);
+	}
+
+	if (params -> solver_algorithm EQ
+	    GST_PVAL_SOLVER_ALGORITHM_BACKTRACK_SEARCH) {
+		for (i = 0; i < nblocks; i++) {
+			bp = &(bc.blocks [i]);
+			if ((bp -> nverts > BACKTRACK_MAX_SIZE) OR
+			    (bp -> nedges > BACKTRACK_MAX_SIZE)) {
+				/* Let the caller report the overflow. */
+				free ((char *) bc.blocks);
+				free ((char *) bc.bedges);
+				return (FALSE);
+			}
+		}
+	}
+
+	/* Blocks consisting of a single edge are trivial.  Gather	*/
+	/* the small blocks for the backtrack search.			*/
+	pool.jobs	= NEWA (nblocks, int);
+	pool.njobs	= 0;
+	ntrivial	= 0;
+	for (i = 0; i < nblocks; i++) {
+		bp = &(bc.blocks [i]);
+		bp -> reason	= GST_SOLVE_NORMAL;
+		bp -> nsol	= -1;
+		bp -> sol	= NULL;
+		bp -> solved	= FALSE;
+		bp -> tried	= FALSE;
+		if (bp -> nedges EQ 1) {
+			bp -> sol	= NEWA (1, int);
+			bp -> sol [0]	= bc.bedges [bp -> first];
+			bp -> nsol	= 1;
+			bp -> solved	= TRUE;
+			++ntrivial;
+		}
+		else if (is_small_block (bp, params)) {
+			pool.jobs [pool.njobs++] = i;
+		}
+	}
+
+	gst_channel_printf (params -> print_solve_trace,
+		"Decomposed hypergraph into %d blocks, %d of them trivial.\n",
+		nblocks, ntrivial);
+
+	/* Parameters for the sub-solvers.  No sub-solver may try to	*/
+	/* decompose its block again, or trace into the user's channel	*/
+	/* from several threads at once.				*/
+	bparams = gst_create_param (NULL);
+	gst_copy_param (bparams, params);
+	bparams -> solver_decomposition =
+				GST_PVAL_SOLVER_DECOMPOSITION_DISABLE;
+	bparams -> solver_algorithm =
+				GST_PVAL_SOLVER_ALGORITHM_BACKTRACK_SEARCH;
+	bparams -> num_threads		= 1;
+	bparams -> print_solve_trace	= NULL;
+
+	/* Solve the small blocks in parallel. */
+	if (pool.njobs > 0) {
+		_gst_mutex_init (&(pool.lock));
+		pool.next_job	= 0;
+		pool.blocks	= bc.blocks;
+		pool.bedges	= bc.bedges;
+		pool.H		= H;
+		pool.params	= bparams;
+
+		nthreads = _gst_effective_threads (params -> num_threads);
+		if (nthreads > pool.njobs) {
+			nthreads = pool.njobs;
+		}
+		_gst_run_workers (nthreads, block_worker, &pool);
+
+		_gst_mutex_destroy (&(pool.lock));
+	}
+
+	for (j = 0; j < pool.njobs; j++) {
+		bp = &(bc.blocks [pool.jobs [j]]);
+		if ((bp -> reason EQ GST_SOLVE_MAX_BACKTRACKS) AND
+		    (params -> solver_algorithm NE
+		     GST_PVAL_SOLVER_ALGORITHM_BACKTRACK_SEARCH)) {
+			/* Give this one to the branch-and-cut. */
+			free ((char *) (bp -> sol));
+			bp -> sol	= NULL;
+			bp -> nsol	= -1;
+			bp -> reason	= GST_SOLVE_NORMAL;
+			bp -> tried	= TRUE;
+			continue;
+		}
+		bp -> solved = TRUE;
+	}
+
+	/* Solve the remaining blocks one at a time, using the		*/
+	/* algorithm (and number of threads) chosen by the user.	*/
+	bparams -> num_threads		= params -> num_threads;
+	bparams -> print_solve_trace	= params -> print_solve_trace;
+	vmap = NEWA (H -> num_verts, int);
+	for (i = 0; i < H -> num_verts; i++) {
+		vmap [i] = -1;
+	}
+	for (i = 0; i < nblocks; i++) {
+		if (solver -> preempt NE GST_SOLVE_NORMAL) break;
+		bp = &(bc.blocks [i]);
+		if (bp -> solved) continue;
+		bparams -> solver_algorithm = params -> solver_algorithm;
+		if (bp -> tried) {
+			bparams -> solver_algorithm =
+				GST_PVAL_SOLVER_ALGORITHM_BRANCH_AND_CUT;
+		}
+		solve_block (H, bp, bc.bedges, bparams, vmap);
+		bp -> solved = TRUE;
+	}
+
+	/* Put the pieces together. */
+	n = 0;
+	complete = TRUE;
+	reason = GST_SOLVE_NORMAL;
+	for (i = 0; i < nblocks; i++) {
+		bp = &(bc.blocks [i]);
+		if ((NOT bp -> solved) OR (bp -> nsol < 0)) {
+			complete = FALSE;
+		}
+		if ((reason EQ GST_SOLVE_NORMAL) AND
+		    (bp -> reason NE GST_SOLVE_NORMAL)) {
+			reason = bp -> reason;
+		}
+	}
+
+	if (complete) {
+		edges = NEWA (H -> num_verts, int);
+		for (i = 0; i < nblocks; i++) {
+			bp = &(bc.blocks [i]);
+			for (j = 0; j < bp -> nsol; j++) {
+				edges [n++] = bp -> sol [j];
+			}
+		}
+		_gst_update_best_solution_set (solver, NULL, n, edges, NULL);
+		free ((char *) edges);
+	}
+
+	if (reason NE GST_SOLVE_NORMAL) {
+		PREEMPT_SOLVER (solver, reason);
+	}
+
+	gst_free_param (bparams);
+	free ((char *) vmap);
+	for (i = 0; i < nblocks; i++) {
+		if (bc.blocks [i].sol NE NULL) {
+			free ((char *) (bc.blocks [i].sol));
+		}
+	}
+	free ((char *) (pool.jobs));
+	free ((char *) bc.blocks);
+	free ((char *) bc.bedges);
+
+	return (TRUE);
+}
+
+/*
+ * Check whether the solver may return the combined optimal solutions
+ * of the blocks instead of doing its own search.  Anything that needs
+ * a single search over the whole hypergraph (limits, targets, multiple
+ * solutions, checkpoints, callbacks) rules this out.
+ */
+
+	static
+	bool
+can_decompose (
+
+struct gst_solver *	solver		/* IN - solver to check */
+)
+{
+int			i;
+struct gst_hypergraph *	H;
+gst_param_ptr		params;
+
+	H	= solver -> H;
+	params	= solver -> params;
+
+	if (params -> solver_decomposition NE
+	    GST_PVAL_SOLVER_DECOMPOSITION_ENABLE) {
+		return (FALSE);
+	}
+	if ((params -> num_feasible_solutions NE 1) OR
+	    (params -> max_feasible_updates NE 0)) {
+		return (FALSE);
+	}
+	if ((params -> checkpoint_filename NE NULL) OR
+	    (params -> merge_constraint_files NE NULL)) {
+		return (FALSE);
+	}
+	if ((params -> cpu_time_limit NE 0) OR
+	    (params -> bb_node_limit NE 0) OR
+	    (params -> bb_lp_limit NE 0)) {
+		return (FALSE);
+	}
+	if ((params -> gap_target NE 1) OR
+	    (params -> upper_bound_target > -DBL_MAX) OR
+	    (params -> lower_bound_target < DBL_MAX) OR
+	    (params -> initial_upper_bound < DBL_MAX)) {
+		return (FALSE);
+	}
+	if (solver -> bb_callback_func NE NULL) {
+		return (FALSE);
+	}
+	if (H -> num_verts < 3) {
+		return (FALSE);
+	}
+	for (i = 0; i < H -> num_edges; i++) {
+		if (H -> cost [i] < 0) {
+			return (FALSE);
+		}
+	}
+
+	return (TRUE);
+}
+
+/*
+ * Small blocks go to the backtrack search.  If the user explicitly
+ * asked for the backtrack search or branch-and-cut, every block uses
+ * that algorithm.
+ */
+
+	static
+	bool
+is_small_block (
+
+struct hgblock *	bp,		/* IN - block to check */
+gst_param_ptr		params		/* IN - user's parameters */
+)
+{
+	switch (params -> solver_algorithm) {
+	case GST_PVAL_SOLVER_ALGORITHM_BACKTRACK_SEARCH:
+		return (TRUE);
+
+	case GST_PVAL_SOLVER_ALGORITHM_BRANCH_AND_CUT:
+		return (FALSE);
+
+	default:
+		break;
+	}
+
+	return ((bp -> nverts <= params -> backtrack_max_verts) AND
+		(bp -> nedges <= params -> backtrack_max_edges));
+}
+
+/*
+ * Find the blocks of the hypergraph.  The caller's structure receives
+ * the list of blocks and their edges.  Returns the number of blocks,
+ * or zero if the hypergraph is not connected.
+ */
+
+	static
+	int
+find_blocks (
+
+struct bcc *		bcp		/* IN/OUT - global BCC data */
+)
+{
+int			i;
+int			root;
+int			nverts;
+int			nedges;
+int			nmasks;
+struct gst_hypergraph *	H;
+
+	H	= bcp -> H;
+	nverts	= H -> num_verts;
+	nedges	= H -> num_edges;
+	nmasks	= BMAP_ELTS (nedges);
+
+	bcp -> dfs	= NEWA (nverts, int);
+	bcp -> low	= NEWA (nverts, int);
+	bcp -> parent	= NEWA (nverts, int);
+	bcp -> vblock	= NEWA (nverts, int);
+
+	for (i = 0; i < nverts; i++) {
+		bcp -> dfs [i]		= 0;
+		bcp -> low [i]		= 0;
+		bcp -> parent [i]	= -1;
+		bcp -> vblock [i]	= -1;
+	}
+
+	bcp -> stack		= NEWA (nedges, int);
+	bcp -> sp		= bcp -> stack;
+	bcp -> counter		= 0;
+	bcp -> edges_seen	= NEWA (nmasks, bitmap_t);
+	memset (bcp -> edges_seen, 0, nmasks * sizeof (bitmap_t));
+
+	bcp -> bedges	= NEWA (nedges, int);
+	bcp -> nbedges	= 0;
+	bcp -> blocks	= NEWA (nedges, struct hgblock);
+	bcp -> nblocks	= 0;
+
+	/* The hypergraph must be connected: a single DFS from any	*/
+	/* vertex must reach all the others.				*/
+	root = -1;
+	for (i = 0; i < nverts; i++) {
+		if (NOT BITON (H -> initial_vert_mask, i)) continue;
+		if (root < 0) {
+			root = i;
+			bcc (bcp, i);
+		}
+		else if (bcp -> dfs [i] EQ 0) {
+			bcp -> nblocks = 0;
+			break;
+		}
+	}
+
+	free ((char *) (bcp -> edges_seen));
+	free ((char *) (bcp -> stack));
+	free ((char *) (bcp -> vblock));
+	free ((char *) (bcp -> parent));
+	free ((char *) (bcp -> low));
+	free ((char *) (bcp -> dfs));
+
+	return (bcp -> nblocks);
+}
+
+/*
+ * This is the recursive part of the bi-connected-components algorithm,
+ * the same as the one used for pruning FSTs.  Each bi-connected
+ * component is recorded as a block, along with its number of vertices.
+ */
+
+	static
+	void
+bcc (
+
+struct bcc *		bcp,		/* IN - global BCC data */
+int			v		/* IN - current DFS vertex */
+)
+{
+int			e;
+int			e2;
+int			w;
+int			k;
+int			b;
+int			nv;
+int *			ep1;
+int *			ep2;
+int *			vp1;
+int *			vp2;
+int *			sp;
+int *			stack;
+struct hgblock *	bp;
+struct gst_hypergraph *	H;
+
+	H = bcp -> H;
+
+	FATAL_ERROR_IF ((v < 0) OR (v >= H -> num_verts));
+
+	++(bcp -> counter);
+	bcp -> dfs [v] = bcp -> counter;
+	bcp -> low [v] = bcp -> counter;
+	ep1 = H -> term_trees [v];
+	ep2 = H -> term_trees [v + 1];
+	while (ep1 < ep2) {
+		e = *ep1++;
+		FATAL_ERROR_IF ((e < 0) OR (e >= H -> num_edges));
+		if (NOT BITON (H -> initial_edge_mask, e)) continue;
+		if (NOT BITON (bcp -> edges_seen, e)) {
+			/* We haven't seen this edge before.  Push	*/
+			/* it onto the stack...				*/
+			FATAL_ERROR_IF (bcp -> sp >=
+					&(bcp -> stack [H -> num_edges]));
+			*(bcp -> sp)++ = e;
+			SETBIT (bcp -> edges_seen, e);
+		}
+		/* Scan the vertices and process them... */
+		vp1 = H -> edge [e];
+		vp2 = H -> edge [e + 1];
+		while (vp1 < vp2) {
+			w = *vp1++;
+			FATAL_ERROR_IF ((w < 0) OR (w >= H -> num_verts));
+			if (bcp -> dfs [w] EQ 0) {
+				bcp -> parent [w] = v;
+				bcc (bcp, w);
+				if (bcp -> low [w] >= bcp -> dfs [v]) {
+					/* We have a new block! */
+					stack	= bcp -> stack;
+					sp	= bcp -> sp;
+					do {
+						FATAL_ERROR_IF (sp <= stack);
+						e2 = *--sp;
+					} while (e2 NE e);
+
+					/* Record its edges, and count	*/
+					/* its vertices.		*/
+					b = (bcp -> nblocks)++;
+					bp = &(bcp -> blocks [b]);
+					bp -> first	= bcp -> nbedges;
+					bp -> nedges	= bcp -> sp - sp;
+					nv = 0;
+					for (k = 0; k < bp -> nedges; k++) {
+						e2 = sp [k];
+						bcp -> bedges [bcp -> nbedges++] = e2;
+						vp1 = H -> edge [e2];
+						vp2 = H -> edge [e2 + 1];
+						while (vp1 < vp2) {
+							w = *vp1++;
+							if (bcp -> vblock [w] NE b) {
+								bcp -> vblock [w] = b;
+								++nv;
+							}
+						}
+					}
+					bp -> nverts = nv;
+
+					/* Pop block edges from stack */
+					bcp -> sp = sp;
+				}
+				if (bcp -> low [w] < bcp -> low [v]) {
+					bcp -> low [v] = bcp -> low [w];
+				}
+			}
+			else if ((w NE bcp -> parent [v]) AND
+				 (bcp -> dfs [w] < bcp -> low [v])) {
+				bcp -> low [v] = bcp -> dfs [w];
+			}
+		}
+	}
+}
+
+/*
+ * Worker thread for the small blocks.  Each worker repeatedly takes
+ * the next block from the pool and solves it.
+ */
+
+	static
+	void
+block_worker (
+
+int		id,		/* IN - worker number */
+void *		arg		/* IN - the block pool */
+)
+{
+int			i;
+int *			vmap;
+struct block_pool *	pp;
+
+	(void) id;
+
+	pp = (struct block_pool *) arg;
+
+	vmap = NEWA (pp -> H -> num_verts, int);
+	for (i = 0; i < pp -> H -> num_verts; i++) {
+		vmap [i] = -1;
+	}
+
+	for (;;) {
+		_gst_mutex_lock (&(pp -> lock));
+		i = pp -> next_job++;
+		_gst_mutex_unlock (&(pp -> lock));
+		if (i >= pp -> njobs) break;
+
+		solve_block (pp -> H,
+			     &(pp -> blocks [pp -> jobs [i]]),
+			     pp -> bedges,
+			     pp -> params,
+			     vmap);
+	}
+
+	free ((char *) vmap);
+}
+
+/*
+ * Solve a single block as a hypergraph instance of its own, and map
+ * its solution back to the edges of the original hypergraph.  The
+ * vertex map must be all -1 on entry, and is left that way.
+ */
+
+	static
+	void
+solve_block (
+
+struct gst_hypergraph *	H,		/* IN - original hypergraph */
+struct hgblock *	bp,		/* IN/OUT - block to solve */
+int *			bedges,		/* IN - edges of all blocks */
+gst_param_ptr		params,		/* IN - parameters to use */
+int *			vmap		/* IN/OUT - scratch vertex map */
+)
+{
+int			i;
+int			e;
+int			nv;
+int			total;
+int			res;
+int *			ep;
+int *			vp1;
+int *			vp2;
+int *			sizes;
+int *			verts;
+double *		costs;
+gst_hg_ptr		sub;
+gst_solver_ptr		bsolver;
+
+	ep = &bedges [bp -> first];
+
+	/* Number the vertices of the block. */
+	nv = 0;
+	total = 0;
+	for (i = 0; i < bp -> nedges; i++) {
+		e = ep [i];
+		vp1 = H -> edge [e];
+		vp2 = H -> edge [e + 1];
+		while (vp1 < vp2) {
+			if (vmap [*vp1] < 0) {
+				vmap [*vp1] = nv++;
+			}
+			++vp1;
+		}
+		total += H -> edge_size [e];
+	}
+	FATAL_ERROR_IF (nv NE bp -> nverts);
+
+	sizes	= NEWA (bp -> nedges, int);
+	verts	= NEWA (total, int);
+	costs	= NEWA (bp -> nedges, double);
+
+	total = 0;
+	for (i = 0; i < bp -> nedges; i++) {
+		e = ep [i];
+		sizes [i] = H -> edge_size [e];
+		costs [i] = H -> cost [e];
+		vp1 = H -> edge [e];
+		vp2 = H -> edge [e + 1];
+		while (vp1 < vp2) {
+			verts [total++] = vmap [*vp1++];
+		}
+	}
+
+	sub = gst_create_hg (NULL);
+	gst_set_hg_number_of_vertices (sub, nv);
+	gst_set_hg_edges (sub, bp -> nedges, sizes, verts, costs);
+
+	bsolver = gst_create_solver (sub, params, NULL);
+
+	res = gst_hg_solve (bsolver, &(bp -> reason));
+	FATAL_ERROR_IF (res NE 0);
+
+	bp -> sol = NEWA (bp -> nedges, int);
+	if (gst_hg_solution (bsolver, &(bp -> nsol), bp -> sol, NULL, 0)
+	    NE 0) {
+		bp -> nsol = -1;
+	}
+	for (i = 0; i < bp -> nsol; i++) {
+		bp -> sol [i] = ep [bp -> sol [i]];
+	}
+
+	gst_free_solver (bsolver);
+	gst_free_hg (sub);
+
+	/* Restore the vertex map. */
+	for (i = 0; i < bp -> nedges; i++) {
+		e = ep [i];
+		vp1 = H -> edge [e];
+		vp2 = H -> edge [e + 1];
+		while (vp1 < vp2) {
+			vmap [*vp1++] = -1;
+		}
+	}
+
+	free ((char *) costs);
+	free ((char *) verts);
+	free ((char *) sizes);
+}
@@ -0,0 +1,38 @@
+/***********************************************************************
+
+	File:	hgblocks.h
+	Rev:	e-1
+	Date:	10/19/2026
+
+	This work is licensed under a Creative Commons
+	Attribution-NonCommercial 4.0 International License.
+
+************************************************************************
+
+	Declarations for solving the blocks of a hypergraph separately.
+
+************************************************************************/
+
+#ifndef	HGBLOCKS_H
+#define	HGBLOCKS_H
+
+#include "gsttypes.h"
+
+struct gst_solver;
+
+
+/*
+ * If the hypergraph has articulation vertices, every spanning tree
+ * consists of a spanning tree of each of its blocks (bi-connected
+ * components), and the blocks can be solved independently of each
+ * other.
+ */
+
+
+/*
+ * Global Routines
+ */
+
+extern bool		_gst_solve_hg_blocks (struct gst_solver * solver);
+
+#endif
@@ -53,6 +53,7 @@
 #include "prepostlude.h"
 #include "steiner.h"
 #include <string.h>
+#include "threads.h"
 
 /*
  * Global functions
@@ -60,7 +61,10 @@
 
 gst_proplist_ptr	gst_get_hg_properties (gst_hg_ptr);
 
+struct full_set *	_gst_copy_full_set (struct full_set *);
+void			_gst_free_full_set (struct full_set *);
 struct full_set *	_gst_remove_degree_two_steiner_points (struct full_set *);
+struct full_set *	_gst_unshare_full_set (struct full_set *);
 
 /*
  * Local functions
@@ -68,6 +72,7 @@ struct full_set *	_gst_remove_degree_two_steiner_points (struct full_set *);
 
 static void		free_edges (gst_hg_ptr);
 static void		free_vertices (gst_hg_ptr);
+static struct full_set *	share_full_set (struct full_set *);
 
 /* Only bump the version number if it is really necessary */
 #define bump_version(hg) \
@@ -143,7 +148,8 @@ gst_hg_ptr		H
 }
 
 /*
- * Free a single FST.
+ * Free a single FST.  If other hypergraphs still share it, we just
+ * drop our reference.
  */
 
 	void
@@ -152,6 +158,11 @@ _gst_free_full_set (
 struct full_set *	fsp	/* IN - full tree to be freed */
 )
 {
+	if ((LOAD_ACQUIRE (&(fsp -> refcount)) > 1) AND
+	    (ATOMIC_ADD (&(fsp -> refcount), -1) > 0)) {
+		/* Somebody else still holds a reference. */
+		return;
+	}
 	if (fsp -> tlist NE NULL) {
 		free ((char *) (fsp -> tlist));
 		fsp -> tlist = NULL;
@@ -298,8 +309,6 @@ int			nedges;
 int			kmasks;
 int			nmasks;
 int			status;
-struct full_set *	fst;
-struct full_set *	dstfst;
 
 	GST_PRELUDE
 
@@ -383,38 +392,14 @@ struct full_set *	dstfst;
 		}
 
 		if (H -> full_trees NE NULL) {
+			/* The FSTs are shared, not copied.  They are	*/
+			/* only copied when one of the hypergraphs	*/
+			/* modifies them.				*/
 			dst -> full_trees = NEWA (nedges, struct full_set *);
 
 			for (i = 0; i < nedges; i++) {
-				/* Copy structure */
-				fst	= H -> full_trees[i];
-
-				dstfst	= NEW (struct full_set);
-
-				dstfst -> next = NULL;
-				dstfst -> tree_num = fst -> tree_num;
-				dstfst -> tree_len = fst -> tree_len;
-				dstfst -> tlist = NEWA (fst -> terminals -> n,
-							int);
-				memcpy (dstfst -> tlist,
-					fst -> tlist,
-					fst -> terminals -> n * sizeof (int));
-				dstfst -> terminals = NEW_PSET (fst -> terminals -> n);
-				COPY_PSET(dstfst -> terminals,
-					  fst -> terminals);
-				if (fst -> steiners NE NULL) {
-					dstfst -> steiners = NEW_PSET (fst -> steiners -> n);
-					COPY_PSET (dstfst -> steiners,
-						   fst -> steiners);
-				}
-				dstfst -> nedges = fst -> nedges;
-				dstfst -> edges = NEWA (fst -> nedges,
-							struct edge);
-				memcpy (dstfst -> edges,
-					fst -> edges,
-					fst -> nedges * sizeof(struct edge));
-
-				dst -> full_trees[i] = dstfst;
+				dst -> full_trees [i] =
+					share_full_set (H -> full_trees [i]);
 			}
 		}
 	} while (FALSE);
@@ -540,35 +525,15 @@ struct full_set *	dstfst;
 							struct full_set *);
 
 			for (i = 0; i < nedges; i++) {
-				/* Copy structure */
 				j = edges [i];
-				fst	= H -> full_trees [j];
-				dstfst	= NEW (struct full_set);
-
-				dstfst -> next = NULL;
-				dstfst -> tree_num = i;
-				dstfst -> tree_len = fst -> tree_len;
-				dstfst -> tlist = NEWA (fst -> terminals -> n,
-							int);
-				memcpy (dstfst -> tlist,
-					fst -> tlist,
-					fst -> terminals -> n * sizeof (int));
-				dstfst -> terminals = NEW_PSET (fst -> terminals -> n);
-				COPY_PSET (dstfst -> terminals,
-					   fst -> terminals);
-				dstfst -> steiners = NULL;
-				if (fst -> steiners NE NULL) {
-					dstfst -> steiners = NEW_PSET (fst -> steiners -> n);
-					COPY_PSET (dstfst -> steiners,
-						   fst -> steiners);
+				fst = H -> full_trees [j];
+				if (fst -> tree_num EQ i) {
+					/* Same FST number -- share it. */
+					dst -> full_trees [i] = share_full_set (fst);
+					continue;
 				}
-				dstfst -> nedges = fst -> nedges;
-				dstfst -> edges	 = NEWA (fst -> nedges,
-							 struct edge);
-				memcpy (dstfst -> edges,
-					fst -> edges,
-					fst -> nedges * sizeof (struct edge));
-
+				dstfst = _gst_copy_full_set (fst);
+				dstfst -> tree_num = i;
 				dst -> full_trees [i] = dstfst;
 			}
 		}
@@ -588,6 +553,95 @@ struct full_set *	dstfst;
 	return (status);
 }
 
+/*
+ * Make a private copy of a single FST.
+ */
+
+	struct full_set *
+_gst_copy_full_set (
+
+struct full_set *	fst	/* IN - full set to copy */
+)
+{
+struct full_set *	dstfst;
+
+	dstfst	= NEW (struct full_set);
+
+	dstfst -> next = NULL;
+	dstfst -> tree_num = fst -> tree_num;
+	dstfst -> tree_len = fst -> tree_len;
+	dstfst -> tlist = NEWA (fst -> terminals -> n, int);
+	memcpy (dstfst -> tlist,
+		fst -> tlist,
+		fst -> terminals -> n * sizeof (int));
+	dstfst -> terminals = NEW_PSET (fst -> terminals -> n);
+	COPY_PSET (dstfst -> terminals, fst -> terminals);
+	dstfst -> steiners = NULL;
+	if (fst -> steiners NE NULL) {
+		dstfst -> steiners = NEW_PSET (fst -> steiners -> n);
+		COPY_PSET (dstfst -> steiners, fst -> steiners);
+	}
+	dstfst -> nedges = fst -> nedges;
+	dstfst -> edges	 = NEWA (fst -> nedges, struct edge);
+	memcpy (dstfst -> edges,
+		fst -> edges,
+		fst -> nedges * sizeof (struct edge));
+	dstfst -> refcount = 1;
+
+	return (dstfst);
+}
+
+/*
+ * Add a reference to the given FST, for sharing it with another
+ * hypergraph.
+ */
+
+	static
+	struct full_set *
+share_full_set (
+
+struct full_set *	fsp	/* IN - full set to be shared */
+)
+{
+int		uncounted;
+
+	/* If not counted yet, we are the only user. */
+	uncounted = 0;
+	(void) ATOMIC_CAS (&(fsp -> refcount), &uncounted, 1);
+	(void) ATOMIC_ADD (&(fsp -> refcount), 1);
+
+	return (fsp);
+}
+
+/*
+ * Get an FST that the caller is free to modify in place.  If the
+ * given FST is shared with other hypergraphs, the caller's reference
+ * is replaced by a reference to a private copy.
+ */
+
+	struct full_set *
+_gst_unshare_full_set (
+
+struct full_set *	fsp	/* IN - full set to be modified */
+)
+{
+struct full_set *	copy;
+
+	if (LOAD_ACQUIRE (&(fsp -> refcount)) <= 1) {
+		return (fsp);
+	}
+
+	/* Copy before dropping our reference, since the other users	*/
+	/* (possibly on other threads) may free it as soon as we do.	*/
+	copy = _gst_copy_full_set (fsp);
+	if (ATOMIC_ADD (&(fsp -> refcount), -1) <= 0) {
+		/* The others let go in the meantime. */
+		_gst_free_full_set (fsp);
+	}
+
+	return (copy);
+}
+
 /*
  * Copy a full set while removing any degree 2 Steiner points
  * (corner points..).
@@ -634,6 +688,7 @@ struct full_set *	nfsp;
 	nfsp -> next = NULL; /* !!!!!!!! */
 	nfsp -> tree_num = ofsp -> tree_num;
 	nfsp -> tree_len = ofsp -> tree_len;
+	nfsp -> refcount = 1;
 
 	nfsp -> tlist = NEWA (ofsp -> terminals -> n, int);
 	memcpy (nfsp -> tlist,
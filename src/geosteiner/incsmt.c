@@ -0,0 +1,1260 @@
+/***********************************************************************
+
+	File:	incsmt.c
+	Rev:	e-1
+	Date:	10/19/2026
+
+	This work is licensed under a Creative Commons
+	Attribution-NonCommercial 4.0 International License.
+
+************************************************************************
+
+	Incremental SMT object: solve an SMT problem repeatedly while
+	the caller adds, moves and removes a few terminals at a time.
+
+************************************************************************/
+
+#include "incsmt.h"
+
+#include "cutrepo.h"
+#include "dsuf.h"
+#include "emst.h"
+#include "fatal.h"
+#include <float.h>
+#include "fstfuncs.h"
+#include "geosteiner.h"
+#include "logic.h"
+#include "memory.h"
+#include "metric.h"
+#include "p1read.h"
+#include "point.h"
+#include "prepostlude.h"
+#include "rmst.h"
+#include "sortfuncs.h"
+#include "steiner.h"
+#include <string.h>
+
+
+/*
+ * Global Routines
+ */
+
+gst_incsmt_ptr	gst_create_incsmt (gst_metric_ptr	metric,
+				   gst_param_ptr	params,
+				   int *		status);
+int		gst_free_incsmt (gst_incsmt_ptr ism);
+int		gst_incsmt_add_terminals (gst_incsmt_ptr	ism,
+					  int			nterms,
+					  double *		terms);
+int		gst_incsmt_move_terminal (gst_incsmt_ptr	ism,
+					  int			term,
+					  double		x,
+					  double		y);
+int		gst_incsmt_remove_terminal (gst_incsmt_ptr	ism,
+					    int			term);
+int		gst_incsmt_solve (gst_incsmt_ptr	ism,
+				  double *		length,
+				  int *			nsps,
+				  double *		sps,
+				  int *			nedges,
+				  int *			edges,
+				  int *			soln_status);
+
+
+/*
+ * Local Equates
+ */
+
+/*
+ * The FSTs are generated anew from scratch, rather than just near the
+ * edited terminals, when more than this fraction of the terminals is
+ * near an edit.
+ */
+
+#define	MAX_NEAR_FRACTION	0.25
+
+
+/*
+ * Local Routines
+ */
+
+static void		discard_solution (gst_incsmt_ptr);
+static double		edit_distance (struct point *,
+				       int,
+				       struct point *,
+				       double *);
+static int		find_fst (gst_hg_ptr, int, int *);
+static double		fst_span (gst_hg_ptr, int);
+static gst_hg_ptr	local_fsts (gst_incsmt_ptr);
+static void		map_edges (gst_incsmt_ptr, gst_hg_ptr, int *);
+static int		mst_edges (gst_hg_ptr, struct pset *, struct edge *);
+static int *		stable_positions (gst_incsmt_ptr);
+static int		warm_start (gst_incsmt_ptr, gst_hg_ptr, int *, double *);
+
+/*
+ * Create an incremental SMT object having no terminals.  The metric
+ * and parameters are copied, so the caller may free them afterwards.
+ */
+
+	gst_incsmt_ptr
+gst_create_incsmt (
+
+gst_metric_ptr		metric,		/* IN - metric to use */
+gst_param_ptr		params,		/* IN - parameters (NULL=default) */
+int *			status		/* OUT - status */
+)
+{
+int			code;
+gst_incsmt_ptr		ism;
+
+	GST_PRELUDE
+
+	ism = NULL;
+	code = 0;
+
+	do {	/* Used only for "break". */
+		if (metric EQ NULL) {
+			code = GST_ERR_INVALID_METRIC;
+			break;
+		}
+
+		ism = NEW (struct gst_incsmt);
+		memset (ism, 0, sizeof (*ism));
+
+		ism -> metric = gst_create_metric (metric -> type,
+						   metric -> parameter,
+						   NULL);
+		ism -> params = NULL;
+		if (params NE NULL) {
+			ism -> params = gst_create_param (NULL);
+			gst_copy_param (ism -> params, params);
+		}
+
+		ism -> maxterms	= 16;
+		ism -> terms	= NEWA (2 * ism -> maxterms, double);
+		ism -> ids	= NEWA (ism -> maxterms, int);
+		ism -> changed	= NEWA (ism -> maxterms, bool);
+		ism -> nterms	= 0;
+		ism -> next_id	= 0;
+		ism -> modified	= TRUE;
+
+		ism -> repo	= gst_create_cut_repository (NULL);
+
+		ism -> H	= NULL;
+		ism -> hg_ids	= NULL;
+		ism -> nsol	= -1;
+		ism -> sol	= NULL;
+		ism -> length	= 0.0;
+		ism -> status	= GST_STATUS_NO_SOLUTION;
+	} while (FALSE);
+
+	if (status NE NULL) {
+		*status = code;
+	}
+
+	GST_POSTLUDE
+	return (ism);
+}
+
+/*
+ * Free an incremental SMT object.
+ */
+
+	int
+gst_free_incsmt (
+
+gst_incsmt_ptr		ism		/* IN - object to free */
+)
+{
+	GST_PRELUDE
+
+	if (ism NE NULL) {
+		discard_solution (ism);
+		gst_free_cut_repository (ism -> repo);
+		if (ism -> params NE NULL) {
+			gst_free_param (ism -> params);
+		}
+		gst_free_metric (ism -> metric);
+		free ((char *) (ism -> changed));
+		free ((char *) (ism -> ids));
+		free ((char *) (ism -> terms));
+		free ((char *) ism);
+	}
+
+	GST_POSTLUDE
+	return (0);
+}
+
+/*
+ * Append terminals.  They are numbered after the existing ones.
+ */
+
+	int
+gst_incsmt_add_terminals (
+
+gst_incsmt_ptr		ism,		/* IN/OUT - incremental SMT object */
+int			nterms,		/* IN - number of terminals to add */
+double *		terms		/* IN - their coordinates */
+)
+{
+int			i;
+int			j;
+int			res;
+int			n;
+double *		newterms;
+int *			newids;
+bool *			newchanged;
+
+	GST_PRELUDE
+
+	res = 0;
+
+	if (nterms < 0) {
+		res = GST_ERR_INVALID_NUMBER_OF_TERMINALS;
+		goto end;
+	}
+
+	n = ism -> nterms + nterms;
+	if (n > ism -> maxterms) {
+		while (ism -> maxterms < n) {
+			ism -> maxterms *= 2;
+		}
+		newterms	= NEWA (2 * ism -> maxterms, double);
+		newids		= NEWA (ism -> maxterms, int);
+		newchanged	= NEWA (ism -> maxterms, bool);
+		for (i = 0; i < ism -> nterms; i++) {
+			newterms [2*i]		= ism -> terms [2*i];
+			newterms [2*i + 1]	= ism -> terms [2*i + 1];
+			newids [i]		= ism -> ids [i];
+			newchanged [i]		= ism -> changed [i];
+		}
+		free ((char *) (ism -> changed));
+		free ((char *) (ism -> ids));
+		free ((char *) (ism -> terms));
+		ism -> terms	= newterms;
+		ism -> ids	= newids;
+		ism -> changed	= newchanged;
+	}
+
+	for (j = 0; j < nterms; j++) {
+		i = ism -> nterms++;
+		ism -> terms [2*i]	= terms [2*j];
+		ism -> terms [2*i + 1]	= terms [2*j + 1];
+		ism -> ids [i]		= (ism -> next_id)++;
+		ism -> changed [i]	= TRUE;
+	}
+	if (nterms > 0) {
+		ism -> modified = TRUE;
+	}
+
+end:
+	GST_POSTLUDE
+	return (res);
+}
+
+/*
+ * Move the given terminal to a new location.
+ */
+
+	int
+gst_incsmt_move_terminal (
+
+gst_incsmt_ptr		ism,		/* IN/OUT - incremental SMT object */
+int			term,		/* IN - terminal to move */
+double			x,		/* IN - new X coordinate */
+double			y		/* IN - new Y coordinate */
+)
+{
+int			res;
+
+	GST_PRELUDE
+
+	res = 0;
+
+	if ((term < 0) OR (term >= ism -> nterms)) {
+		res = GST_ERR_INVALID_VERTEX;
+	}
+	else if ((ism -> terms [2*term] NE x) OR
+		 (ism -> terms [2*term + 1] NE y)) {
+		ism -> terms [2*term]		= x;
+		ism -> terms [2*term + 1]	= y;
+		ism -> changed [term]		= TRUE;
+		ism -> modified			= TRUE;
+	}
+
+	GST_POSTLUDE
+	return (res);
+}
+
+/*
+ * Remove the given terminal.  The terminals after it move down by one.
+ */
+
+	int
+gst_incsmt_remove_terminal (
+
+gst_incsmt_ptr		ism,		/* IN/OUT - incremental SMT object */
+int			term		/* IN - terminal to remove */
+)
+{
+int			i;
+int			res;
+
+	GST_PRELUDE
+
+	res = 0;
+
+	if ((term < 0) OR (term >= ism -> nterms)) {
+		res = GST_ERR_INVALID_VERTEX;
+		goto end;
+	}
+
+	for (i = term + 1; i < ism -> nterms; i++) {
+		ism -> terms [2*i - 2]	= ism -> terms [2*i];
+		ism -> terms [2*i - 1]	= ism -> terms [2*i + 1];
+		ism -> ids [i - 1]	= ism -> ids [i];
+		ism -> changed [i - 1]	= ism -> changed [i];
+	}
+	--(ism -> nterms);
+	ism -> modified = TRUE;
+
+end:
+	GST_POSTLUDE
+	return (res);
+}
+
+/*
+ * Compute an SMT for the current terminals, with the same outputs as
+ * gst_smt().  If nothing was edited since the last call, the previous
+ * result is returned right away.  Otherwise the previous FSTs are
+ * kept, except near the edited terminals, where they are generated
+ * anew.  The previous solution is used to warm-start the solver:
+ * those of its FSTs that involve no edited terminal are looked up
+ * among the new FSTs, and greedily completed into a spanning tree
+ * whose length is given to the solver as its initial upper bound.
+ * The cuts of the previous solve that are still valid are handed to
+ * the solver as well.
+ */
+
+	int
+gst_incsmt_solve (
+
+gst_incsmt_ptr		ism,		/* IN/OUT - incremental SMT object */
+double *		length,		/* OUT - length of SMT */
+int *			nsps,		/* OUT - number of Steiner points */
+double *		sps,		/* OUT - Steiner point coordinates */
+int *			nedges,		/* OUT - number of SMT edges */
+int *			edges,		/* OUT - SMT edges */
+int *			soln_status	/* OUT - solution status */
+)
+{
+int			i;
+int			n;
+int			res;
+int			status;
+int			nwarm;
+int *			warm;
+int *			emap;
+double			ub;
+double			warm_len;
+gst_hg_ptr		H;
+gst_hg_ptr		H2;
+gst_param_ptr		params;
+gst_solver_ptr		solver;
+
+	GST_PRELUDE
+
+	res = 0;
+
+	if (length NE NULL)	 *length	= 0.0;
+	if (nsps NE NULL)	 *nsps		= 0;
+	if (nedges NE NULL)	 *nedges	= 0;
+	if (soln_status NE NULL) *soln_status	= GST_STATUS_NO_SOLUTION;
+
+	if (ism -> nterms <= 1) {
+		/* Trivially optimal, and nothing to remember. */
+		discard_solution (ism);
+		ism -> modified = FALSE;
+		if (soln_status NE NULL) {
+			*soln_status = GST_STATUS_OPTIMAL;
+		}
+		goto end;
+	}
+
+	if (ism -> modified OR (ism -> nsol < 0)) {
+		H = NULL;
+		if (ism -> H NE NULL) {
+			H = local_fsts (ism);
+		}
+		if (H EQ NULL) {
+			H = gst_generate_fsts (ism -> nterms,
+					       ism -> terms,
+					       ism -> metric,
+					       ism -> params,
+					       &status);
+		}
+		if (H EQ NULL) {
+			res = status;
+			goto end;
+		}
+
+		/* Prune FSTs when instance is large, as gst_smt() does. */
+		if (ism -> nterms >= 2000) {
+			H2 = gst_hg_prune_edges (H, ism -> params, &status);
+			if (H2 NE NULL) {
+				gst_free_hg (H);
+				H = H2;
+			}
+		}
+		if (H -> term_trees EQ NULL) {
+			_gst_init_term_trees (H);
+		}
+
+		/* Carry the cuts that are still valid over to H. */
+		if (ism -> H NE NULL) {
+			emap = NEWA (ism -> H -> num_edges, int);
+			map_edges (ism, H, emap);
+			_gst_move_cuts (ism -> repo, ism -> H, H, emap);
+			free ((char *) emap);
+		}
+
+		warm = NEWA (ism -> nterms, int);
+		nwarm = warm_start (ism, H, warm, &warm_len);
+
+		params = gst_create_param (NULL);
+		if (ism -> params NE NULL) {
+			gst_copy_param (params, ism -> params);
+		}
+		gst_get_dbl_param (params, GST_PARAM_INITIAL_UPPER_BOUND, &ub);
+		if ((nwarm > 0) AND (warm_len < ub)) {
+			/* The solver need only look for something	*/
+			/* better than the warm-start tree.		*/
+			gst_set_dbl_param (params,
+					   GST_PARAM_INITIAL_UPPER_BOUND,
+					   warm_len);
+		}
+		else {
+			nwarm = 0;
+		}
+
+		solver = gst_create_solver (H, params, NULL);
+		gst_set_solver_cut_repository (solver, ism -> repo);
+		res = gst_hg_solve (solver, NULL);
+
+		discard_solution (ism);
+
+		if (res EQ 0) {
+			gst_get_solver_status (solver, &(ism -> status));
+			ism -> sol = NEWA (ism -> nterms, int);
+			if (gst_hg_solution (solver,
+					     &n,
+					     ism -> sol,
+					     &(ism -> length),
+					     0) EQ 0) {
+				ism -> nsol = n;
+			}
+			if ((nwarm > 0) AND
+			    ((ism -> nsol < 0) OR (ism -> length > warm_len))) {
+				/* Nothing better than the warm-start	*/
+				/* tree exists (or was found).		*/
+				for (i = 0; i < nwarm; i++) {
+					ism -> sol [i] = warm [i];
+				}
+				ism -> nsol	= nwarm;
+				ism -> length	= warm_len;
+				if (ism -> status EQ GST_STATUS_INFEASIBLE) {
+					ism -> status = GST_STATUS_OPTIMAL;
+				}
+				else if (ism -> status EQ
+					 GST_STATUS_NO_FEASIBLE) {
+					ism -> status = GST_STATUS_FEASIBLE;
+				}
+			}
+		}
+
+		gst_free_solver (solver);
+		gst_free_param (params);
+		free ((char *) warm);
+
+		if (res NE 0) {
+			gst_free_hg (H);
+			goto end;
+		}
+
+		/* Remember the FSTs, and who their terminals are. */
+		ism -> H = H;
+		ism -> hg_ids = NEWA (ism -> nterms, int);
+		for (i = 0; i < ism -> nterms; i++) {
+			ism -> hg_ids [i]	= ism -> ids [i];
+			ism -> changed [i]	= FALSE;
+		}
+		ism -> modified = FALSE;
+	}
+
+	if (soln_status NE NULL) {
+		*soln_status = ism -> status;
+	}
+	if (ism -> nsol >= 0) {
+		if (length NE NULL) {
+			*length = ism -> length;
+		}
+		if ((nsps NE NULL) OR (sps NE NULL) OR
+		    (nedges NE NULL) OR (edges NE NULL)) {
+			gst_get_hg_edge_embedding (ism -> H,
+						   ism -> nsol,
+						   ism -> sol,
+						   nsps,
+						   sps,
+						   nedges,
+						   edges);
+		}
+	}
+
+end:
+	GST_POSTLUDE
+	return (res);
+}
+
+/*
+ * Build the warm-start tree for the new FST hypergraph H.  The FSTs of
+ * the previous solution whose terminals are all still present and
+ * unmoved are looked up in H.  They are completed into a spanning tree
+ * by greedily adding the FSTs of H having the smallest length per
+ * terminal connected.  Returns the number of FSTs in the tree (zero if
+ * there is no previous solution or no spanning tree results), and the
+ * tree's length.
+ */
+
+	static
+	int
+warm_start (
+
+gst_incsmt_ptr		ism,		/* IN - incremental SMT object */
+gst_hg_ptr		H,		/* IN - new FST hypergraph */
+int *			tree,		/* OUT - FSTs of the tree */
+double *		tree_len	/* OUT - length of the tree */
+)
+{
+int			i;
+int			j;
+int			k;
+int			e;
+int			n;
+int			t;
+int			nverts;
+int			ncomps;
+int *			pos;
+int *			vlist;
+int *			vp1;
+int *			vp2;
+int *			order;
+double *		keys;
+bool			ok;
+struct dsuf		sets;
+gst_hg_ptr		H0;
+
+	*tree_len = 0.0;
+
+	H0 = ism -> H;
+	if ((H0 EQ NULL) OR (ism -> nsol <= 0)) {
+		return (0);
+	}
+
+	nverts = H -> num_verts;
+
+	pos = stable_positions (ism);
+
+	_gst_dsuf_create (&sets, nverts);
+	for (i = 0; i < nverts; i++) {
+		_gst_dsuf_makeset (&sets, i);
+	}
+	ncomps = nverts;
+	*tree_len = 0.0;
+	n = 0;
+
+	/* Keep the old FSTs that are still there. */
+	vlist = NEWA (nverts, int);
+	for (j = 0; j < ism -> nsol; j++) {
+		e = ism -> sol [j];
+		vp1 = H0 -> edge [e];
+		vp2 = H0 -> edge [e + 1];
+		k = 0;
+		ok = TRUE;
+		while (vp1 < vp2) {
+			t = pos [ism -> hg_ids [*vp1++]];
+			if (t < 0) {
+				ok = FALSE;
+				break;
+			}
+			vlist [k++] = t;
+		}
+		if (NOT ok) continue;
+
+		e = find_fst (H, k, vlist);
+		if (e < 0) continue;
+
+		/* The old FSTs form a forest, so this never	*/
+		/* closes a cycle.				*/
+		for (i = 1; i < k; i++) {
+			_gst_dsuf_unite (&sets,
+					 _gst_dsuf_find (&sets, vlist [0]),
+					 _gst_dsuf_find (&sets, vlist [i]));
+		}
+		ncomps -= (k - 1);
+		tree [n++] = e;
+		*tree_len += H -> cost [e];
+	}
+	free ((char *) pos);
+
+	/* Complete the tree greedily. */
+	keys = NEWA (H -> num_edges, double);
+	for (e = 0; e < H -> num_edges; e++) {
+		keys [e] = H -> cost [e] / (H -> edge_size [e] - 1);
+	}
+	order = _gst_sort_keys (H -> num_edges, keys, 1);
+
+	for (j = 0; (j < H -> num_edges) AND (ncomps > 1); j++) {
+		e = order [j];
+		if (NOT BITON (H -> initial_edge_mask, e)) continue;
+		vp1 = H -> edge [e];
+		vp2 = H -> edge [e + 1];
+
+		/* All vertices must be in different components. */
+		k = 0;
+		ok = TRUE;
+		while (vp1 < vp2) {
+			t = _gst_dsuf_find (&sets, *vp1++);
+			for (i = 0; i < k; i++) {
+				if (vlist [i] EQ t) break;
+			}
+			if (i < k) {
+				ok = FALSE;
+				break;
+			}
+			vlist [k++] = t;
+		}
+		if (NOT ok) continue;
+
+		for (i = 1; i < k; i++) {
+			_gst_dsuf_unite (&sets,
+					 _gst_dsuf_find (&sets, vlist [0]),
+					 _gst_dsuf_find (&sets, vlist [i]));
+		}
+		ncomps -= (H -> edge_size [e] - 1);
+		tree [n++] = e;
+		*tree_len += H -> cost [e];
+	}
+
+	free ((char *) order);
+	free ((char *) keys);
+	free ((char *) vlist);
+	_gst_dsuf_destroy (&sets);
+
+	if (ncomps > 1) {
+		return (0);
+	}
+
+	return (n);
+}
+
+/*
+ * Map stable ids to current terminal numbers, counting edited
+ * terminals as gone (-1).
+ */
+
+	static
+	int *
+stable_positions (
+
+gst_incsmt_ptr		ism		/* IN - incremental SMT object */
+)
+{
+int			i;
+int *			pos;
+
+	pos = NEWA (ism -> next_id, int);
+	for (i = 0; i < ism -> next_id; i++) {
+		pos [i] = -1;
+	}
+	for (i = 0; i < ism -> nterms; i++) {
+		if (NOT ism -> changed [i]) {
+			pos [ism -> ids [i]] = i;
+		}
+	}
+
+	return (pos);
+}
+
+/*
+ * Build the FST hypergraph of the current terminals from that of the
+ * previous solve, by regenerating only the FSTs near the edits.  The
+ * edits are the old and new locations of the edited terminals, and
+ * the ends of the edges the MST gained.  Each gets a radius R: the
+ * span of the widest previous FST through the nearest previous
+ * terminal, or the distance to that terminal (or the length of the
+ * MST edge) if larger.  The previous FSTs having no edited terminal
+ * are kept.  The FSTs of the terminals within 2R of an edit are
+ * generated, and added unless already kept.  (Those of them that the
+ * remaining terminals would rule out are still valid trees, so at
+ * worst they make the solver's work larger.)  This assumes that the
+ * FSTs through an edited terminal span no more than R: when one of
+ * the generated ones does, or too many terminals are near an edit,
+ * NULL is returned, and the caller generates all FSTs anew.
+ */
+
+	static
+	gst_hg_ptr
+local_fsts (
+
+gst_incsmt_ptr		ism		/* IN - incremental SMT object */
+)
+{
+int			i;
+int			j;
+int			k;
+int			e;
+int			m;
+int			n;
+int			ns;
+int			nedits;
+int			nedges;
+int			count;
+int *			adj;
+int *			first;
+int *			pos;
+int *			inv;
+int *			smap;
+int *			tedit;
+int *			vlist;
+int *			ip1;
+int *			vp1;
+bool			edited;
+bool			ok;
+bitmap_t *		take;
+double			d;
+double			span;
+double			delta;
+double			sdelta;
+double *		radius;
+double *		vspan;
+double *		sterms;
+struct point *		q;
+struct point *		edits;
+struct pset *		pts;
+struct edge *		mst;
+struct full_set *	fsp;
+struct full_set **	trees;
+gst_hg_ptr		H;
+gst_hg_ptr		H0;
+gst_hg_ptr		Hs;
+
+	H0 = ism -> H;
+	if ((H0 -> full_trees EQ NULL) OR (H0 -> pts EQ NULL)) {
+		return (NULL);
+	}
+
+	n = ism -> nterms;
+
+	/* Current number of each previous vertex, if not edited. */
+	pos = stable_positions (ism);
+	vlist = NEWA (H0 -> num_verts + n, int);
+	for (i = 0; i < H0 -> num_verts; i++) {
+		vlist [i] = pos [ism -> hg_ids [i]];
+	}
+	free ((char *) pos);
+	pos = vlist;
+
+	/* Previous vertex of each current terminal, if not edited. */
+	inv = NEWA (n, int);
+	for (i = 0; i < n; i++) {
+		inv [i] = -1;
+	}
+	for (i = 0; i < H0 -> num_verts; i++) {
+		if (pos [i] >= 0) {
+			inv [pos [i]] = i;
+		}
+	}
+	vlist = NEWA (n, int);
+
+	/* The span of the widest previous FST through each vertex. */
+	vspan = NEWA (H0 -> num_verts, double);
+	for (i = 0; i < H0 -> num_verts; i++) {
+		vspan [i] = 0.0;
+	}
+	for (e = 0; e < H0 -> num_edges; e++) {
+		span = fst_span (H0, e);
+		for (vp1 = H0 -> edge [e]; vp1 < H0 -> edge [e + 1]; vp1++) {
+			if (span > vspan [*vp1]) {
+				vspan [*vp1] = span;
+			}
+		}
+	}
+
+	/* Where the edits are: old locations of edited vertices, and	*/
+	/* new ones of edited terminals.  Each gets the radius of the	*/
+	/* nearest previous vertex.					*/
+	edits = NEWA (H0 -> num_verts + 3 * n, struct point);
+	radius = NEWA (H0 -> num_verts + 3 * n, double);
+	tedit = NEWA (n, int);
+	nedits = 0;
+	for (i = 0; i < H0 -> num_verts; i++) {
+		if (pos [i] < 0) {
+			edits [nedits++] = H0 -> pts -> a [i];
+		}
+	}
+	for (i = 0; i < n; i++) {
+		tedit [i] = -1;
+		if (ism -> changed [i]) {
+			edits [nedits].x = ism -> terms [2*i];
+			edits [nedits].y = ism -> terms [2*i + 1];
+			tedit [i] = nedits++;
+		}
+	}
+	ok = TRUE;
+	for (k = 0; k < nedits; k++) {
+		j = -1;
+		d = DBL_MAX;
+		for (i = 0; i < H0 -> num_verts; i++) {
+			if (EDIST (&(edits [k]), &(H0 -> pts -> a [i])) < d) {
+				d = EDIST (&(edits [k]), &(H0 -> pts -> a [i]));
+				j = i;
+			}
+		}
+		radius [k] = (vspan [j] > d) ? vspan [j] : d;
+		if (radius [k] <= 0.0) {
+			ok = FALSE;
+		}
+	}
+
+	/* Where the MST gained an edge between unedited terminals,	*/
+	/* bottleneck Steiner distances grew, so FSTs ruled out before	*/
+	/* may be needed now, even far from the edits.  Count both	*/
+	/* ends of each such edge as edits as well.			*/
+	pts = _gst_create_pset (n, ism -> terms);
+	nedges = (H0 -> num_verts > n) ? H0 -> num_verts : n;
+	mst = NEWA (nedges, struct edge);
+	first = NEWA (H0 -> num_verts + 1, int);
+	adj = NEWA (2 * nedges, int);
+	nedges = mst_edges (H0, H0 -> pts, mst);
+	for (i = 0; i <= H0 -> num_verts; i++) {
+		first [i] = 0;
+	}
+	for (i = 0; i < nedges; i++) {
+		++(first [mst [i].p1 + 1]);
+		++(first [mst [i].p2 + 1]);
+	}
+	for (i = 0; i < H0 -> num_verts; i++) {
+		first [i + 1] += first [i];
+	}
+	for (i = 0; i < nedges; i++) {
+		adj [first [mst [i].p1]++] = mst [i].p2;
+		adj [first [mst [i].p2]++] = mst [i].p1;
+	}
+	for (i = H0 -> num_verts; i > 0; i--) {
+		first [i] = first [i - 1];
+	}
+	first [0] = 0;
+	nedges = mst_edges (H0, pts, mst);
+	for (i = 0; i < nedges; i++) {
+		j = inv [mst [i].p1];
+		k = inv [mst [i].p2];
+		if ((j < 0) OR (k < 0)) continue;
+		for (e = first [j]; e < first [j + 1]; e++) {
+			if (adj [e] EQ k) break;
+		}
+		if (e < first [j + 1]) continue;
+		edits [nedits]	= H0 -> pts -> a [j];
+		radius [nedits]	= (vspan [j] > mst [i].len) ? vspan [j]
+							    : mst [i].len;
+		++nedits;
+		edits [nedits]	= H0 -> pts -> a [k];
+		radius [nedits]	= (vspan [k] > mst [i].len) ? vspan [k]
+							    : mst [i].len;
+		++nedits;
+	}
+	free ((char *) adj);
+	free ((char *) first);
+	free ((char *) mst);
+
+	/* The terminals within 2R of an edit. */
+	smap	= NEWA (n, int);
+	sterms	= NEWA (2 * n, double);
+	ns = 0;
+	q = NEW (struct point);
+	for (i = 0; i < n; i++) {
+		q -> x = ism -> terms [2*i];
+		q -> y = ism -> terms [2*i + 1];
+		if (edit_distance (q, nedits, edits, radius) <= 2.0) {
+			smap [ns] = i;
+			sterms [2*ns]		= q -> x;
+			sterms [2*ns + 1]	= q -> y;
+			++ns;
+		}
+	}
+
+	H	= NULL;
+	Hs	= NULL;
+	take	= NULL;
+	ok	= ok AND (ns <= MAX_NEAR_FRACTION * n);
+
+	if (ok AND (ns >= 2)) {
+		Hs = gst_generate_fsts (ns,
+					sterms,
+					ism -> metric,
+					ism -> params,
+					NULL);
+		ok = (Hs NE NULL) AND (Hs -> full_trees NE NULL);
+	}
+
+	/* Decide which of the new FSTs to take. */
+	m = 0;
+	if (ok AND (Hs NE NULL)) {
+		take = NEWA (BMAP_ELTS (Hs -> num_edges), bitmap_t);
+		memset (take, 0, BMAP_ELTS (Hs -> num_edges) * sizeof (bitmap_t));
+		for (e = 0; ok AND (e < Hs -> num_edges); e++) {
+			span	= fst_span (Hs, e);
+			edited	= FALSE;
+			for (vp1 = Hs -> edge [e]; vp1 < Hs -> edge [e + 1]; vp1++) {
+				i = smap [*vp1];
+				if (ism -> changed [i]) {
+					edited = TRUE;
+					if (span > radius [tedit [i]]) {
+						/* Wider than assumed. */
+						ok = FALSE;
+					}
+				}
+			}
+			if (NOT edited) {
+				/* Not needed if we keep one as short. */
+				k = 0;
+				for (vp1 = Hs -> edge [e]; vp1 < Hs -> edge [e + 1]; vp1++) {
+					vlist [k++] = inv [smap [*vp1]];
+				}
+				j = find_fst (H0, k, vlist);
+				if ((j >= 0) AND (H0 -> cost [j] <= Hs -> cost [e])) continue;
+			}
+			SETBIT (take, e);
+			++m;
+		}
+	}
+
+	if (ok) {
+		/* The previous FSTs having no edited terminal. */
+		for (e = 0; e < H0 -> num_edges; e++) {
+			if (NOT BITON (H0 -> initial_edge_mask, e)) continue;
+			for (vp1 = H0 -> edge [e]; vp1 < H0 -> edge [e + 1]; vp1++) {
+				if (pos [*vp1] < 0) break;
+			}
+			if (vp1 >= H0 -> edge [e + 1]) {
+				++m;
+			}
+		}
+
+		trees = NEWA (m, struct full_set *);
+		m = 0;
+		for (e = 0; e < H0 -> num_edges; e++) {
+			if (NOT BITON (H0 -> initial_edge_mask, e)) continue;
+			for (vp1 = H0 -> edge [e]; vp1 < H0 -> edge [e + 1]; vp1++) {
+				if (pos [*vp1] < 0) break;
+			}
+			if (vp1 < H0 -> edge [e + 1]) continue;
+			fsp = _gst_copy_full_set (H0 -> full_trees [e]);
+			for (j = 0; j < fsp -> terminals -> n; j++) {
+				fsp -> tlist [j] = pos [fsp -> tlist [j]];
+			}
+			fsp -> tree_num = m;
+			trees [m++] = fsp;
+		}
+		if (take NE NULL) {
+			for (e = 0; e < Hs -> num_edges; e++) {
+				if (NOT BITON (take, e)) continue;
+				fsp = _gst_copy_full_set (Hs -> full_trees [e]);
+				for (j = 0; j < fsp -> terminals -> n; j++) {
+					fsp -> tlist [j] = smap [fsp -> tlist [j]];
+				}
+				fsp -> tree_num = m;
+				trees [m++] = fsp;
+			}
+		}
+
+		H = gst_create_hg (NULL);
+		gst_set_hg_number_of_vertices (H, n);
+
+		gst_free_metric (H -> metric);
+		H -> metric = gst_create_metric (ism -> metric -> type,
+						 ism -> metric -> parameter,
+						 NULL);
+
+		H -> num_edges		= m;
+		H -> num_edge_masks	= BMAP_ELTS (m);
+		H -> edge		= NEWA (m + 1, int *);
+		H -> edge_size		= NEWA (m, int);
+		H -> cost		= NEWA (m, dist_t);
+		H -> pts		= pts;
+		pts			= NULL;
+		H -> full_trees		= trees;
+
+		count = 0;
+		for (e = 0; e < m; e++) {
+			H -> edge_size [e]	= trees [e] -> terminals -> n;
+			H -> cost [e]		= trees [e] -> tree_len;
+			count += H -> edge_size [e];
+		}
+		ip1 = NEWA (count, int);
+		for (e = 0; e < m; e++) {
+			H -> edge [e] = ip1;
+			for (j = 0; j < H -> edge_size [e]; j++) {
+				*ip1++ = trees [e] -> tlist [j];
+			}
+		}
+		H -> edge [m] = ip1;
+
+		/* Costs are integral only if they were in both. */
+		delta = 0.0;
+		gst_get_dbl_property (H0 -> proplist,
+				      GST_PROP_HG_INTEGRALITY_DELTA,
+				      &delta);
+		if (Hs NE NULL) {
+			sdelta = 0.0;
+			gst_get_dbl_property (Hs -> proplist,
+					      GST_PROP_HG_INTEGRALITY_DELTA,
+					      &sdelta);
+			if (sdelta < delta) {
+				delta = sdelta;
+			}
+		}
+		gst_set_dbl_property (H -> proplist,
+				      GST_PROP_HG_INTEGRALITY_DELTA,
+				      delta);
+
+		_gst_initialize_hypergraph (H);
+	}
+
+	if (take NE NULL) {
+		free ((char *) take);
+	}
+	if (Hs NE NULL) {
+		gst_free_hg (Hs);
+	}
+	if (pts NE NULL) {
+		free ((char *) pts);
+	}
+	free ((char *) q);
+	free ((char *) sterms);
+	free ((char *) smap);
+	free ((char *) radius);
+	free ((char *) vspan);
+	free ((char *) edits);
+	free ((char *) tedit);
+	free ((char *) vlist);
+	free ((char *) inv);
+	free ((char *) pos);
+
+	return (H);
+}
+
+/*
+ * Get the distance from a point to the nearest edit, in units of the
+ * radius of that edit.
+ */
+
+	static
+	double
+edit_distance (
+
+struct point *		p,		/* IN - the point */
+int			nedits,		/* IN - number of edits */
+struct point *		edits,		/* IN - locations of the edits */
+double *		radius		/* IN - radius of each edit */
+)
+{
+int			i;
+double			d;
+double			best;
+
+	best = DBL_MAX;
+	for (i = 0; i < nedits; i++) {
+		d = EDIST (p, &(edits [i])) / radius [i];
+		if (d < best) {
+			best = d;
+		}
+	}
+
+	return (best);
+}
+
+/*
+ * Get the largest distance between two terminals of an FST.
+ */
+
+	static
+	double
+fst_span (
+
+gst_hg_ptr		H,		/* IN - FST hypergraph */
+int			e		/* IN - the FST */
+)
+{
+int *			vp1;
+int *			vp2;
+double			d;
+double			span;
+
+	span = 0.0;
+	for (vp1 = H -> edge [e]; vp1 < H -> edge [e + 1]; vp1++) {
+		for (vp2 = vp1 + 1; vp2 < H -> edge [e + 1]; vp2++) {
+			d = EDIST (&(H -> pts -> a [*vp1]),
+				   &(H -> pts -> a [*vp2]));
+			if (d > span) {
+				span = d;
+			}
+		}
+	}
+
+	return (span);
+}
+
+/*
+ * Compute an MST of the given points, in the rectilinear metric if H
+ * is rectilinear and in the Euclidean metric otherwise.
+ */
+
+	static
+	int
+mst_edges (
+
+gst_hg_ptr		H,		/* IN - hypergraph giving the metric */
+struct pset *		pts,		/* IN - the points */
+struct edge *		edges		/* OUT - MST edges */
+)
+{
+	if (pts -> n < 2) {
+		return (0);
+	}
+	if (_gst_is_rectilinear (H)) {
+		return (_gst_rect_mst (pts, edges, NULL));
+	}
+	return (_gst_euclidean_mst (pts, edges, 1));
+}
+
+/*
+ * Give the edge of H having the same terminals as each edge of the
+ * previous hypergraph, or -1 if there is none.
+ */
+
+	static
+	void
+map_edges (
+
+gst_incsmt_ptr		ism,		/* IN - incremental SMT object */
+gst_hg_ptr		H,		/* IN - new FST hypergraph */
+int *			emap		/* OUT - edge of H for each old edge */
+)
+{
+int			e;
+int			k;
+int			t;
+int *			pos;
+int *			vlist;
+int *			vp1;
+int *			vp2;
+gst_hg_ptr		H0;
+
+	H0 = ism -> H;
+
+	pos = stable_positions (ism);
+	vlist = NEWA (H -> num_verts, int);
+
+	for (e = 0; e < H0 -> num_edges; e++) {
+		emap [e] = -1;
+		vp1 = H0 -> edge [e];
+		vp2 = H0 -> edge [e + 1];
+		k = 0;
+		while (vp1 < vp2) {
+			t = pos [ism -> hg_ids [*vp1++]];
+			if (t < 0) break;
+			vlist [k++] = t;
+		}
+		if (k < H0 -> edge_size [e]) continue;
+		emap [e] = find_fst (H, k, vlist);
+	}
+
+	free ((char *) vlist);
+	free ((char *) pos);
+}
+
+/*
+ * Find the FST of H whose terminals are exactly the given ones.
+ * Returns -1 if there is none.  If several FSTs span the same
+ * terminals, the shortest is taken.
+ */
+
+	static
+	int
+find_fst (
+
+gst_hg_ptr		H,		/* IN - FST hypergraph */
+int			k,		/* IN - number of terminals */
+int *			vlist		/* IN - the terminals */
+)
+{
+int			i;
+int			e;
+int			best;
+int *			ep1;
+int *			ep2;
+int *			vp1;
+int *			vp2;
+
+	/* Every such FST contains the first terminal. */
+	best = -1;
+	ep1 = H -> term_trees [vlist [0]];
+	ep2 = H -> term_trees [vlist [0] + 1];
+	for (; ep1 < ep2; ep1++) {
+		e = *ep1;
+		if (H -> edge_size [e] NE k) continue;
+		if (NOT BITON (H -> initial_edge_mask, e)) continue;
+		vp1 = H -> edge [e];
+		vp2 = H -> edge [e + 1];
+		for (; vp1 < vp2; vp1++) {
+			for (i = 0; i < k; i++) {
+				if (vlist [i] EQ *vp1) break;
+			}
+			if (i >= k) break;
+		}
+		if (vp1 < vp2) continue;
+		if ((best < 0) OR (H -> cost [e] < H -> cost [best])) {
+			best = e;
+		}
+	}
+
+	return (best);
+}
+
+/*
+ * Forget the result of the last solve.
+ */
+
+	static
+	void
+discard_solution (
+
+gst_incsmt_ptr		ism		/* IN/OUT - incremental SMT object */
+)
+{
+	if (ism -> H NE NULL) {
+		gst_free_hg (ism -> H);
+		ism -> H = NULL;
+	}
+	if (ism -> hg_ids NE NULL) {
+		free ((char *) (ism -> hg_ids));
+		ism -> hg_ids = NULL;
+	}
+	if (ism -> sol NE NULL) {
+		free ((char *) (ism -> sol));
+		ism -> sol = NULL;
+	}
+	ism -> nsol	= -1;
+	ism -> length	= 0.0;
+	ism -> status	= GST_STATUS_NO_SOLUTION;
+}
@@ -0,0 +1,59 @@
+/***********************************************************************
+
+	File:	incsmt.h
+	Rev:	e-1
+	Date:	10/19/2026
+
+	This work is licensed under a Creative Commons
+	Attribution-NonCommercial 4.0 International License.
+
+************************************************************************
+
+	Declarations for the incremental SMT object.
+
+************************************************************************/
+
+#ifndef	INCSMT_H
+#define	INCSMT_H
+
+#include "geosteiner.h"
+#include "gsttypes.h"
+
+
+/*
+ * An incremental SMT object holds a set of terminals that the caller
+ * edits a few at a time, together with the FSTs and the solution of
+ * the most recent solve.  Each terminal carries an id that does not
+ * change when other terminals are added or removed, so that the FSTs
+ * of the previous solution can be recognized in the new FST
+ * hypergraph.  The cuts separated by one solve are kept in a cut
+ * repository, from which the next solve imports those that remain
+ * valid.
+ */
+
+struct gst_incsmt {
+	gst_metric_ptr	metric;		/* copy of caller's metric */
+	gst_param_ptr	params;		/* copy of caller's parameters */
+	int		nterms;		/* number of terminals */
+	int		maxterms;	/* allocated size of arrays */
+	double *	terms;		/* terminal coordinates */
+	int *		ids;		/* stable id of each terminal */
+	bool *		changed;	/* terminal added or moved since */
+					/* the last solve */
+	int		next_id;	/* next stable id to hand out */
+	bool		modified;	/* terminals edited since the */
+					/* last solve */
+
+	gst_cutrepo_ptr	repo;		/* cuts of the last solve */
+
+	/* The result of the last solve. */
+	gst_hg_ptr	H;		/* FST hypergraph */
+	int *		hg_ids;		/* stable id of each vertex of H */
+	int		nsol;		/* number of FSTs in solution, */
+					/* or -1 if there is none */
+	int *		sol;		/* FSTs of solution (edges of H) */
+	double		length;		/* length of solution */
+	int		status;		/* solution status */
+};
+
+#endif
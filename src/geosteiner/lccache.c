@@ -0,0 +1,704 @@
+/***********************************************************************
+
+	File:	lccache.c
+	Rev:	e-1
+	Date:	10/19/2026
+
+	This work is licensed under a Creative Commons
+	Attribution-NonCommercial 4.0 International License.
+
+************************************************************************
+
+	A cache of local cut subproblems: the fractional components
+	that were separated, and the outcome for each of them.
+
+************************************************************************/
+
+#include "lccache.h"
+
+#include "bb.h"
+#include "fatal.h"
+#include "logic.h"
+#include <math.h>
+#include "memory.h"
+#include "sec_comp.h"
+#include "steiner.h"
+#include <string.h>
+
+
+/*
+ * Global Routines
+ */
+
+struct lc_cache *	_gst_create_lc_cache (int megabytes);
+void			_gst_free_lc_cache (struct lc_cache * cache);
+void			_gst_lc_cache_insert (struct lc_cache *	cache,
+					      struct comp *	comp,
+					      double *		y);
+int			_gst_lc_cache_lookup (struct lc_cache *	cache,
+					      struct comp *	comp,
+					      double **		y);
+bool			_gst_read_lc_cache (FILE *		fp,
+					    int			megabytes,
+					    struct lc_cache **	cache);
+void			_gst_write_lc_cache (FILE *		fp,
+					     struct lc_cache *	cache);
+
+
+/*
+ * Local Equates
+ */
+
+/* Weights are rounded to this many parts per unit for hashing. */
+#define	X_HASH_SCALE		10000.0
+
+#define	INITIAL_NUM_BUCKETS	64
+
+#define	HASH_INIT		((int64u) 0xCBF29CE484222325UL)
+#define	HASH_PRIME		((int64u) 0x00000100000001B3UL)
+
+
+/*
+ * Local Types
+ */
+
+struct lc_entry {
+	struct lc_entry *	hnext;		/* next in hash chain */
+	struct lc_entry *	older;		/* less recently used */
+	struct lc_entry *	newer;		/* more recently used */
+	int64u			hash;		/* hash of component */
+	int			status;		/* LC_CACHE_FAILED/CUT */
+	int			num_verts;	/* vertices in component */
+	int			num_edges;	/* edges in component */
+	int *			estart;		/* start of each edge */
+	int *			everts;		/* vertices of all edges */
+	double *		x;		/* LP weight of each edge */
+	double *		y;		/* cut coefficients, if any */
+	size_t			size;		/* memory used by entry */
+};
+
+struct lc_cache {
+	struct lc_entry **	buckets;	/* hash table */
+	int			num_buckets;	/* a power of two */
+	int			count;		/* number of entries */
+	size_t			size;		/* memory used by entries */
+	size_t			max_size;	/* memory allowed */
+	struct lc_entry *	oldest;		/* least recently used */
+	struct lc_entry *	newest;		/* most recently used */
+};
+
+
+/*
+ * Local Routines
+ */
+
+static void		add_entry (struct lc_cache *, struct lc_entry *);
+static void		delete_entry (struct lc_cache *, struct lc_entry *);
+static void		free_entry (struct lc_entry *);
+static int64u		hash_comp (struct comp *);
+static int64u		hash_int (int64u, int);
+static int64u		hash_key (int, int, int *, int, double *);
+static bool		matches (struct lc_entry *, struct comp *);
+static struct lc_entry *	new_entry (int, int, int, bool);
+static void		rehash (struct lc_cache *);
+static void		unlink_entry (struct lc_cache *, struct lc_entry *);
+
+/*
+ * Create an empty cache that uses at most the given amount of memory.
+ */
+
+	struct lc_cache *
+_gst_create_lc_cache (
+
+int		megabytes	/* IN - memory the cache may use */
+)
+{
+int			i;
+struct lc_cache *	cache;
+
+	cache = NEW (struct lc_cache);
+
+	cache -> num_buckets	= INITIAL_NUM_BUCKETS;
+	cache -> buckets	= NEWA (INITIAL_NUM_BUCKETS, struct lc_entry *);
+	cache -> count		= 0;
+	cache -> size		= 0;
+	cache -> max_size	= ((size_t) megabytes) << 20;
+	cache -> oldest		= NULL;
+	cache -> newest		= NULL;
+
+	for (i = 0; i < INITIAL_NUM_BUCKETS; i++) {
+		cache -> buckets [i] = NULL;
+	}
+
+	return (cache);
+}
+
+/*
+ * Free up the given cache.
+ */
+
+	void
+_gst_free_lc_cache (
+
+struct lc_cache *	cache		/* IN - cache to free */
+)
+{
+struct lc_entry *	ep;
+struct lc_entry *	next;
+
+	if (cache EQ NULL) return;
+
+	for (ep = cache -> oldest; ep NE NULL; ep = next) {
+		next = ep -> newer;
+		free_entry (ep);
+	}
+
+	free ((char *) (cache -> buckets));
+	free ((char *) cache);
+}
+
+/*
+ * Look up the given component.  Return LC_CACHE_MISS if it is not in
+ * the cache, LC_CACHE_FAILED if it has no violated local cut, and
+ * LC_CACHE_CUT if the coefficients of its local cut are known.  These
+ * are then returned in Y, which remains valid until the next entry
+ * is added to the cache.
+ */
+
+	int
+_gst_lc_cache_lookup (
+
+struct lc_cache *	cache,		/* IN - cache to search */
+struct comp *		comp,		/* IN - component to find */
+double **		y		/* OUT - local cut coefficients */
+)
+{
+int64u			hash;
+struct lc_entry *	ep;
+
+	*y = NULL;
+
+	if (cache EQ NULL) return (LC_CACHE_MISS);
+
+	hash = hash_comp (comp);
+	ep = cache -> buckets [hash & (cache -> num_buckets - 1)];
+	for (; ep NE NULL; ep = ep -> hnext) {
+		if (ep -> hash NE hash) continue;
+		if (NOT matches (ep, comp)) continue;
+
+		/* Make this the most recently used entry. */
+		unlink_entry (cache, ep);
+		ep -> older = cache -> newest;
+		ep -> newer = NULL;
+		if (cache -> newest NE NULL) {
+			cache -> newest -> newer = ep;
+		}
+		else {
+			cache -> oldest = ep;
+		}
+		cache -> newest = ep;
+
+		*y = ep -> y;
+		return (ep -> status);
+	}
+
+	return (LC_CACHE_MISS);
+}
+
+/*
+ * Record the outcome of separating the given component: the local cut
+ * coefficients Y, or NULL if there is no violated local cut.  Least
+ * recently used entries are discarded to make room.
+ */
+
+	void
+_gst_lc_cache_insert (
+
+struct lc_cache *	cache,		/* IN/OUT - cache to add to */
+struct comp *		comp,		/* IN - component separated */
+double *		y		/* IN - cut coefficients, or NULL */
+)
+{
+int			i;
+int			nedges;
+int			ncard;
+double *		oldy;
+struct lc_entry *	ep;
+
+	if (cache EQ NULL) return;
+
+	nedges	= comp -> num_edges;
+	ncard	= comp -> everts [nedges] - comp -> everts [0];
+
+	/* Replace any previous outcome for this component. */
+	if (_gst_lc_cache_lookup (cache, comp, &oldy) NE LC_CACHE_MISS) {
+		delete_entry (cache, cache -> newest);
+	}
+
+	ep = new_entry (comp -> num_verts, nedges, ncard, (y NE NULL));
+	if (ep -> size > cache -> max_size) {
+		free_entry (ep);
+		return;
+	}
+
+	ep -> status = (y NE NULL) ? LC_CACHE_CUT : LC_CACHE_FAILED;
+	for (i = 0; i <= nedges; i++) {
+		ep -> estart [i] = comp -> everts [i] - comp -> everts [0];
+	}
+	memcpy (ep -> everts, comp -> everts [0], ncard * sizeof (int));
+	memcpy (ep -> x, comp -> x, nedges * sizeof (double));
+	if (y NE NULL) {
+		memcpy (ep -> y, y, nedges * sizeof (double));
+	}
+	ep -> hash = hash_comp (comp);
+
+	add_entry (cache, ep);
+}
+
+/*
+ * Write the cache to the given stream, least recently used entry
+ * first.  A NULL cache is written as an empty one.
+ */
+
+	void
+_gst_write_lc_cache (
+
+FILE *			fp,		/* IN - stream to write to */
+struct lc_cache *	cache		/* IN - cache to write */
+)
+{
+int			n;
+int			hdr [4];
+struct lc_entry *	ep;
+
+	n = (cache EQ NULL) ? 0 : cache -> count;
+	fwrite (&n, 1, sizeof (n), fp);
+
+	if (cache EQ NULL) return;
+
+	for (ep = cache -> oldest; ep NE NULL; ep = ep -> newer) {
+		hdr [0] = ep -> status;
+		hdr [1] = ep -> num_verts;
+		hdr [2] = ep -> num_edges;
+		hdr [3] = ep -> estart [ep -> num_edges];
+		fwrite (hdr, 1, sizeof (hdr), fp);
+		fwrite (ep -> estart, sizeof (int), hdr [2] + 1, fp);
+		fwrite (ep -> everts, sizeof (int), hdr [3], fp);
+		fwrite (ep -> x, sizeof (double), hdr [2], fp);
+		if (ep -> y NE NULL) {
+			fwrite (ep -> y, sizeof (double), hdr [2], fp);
+		}
+		if (ferror (fp)) break;
+	}
+}
+
+/*
+ * Read a cache written by _gst_write_lc_cache().  The new cache uses
+ * at most the given amount of memory.  Return FALSE if the data is
+ * invalid.
+ */
+
+	bool
+_gst_read_lc_cache (
+
+FILE *			fp,		/* IN - stream to read from */
+int			megabytes,	/* IN - memory the cache may use */
+struct lc_cache **	cachep		/* OUT - the cache read */
+)
+{
+int			i;
+int			j;
+int			n;
+int			hdr [4];
+size_t			len;
+struct lc_cache *	cache;
+struct lc_entry *	ep;
+
+	*cachep = NULL;
+
+	if (fread (&n, 1, sizeof (n), fp) NE sizeof (n)) return (FALSE);
+	if (n < 0) return (FALSE);
+
+	cache = _gst_create_lc_cache (megabytes);
+
+	for (i = 0; i < n; i++) {
+		if (fread (hdr, 1, sizeof (hdr), fp) NE sizeof (hdr)) break;
+		if ((hdr [0] NE LC_CACHE_FAILED) AND
+		    (hdr [0] NE LC_CACHE_CUT)) break;
+		if ((hdr [1] < 0) OR (hdr [2] < 0) OR (hdr [3] < 0)) break;
+
+		ep = new_entry (hdr [1],
+				hdr [2],
+				hdr [3],
+				(hdr [0] EQ LC_CACHE_CUT));
+		ep -> status = hdr [0];
+
+		len = fread (ep -> estart, sizeof (int), hdr [2] + 1, fp);
+		len += fread (ep -> everts, sizeof (int), hdr [3], fp);
+		len += fread (ep -> x, sizeof (double), hdr [2], fp);
+		if (ep -> y NE NULL) {
+			len += fread (ep -> y, sizeof (double), hdr [2], fp);
+		}
+		if (len NE (size_t) (((ep -> y NE NULL) ? 3 : 2) * hdr [2]
+				     + 1 + hdr [3])) {
+			free_entry (ep);
+			break;
+		}
+
+		/* Check that the edges are well formed. */
+		for (j = 0; j < hdr [2]; j++) {
+			if (ep -> estart [j] > ep -> estart [j + 1]) break;
+		}
+		if ((j < hdr [2]) OR
+		    (ep -> estart [0] NE 0) OR
+		    (ep -> estart [hdr [2]] NE hdr [3])) {
+			free_entry (ep);
+			break;
+		}
+		for (j = 0; j < hdr [3]; j++) {
+			if ((ep -> everts [j] < 0) OR
+			    (ep -> everts [j] >= hdr [1])) break;
+		}
+		if (j < hdr [3]) {
+			free_entry (ep);
+			break;
+		}
+
+		ep -> hash = hash_key (ep -> num_verts,
+				       ep -> num_edges,
+				       ep -> everts,
+				       hdr [3],
+				       ep -> x);
+
+		if (ep -> size > cache -> max_size) {
+			free_entry (ep);
+			continue;
+		}
+		add_entry (cache, ep);
+	}
+
+	if (i < n) {
+		_gst_free_lc_cache (cache);
+		return (FALSE);
+	}
+
+	*cachep = cache;
+
+	return (TRUE);
+}
+
+/*
+ * Allocate a new cache entry of the given dimensions.
+ */
+
+	static
+	struct lc_entry *
+new_entry (
+
+int		nverts,		/* IN - number of vertices */
+int		nedges,		/* IN - number of edges */
+int		ncard,		/* IN - total cardinality of edges */
+bool		have_y		/* IN - entry holds a local cut */
+)
+{
+struct lc_entry *	ep;
+
+	ep = NEW (struct lc_entry);
+
+	ep -> hnext	= NULL;
+	ep -> older	= NULL;
+	ep -> newer	= NULL;
+	ep -> hash	= 0;
+	ep -> status	= LC_CACHE_FAILED;
+	ep -> num_verts	= nverts;
+	ep -> num_edges	= nedges;
+	ep -> estart	= NEWA (nedges + 1, int);
+	ep -> everts	= NEWA (ncard + 1, int);
+	ep -> x		= NEWA (nedges + 1, double);
+	ep -> y		= NULL;
+	ep -> size	= sizeof (*ep)
+			  + (nedges + ncard + 2) * sizeof (int)
+			  + (nedges + 1) * sizeof (double);
+
+	if (have_y) {
+		ep -> y = NEWA (nedges + 1, double);
+		ep -> size += (nedges + 1) * sizeof (double);
+	}
+
+	return (ep);
+}
+
+/*
+ * Free up a cache entry.
+ */
+
+	static
+	void
+free_entry (
+
+struct lc_entry *	ep		/* IN - entry to free */
+)
+{
+	if (ep -> y NE NULL) {
+		free ((char *) (ep -> y));
+	}
+	free ((char *) (ep -> x));
+	free ((char *) (ep -> everts));
+	free ((char *) (ep -> estart));
+	free ((char *) ep);
+}
+
+/*
+ * Add an entry to the cache, as the most recently used one.  Least
+ * recently used entries are discarded until it fits.
+ */
+
+	static
+	void
+add_entry (
+
+struct lc_cache *	cache,		/* IN/OUT - cache to add to */
+struct lc_entry *	ep		/* IN - entry to add */
+)
+{
+int			i;
+
+	while ((cache -> oldest NE NULL) AND
+	       (cache -> size + ep -> size > cache -> max_size)) {
+		delete_entry (cache, cache -> oldest);
+	}
+
+	if (cache -> count >= cache -> num_buckets) {
+		rehash (cache);
+	}
+
+	i = ep -> hash & (cache -> num_buckets - 1);
+	ep -> hnext = cache -> buckets [i];
+	cache -> buckets [i] = ep;
+
+	ep -> older = cache -> newest;
+	ep -> newer = NULL;
+	if (cache -> newest NE NULL) {
+		cache -> newest -> newer = ep;
+	}
+	else {
+		cache -> oldest = ep;
+	}
+	cache -> newest = ep;
+
+	++(cache -> count);
+	cache -> size += ep -> size;
+}
+
+/*
+ * Remove an entry from the cache and free it.
+ */
+
+	static
+	void
+delete_entry (
+
+struct lc_cache *	cache,		/* IN/OUT - cache to remove from */
+struct lc_entry *	ep		/* IN - entry to remove */
+)
+{
+struct lc_entry **	hookp;
+
+	hookp = &(cache -> buckets [ep -> hash & (cache -> num_buckets - 1)]);
+	while (*hookp NE ep) {
+		FATAL_ERROR_IF (*hookp EQ NULL);
+		hookp = &((*hookp) -> hnext);
+	}
+	*hookp = ep -> hnext;
+
+	unlink_entry (cache, ep);
+
+	--(cache -> count);
+	cache -> size -= ep -> size;
+
+	free_entry (ep);
+}
+
+/*
+ * Remove an entry from the list of entries in order of use.
+ */
+
+	static
+	void
+unlink_entry (
+
+struct lc_cache *	cache,		/* IN/OUT - cache */
+struct lc_entry *	ep		/* IN - entry to unlink */
+)
+{
+	if (ep -> older NE NULL) {
+		ep -> older -> newer = ep -> newer;
+	}
+	else {
+		cache -> oldest = ep -> newer;
+	}
+	if (ep -> newer NE NULL) {
+		ep -> newer -> older = ep -> older;
+	}
+	else {
+		cache -> newest = ep -> older;
+	}
+	ep -> older = NULL;
+	ep -> newer = NULL;
+}
+
+/*
+ * Double the number of hash buckets.
+ */
+
+	static
+	void
+rehash (
+
+struct lc_cache *	cache		/* IN/OUT - cache to rehash */
+)
+{
+int			i;
+int			j;
+int			n;
+struct lc_entry **	buckets;
+struct lc_entry *	ep;
+struct lc_entry *	next;
+
+	n = 2 * cache -> num_buckets;
+	buckets = NEWA (n, struct lc_entry *);
+	for (i = 0; i < n; i++) {
+		buckets [i] = NULL;
+	}
+
+	for (i = 0; i < cache -> num_buckets; i++) {
+		for (ep = cache -> buckets [i]; ep NE NULL; ep = next) {
+			next = ep -> hnext;
+			j = ep -> hash & (n - 1);
+			ep -> hnext = buckets [j];
+			buckets [j] = ep;
+		}
+	}
+
+	free ((char *) (cache -> buckets));
+	cache -> buckets	= buckets;
+	cache -> num_buckets	= n;
+}
+
+/*
+ * Determine whether the given entry is for the given component.  The
+ * weights must agree to within FUZZ.
+ */
+
+	static
+	bool
+matches (
+
+struct lc_entry *	ep,		/* IN - cache entry */
+struct comp *		comp		/* IN - component */
+)
+{
+int			i;
+int			nedges;
+int *			vp;
+
+	nedges = comp -> num_edges;
+
+	if (ep -> num_verts NE comp -> num_verts) return (FALSE);
+	if (ep -> num_edges NE nedges) return (FALSE);
+
+	vp = comp -> everts [0];
+	for (i = 0; i <= nedges; i++) {
+		if (ep -> estart [i] NE (comp -> everts [i] - vp)) {
+			return (FALSE);
+		}
+	}
+	for (i = 0; i < ep -> estart [nedges]; i++) {
+		if (ep -> everts [i] NE vp [i]) return (FALSE);
+	}
+	for (i = 0; i < nedges; i++) {
+		if (fabs (ep -> x [i] - comp -> x [i]) > FUZZ) return (FALSE);
+	}
+
+	return (TRUE);
+}
+
+/*
+ * Compute the hash of a component.
+ */
+
+	static
+	int64u
+hash_comp (
+
+struct comp *		comp		/* IN - component to hash */
+)
+{
+int			nedges;
+
+	nedges = comp -> num_edges;
+
+	return (hash_key (comp -> num_verts,
+			  nedges,
+			  comp -> everts [0],
+			  comp -> everts [nedges] - comp -> everts [0],
+			  comp -> x));
+}
+
+/*
+ * Compute the hash of a component given as its dimensions, the
+ * vertices of all its edges and its weights.  The weights are
+ * rounded, so that nearly equal weights usually hash the same.
+ * (Edge boundaries are left to matches().)
+ */
+
+	static
+	int64u
+hash_key (
+
+int		nverts,		/* IN - number of vertices */
+int		nedges,		/* IN - number of edges */
+int *		verts,		/* IN - vertices of all edges */
+int		ncard,		/* IN - total cardinality of edges */
+double *	x		/* IN - weight of each edge */
+)
+{
+int		i;
+int64u		h;
+
+	h = HASH_INIT;
+	h = hash_int (h, nverts);
+	h = hash_int (h, nedges);
+	for (i = 0; i < ncard; i++) {
+		h = hash_int (h, verts [i]);
+	}
+	for (i = 0; i < nedges; i++) {
+		h = hash_int (h, (int) floor (x [i] * X_HASH_SCALE + 0.5));
+	}
+
+	return (h);
+}
+
+/*
+ * Mix one integer into a 64-bit FNV-1a hash.
+ */
+
+	static
+	int64u
+hash_int (
+
+int64u		h,		/* IN - hash so far */
+int		value		/* IN - integer to mix in */
+)
+{
+int		i;
+int32u		u;
+
+	u = (int32u) value;
+	for (i = 0; i < 4; i++) {
+		h = (h ^ (u & 0xFF)) * HASH_PRIME;
+		u >>= 8;
+	}
+
+	return (h);
+}
@@ -0,0 +1,62 @@
+/***********************************************************************
+
+	File:	lccache.h
+	Rev:	e-1
+	Date:	10/19/2026
+
+	This work is licensed under a Creative Commons
+	Attribution-NonCommercial 4.0 International License.
+
+************************************************************************
+
+	Declarations for the cache of local cut subproblems.
+
+************************************************************************/
+
+#ifndef	LCCACHE_H
+#define	LCCACHE_H
+
+#include "gsttypes.h"
+#include <stdio.h>
+
+struct comp;
+
+
+/*
+ * The local cut separator projects the LP solution onto small
+ * fractional components, and solves an LP for each of them.  The
+ * outcome only depends upon the component and its LP weights, so we
+ * remember it: either that no violated cut exists, or the
+ * coefficients of the cut (before lifting) that was found.
+ *
+ * Components are looked up by a hash of their structure and of their
+ * rounded weights.  The cache uses at most a given amount of memory,
+ * discarding the least recently used entries.
+ */
+
+#define	LC_CACHE_MISS		0	/* component not in cache */
+#define	LC_CACHE_FAILED		1	/* no violated local cut */
+#define	LC_CACHE_CUT		2	/* local cut is known */
+
+struct lc_cache;
+
+
+/*
+ * Global Routines
+ */
+
+extern struct lc_cache *	_gst_create_lc_cache (int megabytes);
+extern void			_gst_free_lc_cache (struct lc_cache * cache);
+extern void			_gst_lc_cache_insert (struct lc_cache * cache,
+						      struct comp *	comp,
+						      double *		y);
+extern int			_gst_lc_cache_lookup (struct lc_cache * cache,
+						      struct comp *	comp,
+						      double **		y);
+extern bool			_gst_read_lc_cache (FILE *		fp,
+						    int			megabytes,
+						    struct lc_cache **	cache);
+extern void			_gst_write_lc_cache (FILE *		fp,
+						     struct lc_cache *	cache);
+
+#endif
@@ -61,6 +61,7 @@
 #include "fatal.h"
 #include <float.h>
 #include "geosteiner.h"
+#include "lccache.h"
 #include "logic.h"
 #include <math.h>
 #include "memory.h"
@@ -243,7 +244,9 @@ static int		find_max_forest (struct comp *,
 					 int *,
 					 gst_param_ptr);
 static int *		heapsort_edges (struct comp *);
-static bool		is_failed_subproblem (struct comp *, struct bbinfo *);
+static struct constraint * lift_cached_cut (struct comp *,
+					    double *,
+					    struct bbinfo *);
 static struct constraint * lift_constraint (struct comp *,
 					    double *,
 					    double,
@@ -283,8 +286,12 @@ static void		quiet_trace_lp_error (
 					struct LCTrace *	tp,
 					const char *		format,
 					int			status);
-static void		record_failed_fcomp (struct comp *, struct bbinfo *);
+static void		record_fcomp (struct comp *, struct bbinfo *, double *);
 static void		reduce_fcomp_in_place (struct comp *);
+static int		screen_fcomp (struct comp *, struct bbinfo *, double **);
+static struct constraint * separate_fcomp (struct comp *,
+					   struct bbinfo *,
+					   double **);
 static struct comp *	simplify_one_fcomp (struct comp *, struct bbinfo *);
 static int *		sort_edges_by_cost_ratio (struct comp *,
 						  double *,
@@ -2010,6 +2017,100 @@ struct bbinfo *		bbip,		/* IN - branch-and-bound info */
 struct constraint *	cp		/* IN - existing constraints */
 )
 {
+int			status;
+double *		y;
+struct constraint *	newcp;
+
+	status = screen_fcomp (comp, bbip, &y);
+	if (status EQ LC_CACHE_FAILED) {
+		return (cp);
+	}
+
+	newcp = NULL;
+	if (status EQ LC_CACHE_CUT) {
+		newcp = lift_cached_cut (comp, y, bbip);
+	}
+	if (newcp EQ NULL) {
+		newcp = separate_fcomp (comp, bbip, &y);
+		record_fcomp (comp, bbip, y);
+		if (y NE NULL) {
+			free ((char *) y);
+		}
+	}
+
+	if (newcp NE NULL) {
+		newcp -> next = cp;
+		cp = newcp;
+	}
+
+	return (cp);
+}
+
+/*
+ * Determine whether the given component should be separated at all.
+ * Return LC_CACHE_FAILED if it is too big, or if we already know that
+ * it has no violated local cut.  Return LC_CACHE_CUT if its local cut
+ * is in the cache, with its coefficients in Y.  Otherwise return
+ * LC_CACHE_MISS.
+ */
+
+	static
+	int
+screen_fcomp (
+
+struct comp *		comp,		/* IN - component to separate */
+struct bbinfo *		bbip,		/* IN - branch-and-bound info */
+double **		y		/* OUT - cached cut coefficients */
+)
+{
+int			nverts;
+int			nedges;
+gst_param_ptr		params;
+
+	*y = NULL;
+
+	params = bbip -> params;
+
+	nverts	= comp -> num_verts;
+	nedges	= comp -> num_edges;
+
+#if 0
+	if (cp EQ NULL) goto pull_out_all_the_stops;
+#endif
+
+	if (   (nverts > params -> local_cuts_max_vertices)
+	    OR (nedges > params -> local_cuts_max_edges)) {
+		/* Problem is too big to attempt! */
+		return (LC_CACHE_FAILED);
+	}
+#if 0
+pull_out_all_the_stops:
+#endif
+	if (nverts > (params -> local_cuts_vertex_threshold * bbip -> cip -> num_verts)) {
+		/* Sub-problem is too large a fraction */
+		/* of the containing problem. */
+		return (LC_CACHE_FAILED);
+	}
+
+	/* Sub-problem may have been tried before. */
+	return (_gst_lc_cache_lookup (bbip -> lc_cache, comp, y));
+}
+
+/*
+ * Separate the local cut for one component.  Return the violated
+ * constraint, or NULL if there is none.  The coefficients of the cut
+ * before lifting are returned in a new array YP (or NULL).
+ */
+
+	static
+	struct constraint *
+separate_fcomp (
+
+struct comp *		comp,		/* IN - component to separate */
+struct bbinfo *		bbip,		/* IN - branch-and-bound info */
+double **		yp		/* OUT - cut coefficients, or NULL */
+)
+{
 int			i;
 int			nverts;
 int			nedges;
@@ -2043,28 +2144,6 @@ struct LCTrace *	tp;
 	nverts	= comp -> num_verts;
 	nedges	= comp -> num_edges;
 
-#if 0
-	if (cp EQ NULL) goto pull_out_all_the_stops;
-#endif
-
-	if (   (nverts > params -> local_cuts_max_vertices)
-	    OR (nedges > params -> local_cuts_max_edges)) {
-		/* Problem is too big to attempt! */
-		return (cp);
-	}
-#if 0
-pull_out_all_the_stops:
-#endif
-	if (nverts > (params -> local_cuts_vertex_threshold * bbip -> cip -> num_verts)) {
-		/* Sub-problem is too large a fraction */
-		/* of the containing problem. */
-		return (cp);
-	}
-	if (is_failed_subproblem (comp, bbip)) {
-		/* Sub-problem was previously tried and failed. */
-		return (cp);
-	}
-
 	gst_channel_printf (print_solve_trace,
 		"Enter find_fcomp_cut with %d vertices and %d edges\n",
 		nverts, nedges);
@@ -2226,16 +2305,18 @@ pull_out_all_the_stops:
 		z += comp -> x [i] * y [i];
 	}
 
+	newcp = NULL;
+	*yp = NULL;
 	if (z <= 1.0 + FUZZ) {
 		gst_channel_printf (print_solve_trace,
 			"find_fcomp_cut failed\n");
-		record_failed_fcomp (comp, bbip);
 	}
 	else {
-		newcp = lift_constraint (comp, y, z, bbip);
+		/* Lifting scales Y, so keep a copy for the cache. */
+		*yp = NEWA (nedges, double);
+		memcpy (*yp, y, nedges * sizeof (double));
 
-		newcp -> next = cp;
-		cp = newcp;
+		newcp = lift_constraint (comp, y, z, bbip);
 	}
 
 	free ((char *) edge_freq);
@@ -2261,7 +2342,7 @@ pull_out_all_the_stops:
 	delete_lp (lp);
 #endif
 
-	return (cp);
+	return (newcp);
 }
 
 /*
@@ -3200,74 +3281,64 @@ mul_by_i:
 }
 
 /*
- * See if the given fractional component has been tried before,
- * with no success.  When this happens, we save time by not trying
- * it over again.
+ * Lift a local cut that was found earlier for an identical component.
+ * Return NULL if it is not violated by the current weights.
  */
 
 	static
-	bool
-is_failed_subproblem (
+	struct constraint *
+lift_cached_cut (
 
-struct comp *		comp,
-struct bbinfo *		bbip
+struct comp *		comp,		/* IN - component to separate */
+double *		y,		/* IN - cut coefficients */
+struct bbinfo *		bbip		/* IN - branch-and-bound info */
 )
 {
 int			i;
-int			nverts;
 int			nedges;
-int			total_card;
-struct comp *		p;
-int *			vp1;
-int *			vp2;
-double			delta;
+double			z;
+double *		ycopy;
+struct constraint *	newcp;
 
-	nverts		= comp -> num_verts;
-	nedges		= comp -> num_edges;
-	total_card	= comp -> everts [nedges] - comp -> everts [0];
-
-	for (p = bbip -> failed_fcomps; p NE NULL; p = p -> next) {
-		if (p -> num_verts NE nverts) continue;
-		if (p -> num_edges NE nedges) continue;
-		vp1 = p -> everts [0];
-		vp2 = p -> everts [nedges];
-		if ((vp2 - vp1) NE total_card) continue;
-		for (i = 0; i < nedges; i++) {
-			delta = fabs (p -> x [i] - comp -> x [i]);
-			if (delta > FUZZ) goto mismatch;
-		}
-		vp2 = comp -> everts [0];
-		for (i = 0; i < total_card; i++) {
-			if (vp1 [i] NE vp2 [i]) goto mismatch;
-		}
-		/* This problem matches a failed one! */
-		return (TRUE);
-mismatch:	;
+	nedges = comp -> num_edges;
+
+	z = 0.0;
+	for (i = 0; i < nedges; i++) {
+		z += comp -> x [i] * y [i];
 	}
+	if (z <= 1.0 + FUZZ) return (NULL);
 
-	return (FALSE);
+	ycopy = NEWA (nedges, double);
+	memcpy (ycopy, y, nedges * sizeof (double));
+
+	newcp = lift_constraint (comp, ycopy, z, bbip);
+
+	free ((char *) ycopy);
+
+	return (newcp);
 }
 
 /*
- * Record the given fractional component in the list of those
- * that have FAILED to find a violated constraint.
+ * Record the outcome of separating the given fractional component in
+ * the local cut cache: the coefficients Y of the violated local cut,
+ * or NULL if none was found.
  */
 
 	static
 	void
-record_failed_fcomp (
+record_fcomp (
 
-struct comp *		comp,		/* IN - component that failed */
-struct bbinfo *		bbip
+struct comp *		comp,		/* IN - component separated */
+struct bbinfo *		bbip,		/* IN - branch-and-bound info */
+double *		y		/* IN - cut coefficients, or NULL */
 )
 {
-struct comp *		comp2;
-
-	/* Make a copy of the component... */
-	comp2 = copy_fsubcomp (comp, NULL, NULL);
+	if (bbip -> lc_cache EQ NULL) {
+		bbip -> lc_cache = _gst_create_lc_cache (
+					bbip -> params -> local_cuts_cache_size);
+	}
 
-	comp2 -> next = bbip -> failed_fcomps;
-	bbip -> failed_fcomps = comp2;
+	_gst_lc_cache_insert (bbip -> lc_cache, comp, y);
 }
 
 /*
@@ -36,7 +36,11 @@
 #include "dsuf.h"
 #include "fatal.h"
 #include "logic.h"
+#include "memory.h"
+#include "sortfuncs.h"
 #include "steiner.h"
+#include <stdlib.h>
+#include "threads.h"
 
 
 /*
@@ -47,14 +51,47 @@ int		_gst_mst_edge_list (int			n,
 				    int			nedges,
 				    struct edge *	edge_list,
 				    struct edge *	edges);
-void		_gst_sort_edge_list (struct edge * a, int n);
+int		_gst_parallel_mst_edge_list (int		n,
+					     int		nedges,
+					     struct edge *	edge_list,
+					     struct edge *	edges,
+					     int		nthreads);
+
+
+/*
+ * Local Constants
+ */
+
+/* Edge lists smaller than this are not worth doing in parallel. */
+#define	PARALLEL_MST_MIN_EDGES	65536
+
+
+/*
+ * Local Types
+ */
+
+struct boruvka {
+	int		nthreads;	/* number of workers */
+	int		nverts;		/* number of vertex slots */
+	struct edge *	edge_list;	/* the input edges */
+	int *		live;		/* indices of remaining edges */
+	int *		first;		/* start of each worker's live slice */
+	int *		count;		/* size of each worker's live slice */
+	int *		comp;		/* component (root) of each vertex */
+	int **		best;		/* cheapest edge leaving each */
+					/* component, for each worker */
+	struct dsuf *	sets;		/* the union-find structure */
+};
 
 
 /*
  * Local Routines
  */
 
-	/* none */
+static bool		edge_precedes (struct edge *, struct edge *);
+static void		find_best_edges (int, void *);
+static void		label_components (int, void *);
+static void		merge_best_edges (int, void *);
 
 /*
  * This routine computes the MST of a given list of edges.
@@ -79,7 +116,7 @@ int		root1;
 int		root2;
 struct dsuf	sets;
 
-	_gst_sort_edge_list (edge_list, nedges);
+	_gst_sort_edges (edge_list, nedges, 1);
 
 	/* Don't assume that the vertex numbers are well-behaved,	*/
 	/* except that they must be non-negative.  We do a quick scan	*/
@@ -138,185 +175,286 @@ struct dsuf	sets;
 }
 
 /*
- * This routine sorts the given edge list in INCREASING order by edge length.
+ * This routine computes the MST of a given list of edges using up to
+ * NTHREADS threads.  We use Boruvka's algorithm: each round finds the
+ * cheapest edge leaving every component (in parallel) and adds all of
+ * them to the tree.  Edges are ordered by length, with ties broken
+ * exactly as in _gst_sort_edges(), so that the MST is unique and
+ * is identical to the one found by _gst_mst_edge_list().  The MST
+ * edges are also returned in the same (sorted) order.
  */
 
+	int
+_gst_parallel_mst_edge_list (
+
+int			n,		/* IN - number of vertices */
+int			nedges,		/* IN - number of edges */
+struct edge *		edge_list,	/* IN - list of edges */
+struct edge *		edges,		/* OUT - MST edge list */
+int			nthreads	/* IN - number of threads to use */
+)
+{
+int		i;
+int		k;
+int		nverts;
+int		mst_edge_count;
+int		added;
+int		root1;
+int		root2;
+int		last;
+int *		best;
+struct edge *	ep;
+struct dsuf	sets;
+struct boruvka	info;
+
+	nthreads = _gst_effective_threads (nthreads);
+	if ((nthreads <= 1) OR (nedges < PARALLEL_MST_MIN_EDGES)) {
+		return (_gst_mst_edge_list (n, nedges, edge_list, edges));
+	}
+
+	/* As in _gst_mst_edge_list(), the vertex numbers need only	*/
+	/* be non-negative.						*/
+
+	nverts = 1;
+	ep = edge_list;
+	for (i = 0; i < nedges; i++, ep++) {
+		if (ep -> p1 >= nverts) {
+			nverts = ep -> p1 + 1;
+		}
+		if (ep -> p2 >= nverts) {
+			nverts = ep -> p2 + 1;
+		}
+	}
+
+	_gst_dsuf_create (&sets, nverts);
+	for (i = 0; i < nverts; i++) {
+		_gst_dsuf_makeset (&sets, i);
+	}
+
+	info.nthreads	= nthreads;
+	info.nverts	= nverts;
+	info.edge_list	= edge_list;
+	info.live	= NEWA (nedges, int);
+	info.first	= NEWA (nthreads, int);
+	info.count	= NEWA (nthreads, int);
+	info.comp	= NEWA (nverts, int);
+	info.best	= NEWA (nthreads, int *);
+	info.sets	= &sets;
+
+	for (i = 0; i < nedges; i++) {
+		info.live [i] = i;
+	}
+	for (i = 0; i < nthreads; i++) {
+		_gst_split_range (nedges, nthreads, i, &info.first [i], &last);
+		info.count [i] = last - info.first [i];
+		info.best [i] = NEWA (nverts, int);
+	}
+
+	mst_edge_count = 0;
+	while (mst_edge_count < n - 1) {
+		_gst_run_workers (nthreads, label_components, &info);
+		_gst_run_workers (nthreads, find_best_edges, &info);
+		_gst_run_workers (nthreads, merge_best_edges, &info);
+
+		/* Add the cheapest edge leaving each component.  Two	*/
+		/* components can pick the same edge -- add it once.	*/
+		best = info.best [0];
+		added = 0;
+		for (i = 0; i < nverts; i++) {
+			k = best [i];
+			if (k < 0) continue;
+			ep = &edge_list [k];
+			root1 = _gst_dsuf_find (&sets, ep -> p1);
+			root2 = _gst_dsuf_find (&sets, ep -> p2);
+			if (root1 EQ root2) continue;
+			_gst_dsuf_unite (&sets, root1, root2);
+			edges [mst_edge_count++] = *ep;
+			++added;
+		}
+		if (added <= 0) {
+			/* Ran out of edges before MST complete! */
+			FATAL_ERROR;
+		}
+	}
+
+	for (i = 0; i < nthreads; i++) {
+		free ((char *) info.best [i]);
+	}
+	free ((char *) info.best);
+	free ((char *) info.comp);
+	free ((char *) info.count);
+	free ((char *) info.first);
+	free ((char *) info.live);
+	_gst_dsuf_destroy (&sets);
+
+	/* Return the edges in the order Kruskal would have found them. */
+	_gst_sort_edges (edges, mst_edge_count, nthreads);
+
+	return (mst_edge_count);
+}
+
+/*
+ * Boruvka phase 1: record the root of each vertex's component.  The
+ * union-find structure is only read here, so we follow the parent
+ * pointers without compressing them.
+ */
+
+	static
 	void
-_gst_sort_edge_list (
+label_components (
 
-struct edge *		a,	/* IN/OUT - array of edges to be sorted. */
-int			n	/* IN - number of elements in array. */
+int		id,		/* IN - worker number */
+void *		arg		/* IN - Boruvka state */
 )
 {
-int		i, j, k;
-int		v1a, v1b, v2a, v2b, tmpv;
-struct edge	tmp;
-struct edge *	p1;
-struct edge *	p2;
-
-	/* Construct the heap via sift-downs, in O(n) time. */
-	for (k = n >> 1; k >= 0; k--) {
-		j = k;
-		for (;;) {
-			i = (j << 1) + 1;
-			if (i + 1 < n) {
-				/* Increment i (to right subchild of j) */
-				/* if the right subchild is greater. */
-				p1 = &a [i];
-				p2 = &a [i + 1];
-				if (p2 -> len > p1 -> len) {
-					++i;
-				}
-				else if (p2 -> len EQ p1 -> len) {
-					/* Edges are the same length: */
-					/* compare lexicographically. */
-					v1a = p1 -> p1;
-					v1b = p1 -> p2;
-					if (v1a > v1b) {
-						tmpv = v1a;
-						v1a = v1b;
-						v1b = tmpv;
-					}
-					v2a = p2 -> p1;
-					v2b = p2 -> p2;
-					if (v2a > v2b) {
-						tmpv = v2a;
-						v2a = v2b;
-						v2b = tmpv;
-					}
-					if ((v2a > v1a) OR
-					    ((v2a EQ v1a) AND (v2b > v1b))) {
-						++i;
-					}
-				}
-			}
-			if (i >= n) {
-				/* Hit bottom of heap, sift-down is done. */
-				break;
-			}
-			p1 = &a [j];
-			p2 = &a [i];
-			if (p1 -> len > p2 -> len) {
-				/* Greatest child is smaller.  Sift-	*/
-				/* down is done. */
-				break;
-			}
-			else if (p1 -> len EQ p2 -> len) {
-				/* Edges are same length:	*/
-				/* compare lexicographically.	*/
-				v1a = p1 -> p1;
-				v1b = p1 -> p2;
-				if (v1a > v1b) {
-					tmpv = v1a;
-					v1a = v1b;
-					v1b = tmpv;
-				}
-				v2a = p2 -> p1;
-				v2b = p2 -> p2;
-				if (v2a > v2b) {
-					tmpv = v2a;
-					v2a = v2b;
-					v2b = tmpv;
-				}
-				if ((v1a > v2a) OR
-				    ((v1a EQ v2a) AND (v1b > v2b))) {
-					/* Greatest child is smaller.  Sift- */
-					/* down is done. */
-					break;
-				}
-			}
-			/* Sift down and continue. */
-			tmp = *p1;
-			*p1 = *p2;
-			*p2 = tmp;
-			j = i;
+int		i;
+int		j;
+int		first;
+int		last;
+int *		parent;
+struct boruvka *	bp;
+
+	bp = (struct boruvka *) arg;
+	parent = bp -> sets -> parent;
+
+	_gst_split_range (bp -> nverts, bp -> nthreads, id, &first, &last);
+	for (i = first; i < last; i++) {
+		j = i;
+		while (parent [j] NE j) {
+			j = parent [j];
 		}
+		bp -> comp [i] = j;
+	}
+}
+
+/*
+ * Boruvka phase 2: scan this worker's slice of the remaining edges,
+ * discarding edges that no longer leave their component, and record
+ * the cheapest edge leaving each component.
+ */
+
+	static
+	void
+find_best_edges (
+
+int		id,		/* IN - worker number */
+void *		arg		/* IN - Boruvka state */
+)
+{
+int		i;
+int		k;
+int		c1;
+int		c2;
+int		nlive;
+int *		live;
+int *		comp;
+int *		best;
+struct edge *	edge_list;
+struct edge *	ep;
+struct boruvka *	bp;
+
+	bp = (struct boruvka *) arg;
+	edge_list	= bp -> edge_list;
+	comp		= bp -> comp;
+	best		= bp -> best [id];
+	live		= &(bp -> live [bp -> first [id]]);
+
+	for (i = 0; i < bp -> nverts; i++) {
+		best [i] = -1;
 	}
 
-	/* Now do actual sorting.  Exchange first/last and sift down. */
-	while (n > 1) {
-		/* Largest is at a [0], swap with a [n-1],	*/
-		/* thereby putting it into final position.	*/
-		--n;
-		tmp = a [0];
-		a [0] = a [n];
-		a [n] = tmp;
-
-		/* Now restore the heap by sifting down at index 0. */
-		j = 0;
-		for (;;) {
-			i = (j << 1) + 1;
-			if (i + 1 < n) {
-				/* Increment i (to right subchild of j) */
-				/* if the right subchild is greater. */
-				p1 = &a [i];
-				p2 = &a [i + 1];
-				if (p2 -> len > p1 -> len) {
-					++i;
-				}
-				else if (p2 -> len EQ p1 -> len) {
-					/* Edges are the same length: */
-					/* compare lexicographically. */
-					v1a = p1 -> p1;
-					v1b = p1 -> p2;
-					if (v1a > v1b) {
-						tmpv = v1a;
-						v1a = v1b;
-						v1b = tmpv;
-					}
-					v2a = p2 -> p1;
-					v2b = p2 -> p2;
-					if (v2a > v2b) {
-						tmpv = v2a;
-						v2a = v2b;
-						v2b = tmpv;
-					}
-					if ((v2a > v1a) OR
-					    ((v2a EQ v1a) AND (v2b > v1b))) {
-						++i;
-					}
-				}
-			}
-			if (i >= n) {
-				/* Hit bottom of heap, sift-down is done. */
-				break;
-			}
-			p1 = &a [j];
-			p2 = &a [i];
-			if (p1 -> len > p2 -> len) {
-				/* Greatest child is smaller.  Sift-	*/
-				/* down is done. */
-				break;
-			}
-			else if (p1 -> len EQ p2 -> len) {
-				/* Edges are same length:	*/
-				/* compare lexicographically.	*/
-				v1a = p1 -> p1;
-				v1b = p1 -> p2;
-				if (v1a > v1b) {
-					tmpv = v1a;
-					v1a = v1b;
-					v1b = tmpv;
-				}
-				v2a = p2 -> p1;
-				v2b = p2 -> p2;
-				if (v2a > v2b) {
-					tmpv = v2a;
-					v2a = v2b;
-					v2b = tmpv;
-				}
-				if ((v1a > v2a) OR
-				    ((v1a EQ v2a) AND (v1b > v2b))) {
-					/* Greatest child is smaller.  Sift- */
-					/* down is done. */
-					break;
-				}
+	nlive = 0;
+	for (i = 0; i < bp -> count [id]; i++) {
+		k = live [i];
+		ep = &edge_list [k];
+		c1 = comp [ep -> p1];
+		c2 = comp [ep -> p2];
+		if (c1 EQ c2) continue;
+		live [nlive++] = k;
+		if ((best [c1] < 0) OR
+		    edge_precedes (ep, &edge_list [best [c1]])) {
+			best [c1] = k;
+		}
+		if ((best [c2] < 0) OR
+		    edge_precedes (ep, &edge_list [best [c2]])) {
+			best [c2] = k;
+		}
+	}
+	bp -> count [id] = nlive;
+}
+
+/*
+ * Boruvka phase 3: combine the per-worker cheapest edges into those
+ * of worker 0.
+ */
+
+	static
+	void
+merge_best_edges (
+
+int		id,		/* IN - worker number */
+void *		arg		/* IN - Boruvka state */
+)
+{
+int		i;
+int		w;
+int		k;
+int		first;
+int		last;
+int *		best;
+struct edge *	edge_list;
+struct boruvka *	bp;
+
+	bp = (struct boruvka *) arg;
+	edge_list	= bp -> edge_list;
+	best		= bp -> best [0];
+
+	_gst_split_range (bp -> nverts, bp -> nthreads, id, &first, &last);
+	for (w = 1; w < bp -> nthreads; w++) {
+		for (i = first; i < last; i++) {
+			k = bp -> best [w] [i];
+			if (k < 0) continue;
+			if ((best [i] < 0) OR
+			    edge_precedes (&edge_list [k],
+					   &edge_list [best [i]])) {
+				best [i] = k;
 			}
-			/* Sift down and continue. */
-			tmp = *p1;
-			*p1 = *p2;
-			*p2 = tmp;
-			j = i;
 		}
 	}
 }
+
+/*
+ * Return TRUE if edge E1 comes strictly before edge E2 in the total
+ * order used by _gst_sort_edges(): by length, then lexicographically
+ * by (smaller endpoint, larger endpoint).
+ */
+
+	static
+	bool
+edge_precedes (
+
+struct edge *		e1,	/* IN - first edge */
+struct edge *		e2	/* IN - second edge */
+)
+{
+int		v1a, v1b, v2a, v2b, tmpv;
+
+	if (e1 -> len < e2 -> len) return (TRUE);
+	if (e1 -> len > e2 -> len) return (FALSE);
+
+	v1a = e1 -> p1;
+	v1b = e1 -> p2;
+	if (v1a > v1b) {
+		tmpv = v1a;
+		v1a = v1b;
+		v1b = tmpv;
+	}
+	v2a = e2 -> p1;
+	v2b = e2 -> p2;
+	if (v2a > v2b) {
+		tmpv = v2a;
+		v2a = v2b;
+		v2b = tmpv;
+	}
+	return ((v1a < v2a) OR ((v1a EQ v2a) AND (v1b < v2b)));
+}
@@ -32,6 +32,10 @@ extern int	_gst_mst_edge_list (int			n,
 				    int			nedges,
 				    struct edge *	edge_list,
 				    struct edge *	edges);
-extern void	_gst_sort_edge_list (struct edge * a, int n);
+extern int	_gst_parallel_mst_edge_list (int		n,
+					     int		nedges,
+					     struct edge *	edge_list,
+					     struct edge *	edges,
+					     int		nthreads);
 
 #endif
@@ -0,0 +1,94 @@
+/***********************************************************************
+
+	File:	p1bin.h
+	Rev:	e-1
+	Date:	10/19/2026
+
+	This work is licensed under a Creative Commons
+	Attribution-NonCommercial 4.0 International License.
+
+************************************************************************
+
+	Layout of the binary FST data format (version 5).
+
+************************************************************************/
+
+#ifndef P1BIN_H
+#define	P1BIN_H
+
+/*
+ * A binary FST file starts with the text line "V5\n", so that the
+ * version can be determined exactly as for the text formats.  This
+ * is followed by a fixed size header, the body and (optionally) a
+ * checksum of the body.  All numbers are stored in little-endian
+ * byte order.  The header is:
+ *
+ *	offset	size	contents
+ *	 0	4	magic number "GSTB"
+ *	 4	4	revision of the binary format
+ *	 8	4	flags (see below)
+ *	12	4	metric (same encoding as versions 2 and 3)
+ *	16	4	number of vertices
+ *	20	4	number of hyperedges
+ *	24	4	scale factor
+ *	28	4	length of the instance name
+ *	32	4	length of the machine description
+ *	36	4	(reserved, zero)
+ *	40	8	MST length (double)
+ *	48	8	integrality delta (double)
+ *	56	8	generation + pruning CPU time in seconds (double)
+ *	64	8	total cardinality of all hyperedges
+ *	72	8	total number of Steiner points in all FSTs
+ *	80	8	total number of edges in all FSTs
+ *	88	8	length of the body in bytes
+ *
+ * The body consists of the following fixed-width columns:
+ *
+ *	instance name (bytes), machine description (bytes),
+ *	vertex X coordinates and then Y coordinates (doubles, if
+ *	geometric), terminal flag of each vertex (bytes), cost of
+ *	each hyperedge (doubles), status of each hyperedge (bytes:
+ *	0 = never needed, 1 = maybe, 2 = required), X and then Y
+ *	coordinates of all Steiner points (doubles, if geometric),
+ *
+ * followed by a length-prefixed (8 bytes) section of variable-length
+ * integers giving, for each hyperedge:
+ *
+ *	number of vertices, delta-coded vertex numbers,
+ *	if geometric: number of Steiner points, number of FST edges,
+ *		      and the two endpoints of each FST edge,
+ *	number of incompatible hyperedges, delta-coded hyperedge
+ *		      numbers.
+ *
+ * Variable-length integers hold 7 bits per byte, least significant
+ * first, with the high bit set on all but the last byte.  Deltas are
+ * "zig-zag" coded so that small negative values are also short.
+ */
+
+#define	FST_BIN_MAGIC		"GSTB"
+#define	FST_BIN_REVISION	1
+#define	FST_BIN_HEADER_SIZE	96
+
+#define	FST_BIN_GEOMETRIC	0x01	/* coordinates and FSTs present */
+#define	FST_BIN_CHECKSUM	0x02	/* body followed by 8-byte checksum */
+
+/*
+ * Limits on header fields, beyond which a file is rejected as corrupt.
+ * Scale factors of larger magnitude cannot be formatted by
+ * _gst_dist_to_string(), and the uniform metric needs memory in
+ * proportion to lambda.
+ */
+
+#define	FST_BIN_MAX_SCALE	100
+#define	FST_BIN_MAX_LAMBDA	1000000
+
+/*
+ * The checksum is the 64-bit FNV-1a hash of the body bytes.
+ */
+
+#define	FST_BIN_HASH_INIT	((int64u) 0xCBF29CE484222325UL)
+#define	FST_BIN_HASH_PRIME	((int64u) 0x00000100000001B3UL)
+#define	FST_BIN_HASH(h, c) \
+	((h) = ((h) ^ ((int64u) (c))) * FST_BIN_HASH_PRIME)
+
+#endif
@@ -51,14 +51,18 @@ o		: Fix -Wall issue.
 
 #include "p1read.h"
 
+#include "config.h"
 #include "fatal.h"
 #include <float.h>
 #include "geosteiner.h"
+#include "gsttypes.h"
 #include "io.h"
+#include <limits.h>
 #include "logic.h"
 #include <math.h>
 #include "memory.h"
 #include "metric.h"
+#include "p1bin.h"
 #include "parmblk.h"
 #include "point.h"
 #include "prepostlude.h"
@@ -66,6 +70,12 @@ o		: Fix -Wall issue.
 #include "steiner.h"
 #include <string.h>
 
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 /*
  * Global Routines
  */
@@ -83,10 +93,35 @@ void		_gst_init_term_trees (struct gst_hypergraph *);
 	/* none */
 
 
+/*
+ * Local Types
+ */
+
+struct bin_in {				/* binary data being decoded */
+	const unsigned char *	p;	/* next byte */
+	const unsigned char *	endp;	/* end of data */
+};
+
+struct bin_map {			/* body of binary data in memory */
+	const unsigned char *	data;	/* start of body */
+	void *			addr;	/* address mapped, or NULL */
+	size_t			len;	/* length of mapping */
+};
+
+
 /*
  * Local Routines
  */
 
+static const unsigned char *
+			bin_bytes (struct bin_in *, int64u);
+static void		bin_column (struct bin_in *, int64u, struct bin_in *);
+static int		bin_count (struct bin_in *, int64u);
+static double		bin_f64 (struct bin_in *);
+static int32u		bin_u32 (struct bin_in *);
+static int64u		bin_u64 (struct bin_in *);
+static int64u		bin_varint (struct bin_in *);
+static int		bin_zigzag (struct bin_in *);
 static int		get_d (FILE *);
 static double		get_dec_double (FILE *);
 static double		get_hex_double (FILE *);
@@ -99,6 +134,11 @@ static void		init_inc_edges (struct gst_hypergraph *,
 					int **,
 					int *);
 static void		init_output_conversion_old (gst_hg_ptr);
+static void		map_binary_body (FILE *,
+					 int64u,
+					 int,
+					 struct bin_map *);
+static gst_hg_ptr	read_binary (FILE *);
 static void		read_duplicate_terminal_groups (
 					FILE *,
 					struct gst_hypergraph *,
@@ -107,6 +147,7 @@ static gst_hg_ptr	read_version_0 (FILE *, int);
 static gst_hg_ptr	read_version_2 (FILE *, int);
 static void		remove_duplicates (int, int **, bitmap_t *);
 static void		skip (FILE *);
+static void		unmap_binary_body (struct bin_map *);
 static void		verify_symmetric (int **, int);
 
 /*
@@ -149,6 +190,10 @@ gst_hg_ptr	H;
 		H = read_version_2 (fp, version);
 		break;
 
+	case GST_PVAL_SAVE_FORMAT_BINARY:
+		H = read_binary (fp);
+		break;
+
 	default:
 		H = NULL;
 		break;
@@ -557,6 +602,7 @@ struct gst_hypergraph *	cip;
 			(void) memset (fsp, 0, sizeof (*fsp));
 			cip -> full_trees [i] = fsp;
 			fsp -> tree_num = i;
+			fsp -> refcount = 1;
 			terms = NEW_PSET (nt);
 			ZERO_PSET (terms, nt);
 			terms -> n = nt;
@@ -698,6 +744,672 @@ struct gst_hypergraph *	cip;
 	return (cip);
 }
 
+/*
+ * This routine reads in the binary data format -- version 5.  See
+ * p1bin.h for a description of the layout.  The body is mapped into
+ * memory when reading from a regular file, and read otherwise.  The
+ * terminal numbers and incompatibility lists are decoded directly into
+ * single contiguous blocks.
+ */
+
+	static
+	gst_hg_ptr
+read_binary (
+
+FILE *		fp		/* IN - input file pointer. */
+)
+{
+int			i;
+int			j;
+int			k;
+int			c;
+int			nverts;
+int			nedges;
+int			nmasks;
+int			nt;
+int			ns;
+int			flags;
+int			metric;
+int			scale_factor;
+int			fst_edge_count;
+int			num_incompat;
+int32u			name_len;
+int32u			machine_len;
+int64u			total_card;
+int64u			total_steins;
+int64u			total_edges;
+int64u			total_incompat;
+int64u			body_len;
+int64u			min_len;
+int64u			hash;
+int64u			var_len;
+long			v;
+double			mst_len;
+double			idelta;
+double			gen_time;
+const unsigned char *	p;
+char *			line;
+bool			geometric;
+struct pset *		terms;
+struct pset *		steins;
+struct point *		p1;
+struct full_set *	fsp;
+struct edge *		ep;
+int *			ip1;
+int *			ip2;
+int *			icounts;
+int **			incompat;
+struct bin_in		hdr;
+struct bin_in		body;
+struct bin_in		xcol;
+struct bin_in		ycol;
+struct bin_in		vars;
+struct bin_map		map;
+unsigned char		hbuf [FST_BIN_HEADER_SIZE];
+struct gst_hypergraph *	cip;
+
+	/* Skip the newline ending the version line. */
+	c = getc (fp);
+	if (c EQ '\r') {
+		c = getc (fp);
+	}
+	if (c NE '\n') {
+		fprintf (stderr, "Bad binary data header!\n");
+		exit (1);
+	}
+
+	if (fread (hbuf, 1, FST_BIN_HEADER_SIZE, fp) NE FST_BIN_HEADER_SIZE) {
+		fprintf (stderr, "Unexpected EOF!\n");
+		exit (1);
+	}
+	hdr.p		= hbuf;
+	hdr.endp	= hbuf + FST_BIN_HEADER_SIZE;
+	if (memcmp (bin_bytes (&hdr, 4), FST_BIN_MAGIC, 4) NE 0) {
+		fprintf (stderr, "Bad binary data header!\n");
+		exit (1);
+	}
+	if (bin_u32 (&hdr) NE FST_BIN_REVISION) {
+		fprintf (stderr, "Unsupported binary data revision!\n");
+		exit (1);
+	}
+	flags		= bin_u32 (&hdr);
+	metric		= bin_u32 (&hdr);
+	nverts		= bin_u32 (&hdr);
+	nedges		= bin_u32 (&hdr);
+	scale_factor	= bin_u32 (&hdr);
+	name_len	= bin_u32 (&hdr);
+	machine_len	= bin_u32 (&hdr);
+	(void) bin_u32 (&hdr);
+	mst_len		= bin_f64 (&hdr);
+	idelta		= bin_f64 (&hdr);
+	gen_time	= bin_f64 (&hdr);
+	total_card	= bin_u64 (&hdr);
+	total_steins	= bin_u64 (&hdr);
+	total_edges	= bin_u64 (&hdr);
+	body_len	= bin_u64 (&hdr);
+
+	geometric = ((flags & FST_BIN_GEOMETRIC) NE 0);
+
+	/* Check every field of the header before we allocate anything	*/
+	/* according to it.						*/
+	if ((metric NE 1) AND
+	    (metric NE 2) AND
+	    (metric NE 3) AND
+	    ((metric < 1002) OR (metric > 1000 + FST_BIN_MAX_LAMBDA))) {
+		fprintf (stderr, "Bad metric: %d\n", metric);
+		exit (1);
+	}
+	if (((flags & ~(FST_BIN_GEOMETRIC | FST_BIN_CHECKSUM)) NE 0) OR
+	    ((metric EQ 3) AND geometric) OR
+	    (nverts < 0) OR
+	    (nedges < 0) OR
+	    (scale_factor < -FST_BIN_MAX_SCALE) OR
+	    (scale_factor > FST_BIN_MAX_SCALE)) {
+		fprintf (stderr, "Bad binary data header!\n");
+		exit (1);
+	}
+
+	/* The fixed-width columns must all fit into the body.  None of	*/
+	/* these sums can overflow, since each term is below 2**36.	*/
+	min_len = ((int64u) name_len) + machine_len
+		  + ((int64u) nverts) + 9 * ((int64u) nedges) + 8;
+	if (geometric) {
+		min_len += 16 * ((int64u) nverts);
+	}
+	if ((min_len > body_len) OR
+	    (geometric AND (total_steins > (body_len - min_len) / 16))) {
+		fprintf (stderr, "Bad binary data length!\n");
+		exit (1);
+	}
+
+	/* Allocate hypergraph... */
+	cip = gst_create_hg (NULL);
+	gst_set_hg_number_of_vertices (cip, nverts);
+
+	gst_free_metric (cip -> metric);
+	switch (metric) {
+	case 1:
+		cip -> metric	= gst_create_metric (GST_METRIC_L, 1, NULL);
+		break;
+	case 2:
+		cip -> metric	= gst_create_metric (GST_METRIC_L, 2, NULL);
+		break;
+	case 3:
+		cip -> metric	= gst_create_metric (GST_METRIC_NONE, 0, NULL);
+		break;
+	default:
+		cip -> metric	= gst_create_metric (GST_METRIC_UNIFORM,
+						     metric - 1000, NULL);
+		break;
+	}
+
+	_gst_set_scale_info (cip -> scale, scale_factor);
+
+	if (geometric) {
+		gst_set_dbl_property (cip -> proplist,
+				      GST_PROP_HG_MST_LENGTH,
+				      mst_len);
+	}
+	gst_set_dbl_property (cip -> proplist,
+			      GST_PROP_HG_INTEGRALITY_DELTA,
+			      idelta);
+	gst_set_dbl_property (cip -> proplist,
+			      GST_PROP_HG_GENERATION_TIME,
+			      gen_time);
+
+	/* Get the body (and its checksum) into memory. */
+	map_binary_body (fp, body_len, flags, &map);
+	body.p		= map.data;
+	body.endp	= map.data + body_len;
+
+	if ((flags & FST_BIN_CHECKSUM) NE 0) {
+		hash = FST_BIN_HASH_INIT;
+		for (p = body.p; p < body.endp; p++) {
+			FST_BIN_HASH (hash, *p);
+		}
+		hdr.p		= body.endp;
+		hdr.endp	= body.endp + 8;
+		if (bin_u64 (&hdr) NE hash) {
+			fprintf (stderr, "Binary data checksum error!\n");
+			exit (1);
+		}
+	}
+
+	line = NEWA (name_len + 1, char);
+	memcpy (line, bin_bytes (&body, name_len), name_len);
+	line [name_len] = '\0';
+	gst_set_str_property (cip -> proplist, GST_PROP_HG_NAME, line);
+	free (line);
+
+	/* Discard the machine description. */
+	(void) bin_bytes (&body, machine_len);
+
+	nmasks = BMAP_ELTS (nedges);
+
+	cip -> initial_edge_mask	= NEWA (nmasks, bitmap_t);
+	cip -> required_edges		= NEWA (nmasks, bitmap_t);
+	for (i = 0; i < nmasks; i++) {
+		cip -> initial_edge_mask [i]	= 0;
+		cip -> required_edges [i]	= 0;
+	}
+
+	cip -> num_edges	= nedges;
+	cip -> num_edge_masks	= nmasks;
+	cip -> edge		= NEWA (nedges + 1, int *);
+	cip -> edge_size	= NEWA (nedges, int);
+	cip -> cost		= NEWA (nedges, dist_t);
+
+	if (geometric) {
+		cip -> pts	= NEW_PSET (nverts);
+		ZERO_PSET (cip -> pts, nverts);
+		cip -> pts -> n = nverts;
+		cip -> full_trees = NEWA (nedges, struct full_set *);
+
+		/* Read in the terminals... */
+		bin_column (&body, nverts, &xcol);
+		bin_column (&body, nverts, &ycol);
+		for (i = 0; i < nverts; i++) {
+			p1 = &(cip -> pts -> a [i]);
+			p1 -> x = bin_f64 (&xcol);
+			p1 -> y = bin_f64 (&ycol);
+		}
+	}
+
+	p = bin_bytes (&body, nverts);
+	for (i = 0; i < nverts; i++) {
+		cip -> tflag [i] = p [i];
+	}
+
+	bin_column (&body, nedges, &xcol);
+	for (i = 0; i < nedges; i++) {
+		cip -> cost [i] = bin_f64 (&xcol);
+	}
+
+	p = bin_bytes (&body, nedges);
+	for (i = 0; i < nedges; i++) {
+		switch (p [i]) {	/* full set status... */
+		case 0:
+			break;
+
+		case 1:
+			SETBIT (cip -> initial_edge_mask, i);
+			break;
+
+		case 2:
+			SETBIT (cip -> required_edges, i);
+			SETBIT (cip -> initial_edge_mask, i);
+			break;
+
+		default:
+			fprintf (stderr, "Invalid full set status: %d\n", p [i]);
+			exit (1);
+		}
+	}
+
+	xcol.p		= NULL;
+	xcol.endp	= NULL;
+	ycol.p		= NULL;
+	ycol.endp	= NULL;
+	if (geometric) {
+		bin_column (&body, total_steins, &xcol);
+		bin_column (&body, total_steins, &ycol);
+	}
+
+	var_len		= bin_u64 (&body);
+	vars.p		= bin_bytes (&body, var_len);
+	vars.endp	= vars.p + var_len;
+	if (vars.endp NE body.endp) {
+		fprintf (stderr, "Bad binary data length!\n");
+		exit (1);
+	}
+
+	/* Every vertex number and incompatibility takes at least one	*/
+	/* byte, and every FST edge two, which bounds the size of these	*/
+	/* blocks.							*/
+	if ((total_card > var_len) OR (total_edges > var_len / 2)) {
+		fprintf (stderr, "Bad binary data header!\n");
+		exit (1);
+	}
+	total_incompat = var_len;
+
+	ip1		= NEWA (total_card + 1, int);
+	ip2		= NEWA (total_incompat + 1, int);
+	incompat	= NEWA (nedges, int *);
+	icounts		= NEWA (nedges, int);
+
+	/* hyperedges... */
+	for (i = 0; i < nedges; i++) {
+		nt = bin_count (&vars, total_card);
+		total_card -= nt;
+		cip -> edge [i]		= ip1;
+		cip -> edge_size [i]	= nt;
+		v = 0;
+		for (j = 0; j < nt; j++) {
+			v += bin_zigzag (&vars);
+			if ((v < 0) OR (v >= nverts)) {
+				fprintf (stderr,
+					 "Terminal index out of range.\n");
+				exit (1);
+			}
+			*ip1++ = v;
+		}
+
+		if (geometric) {
+			fsp = NEW (struct full_set);
+			(void) memset (fsp, 0, sizeof (*fsp));
+			cip -> full_trees [i] = fsp;
+			fsp -> tree_num = i;
+			fsp -> refcount = 1;
+			fsp -> tree_len = cip -> cost [i];
+			fsp -> tlist = NEWA (nt, int);
+			terms = NEW_PSET (nt);
+			ZERO_PSET (terms, nt);
+			terms -> n = nt;
+			for (j = 0; j < nt; j++) {
+				k = cip -> edge [i] [j];
+				fsp -> tlist [j] = k;
+				terms -> a [j] = cip -> pts -> a [k];
+			}
+			ns = bin_count (&vars, total_steins);
+			total_steins -= ns;
+			steins = NEW_PSET (ns);
+			ZERO_PSET (steins, ns);
+			steins -> n = ns;
+			for (j = 0; j < ns; j++) {
+				p1 = &(steins -> a [j]);
+				p1 -> x = bin_f64 (&xcol);
+				p1 -> y = bin_f64 (&ycol);
+			}
+			fsp -> terminals = terms;
+			fsp -> steiners = steins;
+			fst_edge_count = bin_count (&vars, total_edges);
+			total_edges -= fst_edge_count;
+			fsp -> nedges = fst_edge_count;
+			ep = NEWA (fst_edge_count, struct edge);
+			fsp -> edges = ep;
+			for (j = 0; j < fst_edge_count; j++, ep++) {
+				ep -> len = 0;	/* should be unused... */
+				ep -> p1 = bin_count (&vars, nt + ns);
+				ep -> p2 = bin_count (&vars, nt + ns);
+				if ((ep -> p1 >= nt + ns) OR (ep -> p2 >= nt + ns)) {
+					fprintf (stderr, "Invalid edge endpoint!\n");
+					exit (1);
+				}
+			}
+		}
+
+		num_incompat = bin_count (&vars, total_incompat);
+		total_incompat -= num_incompat;
+		icounts [i]	= num_incompat;
+		incompat [i]	= ip2;
+		v = 0;
+		for (j = 0; j < num_incompat; j++) {
+			v += bin_zigzag (&vars);
+			if ((v < 0) OR (v >= nedges)) {
+				fprintf (stderr, "Bad incompatible index.\n");
+				exit (1);
+			}
+			*ip2++ = v;
+		}
+	}
+	cip -> edge [i] = ip1;
+
+	if (vars.p NE vars.endp) {
+		fprintf (stderr, "Bad binary data length!\n");
+		exit (1);
+	}
+
+	unmap_binary_body (&map);
+
+	_gst_init_term_trees (cip);
+	init_inc_edges (cip, incompat, icounts);
+
+	free ((char *) icounts);
+	if (nedges > 0) {
+		free ((char *) incompat [0]);
+	}
+	free ((char *) incompat);
+
+	return (cip);
+}
+
+
+/*
+ * Get the body of the binary data (and the checksum following it)
+ * into memory, leaving the file positioned just after them.  We map
+ * the file into memory when it is a regular file, and otherwise
+ * (e.g., when reading from a pipe) just read it.
+ */
+
+	static
+	void
+map_binary_body (
+
+FILE *			fp,		/* IN - input file pointer. */
+int64u			body_len,	/* IN - length of the body */
+int			flags,		/* IN - flags from the header */
+struct bin_map *	mp		/* OUT - body in memory */
+)
+{
+int64u			len;
+#ifdef HAVE_MMAP
+int			fd;
+long			pos;
+long			offset;
+void *			addr;
+struct stat		st;
+#endif
+
+	len = body_len;
+	if ((flags & FST_BIN_CHECKSUM) NE 0) {
+		len += 8;
+	}
+	if ((len < body_len) OR (((size_t) len) NE len)) {
+		fprintf (stderr, "Binary data too large!\n");
+		exit (1);
+	}
+
+	mp -> addr	= NULL;
+	mp -> len	= 0;
+
+#ifdef HAVE_MMAP
+	fd  = fileno (fp);
+	pos = ftell (fp);
+	if ((fd >= 0) AND
+	    (pos >= 0) AND
+	    (fstat (fd, &st) EQ 0) AND
+	    S_ISREG (st.st_mode)) {
+		if (((int64u) st.st_size) < ((int64u) pos) + len) {
+			/* Don't try to read more than the file holds. */
+			fprintf (stderr, "Unexpected EOF!\n");
+			exit (1);
+		}
+		/* Mappings must start on a page boundary. */
+		offset = pos % sysconf (_SC_PAGESIZE);
+		addr = mmap (NULL,
+			     len + offset,
+			     PROT_READ,
+			     MAP_PRIVATE,
+			     fd,
+			     (off_t) (pos - offset));
+		if ((addr NE MAP_FAILED) AND
+		    (fseek (fp, pos + len, SEEK_SET) EQ 0)) {
+			mp -> addr	= addr;
+			mp -> len	= len + offset;
+			mp -> data	= ((const unsigned char *) addr) + offset;
+			return;
+		}
+		if (addr NE MAP_FAILED) {
+			munmap (addr, len + offset);
+		}
+	}
+#endif
+
+	mp -> data = NEWA (len + 1, unsigned char);
+	if (fread ((void *) (mp -> data), 1, len, fp) NE len) {
+		fprintf (stderr, "Unexpected EOF!\n");
+		exit (1);
+	}
+}
+
+
+/*
+ * Release the memory holding the body of the binary data.
+ */
+
+	static
+	void
+unmap_binary_body (
+
+struct bin_map *	mp		/* IN - body to release */
+)
+{
+#ifdef HAVE_MMAP
+	if (mp -> addr NE NULL) {
+		munmap (mp -> addr, mp -> len);
+		return;
+	}
+#endif
+	free ((char *) (mp -> data));
+}
+
+
+/*
+ * Routines to decode the binary data format.  Each one checks that
+ * the data it consumes is actually there.
+ */
+
+	static
+	const unsigned char *
+bin_bytes (
+
+struct bin_in *		bp,		/* IN - input stream */
+int64u			n		/* IN - number of bytes */
+)
+{
+const unsigned char *	p;
+
+	p = bp -> p;
+	if (n > (int64u) (bp -> endp - p)) {
+		fprintf (stderr, "Unexpected end of binary data!\n");
+		exit (1);
+	}
+	bp -> p = p + n;
+
+	return (p);
+}
+
+
+	static
+	void
+bin_column (
+
+struct bin_in *		bp,		/* IN - input stream */
+int64u			n,		/* IN - number of doubles */
+struct bin_in *		column		/* OUT - stream of the column */
+)
+{
+	if (n > ((int64u) (bp -> endp - bp -> p)) / 8) {
+		fprintf (stderr, "Unexpected end of binary data!\n");
+		exit (1);
+	}
+	column -> p	= bin_bytes (bp, 8 * n);
+	column -> endp	= bp -> p;
+}
+
+
+	static
+	int32u
+bin_u32 (
+
+struct bin_in *		bp		/* IN - input stream */
+)
+{
+int			i;
+int32u			value;
+const unsigned char *	p;
+
+	p = bin_bytes (bp, 4);
+	value = 0;
+	for (i = 3; i >= 0; i--) {
+		value = (value << 8) | p [i];
+	}
+
+	return (value);
+}
+
+
+	static
+	int64u
+bin_u64 (
+
+struct bin_in *		bp		/* IN - input stream */
+)
+{
+int			i;
+int64u			value;
+const unsigned char *	p;
+
+	p = bin_bytes (bp, 8);
+	value = 0;
+	for (i = 7; i >= 0; i--) {
+		value = (value << 8) | p [i];
+	}
+
+	return (value);
+}
+
+
+	static
+	double
+bin_f64 (
+
+struct bin_in *		bp		/* IN - input stream */
+)
+{
+int64u		bits;
+double		value;
+
+	FATAL_ERROR_IF (sizeof (bits) NE sizeof (value));
+	bits = bin_u64 (bp);
+	memcpy (&value, &bits, sizeof (value));
+
+	return (value);
+}
+
+
+	static
+	int64u
+bin_varint (
+
+struct bin_in *		bp		/* IN - input stream */
+)
+{
+int			shift;
+int			c;
+int64u			value;
+
+	value = 0;
+	for (shift = 0; shift < 64; shift += 7) {
+		c = *bin_bytes (bp, 1);
+		value |= ((int64u) (c & 0x7F)) << shift;
+		if ((c & 0x80) EQ 0) {
+			return (value);
+		}
+	}
+	fprintf (stderr, "Bad binary data!\n");
+	exit (1);
+}
+
+
+/*
+ * Read a count, which must not exceed the given limit.
+ */
+
+	static
+	int
+bin_count (
+
+struct bin_in *		bp,		/* IN - input stream */
+int64u			limit		/* IN - largest valid count */
+)
+{
+int64u		value;
+
+	value = bin_varint (bp);
+	if ((value > limit) OR (value > INT_MAX)) {
+		fprintf (stderr, "Bad binary data!\n");
+		exit (1);
+	}
+
+	return ((int) value);
+}
+
+
+/*
+ * Read a zig-zag coded (signed) delta.
+ */
+
+	static
+	int
+bin_zigzag (
+
+struct bin_in *		bp		/* IN - input stream */
+)
+{
+int64u		value;
+
+	value = bin_varint (bp);
+	if (value > INT_MAX) {
+		fprintf (stderr, "Bad binary data!\n");
+		exit (1);
+	}
+	if ((value & 1) NE 0) {
+		return (- ((int) (value >> 1)) - 1);
+	}
+	return ((int) (value >> 1));
+}
+
 /*
  * This routine reads in the duplicate terminal groups.  We do not know
  * how big this is going to be.  Therefore we must plan for the worst
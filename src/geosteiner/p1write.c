@@ -60,12 +60,24 @@
 #include <math.h>
 #include "memory.h"
 #include "metric.h"
+#include "p1bin.h"
 #include "parmblk.h"
 #include "point.h"
 #include "prepostlude.h"
 #include "steiner.h"
 #include <string.h>
 
+/*
+ * Local Types
+ */
+
+struct bin_out {
+	FILE *		fp;		/* output file, or NULL to just count */
+	int64u		hash;		/* checksum of bytes written */
+	int64u		count;		/* number of bytes written */
+};
+
+
 /*
  * Global Routines
  */
@@ -77,7 +89,31 @@ int		gst_save_hg (FILE *, struct gst_hypergraph *, gst_param_ptr);
  * Local Routines
  */
 
+static void		bin_byte (struct bin_out *, int);
+static void		bin_f64 (struct bin_out *, double);
+static void		bin_u32 (struct bin_out *, int32u);
+static void		bin_u64 (struct bin_out *, int64u);
+static void		bin_varint (struct bin_out *, int64u);
+static void		bin_zigzag (struct bin_out *, int);
 static void		double_to_hex (double, char *);
+static int		get_status (struct gst_hypergraph *, int);
+static int		list_incompatibilities (struct gst_hypergraph *,
+						int,
+						int *,
+						bitmap_t *);
+static void		print_binary (FILE *, struct gst_hypergraph *);
+static void		print_binary_body (struct bin_out *,
+					   struct gst_hypergraph *,
+					   bool,
+					   char *,
+					   char *,
+					   int *,
+					   bitmap_t *);
+static void		print_binary_vars (struct bin_out *,
+					   struct gst_hypergraph *,
+					   bool,
+					   int *,
+					   bitmap_t *);
 static void		print_version_0 (FILE *, struct gst_hypergraph *, int);
 static void		print_version_2 (FILE *, struct gst_hypergraph *, int);
 
@@ -118,6 +154,10 @@ int	version;
 		print_version_2 (fp, cip, version);
 		break;
 
+	case GST_PVAL_SAVE_FORMAT_BINARY:
+		print_binary (fp, cip);
+		break;
+
 	default:
 		FATAL_ERROR;
 	}
@@ -668,6 +708,511 @@ gst_proplist_ptr	hgprop;
 #undef MAXCOL
 }
 
+/*
+ * This routine prints out the binary data format -- version 5.  See
+ * p1bin.h for a description of the layout.  The body is generated
+ * twice: once to determine its length (which goes into the header)
+ * and once to actually write it.
+ */
+
+	static
+	void
+print_binary (
+
+FILE *			fp,		/* IN - file pointer for output. */
+struct gst_hypergraph *	cip		/* IN - compatibility info. */
+)
+{
+int			i;
+int			j;
+int			n;
+int			m;
+int			slen;
+int			flags;
+int			metric;
+int64u			total_card;
+int64u			total_steins;
+int64u			total_edges;
+dist_t			mst_len;
+double			idelta;
+double			gen_time;
+double			prune_time;
+bool			geometric;
+char *			descr;
+char *			machine;
+int *			flist;
+bitmap_t *		tmask;
+struct full_set *	fsp;
+gst_proplist_ptr	hgprop;
+struct bin_out		hdr;
+struct bin_out		body;
+
+	geometric = ((cip -> metric NE GST_METRIC_NONE) AND
+		     (cip -> full_trees NE NULL) AND
+		     (cip -> pts NE NULL));
+
+	n = cip -> num_verts;
+	m = cip -> num_edges;
+
+	hgprop = gst_get_hg_properties (cip);
+
+	slen = -1;
+	gst_get_str_property (hgprop, GST_PROP_HG_NAME, &slen, NULL);
+	if (slen < 0) {
+		slen = 0;
+	}
+	descr = NEWA (slen + 1, char);
+	descr [0] = '\0';
+	if (slen > 0) {
+		gst_get_str_property (hgprop, GST_PROP_HG_NAME, NULL, descr);
+	}
+	machine = gst_env -> machine_string;
+
+	/* Same metric codes as versions 2 and 3. */
+	metric = 3;
+	if (geometric) {
+		if (_gst_is_rectilinear (cip)) {
+			metric = 1;
+		}
+		else if (_gst_is_euclidean (cip)) {
+			metric = 2;
+		}
+		else if (cip -> metric -> type EQ GST_METRIC_UNIFORM) {
+			metric = cip -> metric -> parameter + 1000;
+		}
+		else {
+			FATAL_ERROR;
+		}
+	}
+
+	mst_len = 0.0;
+	gst_get_dbl_property (cip -> proplist,
+			      GST_PROP_HG_MST_LENGTH,
+			      &mst_len);
+	idelta = 0.0;
+	gst_get_dbl_property (cip -> proplist,
+			      GST_PROP_HG_INTEGRALITY_DELTA,
+			      &idelta);
+	gen_time = 0.0;
+	gst_get_dbl_property (cip -> proplist,
+			      GST_PROP_HG_GENERATION_TIME,
+			      &gen_time);
+	prune_time = 0.0;
+	gst_get_dbl_property (cip -> proplist,
+			      GST_PROP_HG_PRUNING_TIME,
+			      &prune_time);
+
+	total_card	= 0;
+	total_steins	= 0;
+	total_edges	= 0;
+	for (i = 0; i < m; i++) {
+		total_card += cip -> edge_size [i];
+		if (geometric) {
+			fsp = cip -> full_trees [i];
+			if (fsp -> steiners NE NULL) {
+				total_steins += fsp -> steiners -> n;
+			}
+			total_edges += fsp -> nedges;
+		}
+	}
+
+	flist = NEWA (m, int);
+	tmask = NEWA (cip -> num_vert_masks, bitmap_t);
+	for (i = 0; i < cip -> num_vert_masks; i++) {
+		tmask [i] = 0;
+	}
+
+	/* Determine the length of the body. */
+	body.fp		= NULL;
+	body.hash	= FST_BIN_HASH_INIT;
+	body.count	= 0;
+	print_binary_body (&body, cip, geometric, descr, machine, flist, tmask);
+
+	flags = FST_BIN_CHECKSUM;
+	if (geometric) {
+		flags |= FST_BIN_GEOMETRIC;
+	}
+
+	fprintf (fp, "V%d\n", GST_PVAL_SAVE_FORMAT_BINARY);
+
+	hdr.fp		= fp;
+	hdr.hash	= FST_BIN_HASH_INIT;
+	hdr.count	= 0;
+	for (j = 0; j < 4; j++) {
+		bin_byte (&hdr, FST_BIN_MAGIC [j]);
+	}
+	bin_u32 (&hdr, FST_BIN_REVISION);
+	bin_u32 (&hdr, flags);
+	bin_u32 (&hdr, metric);
+	bin_u32 (&hdr, n);
+	bin_u32 (&hdr, m);
+	bin_u32 (&hdr, cip -> scale -> scale);
+	bin_u32 (&hdr, slen);
+	bin_u32 (&hdr, strlen (machine));
+	bin_u32 (&hdr, 0);
+	bin_f64 (&hdr, mst_len);
+	bin_f64 (&hdr, idelta);
+	bin_f64 (&hdr, gen_time + prune_time);
+	bin_u64 (&hdr, total_card);
+	bin_u64 (&hdr, total_steins);
+	bin_u64 (&hdr, total_edges);
+	bin_u64 (&hdr, body.count);
+	FATAL_ERROR_IF (hdr.count NE FST_BIN_HEADER_SIZE);
+
+	body.fp		= fp;
+	body.hash	= FST_BIN_HASH_INIT;
+	body.count	= 0;
+	print_binary_body (&body, cip, geometric, descr, machine, flist, tmask);
+
+	bin_u64 (&hdr, body.hash);
+
+	free ((char *) tmask);
+	free ((char *) flist);
+	free (descr);
+}
+
+
+/*
+ * This routine generates the body of the binary data format.
+ */
+
+	static
+	void
+print_binary_body (
+
+struct bin_out *	bp,		/* IN - output stream */
+struct gst_hypergraph *	cip,		/* IN - compatibility info. */
+bool			geometric,	/* IN - write geometric info? */
+char *			descr,		/* IN - instance name */
+char *			machine,	/* IN - machine description */
+int *			flist,		/* IN - scratch list of hyperedges */
+bitmap_t *		tmask		/* IN - scratch vertex mask (clear) */
+)
+{
+int			i;
+int			j;
+int			n;
+int			m;
+char *			s;
+struct full_set *	fsp;
+struct bin_out		vars;
+
+	n = cip -> num_verts;
+	m = cip -> num_edges;
+
+	for (s = descr; *s NE '\0'; s++) {
+		bin_byte (bp, *s);
+	}
+	for (s = machine; *s NE '\0'; s++) {
+		bin_byte (bp, *s);
+	}
+
+	if (geometric) {
+		for (i = 0; i < n; i++) {
+			bin_f64 (bp, cip -> pts -> a [i].x);
+		}
+		for (i = 0; i < n; i++) {
+			bin_f64 (bp, cip -> pts -> a [i].y);
+		}
+	}
+	for (i = 0; i < n; i++) {
+		bin_byte (bp, cip -> tflag [i]);
+	}
+	for (i = 0; i < m; i++) {
+		bin_f64 (bp, cip -> cost [i]);
+	}
+	for (i = 0; i < m; i++) {
+		bin_byte (bp, get_status (cip, i));
+	}
+	if (geometric) {
+		for (i = 0; i < m; i++) {
+			fsp = cip -> full_trees [i];
+			if (fsp -> steiners EQ NULL) continue;
+			for (j = 0; j < fsp -> steiners -> n; j++) {
+				bin_f64 (bp, fsp -> steiners -> a [j].x);
+			}
+		}
+		for (i = 0; i < m; i++) {
+			fsp = cip -> full_trees [i];
+			if (fsp -> steiners EQ NULL) continue;
+			for (j = 0; j < fsp -> steiners -> n; j++) {
+				bin_f64 (bp, fsp -> steiners -> a [j].y);
+			}
+		}
+	}
+
+	/* The variable-length section is preceded by its length,	*/
+	/* so we generate it twice also.				*/
+	vars.fp		= NULL;
+	vars.hash	= FST_BIN_HASH_INIT;
+	vars.count	= 0;
+	print_binary_vars (&vars, cip, geometric, flist, tmask);
+
+	bin_u64 (bp, vars.count);
+	print_binary_vars (bp, cip, geometric, flist, tmask);
+}
+
+
+/*
+ * This routine generates the variable-length integer section of the
+ * binary data format.
+ */
+
+	static
+	void
+print_binary_vars (
+
+struct bin_out *	bp,		/* IN - output stream */
+struct gst_hypergraph *	cip,		/* IN - compatibility info. */
+bool			geometric,	/* IN - write geometric info? */
+int *			flist,		/* IN - scratch list of hyperedges */
+bitmap_t *		tmask		/* IN - scratch vertex mask (clear) */
+)
+{
+int			i;
+int			j;
+int			k;
+int			prev;
+int			ns;
+int			count;
+int *			vp1;
+int *			vp2;
+struct full_set *	fsp;
+
+	for (i = 0; i < cip -> num_edges; i++) {
+		bin_varint (bp, cip -> edge_size [i]);
+		prev = 0;
+		vp1 = cip -> edge [i];
+		vp2 = cip -> edge [i + 1];
+		while (vp1 < vp2) {
+			j = *vp1++;
+			bin_zigzag (bp, j - prev);
+			prev = j;
+		}
+		if (geometric) {
+			fsp = cip -> full_trees [i];
+			ns = (fsp -> steiners EQ NULL) ? 0 : fsp -> steiners -> n;
+			bin_varint (bp, ns);
+			bin_varint (bp, fsp -> nedges);
+			for (j = 0; j < fsp -> nedges; j++) {
+				bin_varint (bp, fsp -> edges [j].p1);
+				bin_varint (bp, fsp -> edges [j].p2);
+			}
+		}
+		count = list_incompatibilities (cip, i, flist, tmask);
+		bin_varint (bp, count);
+		prev = 0;
+		for (k = 0; k < count; k++) {
+			bin_zigzag (bp, flist [k] - prev);
+			prev = flist [k];
+		}
+	}
+}
+
+
+/*
+ * Determine the status of the given hyperedge: 0 if never needed,
+ * 2 if always needed and 1 otherwise.
+ */
+
+	static
+	int
+get_status (
+
+struct gst_hypergraph *	cip,		/* IN - compatibility info. */
+int			i		/* IN - hyperedge number */
+)
+{
+	if ((cip -> initial_edge_mask NE NULL) AND
+	    (NOT BITON (cip -> initial_edge_mask, i))) {
+		return (0);
+	}
+	if ((cip -> required_edges NE NULL) AND
+	    (BITON (cip -> required_edges, i))) {
+		return (2);
+	}
+	return (1);
+}
+
+
+/*
+ * Gather the list of hyperedges incompatible with hyperedge I that
+ * we choose to mention, i.e., without the "basic" incompatibilities
+ * and those of pruned hyperedges.  These are the same lists that
+ * versions 2 and 3 write.
+ */
+
+	static
+	int
+list_incompatibilities (
+
+struct gst_hypergraph *	cip,		/* IN - compatibility info. */
+int			i,		/* IN - hyperedge number */
+int *			flist,		/* OUT - incompatible hyperedges */
+bitmap_t *		tmask		/* IN - scratch vertex mask (clear) */
+)
+{
+int		j;
+int		k;
+int		count;
+int *		ep1;
+int *		ep2;
+int *		ep3;
+int *		vp1;
+int *		vp2;
+
+	if (cip -> inc_edges EQ NULL) {
+		return (0);
+	}
+	if ((cip -> initial_edge_mask NE NULL) AND
+	    (NOT BITON (cip -> initial_edge_mask, i))) {
+		return (0);
+	}
+
+	vp1 = cip -> edge [i];
+	vp2 = cip -> edge [i + 1];
+	while (vp1 < vp2) {
+		j = *vp1++;
+		SETBIT (tmask, j);
+	}
+	ep1 = flist;
+	ep2 = cip -> inc_edges [i];
+	ep3 = cip -> inc_edges [i + 1];
+	while (ep2 < ep3) {
+		j = *ep2++;
+		if (i EQ j) continue;
+		if ((cip -> initial_edge_mask NE NULL) AND
+		    (NOT BITON (cip -> initial_edge_mask, j))) continue;
+		count = 0;
+		vp1 = cip -> edge [j];
+		vp2 = cip -> edge [j + 1];
+		while (vp1 < vp2) {
+			k = *vp1++;
+			if (BITON (tmask, k)) {
+				++count;
+			}
+		}
+		/* There shouldn't be any basic incompatibilities */
+		/* in inc_edges any more!			   */
+		FATAL_ERROR_IF (count >= 2);
+		*ep1++ = j;
+	}
+	vp1 = cip -> edge [i];
+	vp2 = cip -> edge [i + 1];
+	while (vp1 < vp2) {
+		j = *vp1++;
+		CLRBIT (tmask, j);
+	}
+
+	return (ep1 - flist);
+}
+
+
+/*
+ * Routines to write the binary data format.  Each byte written is
+ * counted and included in the checksum.  Nothing is actually written
+ * if there is no output file.
+ */
+
+	static
+	void
+bin_byte (
+
+struct bin_out *	bp,		/* IN - output stream */
+int			c		/* IN - byte to write */
+)
+{
+	c &= 0xFF;
+	if (bp -> fp NE NULL) {
+		putc (c, bp -> fp);
+	}
+	FST_BIN_HASH (bp -> hash, c);
+	++(bp -> count);
+}
+
+
+	static
+	void
+bin_u32 (
+
+struct bin_out *	bp,		/* IN - output stream */
+int32u			value		/* IN - value to write */
+)
+{
+int		i;
+
+	for (i = 0; i < 4; i++) {
+		bin_byte (bp, (int) (value & 0xFF));
+		value >>= 8;
+	}
+}
+
+
+	static
+	void
+bin_u64 (
+
+struct bin_out *	bp,		/* IN - output stream */
+int64u			value		/* IN - value to write */
+)
+{
+int		i;
+
+	for (i = 0; i < 8; i++) {
+		bin_byte (bp, (int) (value & 0xFF));
+		value >>= 8;
+	}
+}
+
+
+	static
+	void
+bin_f64 (
+
+struct bin_out *	bp,		/* IN - output stream */
+double			value		/* IN - value to write */
+)
+{
+int64u		bits;
+
+	FATAL_ERROR_IF (sizeof (bits) NE sizeof (value));
+	memcpy (&bits, &value, sizeof (bits));
+	bin_u64 (bp, bits);
+}
+
+
+	static
+	void
+bin_varint (
+
+struct bin_out *	bp,		/* IN - output stream */
+int64u			value		/* IN - value to write */
+)
+{
+	while (value >= 0x80) {
+		bin_byte (bp, (int) ((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+	bin_byte (bp, (int) value);
+}
+
+
+	static
+	void
+bin_zigzag (
+
+struct bin_out *	bp,		/* IN - output stream */
+int			value		/* IN - signed value to write */
+)
+{
+	if (value < 0) {
+		bin_varint (bp, (((int64u) (- (value + 1))) << 1) | 1);
+	}
+	else {
+		bin_varint (bp, ((int64u) value) << 1);
+	}
+}
+
 /*
  * This routine converts a double into a printable ASCII string
  * that represents the exact numeric value in hexidecimal.  The
@@ -72,12 +72,12 @@
  f(SEED_POOL_WITH_2SECS,	1019, seed_pool_with_2secs,	 0, 1, 1) \
  f(NUM_FEASIBLE_SOLUTIONS,	1020, num_feasible_solutions,	 1, INT_MAX, 1) \
  f(MAX_FEASIBLE_UPDATES,	1021, max_feasible_updates,	 0, INT_MAX, 0) \
- f(SOLVER_ALGORITHM,		1022, solver_algorithm,		 0, 2, 0) \
+ f(SOLVER_ALGORITHM,		1022, solver_algorithm,		 0, 3, 0) \
  f(INCLUDE_CORNERS,		1023, include_corners,		 0, 1, 0) \
- f(BACKTRACK_MAX_VERTS,		1024, backtrack_max_verts,	 0, 32, 8) \
- f(BACKTRACK_MAX_EDGES,		1025, backtrack_max_edges,	 0, 32, 12) \
+ f(BACKTRACK_MAX_VERTS,		1024, backtrack_max_verts,	 0, 256, 8) \
+ f(BACKTRACK_MAX_EDGES,		1025, backtrack_max_edges,	 0, 256, 12) \
  f(MAX_BACKTRACKS,		1026, max_backtracks,		 0, INT_MAX, 10000) \
- f(SAVE_FORMAT,			1027, save_format,		 0, 4, 3) \
+ f(SAVE_FORMAT,			1027, save_format,		 0, 5, 3) \
  f(GRID_OVERLAY,		1028, grid_overlay,		 0, 1, 1) \
  f(BSD_METHOD,			1029, bsd_method,		 0, 2, 0) \
  f(MAX_CUTSET_ENUMERATE_COMPS,	1030, max_cutset_enumerate_comps,0, 11, MCEC) \
@@ -92,6 +92,10 @@
  f(INITIAL_PRIMAL_HEURISTIC,	1039, initial_primal_heuristic,	 0, 1, 0) \
  f(INITIAL_PRIMAL_HEUR_STOP,	1040, initial_primal_heur_stop,	 0, 1, 0) \
  f(LOCALCUTS_TRACE_STYLE,	1041, local_cuts_trace_style,	 0, 1, 0) \
+ f(NUM_THREADS,			1042, num_threads,		 1, 1024, 1) \
+ f(LOCAL_CUTS_CACHE_SIZE,	1043, local_cuts_cache_size,	 0, INT_MAX, 64) \
+ f(BB_NODE_MEMORY_LIMIT,	1044, bb_node_memory_limit,	 0, INT_MAX, 0) \
+ f(SOLVER_DECOMPOSITION,	1045, solver_decomposition,	 0, 1, 0) \
 	/* end of list */
 
 /* Define all of the DOUBLE parameters right here. */
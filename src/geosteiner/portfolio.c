@@ -0,0 +1,332 @@
+/***********************************************************************
+
+	File:	portfolio.c
+	Rev:	e-1
+	Date:	10/19/2026
+
+	This work is licensed under a Creative Commons
+	Attribution-NonCommercial 4.0 International License.
+
+************************************************************************
+
+	Race the backtrack search against the branch-and-cut, each
+	on its own thread, sharing the best solution found so far.
+
+************************************************************************/
+
+#include "portfolio.h"
+
+#include "btsearch.h"
+#include "fatal.h"
+#include <float.h>
+#include "geosteiner.h"
+#include "logic.h"
+#include "memory.h"
+#include "solver.h"
+#include <stdlib.h>
+#include "steiner.h"
+#include <string.h>
+#include "threads.h"
+
+
+/*
+ * Global Routines
+ */
+
+bool			_gst_finish_portfolio (struct portfolio * pp);
+double			_gst_portfolio_bound (struct gst_solver * solver);
+void			_gst_portfolio_export (struct gst_solver * solver,
+					       double		length,
+					       bitmap_t *	smt);
+bool			_gst_portfolio_import (struct gst_solver * solver);
+struct portfolio *	_gst_start_portfolio (struct gst_solver * solver);
+
+
+/*
+ * Local Types
+ */
+
+struct portfolio {
+	struct gst_mutex	lock;		/* protects what follows */
+	double			best_length;	/* best solution posted */
+	bitmap_t *		best;		/* edges of that solution */
+
+	int			nmasks;		/* size of best[] */
+	struct gst_solver *	solver;		/* solver doing branch-and-cut */
+	struct gst_solver *	clone;		/* solver doing backtrack */
+	struct gst_thread	thread;		/* thread doing backtrack */
+	bool			bt_done;	/* backtrack search was */
+						/* exhaustive */
+};
+
+
+/*
+ * Local Routines
+ */
+
+static void		free_portfolio (struct portfolio *);
+static void		run_backtrack (void *);
+
+/*
+ * Start racing the backtrack search against the branch-and-cut that
+ * the caller is about to run with the given solver.  The backtrack
+ * search uses a copy of the solver, with its own set of solutions.
+ * Returns NULL if the second thread could not be started.
+ */
+
+	struct portfolio *
+_gst_start_portfolio (
+
+struct gst_solver *	solver		/* IN - solver about to do B&C */
+)
+{
+int			nmasks;
+struct portfolio *	pp;
+struct gst_solver *	clone;
+
+	nmasks = solver -> H -> num_edge_masks;
+
+	pp = NEW (struct portfolio);
+	memset (pp, 0, sizeof (*pp));
+
+	_gst_mutex_init (&(pp -> lock));
+	pp -> nmasks		= nmasks;
+	pp -> best		= NEWA (nmasks, bitmap_t);
+	memset (pp -> best, 0, nmasks * sizeof (bitmap_t));
+	pp -> best_length	= DBL_MAX;
+	if (solver -> nsols > 0) {
+		pp -> best_length = solver -> solutions [0].length;
+		memcpy (pp -> best,
+			solver -> solutions [0].edge_mask,
+			nmasks * sizeof (bitmap_t));
+	}
+
+	/* The copy shares the hypergraph and parameters, which	*/
+	/* neither algorithm modifies.				*/
+	clone = NEW (struct gst_solver);
+	*clone = *solver;
+	clone -> ubip			= NULL;
+	clone -> bbip			= NULL;
+	clone -> proplist		= NULL;
+	clone -> nsols			= 0;
+	clone -> feasible_updates	= 0;
+	clone -> preempt		= GST_SOLVE_NORMAL;
+	clone -> bb_callback_func	= NULL;
+	clone -> bb_callback_data	= NULL;
+	clone -> solutions = NEWA (solver -> solsize, struct gst_hg_solution);
+	memset (clone -> solutions,
+		0,
+		solver -> solsize * sizeof (struct gst_hg_solution));
+	clone -> portfolio		= pp;
+	clone -> cutshare		= NULL;
+
+	pp -> solver	= solver;
+	pp -> clone	= clone;
+	pp -> bt_done	= FALSE;
+
+	solver -> portfolio = pp;
+
+	if (NOT _gst_start_thread (&(pp -> thread), run_backtrack, pp)) {
+		solver -> portfolio = NULL;
+		free_portfolio (pp);
+		return (NULL);
+	}
+
+	return (pp);
+}
+
+/*
+ * The thread that runs the backtrack search.  If the search is not
+ * interrupted, it has found an optimal solution (or shown that there
+ * is none better than the bound it was given), and there is no point
+ * in continuing the branch-and-cut.
+ */
+
+	static
+	void
+run_backtrack (
+
+void *		arg		/* IN - the portfolio */
+)
+{
+struct portfolio *	pp;
+
+	pp = (struct portfolio *) arg;
+
+	_gst_backtrack_search (pp -> clone);
+
+	if (LOAD_ACQUIRE (&(pp -> clone -> preempt)) EQ GST_SOLVE_NORMAL) {
+		pp -> bt_done = TRUE;
+		PREEMPT_SOLVER (pp -> solver, GST_SOLVE_BB_STOP_REQUESTED);
+	}
+}
+
+/*
+ * The branch-and-cut has returned.  Stop the backtrack search, wait
+ * for it, and merge its solutions into those of the main solver.
+ * Returns TRUE if the backtrack search is what completed the solution
+ * process, in which case the preemption it caused is undone.
+ */
+
+	bool
+_gst_finish_portfolio (
+
+struct portfolio *	pp		/* IN - portfolio to finish */
+)
+{
+int			i;
+bool			won;
+struct gst_solver *	solver;
+struct gst_solver *	clone;
+struct gst_hg_solution * sols;
+
+	solver	= pp -> solver;
+	clone	= pp -> clone;
+
+	PREEMPT_SOLVER (clone, GST_SOLVE_BB_STOP_REQUESTED);
+
+	_gst_join_thread (&(pp -> thread));
+
+	solver -> portfolio = NULL;
+
+	sols = clone -> solutions;
+	for (i = 0; i < clone -> nsols; i++) {
+		_gst_update_best_solution_set (solver,
+					       NULL,
+					       sols [i].nedges,
+					       sols [i].edges,
+					       NULL);
+	}
+
+	won = FALSE;
+	if (pp -> bt_done AND
+	    (LOAD_ACQUIRE (&(solver -> preempt)) NE GST_SOLVE_NORMAL)) {
+		STORE_RELEASE (&(solver -> preempt), GST_SOLVE_NORMAL);
+		won = TRUE;
+	}
+
+	free_portfolio (pp);
+
+	return (won);
+}
+
+/*
+ * Free up the portfolio, along with the copy of the solver.
+ */
+
+	static
+	void
+free_portfolio (
+
+struct portfolio *	pp		/* IN - portfolio to free */
+)
+{
+int			i;
+struct gst_solver *	clone;
+
+	clone = pp -> clone;
+	for (i = 0; i < clone -> nsols; i++) {
+		free ((char *) (clone -> solutions [i].edges));
+		free ((char *) (clone -> solutions [i].edge_mask));
+	}
+	free ((char *) (clone -> solutions));
+	free ((char *) clone);
+
+	free ((char *) (pp -> best));
+	_gst_mutex_destroy (&(pp -> lock));
+	free ((char *) pp);
+}
+
+/*
+ * Post a new best solution of the given solver, so that the other
+ * algorithm can use it.
+ */
+
+	void
+_gst_portfolio_export (
+
+struct gst_solver *	solver,		/* IN - solver with new best */
+double			length,		/* IN - length of solution */
+bitmap_t *		smt		/* IN - edges of solution */
+)
+{
+struct portfolio *	pp;
+
+	pp = solver -> portfolio;
+	if (pp EQ NULL) {
+		return;
+	}
+
+	_gst_mutex_lock (&(pp -> lock));
+	if (length < pp -> best_length) {
+		pp -> best_length = length;
+		memcpy (pp -> best, smt, pp -> nmasks * sizeof (bitmap_t));
+	}
+	_gst_mutex_unlock (&(pp -> lock));
+}
+
+/*
+ * If the other algorithm has posted a solution that is better than
+ * the given solver's upper bound, add it to the solver's solutions.
+ * Returns TRUE if the solver thereby has a new best solution.
+ */
+
+	bool
+_gst_portfolio_import (
+
+struct gst_solver *	solver		/* IN - solver to update */
+)
+{
+bool			res;
+bitmap_t *		mask;
+struct portfolio *	pp;
+
+	pp = solver -> portfolio;
+	if (pp EQ NULL) {
+		return (FALSE);
+	}
+
+	mask = NULL;
+	_gst_mutex_lock (&(pp -> lock));
+	if (pp -> best_length < solver -> upperbound) {
+		mask = NEWA (pp -> nmasks, bitmap_t);
+		memcpy (mask, pp -> best, pp -> nmasks * sizeof (bitmap_t));
+	}
+	_gst_mutex_unlock (&(pp -> lock));
+
+	if (mask EQ NULL) {
+		return (FALSE);
+	}
+
+	res = _gst_update_best_solution_set (solver, NULL, 0, NULL, mask);
+
+	free ((char *) mask);
+
+	return (res);
+}
+
+/*
+ * Return the length of the best solution posted so far, or DBL_MAX
+ * if there is none.
+ */
+
+	double
+_gst_portfolio_bound (
+
+struct gst_solver *	solver		/* IN - solver to query */
+)
+{
+double			length;
+struct portfolio *	pp;
+
+	pp = solver -> portfolio;
+	if (pp EQ NULL) {
+		return (DBL_MAX);
+	}
+
+	_gst_mutex_lock (&(pp -> lock));
+	length = pp -> best_length;
+	_gst_mutex_unlock (&(pp -> lock));
+
+	return (length);
+}
@@ -0,0 +1,49 @@
+/***********************************************************************
+
+	File:	portfolio.h
+	Rev:	e-1
+	Date:	10/19/2026
+
+	This work is licensed under a Creative Commons
+	Attribution-NonCommercial 4.0 International License.
+
+************************************************************************
+
+	Declarations for racing the backtrack search against the
+	branch-and-cut.
+
+************************************************************************/
+
+#ifndef	PORTFOLIO_H
+#define	PORTFOLIO_H
+
+#include "bitmaskmacros.h"
+#include "gsttypes.h"
+
+struct gst_solver;
+
+
+/*
+ * While the branch-and-cut runs on the caller's thread, a copy of the
+ * solver runs the backtrack search on a second thread.  Whenever
+ * either of them finds a new best solution, it is posted to the
+ * portfolio, and the other one picks it up from there as its upper
+ * bound.  The first of the two to finish stops the other.
+ */
+
+struct portfolio;
+
+
+/*
+ * Global Routines
+ */
+
+extern bool		_gst_finish_portfolio (struct portfolio * pp);
+extern double		_gst_portfolio_bound (struct gst_solver * solver);
+extern void		_gst_portfolio_export (struct gst_solver * solver,
+					       double		length,
+					       bitmap_t *	smt);
+extern bool		_gst_portfolio_import (struct gst_solver * solver);
+extern struct portfolio * _gst_start_portfolio (struct gst_solver * solver);
+
+#endif
@@ -43,10 +43,9 @@ bool		restore_fp; \
 struct fpsave	fpsave; \
 	GST_PRELUDE_OPEN_CHECK \
 	restore_fp = FALSE; \
-	/* FIXME - this is not thread-safe. */ \
-	if (NOT gst_env -> fp_saved) { \
+	if (NOT _gst_fp_is_saved) { \
 		_gst_set_floating_point_configuration (&fpsave); \
-		gst_env -> fp_saved = TRUE; \
+		_gst_fp_is_saved = TRUE; \
 		restore_fp = TRUE; \
 	}
 
@@ -63,10 +62,9 @@ bool		restore_fp; \
 	}
 
 #define GST_POSTLUDE \
-	/* FIXME - this is not thread-safe. */ \
 	if (restore_fp) { \
 		_gst_restore_floating_point_configuration (&fpsave); \
-		gst_env -> fp_saved = FALSE; \
+		_gst_fp_is_saved = FALSE; \
 	}
 
 #endif
@@ -33,6 +33,8 @@
 /* Columns are symbol and value. */
 #define HG_PROPS(f) \
  f(HALF_FST_COUNT,		10000) \
+ f(MP_FILTERED_COUNT,		10001) \
+ f(MP_ESCALATED_COUNT,		10002) \
  f(GENERATION_TIME,		20000) \
  f(MST_LENGTH,			20001) \
  f(PRUNING_TIME,		20002) \
@@ -61,6 +63,8 @@
  f(CPU_TIME,			21000) \
  f(ROOT_TIME,			21001) \
  f(ROOT_LENGTH,			21002) \
+ f(NODE_MEMORY,			21003) \
+ f(NODE_MEMORY_PER_NODE,	21004) \
 	/* end of list */
 
 #endif
@@ -52,6 +52,7 @@
 #include "emst.h"
 #include "fatal.h"
 #include <float.h>
+#include "fstfuncs.h"
 #include "geosteiner.h"
 #include "greedy.h"
 #include "incompat.h"
@@ -67,6 +68,7 @@
 #include "solver.h"
 #include "steiner.h"
 #include <string.h>
+#include "threads.h"
 
 /*
  * Global Routines
@@ -86,6 +88,10 @@ gst_hg_ptr		gst_hg_prune_edges (gst_hg_ptr, gst_param_ptr, int *);
 #endif
 
 #define INCOMPAT_STEP_SIZE		8
+#define DEPS_STEP_SIZE			4
+
+/* Number of FSTs tested ahead by each thread in parallel scans. */
+#define PRUNE_BATCH_SIZE		32
 
 /*
  * Local Types
@@ -105,6 +111,12 @@ struct clt_info {
 	int				aterm2;
 };
 
+struct fst_deps {
+	int *				list;	/* FSTs to retest */
+	int				count;	/* number of FSTs in list */
+	int				size;	/* allocated size of list */
+};
+
 struct pinfo {
 	struct gst_hypergraph *		cip;
 	int				num_pg_edges;
@@ -120,6 +132,59 @@ struct pinfo {
 	gst_param_ptr			params;
 	gst_param_ptr			upper_bound_params;
 	gst_metric_ptr			metric;
+
+	/* Worklist of FSTs that prune_this_fst() must (re)test. */
+	bitmap_t *			pending;
+	struct fst_deps *		deps;	/* FSTs depending on each FST */
+
+	/* Pruning graph edges at each vertex, for searching. */
+	int **				pg_adj;
+};
+
+/*
+ * Scratch data for testing FSTs.  Each thread has its own.
+ */
+
+struct ptest {
+	bitmap_t *			compat_mask; /* FSTs usable in test */
+	int *				inclist; /* FSTs incompatible with it */
+	struct inc_info			inc_info; /* scratch for inclist */
+	int *				queue;	/* vertices to visit */
+	int *				vstamp;	/* search that visited vertex */
+	int				search_num; /* current search number */
+	int *				fst_stamp; /* test that last used FST */
+	int				test_num; /* current test number */
+	int *				used;	/* FSTs the test depended on */
+	int				nused;	/* number of FSTs in used */
+	int *				saved;	/* used lists of earlier tests */
+	int				nsaved;	/* number of ints in saved */
+	int				saved_size; /* allocated size of saved */
+};
+
+/*
+ * The outcome of testing an FST ahead of time.
+ */
+
+struct pspec {
+	int				fst;	/* FST tested */
+	bool				prune;	/* TRUE if FST can be pruned */
+	int				worker;	/* thread that tested it */
+	int				start;	/* used list in its saved */
+	int				count;	/* length of used list */
+};
+
+/*
+ * State of a (possibly parallel) scan over the worklist.
+ */
+
+struct pscan {
+	struct pinfo *			pip;
+	int				nthreads; /* number of threads */
+	struct ptest			serial;	/* tests using current state */
+	struct ptest *			workers; /* NULL if only one thread */
+	struct pspec *			spec;	/* FSTs tested ahead */
+	int				nspec;	/* number of FSTs in spec */
+	int				max_spec; /* allocated size of spec */
 };
 
 struct incompat {
@@ -153,11 +218,14 @@ struct bc3 {
  * Local Routines
  */
 
+static void		add_dependent (struct pinfo *, int, int);
 static void		add_incompat (struct incompat **, int, int, int *);
+static bool		all_still_present (struct gst_hypergraph *, int *, int);
 static int		bcc_find_required (struct gst_hypergraph *,
 					   int *,
 					   int);
 static void		bcc3 (struct bc3 *, int);
+static void		build_pg_adjacency (struct pinfo *);
 static void		check_for_invalid_fsts (struct gst_hypergraph * H);
 static int		comp_ints (const void *, const void *);
 static int		comp_pg_edges (const void *, const void *);
@@ -171,6 +239,10 @@ static void		compute_incompatibility_info (struct pinfo *,
 static void		compute_pruning_info (struct gst_hypergraph *,
 					      struct bsd *,
 					      struct pinfo *);
+static void		free_pscan (struct pscan *);
+static void		free_ptest (struct ptest *);
+static void		init_pscan (struct pinfo *, struct pscan *, int);
+static void		init_ptest (struct pinfo *, struct ptest *, bitmap_t *);
 static void		init_upper_bound_params (struct pinfo *);
 static bool		passes_upper_bound_tests (struct pinfo *, struct bsd *, int, int,
 						  int *, struct pset *, bitmap_t *, int *, bitmap_t *);
@@ -179,9 +251,15 @@ static void		prune_fsts (struct gst_hypergraph *,
 				    struct bsd *,
 				    double,
 				    gst_param_ptr);
-static bool		prune_this_fst (struct gst_hypergraph *,
-					struct pinfo *,
-					int);
+static int		prune_pending_fsts (struct pscan *);
+static bool		prune_this_fst (struct pinfo *, struct ptest *, int);
+static bool		pg_connected (struct pinfo *,
+				      struct ptest *,
+				      int,
+				      struct clt_info *);
+static void		remove_fst (struct pinfo *, int);
+static int		speculate (struct pscan *, int);
+static void		speculate_worker (int, void *);
 static dist_t		terminal_edge_distance (struct gst_hypergraph *,
 						struct point *,
 						struct point *,
@@ -190,6 +268,8 @@ static dist_t		terminal_edge_distance (struct gst_hypergraph *,
 						dist_t *);
 static void		test_close_terminal (struct pinfo *, struct bsd *, struct full_set *,
 					     int, int, struct clt_info **);
+static bool		test_fst (struct pinfo *, struct ptest *, int);
+static void		use_fst (struct ptest *, int, int);
 static void		zap_deleted_fsts (struct gst_hypergraph *);
 
 
@@ -261,7 +341,9 @@ int			j;
 	default_eps = (params -> eps_mult_factor) * DBL_EPSILON;
 	nedges = 0;
 	if (_gst_is_euclidean (H)) {
-		nedges	= _gst_euclidean_mst (H -> pts, mst_edges);
+		nedges	= _gst_euclidean_mst (H -> pts,
+					      mst_edges,
+					      params -> num_threads);
 	}
 	else if (_gst_is_rectilinear (H)) {
 		empty_rect = _gst_init_empty_rectangles (H -> pts, NULL);
@@ -392,6 +474,7 @@ bool			changed;
 bool			all_pairs_tested;
 struct dsuf		comps;
 struct pinfo		pinfo;
+struct pscan		pscan;
 int *			lvlist;
 struct pset *		ltlist;
 bitmap_t *		ltmask;
@@ -451,6 +534,7 @@ gst_channel_ptr		timing;
 	/* Perform thorough upper bound test for every not-yet pruned FST */
 	pruned_total = 0;
 	for (i = 0; i < nedges; i++) {
+		if (_gst_fst_generation_stopped ()) break;
 
 		if (BITON (cip -> initial_edge_mask, i)) {
 			if (NOT passes_upper_bound_tests (&pinfo, BSD, i, -1,
@@ -491,6 +575,21 @@ gst_channel_ptr		timing;
 	comps_edge = NEWA (cip -> num_verts, int);
 	made_req   = NEWA (nedges, int);
 
+	/* Set up the worklist.  Initially every undecided FST must be	*/
+	/* tested.  Thereafter, an FST is only retested when one of the	*/
+	/* FSTs it depended upon gets pruned (see prune_this_fst).	*/
+	pinfo.pending	= NEWA (nmasks, bitmap_t);
+	pinfo.deps	= NEWA (nedges, struct fst_deps);
+	memset (pinfo.deps, 0, nedges * sizeof (pinfo.deps [0]));
+	for (i = 0; i < nmasks; i++) {
+		pinfo.pending [i] = cip -> initial_edge_mask [i]
+				    & ~(cip -> required_edges [i]);
+	}
+
+	build_pg_adjacency (&pinfo);
+
+	init_pscan (&pinfo, &pscan, params -> num_threads);
+
 	/* Perform actual pruning */
 	if (timing) {
 		char buf [32];
@@ -503,38 +602,11 @@ gst_channel_ptr		timing;
 	scan = 1;
     for (;;) {
 	for (; scan < nedges; scan++) {
+		/* Being stopped: keep what has been pruned so far. */
+		if (_gst_fst_generation_stopped ()) goto stop;
 
 		old_pruned_total   = pruned_total;
-		for (i = 0; i < nedges; i++) {
-			if ((BITON (cip -> initial_edge_mask, i)) AND
-			   (NOT BITON (cip -> required_edges, i))) {
-
-				/* Get list of incompatible edges */
-				numinc = _gst_get_incompat_edges (inclist,
-								  i,
-								  &inc_info);
-
-				/* Set up mask of compatible FSTs */
-				for (k = 0; k < numinc; k++) {
-					j = inclist [k];
-					CLRBIT (pinfo.compat_mask, j);
-				}
-
-				/* Test if FST can be pruned */
-				if (prune_this_fst(cip, &pinfo, i)) {
-					CLRBIT (cip -> initial_edge_mask, i);
-					CLRBIT (pinfo.compat_mask, i);
-					pruned_total++;
-				}
-
-				/* Reset mask */
-				for (k = 0; k < numinc; k++) {
-					j = inclist [k];
-					if (BITON (cip -> initial_edge_mask, j))
-						SETBIT (pinfo.compat_mask, j);
-				}
-			}
-		}
+		pruned_total += prune_pending_fsts (&pscan);
 
 		/* Test if any connected component (initially one
 		   for each terminal) only has one adjacent FST */
@@ -635,8 +707,7 @@ gst_channel_ptr		timing;
 						/* fatal: FST already required */
 						FATAL_ERROR;
 					}
-					CLRBIT (cip -> initial_edge_mask, i);
-					CLRBIT (pinfo.compat_mask, i);
+					remove_fst (&pinfo, i);
 					pruned_total++;
 				}
 			}
@@ -657,8 +728,7 @@ gst_channel_ptr		timing;
 						r2 = _gst_dsuf_find (&comps, *vp);
 
 						if (r1 EQ r2) { /* cycle created - remove FST */
-							CLRBIT (cip -> initial_edge_mask, i);
-							CLRBIT (pinfo.compat_mask, i);
+							remove_fst (&pinfo, i);
 							pruned_total++;
 							vp = vp1 = vp2;
 							break;
@@ -699,8 +769,15 @@ gst_channel_ptr		timing;
 
 	if (NOT changed) break;
 
-	/* We found new incompatibilities.  Prune those undecided ones	*/
-	/* that are incompatible to a required FST.			*/
+	/* We found new incompatibilities.  These change what every	*/
+	/* FST is compatible with, so all of them must be retested.	*/
+	for (i = 0; i < nmasks; i++) {
+		pinfo.pending [i] = cip -> initial_edge_mask [i]
+				    & ~(cip -> required_edges [i]);
+	}
+
+	/* Prune those undecided ones that are incompatible to a	*/
+	/* required FST.						*/
 
 	for (fsave = 0; fsave < nedges; fsave++) {
 		if (NOT BITON (cip -> required_edges, fsave)) continue;
@@ -714,14 +791,14 @@ gst_channel_ptr		timing;
 					/* fatal: FST already required */
 					FATAL_ERROR;
 				}
-				CLRBIT (cip -> initial_edge_mask, i);
-				CLRBIT (pinfo.compat_mask, i);
+				remove_fst (&pinfo, i);
 				pruned_total++;
 			}
 		}
 	}
     }
 
+stop:
 	if (timing) {
 		gst_channel_printf (timing, "- pruning finished: before: %d  after: %d  required: %d\n",
 			nedges, nedges - pruned_total, required_total);
@@ -743,6 +820,17 @@ gst_channel_ptr		timing;
 
 	_gst_dsuf_destroy (&comps);
 
+	for (i = 0; i < nedges; i++) {
+		if (pinfo.deps [i].list NE NULL) {
+			free ((char *) (pinfo.deps [i].list));
+		}
+	}
+	free_pscan (&pscan);
+	free ((char *) (pinfo.pg_adj [0]));
+	free ((char *) pinfo.pg_adj);
+	free ((char *) pinfo.deps);
+	free ((char *) pinfo.pending);
+
 	free ((char *) made_req);
 	free ((char *) comps_edge);
 
@@ -808,6 +896,7 @@ int *			vp2;
 int *			ep;
 int *			ep1;
 int *			ep2;
+struct full_set *	fsp;
 
 	/* First we count the number of FSTs that remain */
 	/* and set up map from old to new edge index */
@@ -876,8 +965,13 @@ int *			ep2;
 	if (cip -> full_trees NE NULL) {
 		for (i = 0; i < cip -> num_edges; i++) {
 			if (ni[i] >= 0) {
-				cip -> full_trees [ ni[i] ] = cip -> full_trees [i];
-				cip -> full_trees [ ni[i] ] -> tree_num = ni[i];
+				fsp = cip -> full_trees [i];
+				if (fsp -> tree_num NE ni[i]) {
+					/* Renumbering modifies the FST. */
+					fsp = _gst_unshare_full_set (fsp);
+					fsp -> tree_num = ni[i];
+				}
+				cip -> full_trees [ ni[i] ] = fsp;
 			}
 			else {
 				/* Free FST data */
@@ -966,72 +1060,660 @@ int *		ep2;
 }
 
 /*
- * Check if a given FST can be pruned
+ * Set up the scratch data for testing FSTs, using the given number of
+ * threads.
+ */
+
+	static
+	void
+init_pscan (
+
+struct pinfo *		pip,		/* IN - pruning data structure */
+struct pscan *		ps,		/* OUT - scan state */
+int			nthreads	/* IN - number of threads to use */
+)
+{
+int			i;
+int			nmasks;
+struct ptest *		tp;
+
+	nmasks = pip -> cip -> num_edge_masks;
+
+	ps -> pip	= pip;
+	ps -> nthreads	= _gst_effective_threads (nthreads);
+	ps -> workers	= NULL;
+	ps -> spec	= NULL;
+	ps -> nspec	= 0;
+	ps -> max_spec	= 0;
+
+	/* Serial tests toggle the compatibility mask in place. */
+	init_ptest (pip, &(ps -> serial), pip -> compat_mask);
+
+	if (ps -> nthreads <= 1) return;
+
+	/* Each thread tests against its own copy of the mask. */
+	ps -> workers = NEWA (ps -> nthreads, struct ptest);
+	for (i = 0; i < ps -> nthreads; i++) {
+		tp = &(ps -> workers [i]);
+		init_ptest (pip, tp, NEWA (nmasks, bitmap_t));
+	}
+	ps -> max_spec	= PRUNE_BATCH_SIZE * ps -> nthreads;
+	ps -> spec	= NEWA (ps -> max_spec, struct pspec);
+}
+
+/*
+ * Free up the scratch data for testing FSTs.
+ */
+
+	static
+	void
+free_pscan (
+
+struct pscan *		ps		/* IN - scan state to free */
+)
+{
+int			i;
+struct ptest *		tp;
+
+	if (ps -> workers NE NULL) {
+		for (i = 0; i < ps -> nthreads; i++) {
+			tp = &(ps -> workers [i]);
+			free ((char *) (tp -> compat_mask));
+			free_ptest (tp);
+		}
+		free ((char *) (ps -> workers));
+		free ((char *) (ps -> spec));
+	}
+	free_ptest (&(ps -> serial));
+}
+
+/*
+ * Set up the scratch data for testing FSTs in one thread.  The
+ * compatibility mask belongs to the caller.
+ */
+
+	static
+	void
+init_ptest (
+
+struct pinfo *		pip,		/* IN - pruning data structure */
+struct ptest *		tp,		/* OUT - scratch data */
+bitmap_t *		compat_mask	/* IN - mask to use in tests */
+)
+{
+int			nverts;
+int			nedges;
+
+	/* The extra vertex is the dummy attachment point used by	*/
+	/* test_close_terminal().					*/
+	nverts = pip -> num_pg_verts + 1;
+	nedges = pip -> cip -> num_edges;
+
+	tp -> compat_mask	= compat_mask;
+	tp -> inclist		= NEWA (nedges, int);
+	tp -> queue		= NEWA (nverts, int);
+	tp -> vstamp		= NEWA (nverts, int);
+	tp -> search_num	= 0;
+	tp -> fst_stamp		= NEWA (nedges, int);
+	tp -> test_num		= 0;
+	tp -> used		= NEWA (nedges, int);
+	tp -> nused		= 0;
+	tp -> saved		= NULL;
+	tp -> nsaved		= 0;
+	tp -> saved_size	= 0;
+
+	memset (tp -> vstamp, 0, nverts * sizeof (int));
+	memset (tp -> fst_stamp, 0, nedges * sizeof (int));
+
+	_gst_startup_incompat_edges (&(tp -> inc_info), pip -> cip);
+}
+
+/*
+ * Free up the scratch data for testing FSTs in one thread.
+ */
+
+	static
+	void
+free_ptest (
+
+struct ptest *		tp		/* IN - scratch data to free */
+)
+{
+	_gst_shutdown_incompat_edges (&(tp -> inc_info));
+
+	if (tp -> saved NE NULL) {
+		free ((char *) (tp -> saved));
+	}
+	free ((char *) (tp -> used));
+	free ((char *) (tp -> fst_stamp));
+	free ((char *) (tp -> vstamp));
+	free ((char *) (tp -> queue));
+	free ((char *) (tp -> inclist));
+}
+
+/*
+ * Test every FST on the worklist once, in order, pruning those that
+ * can be pruned.  FSTs put back on the worklist by a removal are
+ * tested in this same scan if they come later in the order.  Return
+ * the number of FSTs pruned.
+ *
+ * With several threads, the next batch of FSTs on the worklist is
+ * first tested ahead of time, in parallel, against the state at the
+ * start of the batch.  The results are then committed in order.  A
+ * test reads only the FSTs it depends upon, so its outcome (and its
+ * list of dependencies) is exactly what a serial test would give,
+ * unless one of these FSTs was removed earlier in the batch.  Such
+ * FSTs are simply tested again.  Thus the FSTs pruned are exactly the
+ * same as when using a single thread.
+ */
+
+	static
+	int
+prune_pending_fsts (
+
+struct pscan *		ps		/* IN - scan state */
+)
+{
+int			i;
+int			j;
+int			k;
+int			nedges;
+int			nused;
+int			limit;
+int			pruned;
+int *			used;
+bool			prune;
+struct pinfo *		pip;
+struct gst_hypergraph *	cip;
+struct pspec *		sp;
+
+	pip	= ps -> pip;
+	cip	= pip -> cip;
+	nedges	= cip -> num_edges;
+
+	pruned	= 0;
+	limit	= 0;
+	k	= 0;
+	ps -> nspec = 0;
+
+	for (i = 0; i < nedges; i++) {
+		if (((i % BPW) EQ 0) AND (pip -> pending [i / BPW] EQ 0)) {
+			/* Skip a whole word of FSTs not to retest. */
+			i += BPW - 1;
+			continue;
+		}
+		if (NOT BITON (pip -> pending, i)) continue;
+		if (_gst_fst_generation_stopped ()) break;
+
+		if ((ps -> workers NE NULL) AND (i >= limit)) {
+			limit = speculate (ps, i);
+			k = 0;
+		}
+
+		CLRBIT (pip -> pending, i);
+
+		if (NOT BITON (cip -> initial_edge_mask, i)) continue;
+		if (BITON (cip -> required_edges, i)) continue;
+
+		while ((k < ps -> nspec) AND (ps -> spec [k].fst < i)) {
+			++k;
+		}
+		sp = NULL;
+		if ((k < ps -> nspec) AND (ps -> spec [k].fst EQ i)) {
+			sp = &(ps -> spec [k]);
+			used = &(ps -> workers [sp -> worker].saved [sp -> start]);
+			nused = sp -> count;
+			if (NOT all_still_present (cip, used, nused)) {
+				/* Result is stale -- test this FST again. */
+				sp = NULL;
+			}
+		}
+
+		if (sp NE NULL) {
+			prune = sp -> prune;
+		}
+		else {
+			prune = test_fst (pip, &(ps -> serial), i);
+			used = ps -> serial.used;
+			nused = ps -> serial.nused;
+		}
+
+		for (j = 0; j < nused; j++) {
+			add_dependent (pip, used [j], i);
+		}
+
+		if (prune) {
+			remove_fst (pip, i);
+			++pruned;
+		}
+	}
+
+	return (pruned);
+}
+
+/*
+ * Test the next batch of undecided FSTs on the worklist (starting at
+ * FST FIRST) in parallel.  Return the index of the first FST beyond
+ * the batch.
  */
+
+	static
+	int
+speculate (
+
+struct pscan *		ps,		/* IN/OUT - scan state */
+int			first		/* IN - first FST to consider */
+)
+{
+int			i;
+int			w;
+int			nedges;
+int			nmasks;
+struct pinfo *		pip;
+struct gst_hypergraph *	cip;
+
+	pip	= ps -> pip;
+	cip	= pip -> cip;
+	nedges	= cip -> num_edges;
+	nmasks	= cip -> num_edge_masks;
+
+	ps -> nspec = 0;
+	for (i = first; i < nedges; i++) {
+		if (ps -> nspec >= ps -> max_spec) break;
+		if (((i % BPW) EQ 0) AND (pip -> pending [i / BPW] EQ 0)) {
+			i += BPW - 1;
+			continue;
+		}
+		if (NOT BITON (pip -> pending, i)) continue;
+		if (NOT BITON (cip -> initial_edge_mask, i)) continue;
+		if (BITON (cip -> required_edges, i)) continue;
+		ps -> spec [(ps -> nspec)++].fst = i;
+	}
+
+	for (w = 0; w < ps -> nthreads; w++) {
+		memcpy (ps -> workers [w].compat_mask,
+			pip -> compat_mask,
+			nmasks * sizeof (bitmap_t));
+		ps -> workers [w].nsaved = 0;
+	}
+
+	_gst_run_workers (ps -> nthreads, speculate_worker, ps);
+
+	return (i);
+}
+
+/*
+ * Test this worker's share of the batch of FSTs.  Nothing but the
+ * worker's own scratch data and its share of the results is written.
+ */
+
+	static
+	void
+speculate_worker (
+
+int			id,		/* IN - worker number */
+void *			arg		/* IN - scan state */
+)
+{
+int			k;
+int			first;
+int			last;
+int			size;
+int *			saved;
+struct pscan *		ps;
+struct ptest *		tp;
+struct pspec *		sp;
+
+	ps = (struct pscan *) arg;
+	tp = &(ps -> workers [id]);
+
+	_gst_split_range (ps -> nspec, ps -> nthreads, id, &first, &last);
+	for (k = first; k < last; k++) {
+		sp = &(ps -> spec [k]);
+		sp -> prune	= test_fst (ps -> pip, tp, sp -> fst);
+		sp -> worker	= id;
+		sp -> start	= tp -> nsaved;
+		sp -> count	= tp -> nused;
+
+		/* Keep the FSTs this test depended upon. */
+		if (tp -> nsaved + tp -> nused > tp -> saved_size) {
+			size = 2 * tp -> saved_size + tp -> nused;
+			saved = NEWA (size, int);
+			if (tp -> saved NE NULL) {
+				memcpy (saved,
+					tp -> saved,
+					tp -> nsaved * sizeof (int));
+				free ((char *) (tp -> saved));
+			}
+			tp -> saved = saved;
+			tp -> saved_size = size;
+		}
+		memcpy (&(tp -> saved [tp -> nsaved]),
+			tp -> used,
+			tp -> nused * sizeof (int));
+		tp -> nsaved += tp -> nused;
+	}
+}
+
+/*
+ * Return TRUE if none of the given FSTs has been removed.
+ */
+
 	static
 	bool
-prune_this_fst (
+all_still_present (
 
 struct gst_hypergraph *	cip,		/* IN - compatibility info */
+int *			list,		/* IN - list of FSTs */
+int			n		/* IN - number of FSTs in list */
+)
+{
+int			i;
+
+	for (i = 0; i < n; i++) {
+		if (NOT BITON (cip -> initial_edge_mask, list [i])) {
+			return (FALSE);
+		}
+	}
+	return (TRUE);
+}
+
+/*
+ * Test whether a given FST can be pruned, using the given scratch
+ * data.  The FSTs incompatible with it are temporarily removed from
+ * the compatibility mask.  On return, the used list holds the FSTs
+ * that the outcome depends upon.
+ */
+
+	static
+	bool
+test_fst (
+
+struct pinfo *		pip,		/* IN - pruning data structure */
+struct ptest *		tp,		/* IN/OUT - scratch data */
+int			fst		/* IN - FST to test */
+)
+{
+int			j;
+int			k;
+int			numinc;
+bool			prune;
+
+	/* Get list of incompatible edges */
+	numinc = _gst_get_incompat_edges (tp -> inclist,
+					  fst,
+					  &(tp -> inc_info));
+
+	/* Set up mask of compatible FSTs */
+	for (k = 0; k < numinc; k++) {
+		j = tp -> inclist [k];
+		CLRBIT (tp -> compat_mask, j);
+	}
+
+	tp -> nused = 0;
+	prune = prune_this_fst (pip, tp, fst);
+
+	/* Reset mask */
+	for (k = 0; k < numinc; k++) {
+		j = tp -> inclist [k];
+		if (BITON (pip -> cip -> initial_edge_mask, j)) {
+			SETBIT (tp -> compat_mask, j);
+		}
+	}
+
+	return (prune);
+}
+
+/*
+ * Check if a given FST can be pruned.  This is the case if some close
+ * terminal is not connected to its attachment points in the pruning
+ * graph, using only edges of compatible FSTs that are no longer than
+ * the distance to the terminal.
+ */
+	static
+	bool
+prune_this_fst (
+
 struct pinfo *	pip,		/* IN - pruning data structure */
+struct ptest *	tp,		/* IN/OUT - scratch data */
 int		fst
 )
 {
-int			i;
 int			clt_count;
 int			curr_clt;
-int			root;
-int			root1;
-int			root2;
-bool			prune_fst;
-struct dsuf		comps;
-struct pg_edge *	pg_edge;
+dist_t			longest;
 struct clt_info *	clt;
 
 	clt_count = pip -> clt_count [fst];
 	if (clt_count == 0) return FALSE;
+	if (pip -> num_pg_edges <= 0) return FALSE;
 
-	/* Create disjoint set */
-	_gst_dsuf_create (&comps, pip -> num_pg_verts + 1);
-	for (i = 0; i < pip -> num_pg_verts + 1; i++)
-		_gst_dsuf_makeset (&comps, i);
-
-	/* Add pruning graph edges (in sorted order) */
+	++(tp -> test_num);
 
-	prune_fst = FALSE;
-	curr_clt  = 0;
-	clt = &(pip -> clt_info [fst][curr_clt]);
-	for (i = 0; i < pip -> num_pg_edges; i++) {
-		pg_edge = &(pip -> pg_edges[i]);
-		while (pg_edge -> len > clt -> dist) {
-			root  = _gst_dsuf_find (&comps, clt -> term);
-			root1 = _gst_dsuf_find (&comps, clt -> aterm1);
-			root2 = _gst_dsuf_find (&comps, clt -> aterm2);
-
-			if ((root NE root1) AND (root NE root2)) {
-				prune_fst = TRUE; /* This FST can be pruned! */
-				goto prune_exit;
-			}
+	longest = pip -> pg_edges [pip -> num_pg_edges - 1].len;
 
-			curr_clt++;
-			if (curr_clt >= clt_count)
-				goto prune_exit; /* This FST cannot be pruned... */
-			clt = &(pip -> clt_info [fst][curr_clt]);
+	/* The close terminals are sorted by distance. */
+	for (curr_clt = 0; curr_clt < clt_count; curr_clt++) {
+		clt = &(pip -> clt_info [fst][curr_clt]);
+		if (clt -> dist >= longest) {
+			/* Every terminal is connected at this distance. */
+			break;
+		}
+		if (NOT pg_connected (pip, tp, fst, clt)) {
+			return (TRUE);	/* This FST can be pruned! */
 		}
+	}
+
+	return (FALSE);
+}
+
+/*
+ * Determine whether the given close terminal is connected to one of
+ * its attachment points in the pruning graph, using compatible edges
+ * no longer than the distance to the terminal.  We search from the
+ * terminal, breadth-first, so the work done only depends on the size
+ * of its component, not on the size of the entire pruning graph, and
+ * nearby attachment points are found quickly.
+ *
+ * The outcome only depends upon the edges in the search tree.  As
+ * long as none of their FSTs is removed, testing this FST again gives
+ * the same answer.  Therefore we record each such FST in the used
+ * list, so that the FST being tested can be made a dependent of it.
+ */
 
-		/* Add edge if FST is not deleted or incompatible */
-		if (BITON (pip -> compat_mask, pg_edge -> fst)) {
-			root1 = _gst_dsuf_find (&comps, pg_edge -> p1);
-			root2 = _gst_dsuf_find (&comps, pg_edge -> p2);
-			if (root1 NE root2)
-				_gst_dsuf_unite (&comps, root1, root2);
+	static
+	bool
+pg_connected (
+
+struct pinfo *		pip,		/* IN - pruning data structure */
+struct ptest *		tp,		/* IN/OUT - scratch data */
+int			fst,		/* IN - FST being tested */
+struct clt_info *	clt		/* IN - close terminal to check */
+)
+{
+int			v;
+int			w;
+int			search;
+int *			head;
+int *			tail;
+int *			ep1;
+int *			ep2;
+struct pg_edge *	pg_edge;
+
+	if ((clt -> term EQ clt -> aterm1) OR (clt -> term EQ clt -> aterm2)) {
+		return (TRUE);
+	}
+
+	search = ++(tp -> search_num);
+
+	head = tp -> queue;
+	tail = head;
+	tp -> vstamp [clt -> term] = search;
+	*tail++ = clt -> term;
+	while (head < tail) {
+		v = *head++;
+		ep1 = pip -> pg_adj [v];
+		ep2 = pip -> pg_adj [v + 1];
+		for (; ep1 < ep2; ep1++) {
+			/* Edges at each vertex are sorted by length. */
+			pg_edge = &(pip -> pg_edges [*ep1]);
+			if (pg_edge -> len > clt -> dist) break;
+			if (NOT BITON (tp -> compat_mask, pg_edge -> fst)) continue;
+			w = (pg_edge -> p1 EQ v) ? pg_edge -> p2 : pg_edge -> p1;
+			if (tp -> vstamp [w] EQ search) continue;
+			tp -> vstamp [w] = search;
+			use_fst (tp, pg_edge -> fst, fst);
+			if ((w EQ clt -> aterm1) OR (w EQ clt -> aterm2)) {
+				return (TRUE);
+			}
+			*tail++ = w;
 		}
+	}
+
+	return (FALSE);
+}
+
+/*
+ * Note that the outcome of testing FST DEP depends upon FST FST.
+ */
+
+	static
+	void
+use_fst (
+
+struct ptest *		tp,		/* IN/OUT - scratch data */
+int			fst,		/* IN - FST depended upon */
+int			dep		/* IN - FST being tested */
+)
+{
+	if (fst EQ dep) return;
+
+	/* Record each FST only once per test. */
+	if (tp -> fst_stamp [fst] EQ tp -> test_num) return;
+	tp -> fst_stamp [fst] = tp -> test_num;
 
+	tp -> used [(tp -> nused)++] = fst;
+}
+
+/*
+ * Build the list of pruning graph edges incident to each vertex.
+ * Since the edges are sorted by length, so are these lists.
+ */
+
+	static
+	void
+build_pg_adjacency (
+
+struct pinfo *		pip		/* IN/OUT - pruning data structure */
+)
+{
+int			i;
+int			nverts;
+int *			count;
+int *			ip;
+struct pg_edge *	pg_edge;
+
+	/* The extra vertex is the dummy attachment point used by	*/
+	/* test_close_terminal().  It has no edges.			*/
+	nverts = pip -> num_pg_verts + 1;
+
+	count = NEWA (nverts, int);
+	memset (count, 0, nverts * sizeof (int));
+	for (i = 0; i < pip -> num_pg_edges; i++) {
+		pg_edge = &(pip -> pg_edges [i]);
+		++(count [pg_edge -> p1]);
+		++(count [pg_edge -> p2]);
 	}
-	prune_exit:
 
-	_gst_dsuf_destroy (&comps);
-	return prune_fst;
+	pip -> pg_adj = NEWA (nverts + 1, int *);
+	ip = NEWA (2 * pip -> num_pg_edges + 1, int);
+	for (i = 0; i < nverts; i++) {
+		pip -> pg_adj [i] = ip;
+		ip += count [i];
+	}
+	pip -> pg_adj [i] = ip;
+
+	/* Fill in the lists, using the counts as fill pointers. */
+	for (i = 0; i < nverts; i++) {
+		count [i] = 0;
+	}
+	for (i = 0; i < pip -> num_pg_edges; i++) {
+		pg_edge = &(pip -> pg_edges [i]);
+		pip -> pg_adj [pg_edge -> p1] [(count [pg_edge -> p1])++] = i;
+		pip -> pg_adj [pg_edge -> p2] [(count [pg_edge -> p2])++] = i;
+	}
+
+	free ((char *) count);
+}
+
+/*
+ * Record that the outcome of testing FST DEP depends upon FST FST.
+ */
+
+	static
+	void
+add_dependent (
+
+struct pinfo *		pip,		/* IN - pruning data structure */
+int			fst,		/* IN - FST depended upon */
+int			dep		/* IN - FST being tested */
+)
+{
+int			size;
+int *			list;
+struct fst_deps *	dp;
+
+	dp = &(pip -> deps [fst]);
+	if (dp -> count >= dp -> size) {
+		size = 2 * dp -> size + DEPS_STEP_SIZE;
+		list = NEWA (size, int);
+		if (dp -> list NE NULL) {
+			memcpy (list, dp -> list, dp -> count * sizeof (int));
+			free ((char *) (dp -> list));
+		}
+		dp -> list = list;
+		dp -> size = size;
+	}
+	dp -> list [(dp -> count)++] = dep;
+}
+
+/*
+ * Remove the given FST, and put each undecided FST whose pruning test
+ * depended upon it back on the worklist.
+ */
+
+	static
+	void
+remove_fst (
+
+struct pinfo *		pip,		/* IN - pruning data structure */
+int			fst		/* IN - FST to remove */
+)
+{
+int			i;
+int			j;
+struct fst_deps *	dp;
+struct gst_hypergraph *	cip;
+
+	cip = pip -> cip;
+
+	CLRBIT (cip -> initial_edge_mask, fst);
+	CLRBIT (pip -> compat_mask, fst);
+
+	dp = &(pip -> deps [fst]);
+	for (i = 0; i < dp -> count; i++) {
+		j = dp -> list [i];
+		if ((BITON (cip -> initial_edge_mask, j)) AND
+		    (NOT BITON (cip -> required_edges, j))) {
+			SETBIT (pip -> pending, j);
+		}
+	}
+	if (dp -> list NE NULL) {
+		free ((char *) (dp -> list));
+	}
+	dp -> list	= NULL;
+	dp -> count	= 0;
+	dp -> size	= 0;
 }
 
 /*
@@ -1189,6 +1871,8 @@ gst_param_ptr		params;
 	*changed = FALSE;
 	*all_pairs_tested = TRUE;
 	for (i = 0; i < nedges; i++) {
+		/* Being stopped: missing incompatibilities do no harm. */
+		if (_gst_fst_generation_stopped ()) break;
 		if (NOT BITON (edge_mask, i)) continue;
 		if (cip -> edge_size [i] >= max_pair) {
 			/* Must test this one later. */
@@ -1474,6 +2158,12 @@ gst_param_ptr		params;
 			buf);
 	}
 	for (i = 0; i < nedges; i++) {
+		if (_gst_fst_generation_stopped ()) {
+			/* No more pruning will be done. */
+			pip -> clt_count [i] = 0;
+			pip -> clt_info [i]  = NULL;
+			continue;
+		}
 
 		/* Mark terminals in current FST */
 		vp1 = cip -> edge [i];
@@ -0,0 +1,498 @@
+/***********************************************************************
+
+	File:	radixsort.c
+	Rev:	e-1
+	Date:	10/19/2026
+
+	This work is licensed under a Creative Commons
+	Attribution-NonCommercial 4.0 International License.
+
+************************************************************************
+
+	Sort edges, points and floating point keys using a stable
+	LSD radix sort on 64-bit keys.  Large inputs are sorted
+	using several threads.
+
+************************************************************************/
+
+#include "sortfuncs.h"
+
+#include "fatal.h"
+#include "gsttypes.h"
+#include "logic.h"
+#include "memory.h"
+#include "point.h"
+#include "steiner.h"
+#include <stdlib.h>
+#include <string.h>
+#include "threads.h"
+
+
+/*
+ * Global Routines
+ */
+
+void		_gst_sort_edges (struct edge * a, int n, int nthreads);
+int *		_gst_sort_keys (int n, dist_t * keys, int nthreads);
+int *		_gst_sort_points_x (struct pset * pts, int nthreads);
+int *		_gst_sort_points_y (struct pset * pts, int nthreads);
+
+
+/*
+ * Local Constants
+ */
+
+#define	RADIX_BITS		8
+#define	RADIX			(1 << RADIX_BITS)
+#define	NUM_DIGITS		(64 / RADIX_BITS)
+
+/* Inputs smaller than this are sorted by straight insertion. */
+#define	SMALL_SORT		32
+
+/* Each thread gets at least this many items to sort. */
+#define	PARALLEL_SORT_MIN	65536
+
+
+/*
+ * Local Types
+ */
+
+struct rkey {
+	int64u		key;		/* sort key */
+	int		index;		/* item having this key */
+};
+
+struct rsort {
+	int		n;		/* number of items */
+	int		nthreads;	/* number of workers */
+	int		shift;		/* current digit position */
+	struct rkey *	src;		/* items to scatter */
+	struct rkey *	dst;		/* where to scatter them */
+	int *		counts;		/* RADIX counters per worker */
+};
+
+
+/*
+ * Local Routines
+ */
+
+static void		count_digits (int, void *);
+static int64u		double_key (double);
+static void		insertion_sort (struct rkey *, int);
+static void		radix_sort (struct rkey *, struct rkey *, int, int);
+static void		scatter_digits (int, void *);
+static void		sort_by_keys (int, int, int64u **, int *, int);
+
+/*
+ * Sort the given edge list in INCREASING order by edge length.
+ * Edges of equal length are ordered lexicographically by their
+ * (smaller vertex, larger vertex) pair.
+ */
+
+	void
+_gst_sort_edges (
+
+struct edge *		a,		/* IN/OUT - edges to sort */
+int			n,		/* IN - number of edges */
+int			nthreads	/* IN - number of threads to use */
+)
+{
+int		i;
+int		v1;
+int		v2;
+int *		perm;
+int64u *	keys [2];
+struct edge *	tmp;
+
+	if (n <= 1) return;
+
+	keys [0] = NEWA (n, int64u);
+	keys [1] = NEWA (n, int64u);
+	for (i = 0; i < n; i++) {
+		v1 = a [i].p1;
+		v2 = a [i].p2;
+		if (v1 > v2) {
+			v1 = a [i].p2;
+			v2 = a [i].p1;
+		}
+		keys [0] [i] = double_key (a [i].len);
+		keys [1] [i] = (((int64u) ((int32u) v1)) << 32) | ((int32u) v2);
+	}
+
+	perm = NEWA (n, int);
+	sort_by_keys (n, 2, keys, perm, nthreads);
+
+	tmp = NEWA (n, struct edge);
+	for (i = 0; i < n; i++) {
+		tmp [i] = a [perm [i]];
+	}
+	memcpy (a, tmp, n * sizeof (struct edge));
+
+	free ((char *) tmp);
+	free ((char *) perm);
+	free ((char *) keys [1]);
+	free ((char *) keys [0]);
+}
+
+/*
+ * Sort the given terminals in increasing order by the following keys:
+ *
+ *	1.	X coordinate
+ *	2.	Y coordinate
+ *	3.	index (i.e., position within input data)
+ *
+ * Of course, we do not move the points, but rather return an array
+ * of indexes into the points.
+ */
+
+	int *
+_gst_sort_points_x (
+
+struct pset *		pts,		/* IN - the terminals to sort */
+int			nthreads	/* IN - number of threads to use */
+)
+{
+int		i;
+int		n;
+int *		index;
+int64u *	keys [2];
+
+	n = pts -> n;
+
+	keys [0] = NEWA (n, int64u);
+	keys [1] = NEWA (n, int64u);
+	for (i = 0; i < n; i++) {
+		keys [0] [i] = double_key (pts -> a [i].x);
+		keys [1] [i] = double_key (pts -> a [i].y);
+	}
+
+	index = NEWA (n, int);
+	sort_by_keys (n, 2, keys, index, nthreads);
+
+	free ((char *) keys [1]);
+	free ((char *) keys [0]);
+
+	return (index);
+}
+
+/*
+ * Sort the given terminals in increasing order by the following keys:
+ *
+ *	1.	Y coordinate
+ *	2.	X coordinate
+ *	3.	index (i.e., position within input data)
+ */
+
+	int *
+_gst_sort_points_y (
+
+struct pset *		pts,		/* IN - the terminals to sort */
+int			nthreads	/* IN - number of threads to use */
+)
+{
+int		i;
+int		n;
+int *		index;
+int64u *	keys [2];
+
+	n = pts -> n;
+
+	keys [0] = NEWA (n, int64u);
+	keys [1] = NEWA (n, int64u);
+	for (i = 0; i < n; i++) {
+		keys [0] [i] = double_key (pts -> a [i].y);
+		keys [1] [i] = double_key (pts -> a [i].x);
+	}
+
+	index = NEWA (n, int);
+	sort_by_keys (n, 2, keys, index, nthreads);
+
+	free ((char *) keys [1]);
+	free ((char *) keys [0]);
+
+	return (index);
+}
+
+/*
+ * Return an array of indexes 0 through N-1 sorted in increasing order
+ * by the given keys.  Items having equal keys remain in index order.
+ */
+
+	int *
+_gst_sort_keys (
+
+int			n,		/* IN - number of keys */
+dist_t *		keys,		/* IN - the keys to sort by */
+int			nthreads	/* IN - number of threads to use */
+)
+{
+int		i;
+int *		index;
+int64u *	ikeys;
+
+	ikeys = NEWA (n, int64u);
+	for (i = 0; i < n; i++) {
+		ikeys [i] = double_key (keys [i]);
+	}
+
+	index = NEWA (n, int);
+	sort_by_keys (n, 1, &ikeys, index, nthreads);
+
+	free ((char *) ikeys);
+
+	return (index);
+}
+
+/*
+ * Compute the permutation PERM that sorts items 0 through N-1 by the
+ * given keys.  KEYS [0] is the most significant key and KEYS [NKEYS-1]
+ * the least significant.  Ties are broken by item index.  We do a
+ * stable sort on each key in turn, starting with the least
+ * significant one.
+ */
+
+	static
+	void
+sort_by_keys (
+
+int		n,		/* IN - number of items */
+int		nkeys,		/* IN - number of keys per item */
+int64u **	keys,		/* IN - the keys of each item */
+int *		perm,		/* OUT - sorted order of the items */
+int		nthreads	/* IN - number of threads to use */
+)
+{
+int		i;
+int		j;
+int64u *	kp;
+struct rkey *	a;
+struct rkey *	tmp;
+
+	FATAL_ERROR_IF (sizeof (int64u) NE sizeof (double));
+
+	for (i = 0; i < n; i++) {
+		perm [i] = i;
+	}
+	if (n <= 1) return;
+
+	nthreads = _gst_effective_threads (nthreads);
+	if (nthreads > n / PARALLEL_SORT_MIN) {
+		nthreads = n / PARALLEL_SORT_MIN;
+	}
+	if (nthreads < 1) {
+		nthreads = 1;
+	}
+
+	a	= NEWA (n, struct rkey);
+	tmp	= NEWA (n, struct rkey);
+
+	for (j = nkeys - 1; j >= 0; j--) {
+		kp = keys [j];
+		for (i = 0; i < n; i++) {
+			a [i].key	= kp [perm [i]];
+			a [i].index	= perm [i];
+		}
+		if (n <= SMALL_SORT) {
+			insertion_sort (a, n);
+		}
+		else {
+			radix_sort (a, tmp, n, nthreads);
+		}
+		for (i = 0; i < n; i++) {
+			perm [i] = a [i].index;
+		}
+	}
+
+	free ((char *) tmp);
+	free ((char *) a);
+}
+
+/*
+ * Stable LSD radix sort of the given items by key.  TMP is scratch
+ * space for N items.  Digits that are the same in every key are
+ * skipped.  Each worker counts and then scatters its own contiguous
+ * slice of the items, so the sort is stable no matter how many
+ * threads are used.
+ */
+
+	static
+	void
+radix_sort (
+
+struct rkey *	a,		/* IN/OUT - items to sort */
+struct rkey *	tmp,		/* IN - scratch space */
+int		n,		/* IN - number of items */
+int		nthreads	/* IN - number of threads to use */
+)
+{
+int		i;
+int		d;
+int		w;
+int		pos;
+int		count;
+int		shift;
+int64u		first;
+int64u		diff;
+struct rkey *	t;
+struct rsort	info;
+
+	/* Find the digits in which some keys differ. */
+	first = a [0].key;
+	diff = 0;
+	for (i = 1; i < n; i++) {
+		diff |= (a [i].key ^ first);
+	}
+
+	info.n		= n;
+	info.nthreads	= nthreads;
+	info.src	= a;
+	info.dst	= tmp;
+	info.counts	= NEWA (nthreads * RADIX, int);
+
+	for (shift = 0; shift < 64; shift += RADIX_BITS) {
+		if (((diff >> shift) & (RADIX - 1)) EQ 0) continue;
+
+		info.shift = shift;
+		_gst_run_workers (nthreads, count_digits, &info);
+
+		/* Turn the counts into starting positions, by digit	*/
+		/* first and then by worker.				*/
+		pos = 0;
+		for (d = 0; d < RADIX; d++) {
+			for (w = 0; w < nthreads; w++) {
+				count = info.counts [w * RADIX + d];
+				info.counts [w * RADIX + d] = pos;
+				pos += count;
+			}
+		}
+
+		_gst_run_workers (nthreads, scatter_digits, &info);
+
+		t		= info.src;
+		info.src	= info.dst;
+		info.dst	= t;
+	}
+
+	if (info.src NE a) {
+		memcpy (a, info.src, n * sizeof (struct rkey));
+	}
+
+	free ((char *) info.counts);
+}
+
+/*
+ * Count the current digit of each item in this worker's slice.
+ */
+
+	static
+	void
+count_digits (
+
+int		id,		/* IN - worker number */
+void *		arg		/* IN - sort state */
+)
+{
+int		i;
+int		first;
+int		last;
+int		shift;
+int *		counts;
+struct rkey *	src;
+struct rsort *	rp;
+
+	rp = (struct rsort *) arg;
+	shift	= rp -> shift;
+	src	= rp -> src;
+	counts	= &(rp -> counts [id * RADIX]);
+
+	memset (counts, 0, RADIX * sizeof (int));
+
+	_gst_split_range (rp -> n, rp -> nthreads, id, &first, &last);
+	for (i = first; i < last; i++) {
+		++(counts [(src [i].key >> shift) & (RADIX - 1)]);
+	}
+}
+
+/*
+ * Move each item in this worker's slice to its place in the output.
+ */
+
+	static
+	void
+scatter_digits (
+
+int		id,		/* IN - worker number */
+void *		arg		/* IN - sort state */
+)
+{
+int		i;
+int		first;
+int		last;
+int		shift;
+int *		counts;
+struct rkey *	src;
+struct rkey *	dst;
+struct rsort *	rp;
+
+	rp = (struct rsort *) arg;
+	shift	= rp -> shift;
+	src	= rp -> src;
+	dst	= rp -> dst;
+	counts	= &(rp -> counts [id * RADIX]);
+
+	_gst_split_range (rp -> n, rp -> nthreads, id, &first, &last);
+	for (i = first; i < last; i++) {
+		dst [counts [(src [i].key >> shift) & (RADIX - 1)]++] = src [i];
+	}
+}
+
+/*
+ * Stable straight insertion sort of a few items by key.
+ */
+
+	static
+	void
+insertion_sort (
+
+struct rkey *	a,		/* IN/OUT - items to sort */
+int		n		/* IN - number of items */
+)
+{
+int		i;
+int		j;
+struct rkey	tmp;
+
+	for (i = 1; i < n; i++) {
+		tmp = a [i];
+		for (j = i; j > 0; j--) {
+			if (a [j - 1].key <= tmp.key) break;
+			a [j] = a [j - 1];
+		}
+		a [j] = tmp;
+	}
+}
+
+/*
+ * Map a double to an unsigned 64-bit integer having the same order.
+ * Positive numbers get their sign bit set, negative numbers have all
+ * their bits flipped.  Minus zero is treated as zero.
+ */
+
+	static
+	int64u
+double_key (
+
+double		x		/* IN - value to map */
+)
+{
+int64u		u;
+
+	if (x EQ 0.0) {
+		x = 0.0;
+	}
+	memcpy (&u, &x, sizeof (u));
+	if ((u >> 63) NE 0) {
+		return (~u);
+	}
+	return (u | (((int64u) 1) << 63));
+}
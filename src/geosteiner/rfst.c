@@ -250,7 +250,7 @@ gst_proplist_ptr	plist;
 	T0 = _gst_get_cpu_time ();
 	Tn = T0;
 
-	rinfo.x_order = _gst_heapsort_x (pts);
+	rinfo.x_order = _gst_sort_points_x (pts, params -> num_threads);
 
 	if (timing NE NULL) {
 		_gst_convert_delta_cpu_time (buf1, &Tn);
@@ -283,7 +283,8 @@ gst_proplist_ptr	plist;
 		gst_channel_printf (timing, "Remove Duplicates:      %s\n", buf1);
 	}
 
-	rinfo.y_order = _gst_heapsort_y (pts2);
+	rinfo.y_order = _gst_sort_points_y (pts2,
+					     params -> num_threads);
 
 	if (timing NE NULL) {
 		_gst_convert_delta_cpu_time (buf1, &Tn);
@@ -521,6 +522,7 @@ gst_channel_ptr		timing;
 
 	for (dir = 0; dir < 2; dir++) {
 		for (i = 0; i < n; i++) {
+			if (_gst_fst_generation_stopped ()) break;
 			rip -> terms [0]	= i;
 			rip -> maxedges [i]	= 0.0;
 			/* Long leg candidate list is initially empty,	*/
@@ -1684,6 +1686,7 @@ found_rfst:
 	fsp -> steiners		= new_steiners;
 	fsp -> nedges		= nedges;
 	fsp -> edges		= edges;
+	fsp -> refcount		= 1;
 
 	rp = NEW (struct rlist);
 
@@ -2109,6 +2112,7 @@ struct full_set *	fsp;
 			fsp -> steiners	 = NULL;
 			fsp -> nedges	 = 1;
 			fsp -> edges	 = edges;
+			fsp -> refcount	 = 1;
 
 			*(rip -> hookp) = fsp;
 			rip -> hookp	= &(fsp -> next);
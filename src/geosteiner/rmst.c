@@ -40,11 +40,13 @@
 #include "dsuf.h"
 #include "emptyr.h"
 #include "fatal.h"
+#include "fstfuncs.h"
 #include "logic.h"
 #include <math.h>
 #include "memory.h"
 #include "mst.h"
 #include "point.h"
+#include "sortfuncs.h"
 #include <stdlib.h>
 #include "steiner.h"
 #include <string.h>
@@ -71,6 +73,7 @@ dist_t		_gst_rect_mst_length (struct pset *);
  * Local Routines
  */
 
+static int		build_octant_edges (struct pset *, struct edge **);
 static int		build_rect_edges (struct pset *,
 					  struct edge **,
 					  int,
@@ -119,7 +122,9 @@ struct edge *	edges;
  * The caller may optionally provide an empty rectangle bit-matrix.
  * This info can substantially speed up the algorithm and decrease
  * memory requirements by limiting the number of edges stored and sorted.
- * If such info is unavailable, supply empty_rect = NULL.
+ * If such info is unavailable, supply empty_rect = NULL, and we use
+ * the nearest neighbor of each point in each octant instead.  (This
+ * may break ties between equal edges differently.)
  */
 
 	int
@@ -134,7 +139,13 @@ int		nedges;
 int		mst_edge_count;
 struct edge *	edge_array;
 
-	nedges = build_rect_edges (pts, &edge_array, 0, empty_rect);
+	if ((empty_rect EQ NULL) OR _gst_fst_generation_stopped ()) {
+		/* The empty rectangles may have been cut short. */
+		nedges = build_octant_edges (pts, &edge_array);
+	}
+	else {
+		nedges = build_rect_edges (pts, &edge_array, 0, empty_rect);
+	}
 
 	mst_edge_count = _gst_mst_edge_list (pts -> n,
 					     nedges,
@@ -223,6 +234,149 @@ struct point *	p2;
 	return (nedges);
 }
 
+/*
+ * This routine builds a sparse edge-list that contains a rectilinear
+ * MST of the given points: each point is joined to its nearest neighbor
+ * in each octant of the plane around it.  Only four octants need be
+ * searched -- the other four give the same edges seen from the other
+ * end.  Reflecting the points maps each of these four octants onto
+ * the octant {q : x(q) >= x(p), y(q) - x(q) >= y(p) - x(p)}, in which
+ * the nearest neighbor of p is the point having least x(q) + y(q).
+ * We find it by sweeping the points in decreasing X order, keeping
+ * the points already swept in a Fenwick tree indexed by the rank of
+ * y - x.  This gives at most 4N edges in O(N log N) time.
+ */
+
+	static
+	int
+build_octant_edges (
+
+struct pset *		pts,		/* IN - set of points */
+struct edge **		edges_out	/* OUT - edge list */
+)
+{
+int		i;
+int		j;
+int		k;
+int		n;
+int		r;
+int		dir;
+int		nedges;
+int *		rank;
+int *		best;
+int *		order;
+int *		order2;
+int *		order3;
+dist_t		t;
+dist_t *	x;
+dist_t *	y;
+dist_t *	key;
+struct edge *	edges;
+
+	n = pts -> n;
+
+	x	= NEWA (n, dist_t);
+	y	= NEWA (n, dist_t);
+	key	= NEWA (n, dist_t);
+	rank	= NEWA (n, int);
+	best	= NEWA (n, int);
+	order	= NEWA (n, int);
+	edges	= NEWA (4 * n + 1, struct edge);
+
+	for (i = 0; i < n; i++) {
+		x [i] = pts -> a [i].x;
+		y [i] = pts -> a [i].y;
+	}
+
+	nedges = 0;
+	for (dir = 0; dir < 4; dir++) {
+		/* Reflect the points onto the next octant. */
+		if (dir EQ 2) {
+			for (i = 0; i < n; i++) {
+				x [i] = - x [i];
+			}
+		}
+		else if (dir NE 0) {
+			for (i = 0; i < n; i++) {
+				t = x [i];  x [i] = y [i];  y [i] = t;
+			}
+		}
+
+		/* Rank the points by y - x, equal values sharing a rank. */
+		for (i = 0; i < n; i++) {
+			key [i] = y [i] - x [i];
+		}
+		order2 = _gst_sort_keys (n, key, 1);
+		r = 0;
+		for (k = 0; k < n; k++) {
+			if ((k > 0) AND (key [order2 [k]] NE key [order2 [k - 1]])) {
+				++r;
+			}
+			/* Reverse the ranks so that the octant is a prefix. */
+			rank [order2 [k]] = n - r;
+		}
+		free ((char *) order2);
+
+		/* Sweep by decreasing X, ties by decreasing Y. */
+		for (i = 0; i < n; i++) {
+			key [i] = - y [i];
+		}
+		order2 = _gst_sort_keys (n, key, 1);
+		for (k = 0; k < n; k++) {
+			key [k] = - x [order2 [k]];
+		}
+		order3 = _gst_sort_keys (n, key, 1);
+		for (k = 0; k < n; k++) {
+			order [k] = order2 [order3 [k]];
+		}
+		free ((char *) order3);
+		free ((char *) order2);
+
+		for (i = 0; i < n; i++) {
+			best [i] = -1;
+		}
+		for (k = 0; k < n; k++) {
+			i = order [k];
+			/* Nearest point already swept in the octant of i. */
+			j = -1;
+			for (r = rank [i]; r > 0; r -= (r & -r)) {
+				if ((best [r - 1] >= 0) AND
+				    ((j < 0) OR
+				     (x [best [r - 1]] + y [best [r - 1]] <
+				      x [j] + y [j]))) {
+					j = best [r - 1];
+				}
+			}
+			if (j >= 0) {
+				/* List each edge as all-pairs would. */
+				edges [nedges].len = RDIST (&(pts -> a [i]),
+							    &(pts -> a [j]));
+				edges [nedges].p1  = (i < j) ? i : j;
+				edges [nedges].p2  = (i < j) ? j : i;
+				++nedges;
+			}
+			for (r = rank [i]; r <= n; r += (r & -r)) {
+				if ((best [r - 1] < 0) OR
+				    (x [i] + y [i] <
+				     x [best [r - 1]] + y [best [r - 1]])) {
+					best [r - 1] = i;
+				}
+			}
+		}
+	}
+
+	free ((char *) order);
+	free ((char *) best);
+	free ((char *) rank);
+	free ((char *) key);
+	free ((char *) y);
+	free ((char *) x);
+
+	*edges_out = edges;
+
+	return (nedges);
+}
+
 /*
  * This routine computes an approximate Steiner Minimal Tree using the
  * heuristic method of Kahng and Robins.
@@ -361,7 +515,7 @@ struct dsuf	sets;
 
 	nedges = build_rect_edges (pts, &edge_array, max_edges, NULL);
 
-	_gst_sort_edge_list (&edge_array [0], nedges);
+	_gst_sort_edges (&edge_array [0], nedges, 1);
 
 	/* We know that build-edges gives us edges having vertices	*/
 	/* in the range of 0 through nterms - 1, so we don't have to	*/
@@ -429,8 +583,9 @@ struct dsuf	sets;
 					++new_nedges;
 					++ep2;
 				}
-				_gst_sort_edge_list (&new_edges [0],
-						     new_nedges);
+				_gst_sort_edges (&new_edges [0],
+						 new_nedges,
+						 1);
 
 				for (m = 0; m <= n; m++) {
 					_gst_dsuf_makeset (&sets, m);
@@ -504,7 +659,7 @@ struct dsuf	sets;
 			++ep;
 			++new_nedges;
 		}
-		_gst_sort_edge_list (&new_edges [0], new_nedges);
+		_gst_sort_edges (&new_edges [0], new_nedges, 1);
 		ep1	= &edge_array [0];
 		endp1	= ep1 + nedges;
 		ep2	= &new_edges [0];
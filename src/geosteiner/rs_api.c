@@ -1,4 +1,6 @@
 #include "geosteiner.h"
+#include "point.h"
+#include "steiner.h"
 #include "stdlib.h"
 
 struct C_ESMT {
@@ -35,3 +37,105 @@ struct C_ESMT rs_compute_esmt (int nterms, double * terms)
 
 	return c_esmt;
 }
+
+/*
+ * Accessors used by the safe Rust wrappers.  They hand out pointers into
+ * the hypergraph itself, which stay valid until the hypergraph is changed
+ * or freed.
+ */
+
+struct C_HG {
+int nverts;
+int nedges;
+const int * edge_sizes;
+const double * costs;
+const int * vertices;
+};
+
+struct C_FST {
+int nterms;
+const int * tlist;
+const struct point * terms;
+int nsps;
+const struct point * sps;
+int nedges;
+const struct edge * edges;
+};
+
+int rs_hg_info (gst_hg_ptr H, struct C_HG * out)
+    {
+    if (H == NULL) {
+        return GST_ERR_INVALID_HYPERGRAPH;
+    }
+
+    out -> nverts = H -> num_verts;
+    out -> nedges = H -> num_edges;
+    out -> edge_sizes = H -> edge_size;
+    out -> costs = H -> cost;
+    out -> vertices = (H -> edge != NULL) ? H -> edge [0] : NULL;
+
+    return 0;
+}
+
+int rs_hg_fst (gst_hg_ptr H, int e, struct C_FST * out)
+    {
+    struct full_set * fst;
+
+    if (H == NULL) {
+        return GST_ERR_INVALID_HYPERGRAPH;
+    }
+    if ((e < 0) || (e >= H -> num_edges)) {
+        return GST_ERR_INVALID_EDGE;
+    }
+    if (H -> full_trees == NULL) {
+        return GST_ERR_NO_EMBEDDING;
+    }
+
+    fst = H -> full_trees [e];
+    out -> nterms = fst -> terminals -> n;
+    out -> tlist = fst -> tlist;
+    out -> terms = fst -> terminals -> a;
+    out -> nsps = (fst -> steiners != NULL) ? fst -> steiners -> n : 0;
+    out -> sps = (fst -> steiners != NULL) ? fst -> steiners -> a : NULL;
+    out -> nedges = fst -> nedges;
+    out -> edges = fst -> edges;
+
+    return 0;
+}
+
+int rs_save_hg (const char * path, gst_hg_ptr H, gst_param_ptr param)
+    {
+    int status;
+    FILE * fp;
+
+    fp = fopen (path, "wb");
+    if (fp == NULL) {
+        return GST_ERR_UNDEFINED;
+    }
+
+    status = gst_save_hg (fp, H, param);
+
+    if (fclose (fp) != 0 && status == 0) {
+        status = GST_ERR_UNDEFINED;
+    }
+
+    return status;
+}
+
+gst_hg_ptr rs_load_hg (const char * path, gst_param_ptr param, int * status)
+    {
+    gst_hg_ptr H;
+    FILE * fp;
+
+    fp = fopen (path, "rb");
+    if (fp == NULL) {
+        *status = GST_ERR_UNDEFINED;
+        return NULL;
+    }
+
+    H = gst_load_hg (fp, param, status);
+
+    fclose (fp);
+
+    return H;
+}
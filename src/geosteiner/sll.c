@@ -100,8 +100,6 @@ static void		add_fst (struct pset *		pts,
 				 int *			fst_count,
 				 dist_t			mst_l);
 static dist_t		fst_length (struct pset *, int *);
-static int		compare_edge_length (int, int, void *);
-static int		compare_fst_ratio (int, int, void *);
 
 
 /*
@@ -192,59 +190,6 @@ dist_t			min_length;
 	return (0.0);
 }
 
-/*
- * Compares edges by length. Returns TRUE if the first edge is shorter than
- * the second edge or if they are equal in length but with first index smaller
- * than the second index. Otherwise FALSE is returned.
- */
-	static
-	int
-compare_edge_length
-(
-
-int	i1,	/* IN - first index */
-int	i2,	/* IN - second index */
-void *	array	/* IN - array to be sorted */
-)
-{
-dist_t			key1, key2;
-
-	key1 = ((struct sll_edge *)array)[i1].len;
-	key2 = ((struct sll_edge *)array)[i2].len;
-
-	if ((key1 < key2) OR
-	    ((key1 EQ key2) AND (i1 < i2)))
-		return (-1);
-
-	return (1);
-}
-
-/*
- * Compare fsts by ratio.
- */
-	static
-	int
-compare_fst_ratio
-(
-
-int	i1,	/* IN - first index */
-int	i2,	/* IN - second index */
-void *	array	/* IN - array to be sorted */
-)
-{
-dist_t			key1, key2;
-
-	key1 = ((struct sll_fst *) array) [i1].ratio;
-	key2 = ((struct sll_fst *) array) [i2].ratio;
-
-	if ((key1 < key2) OR
-	    ((key1 EQ key2) AND (i1 < i2))) {
-		return (-1);
-	}
-
-	return (1);
-}
-
 /*
  * Add generated FST to list of FSTs
  */
@@ -314,6 +259,7 @@ int *			neighborlist;
 int *			triangleedges;
 int *			sortededges;
 int *			sortedfsts;
+dist_t *		keys;
 dist_t			mst_l, total_mst_l, outgoing_mst_edge_l;
 dist_t			total_smt_l, mx, my;
 struct point		minp, maxp;
@@ -430,9 +376,12 @@ struct sll_fst *	sll_fsts;
 
 	/* Sort edges */
 
-	sortededges = _gst_heapsort (numberofedges,
-				     sll_edges,
-				     compare_edge_length);
+	keys = NEWA (numberofedges, dist_t);
+	for (i = 0; i < numberofedges; i++) {
+		keys [i] = sll_edges [i].len;
+	}
+	sortededges = _gst_sort_keys (numberofedges, keys, 1);
+	free (keys);
 
 	/* Use Kruskal to find MST */
 
@@ -570,7 +519,12 @@ struct sll_fst *	sll_fsts;
 
 	/* Sort FSTs */
 
-	sortedfsts = _gst_heapsort (fst_count, sll_fsts, compare_fst_ratio);
+	keys = NEWA (fst_count, dist_t);
+	for (i = 0; i < fst_count; i++) {
+		keys [i] = sll_fsts [i].ratio;
+	}
+	sortedfsts = _gst_sort_keys (fst_count, keys, 1);
+	free (keys);
 
 	/* Build heuristic tree */
 
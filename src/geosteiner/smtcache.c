@@ -0,0 +1,1103 @@
+/***********************************************************************
+
+	File:	smtcache.c
+	Rev:	e-1
+	Date:	10/19/2026
+
+	This work is licensed under a Creative Commons
+	Attribution-NonCommercial 4.0 International License.
+
+************************************************************************
+
+	A cache of solved SMT instances, in front of gst_smt().
+	Instances are looked up by a canonical form that identifies
+	copies of each other under the symmetries of the metric.
+
+************************************************************************/
+
+#include "smtcache.h"
+
+#include "efuncs.h"
+#include "fatal.h"
+#include "geosteiner.h"
+#include "logic.h"
+#include <math.h>
+#include "memory.h"
+#include "metric.h"
+#include "prepostlude.h"
+#include "sortfuncs.h"
+#include "steiner.h"
+#include <string.h>
+
+
+/*
+ * Global Routines
+ */
+
+gst_smtcache_ptr	gst_create_smtcache (gst_metric_ptr	metric,
+					     gst_param_ptr	params,
+					     int		megabytes,
+					     int *		status);
+int			gst_free_smtcache (gst_smtcache_ptr cache);
+int			gst_get_smtcache_stats (gst_smtcache_ptr cache,
+						int *		hits,
+						int *		misses,
+						int *		entries,
+						double *	kbytes);
+int			gst_smtcache_solve (gst_smtcache_ptr	cache,
+					    int			nterms,
+					    double *		terms,
+					    double *		length,
+					    int *		nsps,
+					    double *		sps,
+					    int *		nedges,
+					    int *		edges,
+					    int *		soln_status);
+
+
+/*
+ * Local Equates
+ */
+
+/* Canonical coordinates (which lie in [-1,1]) are rounded to this	*/
+/* many parts per unit.  Instances match if their rounded canonical	*/
+/* coordinates are equal.						*/
+#define	COORD_SCALE		1.0e9
+
+/* Relative tolerance for terminals to be farthest from the centroid. */
+#define	FAR_TOLERANCE		1.0e-9
+
+#define	INITIAL_NUM_BUCKETS	64
+
+#define	HASH_INIT		((int64u) 0xCBF29CE484222325UL)
+#define	HASH_PRIME		((int64u) 0x00000100000001B3UL)
+
+
+/*
+ * Local Types
+ */
+
+struct smt_entry {
+	struct smt_entry *	hnext;		/* next in hash chain */
+	struct smt_entry *	older;		/* less recently used */
+	struct smt_entry *	newer;		/* more recently used */
+	int64u			hash;		/* hash of key */
+	int			nterms;		/* number of terminals */
+	int *			key;		/* rounded canonical terminals */
+	double			length;		/* length of SMT / scale */
+	int			status;		/* solution status */
+	int			nsps;		/* number of Steiner points */
+	double *		sps;		/* canonical Steiner points */
+	int			nedges;		/* number of SMT edges */
+	int *			edges;		/* SMT edges, with terminals */
+						/* in canonical order */
+	size_t			size;		/* memory used by entry */
+};
+
+/*
+ * The transformation of an instance into canonical form: translate
+ * the centroid to the origin, optionally reflect in the x-axis, rotate
+ * by the given angle and divide by the scale.  The terminals of the
+ * canonical form are sorted, and perm gives the original terminal in
+ * each position.
+ */
+
+struct canon {
+	int		nterms;		/* number of terminals */
+	double		cx;		/* centroid */
+	double		cy;
+	double		scale;		/* distance of farthest terminal */
+	double		cos_a;		/* rotation */
+	double		sin_a;
+	bool		mirror;		/* reflect before rotating */
+	int *		key;		/* rounded canonical coordinates */
+	int *		perm;		/* original terminal of each */
+					/* canonical position */
+	int64u		hash;		/* hash of key */
+};
+
+/* An SMT as returned by gst_smt(). */
+
+struct smt_soln {
+	double		length;		/* length of SMT */
+	int		status;		/* solution status */
+	int		nsps;		/* number of Steiner points */
+	double *	sps;		/* Steiner point coordinates */
+	int		nedges;		/* number of SMT edges */
+	int *		edges;		/* SMT edges */
+};
+
+
+/*
+ * Local Routines
+ */
+
+static void		add_entry (gst_smtcache_ptr, struct smt_entry *);
+static bool		canonicalize (gst_smtcache_ptr,
+				      int,
+				      double *,
+				      struct canon *);
+static int		compare_points (int, int, void *);
+static void		delete_entry (gst_smtcache_ptr, struct smt_entry *);
+static void		free_entry (struct smt_entry *);
+static void		from_canonical (struct canon *,
+					double,
+					double,
+					double *,
+					double *);
+static int64u		hash_int (int64u, int);
+static struct smt_entry *	lookup (gst_smtcache_ptr, struct canon *);
+static struct smt_entry *	make_entry (struct canon *, struct smt_soln *);
+static void		rehash (gst_smtcache_ptr);
+static int		solve_smt (gst_smtcache_ptr,
+				   int,
+				   double *,
+				   struct smt_soln *);
+static void		to_canonical (struct canon *,
+				      double,
+				      double,
+				      double *,
+				      double *);
+static void		try_transform (struct canon *,
+				       double *,
+				       double,
+				       double,
+				       bool,
+				       int *,
+				       bool);
+static void		unlink_entry (gst_smtcache_ptr, struct smt_entry *);
+
+/*
+ * Create an empty SMT cache that uses at most the given amount of
+ * memory.  The metric and parameters are copied, so the caller may
+ * free them afterwards.
+ */
+
+	gst_smtcache_ptr
+gst_create_smtcache (
+
+gst_metric_ptr		metric,		/* IN - metric to use */
+gst_param_ptr		params,		/* IN - parameters (NULL=default) */
+int			megabytes,	/* IN - memory the cache may use */
+int *			status		/* OUT - status */
+)
+{
+int			i;
+int			code;
+gst_smtcache_ptr	cache;
+
+	GST_PRELUDE
+
+	cache = NULL;
+	code = 0;
+
+	do {	/* Used only for "break". */
+		if (metric EQ NULL) {
+			code = GST_ERR_INVALID_METRIC;
+			break;
+		}
+		if (megabytes < 0) {
+			code = GST_ERR_PARAMETER_VALUE_OUT_OF_RANGE;
+			break;
+		}
+
+		cache = NEW (struct gst_smtcache);
+		memset (cache, 0, sizeof (*cache));
+
+		cache -> metric = gst_create_metric (metric -> type,
+						     metric -> parameter,
+						     NULL);
+		cache -> params = NULL;
+		if (params NE NULL) {
+			cache -> params = gst_create_param (NULL);
+			gst_copy_param (cache -> params, params);
+		}
+
+		_gst_mutex_init (&(cache -> lock));
+		cache -> num_buckets	= INITIAL_NUM_BUCKETS;
+		cache -> buckets = NEWA (INITIAL_NUM_BUCKETS,
+					 struct smt_entry *);
+		for (i = 0; i < INITIAL_NUM_BUCKETS; i++) {
+			cache -> buckets [i] = NULL;
+		}
+		cache -> count		= 0;
+		cache -> size		= 0;
+		cache -> max_size	= ((size_t) megabytes) << 20;
+		cache -> oldest		= NULL;
+		cache -> newest		= NULL;
+		cache -> hits		= 0;
+		cache -> misses		= 0;
+	} while (FALSE);
+
+	if (status NE NULL) {
+		*status = code;
+	}
+
+	GST_POSTLUDE
+	return (cache);
+}
+
+/*
+ * Free an SMT cache.
+ */
+
+	int
+gst_free_smtcache (
+
+gst_smtcache_ptr	cache		/* IN - cache to free */
+)
+{
+struct smt_entry *	ep;
+struct smt_entry *	next;
+
+	GST_PRELUDE
+
+	if (cache NE NULL) {
+		for (ep = cache -> oldest; ep NE NULL; ep = next) {
+			next = ep -> newer;
+			free_entry (ep);
+		}
+		free ((char *) (cache -> buckets));
+		_gst_mutex_destroy (&(cache -> lock));
+		if (cache -> params NE NULL) {
+			gst_free_param (cache -> params);
+		}
+		gst_free_metric (cache -> metric);
+		free ((char *) cache);
+	}
+
+	GST_POSTLUDE
+	return (0);
+}
+
+/*
+ * Solve an SMT instance, as gst_smt() does, answering it from the
+ * cache if a copy of it has been solved before.  Only optimal
+ * solutions are added to the cache.
+ */
+
+	int
+gst_smtcache_solve (
+
+gst_smtcache_ptr	cache,		/* IN/OUT - SMT cache */
+int			nterms,		/* IN - number of terminals */
+double *		terms,		/* IN - terminal coordinates */
+double *		length,		/* OUT - length of SMT */
+int *			nsps,		/* OUT - number of Steiner points */
+double *		sps,		/* OUT - Steiner point coordinates */
+int *			nedges,		/* OUT - number of SMT edges */
+int *			edges,		/* OUT - SMT edges */
+int *			soln_status	/* OUT - solution status */
+)
+{
+int			i;
+int			res;
+struct smt_entry *	ep;
+struct smt_entry *	new_ep;
+struct canon		canon;
+struct smt_soln		soln;
+
+	GST_PRELUDE
+
+	res = 0;
+
+	if (length NE NULL)	 *length	= 0.0;
+	if (nsps NE NULL)	 *nsps		= 0;
+	if (nedges NE NULL)	 *nedges	= 0;
+	if (soln_status NE NULL) *soln_status	= GST_STATUS_NO_SOLUTION;
+
+	if (nterms < 0) {
+		res = GST_ERR_INVALID_NUMBER_OF_TERMINALS;
+		goto end;
+	}
+
+	if (NOT canonicalize (cache, nterms, terms, &canon)) {
+		/* Not worth caching. */
+		_gst_mutex_lock (&(cache -> lock));
+		++(cache -> misses);
+		_gst_mutex_unlock (&(cache -> lock));
+		res = gst_smt (nterms, terms,
+			       length, nsps, sps, nedges, edges, soln_status,
+			       cache -> metric, cache -> params);
+		goto end;
+	}
+
+	_gst_mutex_lock (&(cache -> lock));
+	ep = lookup (cache, &canon);
+	if (ep NE NULL) {
+		++(cache -> hits);
+		if (length NE NULL) {
+			*length = ep -> length * canon.scale;
+		}
+		if (soln_status NE NULL) {
+			*soln_status = ep -> status;
+		}
+		if (nsps NE NULL) {
+			*nsps = ep -> nsps;
+		}
+		if (sps NE NULL) {
+			for (i = 0; i < ep -> nsps; i++) {
+				from_canonical (&canon,
+						ep -> sps [2*i],
+						ep -> sps [2*i + 1],
+						&sps [2*i],
+						&sps [2*i + 1]);
+			}
+		}
+		if (nedges NE NULL) {
+			*nedges = ep -> nedges;
+		}
+		if (edges NE NULL) {
+			for (i = 0; i < 2 * ep -> nedges; i++) {
+				edges [i] = ep -> edges [i];
+				if (edges [i] < nterms) {
+					edges [i] = canon.perm [edges [i]];
+				}
+			}
+		}
+		_gst_mutex_unlock (&(cache -> lock));
+		goto done;
+	}
+	++(cache -> misses);
+	_gst_mutex_unlock (&(cache -> lock));
+
+	/* Solve without holding the cache lock.  gst_hg_solve() takes	*/
+	/* the process-wide LP solver lock for the branch-and-cut.	*/
+	res = solve_smt (cache, nterms, terms, &soln);
+	if (res NE 0) goto done;
+
+	if (length NE NULL) {
+		*length = soln.length;
+	}
+	if (soln_status NE NULL) {
+		*soln_status = soln.status;
+	}
+	if (nsps NE NULL) {
+		*nsps = soln.nsps;
+	}
+	if (sps NE NULL) {
+		memcpy (sps, soln.sps, 2 * soln.nsps * sizeof (double));
+	}
+	if (nedges NE NULL) {
+		*nedges = soln.nedges;
+	}
+	if (edges NE NULL) {
+		memcpy (edges, soln.edges, 2 * soln.nedges * sizeof (int));
+	}
+
+	if (soln.status EQ GST_STATUS_OPTIMAL) {
+		new_ep = make_entry (&canon, &soln);
+		_gst_mutex_lock (&(cache -> lock));
+		if ((new_ep -> size > cache -> max_size) OR
+		    (lookup (cache, &canon) NE NULL)) {
+			/* Too big, or another thread got there first. */
+			free_entry (new_ep);
+		}
+		else {
+			add_entry (cache, new_ep);
+		}
+		_gst_mutex_unlock (&(cache -> lock));
+	}
+
+	free ((char *) (soln.edges));
+	free ((char *) (soln.sps));
+
+done:
+	free ((char *) (canon.perm));
+	free ((char *) (canon.key));
+
+end:
+	GST_POSTLUDE
+	return (res);
+}
+
+/*
+ * Return the number of instances answered from the cache and solved
+ * anew, and the number and size of the entries in the cache.
+ */
+
+	int
+gst_get_smtcache_stats (
+
+gst_smtcache_ptr	cache,		/* IN - SMT cache */
+int *			hits,		/* OUT - instances found in cache */
+int *			misses,		/* OUT - instances solved */
+int *			entries,	/* OUT - instances in cache */
+double *		kbytes		/* OUT - memory used by entries */
+)
+{
+	GST_PRELUDE
+
+	_gst_mutex_lock (&(cache -> lock));
+	if (hits NE NULL) {
+		*hits = cache -> hits;
+	}
+	if (misses NE NULL) {
+		*misses = cache -> misses;
+	}
+	if (entries NE NULL) {
+		*entries = cache -> count;
+	}
+	if (kbytes NE NULL) {
+		*kbytes = ((double) (cache -> size)) / 1024.0;
+	}
+	_gst_mutex_unlock (&(cache -> lock));
+
+	GST_POSTLUDE
+	return (0);
+}
+
+/*
+ * Compute the canonical form of the given terminals.  The terminals
+ * are translated so that their centroid is at the origin and scaled so
+ * that the farthest one is at distance 1.  Of the rotations and
+ * reflections that preserve the metric, we then use the one giving the
+ * lexicographically smallest sorted list of terminals.  For the
+ * Euclidean metric (where all rotations qualify) we only try those
+ * that put a farthest terminal on the positive x-axis.  Returns FALSE
+ * for instances that are not worth caching, or whose metric we do not
+ * know the symmetries of.
+ */
+
+	static
+	bool
+canonicalize (
+
+gst_smtcache_ptr	cache,		/* IN - SMT cache */
+int			nterms,		/* IN - number of terminals */
+double *		terms,		/* IN - terminal coordinates */
+struct canon *		cp		/* OUT - canonical form */
+)
+{
+int			i;
+int			k;
+int			lambda;
+int			mirror;
+int *			tmp;
+double			r;
+double			dx;
+double			dy;
+double			angle;
+double *		dist;
+gst_metric_ptr		metric;
+
+	cp -> key	= NULL;
+	cp -> perm	= NULL;
+
+	/* The small cases are solved directly by gst_smt(). */
+	if (nterms <= 3) return (FALSE);
+
+	metric = cache -> metric;
+	lambda = 0;
+	if (metric -> type EQ GST_METRIC_UNIFORM) {
+		lambda = metric -> parameter;
+	}
+	else if ((metric -> type EQ GST_METRIC_L) AND
+		 (metric -> parameter EQ 1)) {
+		/* Same symmetries as the lambda = 2 metric. */
+		lambda = 2;
+	}
+	else if ((metric -> type NE GST_METRIC_L) OR
+		 (metric -> parameter NE 2)) {
+		return (FALSE);
+	}
+
+	cp -> nterms	= nterms;
+	cp -> cx	= 0.0;
+	cp -> cy	= 0.0;
+	for (i = 0; i < nterms; i++) {
+		cp -> cx += terms [2*i];
+		cp -> cy += terms [2*i + 1];
+	}
+	cp -> cx /= nterms;
+	cp -> cy /= nterms;
+
+	dist = NEWA (nterms, double);
+	cp -> scale = 0.0;
+	for (i = 0; i < nterms; i++) {
+		dx = terms [2*i] - cp -> cx;
+		dy = terms [2*i + 1] - cp -> cy;
+		dist [i] = sqrt (dx * dx + dy * dy);
+		if (dist [i] > cp -> scale) {
+			cp -> scale = dist [i];
+		}
+	}
+	if (cp -> scale <= 0.0) {
+		/* All terminals coincide. */
+		free ((char *) dist);
+		return (FALSE);
+	}
+
+	cp -> key	= NEWA (2 * nterms, int);
+	cp -> perm	= NEWA (nterms, int);
+	tmp		= NEWA (2 * nterms, int);
+
+	k = 0;
+	for (mirror = 0; mirror <= 1; mirror++) {
+		if (lambda > 0) {
+			for (i = 0; i < 2 * lambda; i++) {
+				angle = i * PI / lambda;
+				try_transform (cp,
+					       terms,
+					       cos (angle),
+					       sin (angle),
+					       (mirror NE 0),
+					       tmp,
+					       (k EQ 0));
+				++k;
+			}
+			continue;
+		}
+		r = cp -> scale * (1.0 - FAR_TOLERANCE);
+		for (i = 0; i < nterms; i++) {
+			if (dist [i] < r) continue;
+			dx = terms [2*i] - cp -> cx;
+			dy = terms [2*i + 1] - cp -> cy;
+			if (mirror NE 0) {
+				dy = -dy;
+			}
+			/* Rotate this terminal onto the positive x-axis. */
+			try_transform (cp,
+				       terms,
+				       dx / dist [i],
+				       -dy / dist [i],
+				       (mirror NE 0),
+				       tmp,
+				       (k EQ 0));
+			++k;
+		}
+	}
+
+	free ((char *) tmp);
+	free ((char *) dist);
+
+	cp -> hash = HASH_INIT;
+	cp -> hash = hash_int (cp -> hash, nterms);
+	for (i = 0; i < 2 * nterms; i++) {
+		cp -> hash = hash_int (cp -> hash, cp -> key [i]);
+	}
+
+	return (TRUE);
+}
+
+/*
+ * Apply the given rotation (and reflection) to the terminals, and
+ * round and sort the result.  Make this the canonical form if it is
+ * the first one tried or lexicographically smaller than the best so
+ * far.
+ */
+
+	static
+	void
+try_transform (
+
+struct canon *		cp,		/* IN/OUT - canonical form */
+double *		terms,		/* IN - terminal coordinates */
+double			cos_a,		/* IN - rotation to try */
+double			sin_a,
+bool			mirror,		/* IN - reflect first */
+int *			tmp,		/* IN - scratch, 2 * nterms ints */
+bool			first		/* IN - no canonical form yet */
+)
+{
+int			i;
+int			j;
+int			n;
+int *			perm;
+double			x;
+double			y;
+struct canon		trial;
+
+	n = cp -> nterms;
+
+	trial		= *cp;
+	trial.cos_a	= cos_a;
+	trial.sin_a	= sin_a;
+	trial.mirror	= mirror;
+
+	for (i = 0; i < n; i++) {
+		to_canonical (&trial, terms [2*i], terms [2*i + 1], &x, &y);
+		tmp [2*i]	= (int) floor (x * COORD_SCALE + 0.5);
+		tmp [2*i + 1]	= (int) floor (y * COORD_SCALE + 0.5);
+	}
+	perm = _gst_heapsort (n, tmp, compare_points);
+
+	if (NOT first) {
+		for (i = 0; i < n; i++) {
+			j = perm [i];
+			if (tmp [2*j] NE cp -> key [2*i]) break;
+			if (tmp [2*j + 1] NE cp -> key [2*i + 1]) break;
+		}
+		if ((i >= n) OR
+		    (tmp [2*j] > cp -> key [2*i]) OR
+		    ((tmp [2*j] EQ cp -> key [2*i]) AND
+		     (tmp [2*j + 1] > cp -> key [2*i + 1]))) {
+			/* Not smaller. */
+			free ((char *) perm);
+			return;
+		}
+	}
+
+	cp -> cos_a	= cos_a;
+	cp -> sin_a	= sin_a;
+	cp -> mirror	= mirror;
+	for (i = 0; i < n; i++) {
+		j = perm [i];
+		cp -> key [2*i]		= tmp [2*j];
+		cp -> key [2*i + 1]	= tmp [2*j + 1];
+		cp -> perm [i]		= j;
+	}
+
+	free ((char *) perm);
+}
+
+/*
+ * Compare two rounded points by x, then y, then index.
+ */
+
+	static
+	int
+compare_points (
+
+int		i,		/* IN - first point */
+int		j,		/* IN - second point */
+void *		array		/* IN - rounded coordinates */
+)
+{
+int *		p;
+
+	p = (int *) array;
+
+	if (p [2*i] < p [2*j]) return (-1);
+	if (p [2*i] > p [2*j]) return (1);
+	if (p [2*i + 1] < p [2*j + 1]) return (-1);
+	if (p [2*i + 1] > p [2*j + 1]) return (1);
+	if (i < j) return (-1);
+	if (i > j) return (1);
+	return (0);
+}
+
+/*
+ * Map a point of the instance into canonical coordinates.
+ */
+
+	static
+	void
+to_canonical (
+
+struct canon *		cp,		/* IN - canonical form */
+double			x,		/* IN - point of instance */
+double			y,
+double *		xp,		/* OUT - canonical point */
+double *		yp
+)
+{
+double			dx;
+double			dy;
+
+	dx = x - cp -> cx;
+	dy = y - cp -> cy;
+	if (cp -> mirror) {
+		dy = -dy;
+	}
+	*xp = (cp -> cos_a * dx - cp -> sin_a * dy) / cp -> scale;
+	*yp = (cp -> sin_a * dx + cp -> cos_a * dy) / cp -> scale;
+}
+
+/*
+ * Map a point in canonical coordinates back into the instance.
+ */
+
+	static
+	void
+from_canonical (
+
+struct canon *		cp,		/* IN - canonical form */
+double			x,		/* IN - canonical point */
+double			y,
+double *		xp,		/* OUT - point of instance */
+double *		yp
+)
+{
+double			dx;
+double			dy;
+
+	x *= cp -> scale;
+	y *= cp -> scale;
+	dx =   cp -> cos_a * x + cp -> sin_a * y;
+	dy = - cp -> sin_a * x + cp -> cos_a * y;
+	if (cp -> mirror) {
+		dy = -dy;
+	}
+	*xp = dx + cp -> cx;
+	*yp = dy + cp -> cy;
+}
+
+/*
+ * Solve the instance the way gst_smt() does, keeping the complete
+ * solution.
+ */
+
+	static
+	int
+solve_smt (
+
+gst_smtcache_ptr	cache,		/* IN - SMT cache */
+int			nterms,		/* IN - number of terminals */
+double *		terms,		/* IN - terminal coordinates */
+struct smt_soln *	soln		/* OUT - the solution */
+)
+{
+int			res;
+int			status;
+int			nfsts;
+int *			fsts;
+gst_hg_ptr		H;
+gst_hg_ptr		H2;
+gst_solver_ptr		solver;
+
+	soln -> length	= 0.0;
+	soln -> status	= GST_STATUS_NO_SOLUTION;
+	soln -> nsps	= 0;
+	soln -> sps	= NULL;
+	soln -> nedges	= 0;
+	soln -> edges	= NULL;
+
+	H = gst_generate_fsts (nterms,
+			       terms,
+			       cache -> metric,
+			       cache -> params,
+			       &status);
+	if (H EQ NULL) {
+		return (status);
+	}
+
+	/* Prune FSTs when instance is large, as gst_smt() does. */
+	if (nterms >= 2000) {
+		H2 = gst_hg_prune_edges (H, cache -> params, &status);
+		if (H2 NE NULL) {
+			gst_free_hg (H);
+			H = H2;
+		}
+	}
+
+	solver = gst_create_solver (H, cache -> params, NULL);
+	res = gst_hg_solve (solver, NULL);
+
+	if (res EQ 0) {
+		gst_get_solver_status (solver, &(soln -> status));
+		fsts = NEWA (nterms, int);
+		if (gst_hg_solution (solver,
+				     &nfsts,
+				     fsts,
+				     &(soln -> length),
+				     0) EQ 0) {
+			gst_get_hg_edge_embedding (H,
+						   nfsts,
+						   fsts,
+						   &(soln -> nsps),
+						   NULL,
+						   &(soln -> nedges),
+						   NULL);
+			soln -> sps	= NEWA (2 * soln -> nsps + 1, double);
+			soln -> edges	= NEWA (2 * soln -> nedges + 1, int);
+			gst_get_hg_edge_embedding (H,
+						   nfsts,
+						   fsts,
+						   NULL,
+						   soln -> sps,
+						   NULL,
+						   soln -> edges);
+		}
+		else {
+			soln -> status = GST_STATUS_NO_SOLUTION;
+		}
+		free ((char *) fsts);
+	}
+
+	gst_free_solver (solver);
+	gst_free_hg (H);
+
+	return (res);
+}
+
+/*
+ * Build a cache entry holding the given solution in canonical form.
+ */
+
+	static
+	struct smt_entry *
+make_entry (
+
+struct canon *		cp,		/* IN - canonical form of instance */
+struct smt_soln *	soln		/* IN - solution of instance */
+)
+{
+int			i;
+int			n;
+int *			pos;
+struct smt_entry *	ep;
+
+	n = cp -> nterms;
+
+	ep = NEW (struct smt_entry);
+
+	ep -> hnext	= NULL;
+	ep -> older	= NULL;
+	ep -> newer	= NULL;
+	ep -> hash	= cp -> hash;
+	ep -> nterms	= n;
+	ep -> key	= NEWA (2 * n, int);
+	ep -> length	= soln -> length / cp -> scale;
+	ep -> status	= soln -> status;
+	ep -> nsps	= soln -> nsps;
+	ep -> sps	= NEWA (2 * soln -> nsps + 1, double);
+	ep -> nedges	= soln -> nedges;
+	ep -> edges	= NEWA (2 * soln -> nedges + 1, int);
+	ep -> size	= sizeof (*ep)
+			  + (2 * n + 2 * soln -> nedges + 2) * sizeof (int)
+			  + (2 * soln -> nsps + 1) * sizeof (double);
+
+	memcpy (ep -> key, cp -> key, 2 * n * sizeof (int));
+
+	for (i = 0; i < soln -> nsps; i++) {
+		to_canonical (cp,
+			      soln -> sps [2*i],
+			      soln -> sps [2*i + 1],
+			      &(ep -> sps [2*i]),
+			      &(ep -> sps [2*i + 1]));
+	}
+
+	/* Renumber the terminals into canonical order. */
+	pos = NEWA (n, int);
+	for (i = 0; i < n; i++) {
+		pos [cp -> perm [i]] = i;
+	}
+	for (i = 0; i < 2 * soln -> nedges; i++) {
+		ep -> edges [i] = soln -> edges [i];
+		if (ep -> edges [i] < n) {
+			ep -> edges [i] = pos [ep -> edges [i]];
+		}
+	}
+	free ((char *) pos);
+
+	return (ep);
+}
+
+/*
+ * Look up the given canonical form, making it the most recently used
+ * entry if found.  The caller must hold the lock.
+ */
+
+	static
+	struct smt_entry *
+lookup (
+
+gst_smtcache_ptr	cache,		/* IN - cache to search */
+struct canon *		cp		/* IN - canonical form to find */
+)
+{
+struct smt_entry *	ep;
+
+	ep = cache -> buckets [cp -> hash & (cache -> num_buckets - 1)];
+	for (; ep NE NULL; ep = ep -> hnext) {
+		if (ep -> hash NE cp -> hash) continue;
+		if (ep -> nterms NE cp -> nterms) continue;
+		if (memcmp (ep -> key,
+			    cp -> key,
+			    2 * cp -> nterms * sizeof (int)) NE 0) continue;
+
+		unlink_entry (cache, ep);
+		ep -> older = cache -> newest;
+		ep -> newer = NULL;
+		if (cache -> newest NE NULL) {
+			cache -> newest -> newer = ep;
+		}
+		else {
+			cache -> oldest = ep;
+		}
+		cache -> newest = ep;
+
+		return (ep);
+	}
+
+	return (NULL);
+}
+
+/*
+ * Free up a cache entry.
+ */
+
+	static
+	void
+free_entry (
+
+struct smt_entry *	ep		/* IN - entry to free */
+)
+{
+	free ((char *) (ep -> edges));
+	free ((char *) (ep -> sps));
+	free ((char *) (ep -> key));
+	free ((char *) ep);
+}
+
+/*
+ * Add an entry to the cache, as the most recently used one.  Least
+ * recently used entries are discarded until it fits.
+ */
+
+	static
+	void
+add_entry (
+
+gst_smtcache_ptr	cache,		/* IN/OUT - cache to add to */
+struct smt_entry *	ep		/* IN - entry to add */
+)
+{
+int			i;
+
+	while ((cache -> oldest NE NULL) AND
+	       (cache -> size + ep -> size > cache -> max_size)) {
+		delete_entry (cache, cache -> oldest);
+	}
+
+	if (cache -> count >= cache -> num_buckets) {
+		rehash (cache);
+	}
+
+	i = ep -> hash & (cache -> num_buckets - 1);
+	ep -> hnext = cache -> buckets [i];
+	cache -> buckets [i] = ep;
+
+	ep -> older = cache -> newest;
+	ep -> newer = NULL;
+	if (cache -> newest NE NULL) {
+		cache -> newest -> newer = ep;
+	}
+	else {
+		cache -> oldest = ep;
+	}
+	cache -> newest = ep;
+
+	++(cache -> count);
+	cache -> size += ep -> size;
+}
+
+/*
+ * Remove an entry from the cache and free it.
+ */
+
+	static
+	void
+delete_entry (
+
+gst_smtcache_ptr	cache,		/* IN/OUT - cache to remove from */
+struct smt_entry *	ep		/* IN - entry to remove */
+)
+{
+struct smt_entry **	hookp;
+
+	hookp = &(cache -> buckets [ep -> hash & (cache -> num_buckets - 1)]);
+	while (*hookp NE ep) {
+		FATAL_ERROR_IF (*hookp EQ NULL);
+		hookp = &((*hookp) -> hnext);
+	}
+	*hookp = ep -> hnext;
+
+	unlink_entry (cache, ep);
+
+	--(cache -> count);
+	cache -> size -= ep -> size;
+
+	free_entry (ep);
+}
+
+/*
+ * Remove an entry from the list of entries in order of use.
+ */
+
+	static
+	void
+unlink_entry (
+
+gst_smtcache_ptr	cache,		/* IN/OUT - cache */
+struct smt_entry *	ep		/* IN - entry to unlink */
+)
+{
+	if (ep -> older NE NULL) {
+		ep -> older -> newer = ep -> newer;
+	}
+	else {
+		cache -> oldest = ep -> newer;
+	}
+	if (ep -> newer NE NULL) {
+		ep -> newer -> older = ep -> older;
+	}
+	else {
+		cache -> newest = ep -> older;
+	}
+	ep -> older = NULL;
+	ep -> newer = NULL;
+}
+
+/*
+ * Double the number of hash buckets.
+ */
+
+	static
+	void
+rehash (
+
+gst_smtcache_ptr	cache		/* IN/OUT - cache to rehash */
+)
+{
+int			i;
+int			j;
+int			n;
+struct smt_entry **	buckets;
+struct smt_entry *	ep;
+struct smt_entry *	next;
+
+	n = 2 * cache -> num_buckets;
+	buckets = NEWA (n, struct smt_entry *);
+	for (i = 0; i < n; i++) {
+		buckets [i] = NULL;
+	}
+
+	for (i = 0; i < cache -> num_buckets; i++) {
+		for (ep = cache -> buckets [i]; ep NE NULL; ep = next) {
+			next = ep -> hnext;
+			j = ep -> hash & (n - 1);
+			ep -> hnext = buckets [j];
+			buckets [j] = ep;
+		}
+	}
+
+	free ((char *) (cache -> buckets));
+	cache -> buckets	= buckets;
+	cache -> num_buckets	= n;
+}
+
+/*
+ * Mix one integer into a 64-bit FNV-1a hash.
+ */
+
+	static
+	int64u
+hash_int (
+
+int64u		h,		/* IN - hash so far */
+int		value		/* IN - integer to mix in */
+)
+{
+int		i;
+int32u		u;
+
+	u = (int32u) value;
+	for (i = 0; i < 4; i++) {
+		h = (h ^ (u & 0xFF)) * HASH_PRIME;
+		u >>= 8;
+	}
+
+	return (h);
+}
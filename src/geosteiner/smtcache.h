@@ -0,0 +1,55 @@
+/***********************************************************************
+
+	File:	smtcache.h
+	Rev:	e-1
+	Date:	10/19/2026
+
+	This work is licensed under a Creative Commons
+	Attribution-NonCommercial 4.0 International License.
+
+************************************************************************
+
+	Declarations for the cache of solved SMT instances.
+
+************************************************************************/
+
+#ifndef	SMTCACHE_H
+#define	SMTCACHE_H
+
+#include "geosteiner.h"
+#include "gsttypes.h"
+#include <stddef.h>
+#include "threads.h"
+
+struct smt_entry;
+
+
+/*
+ * An SMT cache remembers the solutions of the instances it has solved,
+ * keyed by a canonical form of the terminals that is the same for all
+ * instances that differ only by a symmetry of the metric (translation,
+ * uniform scaling, and those rotations and reflections that preserve
+ * the metric).  An instance that is a copy of one already solved is
+ * answered by mapping the stored solution back onto its terminals.
+ *
+ * The cache uses at most a given amount of memory, discarding the
+ * least recently used entries.  It may be shared by several threads.
+ */
+
+struct gst_smtcache {
+	gst_metric_ptr		metric;		/* copy of caller's metric */
+	gst_param_ptr		params;		/* copy of caller's parameters */
+
+	struct gst_mutex	lock;		/* protects what follows */
+	struct smt_entry **	buckets;	/* hash table */
+	int			num_buckets;	/* a power of two */
+	int			count;		/* number of entries */
+	size_t			size;		/* memory used by entries */
+	size_t			max_size;	/* memory allowed */
+	struct smt_entry *	oldest;		/* least recently used */
+	struct smt_entry *	newest;		/* most recently used */
+	int			hits;		/* instances found in cache */
+	int			misses;		/* instances solved anew */
+};
+
+#endif
@@ -53,16 +53,20 @@
 #include "btsearch.h"
 #include "ckpt.h"
 #include "constrnt.h"
+#include "cutrepo.h"
 #include "fatal.h"
 #include <float.h>
 #include "fputils.h"
 #include "geosteiner.h"
+#include "hgblocks.h"
 #include "logic.h"
 #include "memory.h"
 #include "parmblk.h"
+#include "portfolio.h"
 #include "prepostlude.h"
 #include "steiner.h"
 #include <string.h>
+#include "threads.h"
 #include "ub.h"
 
 
@@ -94,6 +98,7 @@ void		_gst_update_solver_properties (struct gst_solver * solver);
  * Local Routines
  */
 
+static bool	can_race (gst_solver_ptr);
 static void	check_solution_set_resize (gst_solver_ptr);
 static void	clear_solver (gst_solver_ptr);
 static void	discard_solver_properties (gst_solver_ptr);
@@ -115,6 +120,7 @@ static int	verify_hypergraph (gst_hg_ptr);
 #define BACKTRACK_SEARCH	1
 #define BRANCH_AND_CUT		2
 #define HEURISTIC		3
+#define DECOMPOSITION		4
 
 /*
  * Create a solver object and initialize it
@@ -186,6 +192,8 @@ gst_solver_ptr		solver
 	if (solver NE NULL) {
 		clear_solver (solver);
 
+		_gst_free_cutshare (solver);
+
 		gst_free_proplist (solver -> proplist);
 		solver -> proplist = NULL;
 
@@ -234,12 +242,14 @@ int *		reason		/* OUT - reason to exit solver GST_SOLVE_... */
 )
 {
 int		i;
-int		nmasks;
 int		res;
 int		save_opt;
+bool		decomposed;
 bool		use_backtrack_search;
+bool		use_portfolio;
 cpu_time_t	t1;
 struct bbinfo *	bbip;
+struct portfolio * pp;
 gst_hg_ptr	H;
 gst_param_ptr	params;
 char **		merge_files;
@@ -304,6 +314,7 @@ char **		merge_files;
 
 		_gst_begin_using_lp_solver ();
 
+		_gst_lock_lp_solver ();
 		bbip -> lpmem = NEW (struct lpmem);
 		bbip -> lp = _gst_build_initial_formulation (bbip -> cpool,
 							     bbip -> vert_mask,
@@ -311,13 +322,16 @@ char **		merge_files;
 							     H,
 							     bbip -> lpmem,
 							     params);
+		_gst_unlock_lp_solver ();
 
 		bbip -> params = params;
 		solver -> bbip = bbip;
 		bbip -> solver = solver;
 	} while (FALSE);
 
+	decomposed = FALSE;
 	use_backtrack_search = FALSE;
+	use_portfolio = FALSE;
 
 	if (bbip EQ NULL) {
 
@@ -352,6 +366,12 @@ char **		merge_files;
 			    (H -> num_edges <= params -> backtrack_max_edges)) {
 				use_backtrack_search = TRUE;
 			}
+			else if (_gst_effective_threads (
+						params -> num_threads) > 1) {
+				/* Mid-size instance, and we may use more	*/
+				/* than one thread: race the two.		*/
+				use_portfolio = can_race (solver);
+			}
 			break;
 
 		case GST_PVAL_SOLVER_ALGORITHM_BRANCH_AND_CUT:
@@ -361,16 +381,28 @@ char **		merge_files;
 			use_backtrack_search = TRUE;
 			break;
 
+		case GST_PVAL_SOLVER_ALGORITHM_PORTFOLIO:
+			use_portfolio = can_race (solver);
+			break;
+
 		default:
 			FATAL_ERROR;
 		}
-	}
 
-	nmasks = H -> num_edge_masks;
+		/* Solve the blocks of the hypergraph separately, if	*/
+		/* requested and there is more than one.		*/
+		if (	(solver -> preempt EQ GST_SOLVE_NORMAL)
+		    AND _gst_solve_hg_blocks (solver)) {
+			decomposed = TRUE;
+			solver -> latest_optimizer_run = DECOMPOSITION;
+		}
+	}
 
 	if (	use_backtrack_search
+	    AND NOT decomposed
 	    AND (solver -> preempt EQ GST_SOLVE_NORMAL)) {
-		if ((nmasks NE 1) OR (H -> num_edges > 32)) {
+		if ((H -> num_verts > BACKTRACK_MAX_SIZE) OR
+		    (H -> num_edges > BACKTRACK_MAX_SIZE)) {
 			/* The user ASKED for backtrack search on an	*/
 			/* instance that is too big!			*/
 			res = GST_ERR_BACKTRACK_OVERFLOW;
@@ -413,9 +445,17 @@ char **		merge_files;
 	}
 
 	if (	NOT use_backtrack_search
+	    AND NOT decomposed
 	    AND (solver -> preempt EQ GST_SOLVE_NORMAL)) {
 		if (bbip EQ NULL) {
 			_gst_begin_using_lp_solver ();
+		}
+
+		/* The LP solver is not reentrant.  Other threads	*/
+		/* wait here until this branch-and-cut is done.	*/
+		_gst_lock_lp_solver ();
+
+		if (bbip EQ NULL) {
 			bbip = _gst_create_bbinfo (solver);
 			solver -> bbip = bbip;
 		}
@@ -423,15 +463,31 @@ char **		merge_files;
 			/* Restarting a previous branch-and-cut... */
 		}
 
+		/* Share cuts with other solvers, if requested. */
+		_gst_start_cut_sharing (solver);
+
 		/* Merge in constraints from specified files. */
 		merge_files = get_files_to_merge (params);
 		_gst_merge_constraints (bbip, merge_files);
 		free_files_to_merge (merge_files);
 
+		/* Race the backtrack search against it, if requested. */
+		pp = NULL;
+		if (use_portfolio) {
+			pp = _gst_start_portfolio (solver);
+		}
+
 		/* Do the branch-and-cut... */
 		_gst_branch_and_cut (solver);
 
+		_gst_unlock_lp_solver ();
+
 		solver -> latest_optimizer_run = BRANCH_AND_CUT;
+
+		if ((pp NE NULL) AND _gst_finish_portfolio (pp)) {
+			/* The backtrack search finished first. */
+			solver -> latest_optimizer_run = BACKTRACK_SEARCH;
+		}
 	}
 
 	if (solver -> preempt EQ GST_SOLVE_NORMAL) {
@@ -570,6 +626,7 @@ int	ss;
 
 	case BACKTRACK_SEARCH:
 	case BRANCH_AND_CUT:
+	case DECOMPOSITION:
 		if (solver -> preempt EQ GST_SOLVE_NORMAL) { /* The search was exhaustive */
 			if (solver -> nsols > 0) {
 				/* The best existing solution must be optimal */
@@ -838,7 +895,9 @@ bool		res;
 		if (length < sols [i].length) break;
 	}
 
-	res = i EQ 0; /* True if we have a new best solution (and better) */
+	/* True if we have a new best solution (and better than any	*/
+	/* initial upper bound the user gave us).			*/
+	res = (i EQ 0) AND (length < solver -> upperbound);
 
 	if (nsols >= solsize) {
 		/* We don't have room to save another solution -- we	*/
@@ -908,11 +967,40 @@ bool		res;
 		}
 
 		solver -> upperbound = length;
+
+		/* Let any algorithm racing this one know about it. */
+		_gst_portfolio_export (solver, length, sols [0].edge_mask);
 	}
 
 	return res;
 }
 
+/*
+ * Determine if the backtrack search can be raced against the
+ * branch-and-cut on the given problem instance.  The backtrack search
+ * must be able to handle it, and limiting the number of feasible
+ * updates only makes sense for one algorithm at a time.
+ */
+
+	static
+	bool
+can_race (
+
+gst_solver_ptr		solver
+)
+{
+	if ((solver -> H -> num_verts > BACKTRACK_MAX_SIZE) OR
+	    (solver -> H -> num_edges > BACKTRACK_MAX_SIZE)) {
+		return (FALSE);
+	}
+
+	if (solver -> params -> max_feasible_updates NE 0) {
+		return (FALSE);
+	}
+
+	return (TRUE);
+}
+
 /*
  * Determine if the given problem instance was modified since the
  * last time the solver was called.
@@ -943,6 +1031,7 @@ struct gst_solver *	solver
 )
 {
 struct bbstats *	statp;
+struct bbtree *		tp;
 gst_proplist_ptr	plist;
 
 #define SETINT(a,b)	gst_set_int_property (plist, a, b)
@@ -976,6 +1065,15 @@ gst_proplist_ptr	plist;
 		SETINT (GST_PROP_SOLVER_FINAL_LPROWS, statp -> cs_final.num_lprows);
 		SETINT (GST_PROP_SOLVER_FINAL_LPNZ,   statp -> cs_final.num_lpnz);
 	}
+
+	if (	(solver -> bbip NE NULL)
+	    AND ((tp = solver -> bbip -> bbtree) NE NULL)
+	    AND (tp -> peak_nodes > 0)) {
+		/* Peak memory used by suspended nodes. */
+		SETDBL (GST_PROP_SOLVER_NODE_MEMORY, tp -> peak_bytes);
+		SETDBL (GST_PROP_SOLVER_NODE_MEMORY_PER_NODE,
+			tp -> peak_bytes / tp -> peak_nodes);
+	}
 }
 
 /*
@@ -998,6 +1096,8 @@ static int ids [] = {
 	GST_PROP_SOLVER_CPU_TIME,
 	GST_PROP_SOLVER_ROOT_TIME,
 	GST_PROP_SOLVER_ROOT_LENGTH,
+	GST_PROP_SOLVER_NODE_MEMORY,
+	GST_PROP_SOLVER_NODE_MEMORY_PER_NODE,
 	GST_PROP_SOLVER_ROOT_OPTIMAL,
 	GST_PROP_SOLVER_ROOT_LPS,
 	GST_PROP_SOLVER_NUM_NODES,
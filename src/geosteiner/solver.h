@@ -39,11 +39,13 @@
 #include "bitmaskmacros.h"
 #include "cputime.h"
 #include "geosteiner.h"
+#include "threads.h"
 
 struct gst_hypergraph;
 struct gst_node;
 struct gst_param;
 struct gst_solver;
+struct portfolio;
 
 struct gst_solver {
 	struct gst_hypergraph *
@@ -81,11 +83,26 @@ struct gst_solver {
 	/* Callback stuff. */
 	gst_bb_callback_func_t *	bb_callback_func;
 	void *				bb_callback_data;
+
+	/* Shared best solution, while racing backtrack against B&C */
+	struct portfolio *		portfolio;
+
+	/* Repository of cuts shared with other solvers, if any */
+	struct cutshare *		cutshare;
 };
 
-#define PREEMPT_SOLVER(solver,reason)		\
-	if ((solver) -> preempt EQ 0) {		\
-		(solver) -> preempt = reason;	\
+/*
+ * The preempt flag may be set by one thread while another is solving,
+ * so it is set and tested with the atomic operations of threads.h.
+ * Only the first reason given is kept.
+ */
+
+#define PREEMPT_SOLVER(solver,reason)				\
+	{							\
+		int	_zero = 0;				\
+		(void) ATOMIC_CAS (&((solver) -> preempt),	\
+				   &_zero,			\
+				   (reason));			\
 	}
 
 /*
@@ -34,6 +34,9 @@
 #ifndef	SORTFUNCS_H
 #define	SORTFUNCS_H
 
+#include "geomtypes.h"
+
+struct edge;
 struct pset;
 
 typedef int (*gst_compare_func_ptr) (int, int, void *);
@@ -41,8 +44,10 @@ typedef int (*gst_compare_func_ptr) (int, int, void *);
 extern int *	_gst_heapsort (int			n,
 			  void *		array,
 			  gst_compare_func_ptr	compare);
-extern int *	_gst_heapsort_x (struct pset *);
-extern int *	_gst_heapsort_y (struct pset *);
+extern void	_gst_sort_edges (struct edge * a, int n, int nthreads);
 extern void	_gst_sort_ints (int * array, int n);
+extern int *	_gst_sort_keys (int n, dist_t * keys, int nthreads);
+extern int *	_gst_sort_points_x (struct pset * pts, int nthreads);
+extern int *	_gst_sort_points_y (struct pset * pts, int nthreads);
 
 #endif
@@ -88,7 +88,12 @@ struct edge {
 
 
 /*
- * The structure used to represent a single FST.
+ * The structure used to represent a single FST.  Copies of a
+ * hypergraph share its FSTs rather than duplicating them.  The
+ * reference count tells how many hypergraphs refer to the FST, and
+ * a shared FST must be unshared (see _gst_unshare_full_set) before it
+ * is modified.  The count is only updated atomically, so hypergraphs
+ * sharing FSTs may be copied, modified and freed on different threads.
  */
 
 struct full_set {
@@ -100,6 +105,7 @@ struct full_set {
 	struct pset *		steiners;
 	int			nedges;
 	struct edge *		edges;
+	int			refcount;
 };
 
 /*
@@ -151,8 +157,12 @@ struct gst_hypergraph {
  * Function Prototypes.
  */
 
+extern struct full_set *
+		_gst_copy_full_set (struct full_set * fsp);
 extern void	_gst_free_full_set (struct full_set * fsp);
 extern struct full_set *
 		_gst_remove_degree_two_steiner_points (struct full_set * fsp);
+extern struct full_set *
+		_gst_unshare_full_set (struct full_set * fsp);
 
 #endif
@@ -0,0 +1,442 @@
+/***********************************************************************
+
+	File:	threads.c
+	Rev:	e-1
+	Date:	10/19/2026
+
+	This work is licensed under a Creative Commons
+	Attribution-NonCommercial 4.0 International License.
+
+************************************************************************
+
+	A simple worker-thread facility.  A parallel phase is written
+	as a worker function that is called once for each of N
+	workers.  Workers must never wait for each other, so that
+	running them one after another (as we do when POSIX threads
+	are not available) yields exactly the same results.
+
+************************************************************************/
+
+#include "threads.h"
+
+#include "fatal.h"
+#include "logic.h"
+#include "memory.h"
+#include <stdlib.h>
+#ifdef HAVE_PTHREADS
+#include <errno.h>
+#include <time.h>
+#endif
+
+
+/*
+ * Global Routines
+ */
+
+void		_gst_cond_destroy (struct gst_cond * cp);
+void		_gst_cond_init (struct gst_cond * cp);
+void		_gst_cond_signal (struct gst_cond * cp);
+void		_gst_cond_timedwait (struct gst_cond *	cp,
+				     struct gst_mutex *	mp,
+				     double		seconds);
+void		_gst_cond_wait (struct gst_cond *	cp,
+				struct gst_mutex *	mp);
+int		_gst_effective_threads (int requested);
+void		_gst_join_thread (struct gst_thread * tp);
+void		_gst_mutex_destroy (struct gst_mutex * mp);
+void		_gst_mutex_init (struct gst_mutex * mp);
+void		_gst_mutex_lock (struct gst_mutex * mp);
+void		_gst_mutex_unlock (struct gst_mutex * mp);
+void		_gst_run_workers (int			nworkers,
+				  gst_worker_func_t	func,
+				  void *		arg);
+void		_gst_split_range (int		n,
+				  int		nparts,
+				  int		part,
+				  int *		first,
+				  int *		last);
+bool		_gst_start_thread (struct gst_thread *	tp,
+				   gst_thread_func_t	func,
+				   void *		arg);
+void		_gst_thread_pause (void);
+
+
+/*
+ * Local Types
+ */
+
+#ifdef HAVE_PTHREADS
+
+struct worker {
+	int			id;
+	gst_worker_func_t	func;
+	void *			arg;
+	pthread_t		thread;
+	int			started;
+};
+
+#endif
+
+
+/*
+ * Local Routines
+ */
+
+#ifdef HAVE_PTHREADS
+static void *		thread_start (void *);
+static void *		worker_start (void *);
+#endif
+
+/*
+ * Return the number of workers that will actually be used when the
+ * caller asks for the given number of threads.  Without thread
+ * support we always run a single worker.
+ */
+
+	int
+_gst_effective_threads (
+
+int		requested	/* IN - requested number of threads */
+)
+{
+#ifdef HAVE_PTHREADS
+	if (requested < 1) {
+		return (1);
+	}
+	return (requested);
+#else
+	return (1);
+#endif
+}
+
+/*
+ * Run the given worker function once for each worker number
+ * 0 through NWORKERS-1, and wait for all of them to finish.
+ * Worker 0 always runs in the calling thread.
+ */
+
+	void
+_gst_run_workers (
+
+int			nworkers,	/* IN - number of workers */
+gst_worker_func_t	func,		/* IN - worker function */
+void *			arg		/* IN - data shared by workers */
+)
+{
+int			i;
+#ifdef HAVE_PTHREADS
+struct worker *		wp;
+struct worker *		workers;
+#endif
+
+	FATAL_ERROR_IF (func EQ NULL);
+
+	if (nworkers <= 1) {
+		(*func) (0, arg);
+		return;
+	}
+
+#ifdef HAVE_PTHREADS
+	workers = NEWA (nworkers, struct worker);
+	for (i = 1; i < nworkers; i++) {
+		wp = &workers [i];
+		wp -> id	= i;
+		wp -> func	= func;
+		wp -> arg	= arg;
+		wp -> started	= (pthread_create (&(wp -> thread),
+						   NULL,
+						   worker_start,
+						   wp) EQ 0);
+	}
+
+	(*func) (0, arg);
+
+	for (i = 1; i < nworkers; i++) {
+		wp = &workers [i];
+		if (wp -> started) {
+			pthread_join (wp -> thread, NULL);
+		}
+		else {
+			/* Could not get a thread -- just do it here. */
+			(*func) (i, arg);
+		}
+	}
+	free ((char *) workers);
+#else
+	for (i = 0; i < nworkers; i++) {
+		(*func) (i, arg);
+	}
+#endif
+}
+
+/*
+ * The start routine of each thread created by _gst_run_workers().
+ */
+
+#ifdef HAVE_PTHREADS
+
+	static
+	void *
+worker_start (
+
+void *		p		/* IN - the worker to run */
+)
+{
+struct worker *		wp;
+
+	wp = (struct worker *) p;
+	(*(wp -> func)) (wp -> id, wp -> arg);
+
+	return (NULL);
+}
+
+#endif
+
+/*
+ * Divide the index range 0 through N-1 into NPARTS nearly equal
+ * contiguous pieces, and return the range FIRST <= i < LAST of the
+ * given piece.
+ */
+
+	void
+_gst_split_range (
+
+int		n,		/* IN - size of range to split */
+int		nparts,		/* IN - number of pieces */
+int		part,		/* IN - piece to get */
+int *		first,		/* OUT - start of piece */
+int *		last		/* OUT - end of piece (exclusive) */
+)
+{
+	FATAL_ERROR_IF ((nparts < 1) OR (part < 0) OR (part >= nparts));
+
+	*first	= (int) (((double) n) * part / nparts);
+	*last	= (int) (((double) n) * (part + 1) / nparts);
+}
+
+/*
+ * Mutual exclusion locks.
+ */
+
+	void
+_gst_mutex_init (
+
+struct gst_mutex *	mp		/* IN - lock to initialize */
+)
+{
+#ifdef HAVE_PTHREADS
+	FATAL_ERROR_IF (pthread_mutex_init (&(mp -> mutex), NULL) NE 0);
+#else
+	mp -> dummy = 0;
+#endif
+}
+
+
+	void
+_gst_mutex_destroy (
+
+struct gst_mutex *	mp		/* IN - lock to destroy */
+)
+{
+#ifdef HAVE_PTHREADS
+	pthread_mutex_destroy (&(mp -> mutex));
+#endif
+}
+
+
+	void
+_gst_mutex_lock (
+
+struct gst_mutex *	mp		/* IN - lock to acquire */
+)
+{
+#ifdef HAVE_PTHREADS
+	FATAL_ERROR_IF (pthread_mutex_lock (&(mp -> mutex)) NE 0);
+#endif
+}
+
+
+	void
+_gst_mutex_unlock (
+
+struct gst_mutex *	mp		/* IN - lock to release */
+)
+{
+#ifdef HAVE_PTHREADS
+	FATAL_ERROR_IF (pthread_mutex_unlock (&(mp -> mutex)) NE 0);
+#endif
+}
+
+/*
+ * Condition variables.  A thread waits while holding the given lock,
+ * which is released until the thread is woken.  Wake-ups may be
+ * spurious, so the waiter must test its condition again.
+ */
+
+	void
+_gst_cond_init (
+
+struct gst_cond *	cp		/* IN - condition to initialize */
+)
+{
+#ifdef HAVE_PTHREADS
+	FATAL_ERROR_IF (pthread_cond_init (&(cp -> cond), NULL) NE 0);
+#else
+	cp -> dummy = 0;
+#endif
+}
+
+
+	void
+_gst_cond_destroy (
+
+struct gst_cond *	cp		/* IN - condition to destroy */
+)
+{
+#ifdef HAVE_PTHREADS
+	pthread_cond_destroy (&(cp -> cond));
+#endif
+}
+
+
+	void
+_gst_cond_wait (
+
+struct gst_cond *	cp,		/* IN - condition to wait for */
+struct gst_mutex *	mp		/* IN - lock held by the caller */
+)
+{
+#ifdef HAVE_PTHREADS
+	FATAL_ERROR_IF (pthread_cond_wait (&(cp -> cond), &(mp -> mutex))
+			NE 0);
+#endif
+}
+
+
+/*
+ * Wait as above, but for at most the given number of seconds.
+ */
+
+	void
+_gst_cond_timedwait (
+
+struct gst_cond *	cp,		/* IN - condition to wait for */
+struct gst_mutex *	mp,		/* IN - lock held by the caller */
+double			seconds		/* IN - longest time to wait */
+)
+{
+#ifdef HAVE_PTHREADS
+int			rc;
+long			nsec;
+struct timespec		ts;
+
+	clock_gettime (CLOCK_REALTIME, &ts);
+	if (seconds > 0.0) {
+		ts.tv_sec += (time_t) seconds;
+		nsec = ts.tv_nsec
+			+ (long) ((seconds - (time_t) seconds) * 1.0e9);
+		if (nsec >= 1000000000L) {
+			nsec -= 1000000000L;
+			++(ts.tv_sec);
+		}
+		ts.tv_nsec = nsec;
+	}
+	rc = pthread_cond_timedwait (&(cp -> cond), &(mp -> mutex), &ts);
+	FATAL_ERROR_IF ((rc NE 0) AND (rc NE ETIMEDOUT));
+#endif
+}
+
+
+	void
+_gst_cond_signal (
+
+struct gst_cond *	cp		/* IN - condition to signal */
+)
+{
+#ifdef HAVE_PTHREADS
+	FATAL_ERROR_IF (pthread_cond_signal (&(cp -> cond)) NE 0);
+#endif
+}
+
+/*
+ * Start a background thread that runs FUNC (ARG).  Returns FALSE if
+ * the thread could not be started, in which case the caller must do
+ * the work itself.
+ */
+
+	bool
+_gst_start_thread (
+
+struct gst_thread *	tp,		/* OUT - the thread */
+gst_thread_func_t	func,		/* IN - function to run */
+void *			arg		/* IN - argument to pass */
+)
+{
+	FATAL_ERROR_IF (func EQ NULL);
+
+	tp -> func	= func;
+	tp -> arg	= arg;
+
+#ifdef HAVE_PTHREADS
+	return (pthread_create (&(tp -> thread), NULL, thread_start, tp) EQ 0);
+#else
+	return (FALSE);
+#endif
+}
+
+/*
+ * The start routine of each thread created by _gst_start_thread().
+ */
+
+#ifdef HAVE_PTHREADS
+
+	static
+	void *
+thread_start (
+
+void *		p		/* IN - the thread to run */
+)
+{
+struct gst_thread *	tp;
+
+	tp = (struct gst_thread *) p;
+	(*(tp -> func)) (tp -> arg);
+
+	return (NULL);
+}
+
+#endif
+
+/*
+ * Wait for a thread started by _gst_start_thread() to finish.
+ */
+
+	void
+_gst_join_thread (
+
+struct gst_thread *	tp		/* IN - thread to wait for */
+)
+{
+#ifdef HAVE_PTHREADS
+	pthread_join (tp -> thread, NULL);
+#endif
+}
+
+/*
+ * Give up the processor for a short while.  This is how background
+ * threads wait for more work, without needing a lock that the
+ * threads feeding them would have to take.
+ */
+
+	void
+_gst_thread_pause (void)
+
+{
+#ifdef HAVE_PTHREADS
+struct timespec		ts;
+
+	ts.tv_sec	= 0;
+	ts.tv_nsec	= 1000000;	/* 1 millisecond */
+	nanosleep (&ts, NULL);
+#endif
+}
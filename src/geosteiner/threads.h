@@ -0,0 +1,148 @@
+/***********************************************************************
+
+	File:	threads.h
+	Rev:	e-1
+	Date:	10/19/2026
+
+	This work is licensed under a Creative Commons
+	Attribution-NonCommercial 4.0 International License.
+
+************************************************************************
+
+	Declarations for the simple worker-thread facility used by
+	the parallel phases of GeoSteiner.
+
+************************************************************************/
+
+#ifndef THREADS_H
+#define	THREADS_H
+
+#include "config.h"
+#include "gsttypes.h"
+
+#ifdef HAVE_PTHREADS
+#include <pthread.h>
+#endif
+
+/*
+ * A worker function is called once for each worker, with the worker
+ * number (0 through NWORKERS-1) and a pointer to data shared by all
+ * of the workers.
+ */
+
+typedef void	(*gst_worker_func_t) (int id, void * arg);
+
+/*
+ * A background thread, running the given function with the given
+ * argument.  Without thread support such a thread can never be
+ * started, and the caller must do the work itself.
+ */
+
+typedef void	(*gst_thread_func_t) (void * arg);
+
+struct gst_thread {
+	gst_thread_func_t	func;
+	void *			arg;
+#ifdef HAVE_PTHREADS
+	pthread_t		thread;
+#endif
+};
+
+/*
+ * A mutual exclusion lock.  When threads are not available, there is
+ * only ever one worker running, and these locks do nothing.
+ */
+
+struct gst_mutex {
+#ifdef HAVE_PTHREADS
+	pthread_mutex_t		mutex;
+#else
+	int			dummy;
+#endif
+};
+
+/*
+ * A condition variable, on which a background thread sleeps until
+ * another thread has work for it.  It is always used together with a
+ * gst_mutex.  Without threads nobody can ever wait on it.
+ */
+
+struct gst_cond {
+#ifdef HAVE_PTHREADS
+	pthread_cond_t		cond;
+#else
+	int			dummy;
+#endif
+};
+
+/*
+ * Loads and stores of a word that is shared with another thread
+ * without a lock.  A store is not reordered with the memory accesses
+ * that precede it, and a load is not reordered with those that follow
+ * it.  ATOMIC_ADD adds to the word and yields its new value.
+ * ATOMIC_CAS stores N in the word if it holds *O, and otherwise
+ * copies its value to *O, yielding TRUE if the store was done.
+ * MEMORY_BARRIER keeps all earlier loads and stores ahead of all
+ * later ones, including a store followed by a load.
+ */
+
+#ifdef HAVE_PTHREADS
+#define	LOAD_ACQUIRE(p)		__atomic_load_n ((p), __ATOMIC_ACQUIRE)
+#define	STORE_RELEASE(p,v)	__atomic_store_n ((p), (v), __ATOMIC_RELEASE)
+#define	ATOMIC_ADD(p,v)		__atomic_add_fetch ((p), (v), __ATOMIC_ACQ_REL)
+#define	ATOMIC_CAS(p,o,n) \
+	__atomic_compare_exchange_n ((p), (o), (n), 0, \
+				     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#define	MEMORY_BARRIER()	__atomic_thread_fence (__ATOMIC_SEQ_CST)
+#else
+#define	LOAD_ACQUIRE(p)		(*(p))
+#define	STORE_RELEASE(p,v)	(*(p) = (v))
+#define	ATOMIC_ADD(p,v)		(*(p) += (v))
+#define	ATOMIC_CAS(p,o,n) \
+	((*(p) EQ *(o)) ? (*(p) = (n), TRUE) : (*(o) = *(p), FALSE))
+#define	MEMORY_BARRIER()
+#endif
+
+/*
+ * Storage class of a variable of which each thread has its own copy.
+ */
+
+#ifdef HAVE_PTHREADS
+#define	THREAD_LOCAL		__thread
+#else
+#define	THREAD_LOCAL
+#endif
+
+
+/*
+ * Global Routines
+ */
+
+extern void	_gst_cond_destroy (struct gst_cond * cp);
+extern void	_gst_cond_init (struct gst_cond * cp);
+extern void	_gst_cond_signal (struct gst_cond * cp);
+extern void	_gst_cond_timedwait (struct gst_cond *	cp,
+				     struct gst_mutex *	mp,
+				     double		seconds);
+extern void	_gst_cond_wait (struct gst_cond *	cp,
+				struct gst_mutex *	mp);
+extern int	_gst_effective_threads (int requested);
+extern void	_gst_join_thread (struct gst_thread * tp);
+extern void	_gst_mutex_destroy (struct gst_mutex * mp);
+extern void	_gst_mutex_init (struct gst_mutex * mp);
+extern void	_gst_mutex_lock (struct gst_mutex * mp);
+extern void	_gst_mutex_unlock (struct gst_mutex * mp);
+extern void	_gst_run_workers (int			nworkers,
+				  gst_worker_func_t	func,
+				  void *		arg);
+extern void	_gst_split_range (int		n,
+				  int		nparts,
+				  int		part,
+				  int *		first,
+				  int *		last);
+extern bool	_gst_start_thread (struct gst_thread *	tp,
+				   gst_thread_func_t	func,
+				   void *		arg);
+extern void	_gst_thread_pause (void);
+
+#endif
@@ -0,0 +1,1188 @@
+/***********************************************************************
+
+	File:	tiled.c
+	Rev:	e-1
+	Date:	10/19/2026
+
+	This work is licensed under a Creative Commons
+	Attribution-NonCommercial 4.0 International License.
+
+************************************************************************
+
+	Approximate SMTs for very large instances: cut the terminals
+	into overlapping tiles along the Euclidean minimum spanning
+	tree, solve each tile exactly, stitch the tile solutions
+	together and repair the tree along the seams.
+
+************************************************************************/
+
+#include "dsuf.h"
+#include "emst.h"
+#include "fatal.h"
+#include <float.h>
+#include "geosteiner.h"
+#include "logic.h"
+#include "memory.h"
+#include "metric.h"
+#include "parmblk.h"
+#include "point.h"
+#include "prepostlude.h"
+#include "sortfuncs.h"
+#include "steiner.h"
+#include <string.h>
+#include "threads.h"
+
+
+/*
+ * Global Routines
+ */
+
+int		gst_tiled_smt (int		nterms,
+			       double *		terms,
+			       int		tile_size,
+			       double *		length,
+			       double *		lower_bound,
+			       int *		nsps,
+			       double *		sps,
+			       int *		nedges,
+			       int *		edges,
+			       gst_metric_ptr	metric,
+			       gst_param_ptr	params);
+
+
+/*
+ * Local Equates
+ */
+
+#define	DEFAULT_TILE_SIZE	100
+#define	MIN_TILE_SIZE		4
+
+/*
+ * Every Steiner tree in the plane is at least this fraction of the
+ * length of the Euclidean MST (Chung and Graham, 1985).  Under the
+ * other metrics every distance is at least the Euclidean one, so the
+ * same bound applies there.
+ */
+
+#define	STEINER_RATIO_BOUND	0.824
+
+
+/*
+ * Local Types
+ */
+
+/* One full component of a tile's solution. */
+struct tfst {
+	int		nterms;		/* number of terminals */
+	int		nsps;		/* number of Steiner points */
+	int		nedges;		/* number of edges */
+	double		length;		/* length of component */
+	int *		terms;		/* terminals (global numbers) */
+	double *	sps;		/* Steiner point coordinates */
+	int *		edges;		/* edges: endpoints below nterms */
+					/* index terms[], the others sps[] */
+	bool		seam;		/* not inside a single tile */
+	bool		alive;		/* still part of the tree */
+};
+
+/* A set of terminals to be solved exactly. */
+struct tile_job {
+	int		nterms;		/* number of terminals */
+	int *		terms;		/* terminals (global numbers) */
+	int		nfsts;		/* FSTs of solution, or -1 if none */
+	struct tfst **	fsts;		/* the solution */
+	bool		optimal;	/* solution is optimal */
+	int		nold;		/* number of FSTs being replaced */
+	int *		old;		/* FSTs being replaced */
+	double		old_length;	/* their total length */
+};
+
+struct tile_pool {
+	struct gst_mutex	lock;		/* protects next_job */
+	int			next_job;	/* next job to solve */
+	int			njobs;		/* number of jobs */
+	struct tile_job *	jobs;		/* the jobs */
+	double *		terms;		/* all terminal coordinates */
+	gst_metric_ptr		metric;		/* metric */
+	gst_param_ptr		params;		/* parameters for the tiles */
+};
+
+/* The stitched tree, as a list of full components. */
+struct ttree {
+	int		nfsts;		/* number of FSTs */
+	int		maxfsts;	/* allocated size of fsts[] */
+	struct tfst **	fsts;		/* the FSTs */
+};
+
+
+/*
+ * Local Routines
+ */
+
+static void		add_fst (struct ttree *, struct tfst *);
+static int		cluster_tree (int, int *, int *, int, int *);
+static void		free_jobs (int, struct tile_job *);
+static void		free_tfst (struct tfst *);
+static int		make_repair_jobs (int, struct ttree *, int,
+					  struct tile_job **);
+static int		make_tiles (int, int *, int *, int, int *, int,
+				    struct tile_job **);
+static void		repair_seams (struct tile_pool *,
+				      int,
+				      struct ttree *,
+				      int,
+				      int);
+static void		run_jobs (struct tile_pool *,
+				  int,
+				  struct tile_job *,
+				  int);
+static void		solve_job (struct tile_pool *, struct tile_job *);
+static void		stitch_tiles (int,
+				      double *,
+				      int,
+				      struct tile_job *,
+				      int *,
+				      struct edge *,
+				      gst_metric_ptr,
+				      struct ttree *);
+static void		tile_worker (int, void *);
+
+/*
+ * Construct a short Steiner tree for a very large set of terminals,
+ * one that is too large to be solved exactly.  The terminals are cut
+ * into tiles of at most TILE_SIZE terminals, each a subtree of the
+ * Euclidean MST, and every tile is grown by some of its neighbours
+ * along the MST so that neighbouring tiles overlap.  Each tile is
+ * solved exactly (FST generation and the solver, as in gst_smt()),
+ * several at a time.  The full components of the tile solutions are
+ * then joined into a tree, preferring those inside a single tile, and
+ * with MST edges filling the gaps.  Finally, the tree is repaired
+ * along the seams between the tiles by solving small windows around
+ * them exactly.
+ *
+ * The lower bound returned is based on the length of the Euclidean
+ * MST of the terminals.
+ */
+
+	int
+gst_tiled_smt (
+
+int			nterms,		/* IN - number of terminals */
+double *		terms,		/* IN - terminal coordinates */
+int			tile_size,	/* IN - terminals per tile */
+					/* (0 = default) */
+double *		length,		/* OUT - length of tree */
+double *		lower_bound,	/* OUT - lower bound on SMT length */
+int *			nsps,		/* OUT - number of Steiner points */
+double *		sps,		/* OUT - Steiner point coordinates */
+int *			nedges,		/* OUT - number of tree edges */
+int *			edges,		/* OUT - tree edges */
+gst_metric_ptr		metric,		/* IN - metric */
+gst_param_ptr		params		/* IN - parameters (NULL=default) */
+)
+{
+int			i;
+int			j;
+int			k;
+int			res;
+int			nmst;
+int			ntiles;
+int			nthreads;
+int			ns;
+int			ne;
+int *			cluster;
+int *			adj_start;
+int *			adj;
+double			len;
+double			emst_len;
+struct edge *		mst;
+struct pset *		pts;
+struct tfst *		fp;
+struct tile_job *	tiles;
+gst_param_ptr		tparams;
+struct tile_pool	pool;
+struct ttree		tree;
+
+	GST_PRELUDE
+
+	res = 0;
+
+	if (length NE NULL)	 *length	= 0.0;
+	if (lower_bound NE NULL) *lower_bound	= 0.0;
+	if (nsps NE NULL)	 *nsps		= 0;
+	if (nedges NE NULL)	 *nedges	= 0;
+
+	do {	/* Used only for "break"... */
+		if (nterms < 0) {
+			res = GST_ERR_INVALID_NUMBER_OF_TERMINALS;
+			break;
+		}
+		if (	(metric EQ NULL)
+		    OR ((metric -> type NE GST_METRIC_L) AND
+			(metric -> type NE GST_METRIC_UNIFORM))) {
+			res = GST_ERR_INVALID_METRIC;
+			break;
+		}
+		if (nterms < 2) break;
+
+		if (tile_size <= 0) {
+			tile_size = DEFAULT_TILE_SIZE;
+		}
+		if (tile_size < MIN_TILE_SIZE) {
+			tile_size = MIN_TILE_SIZE;
+		}
+
+		if (params EQ NULL) {
+			params = (gst_param_ptr) &_gst_default_parmblk;
+		}
+		nthreads = _gst_effective_threads (params -> num_threads);
+
+		/* The Euclidean MST guides the tiling, provides the	*/
+		/* lower bound and fills the gaps between the tiles.	*/
+		pts = NEW_PSET (nterms);
+		ZERO_PSET (pts, nterms);
+		pts -> n = nterms;
+		for (i = 0; i < nterms; i++) {
+			pts -> a [i].x = terms [2*i];
+			pts -> a [i].y = terms [2*i + 1];
+		}
+		mst = NEWA (nterms - 1, struct edge);
+		nmst = _gst_euclidean_mst (pts, mst, nthreads);
+		FATAL_ERROR_IF (nmst NE nterms - 1);
+		free ((char *) pts);
+
+		emst_len = 0.0;
+		adj_start = NEWA (nterms + 1, int);
+		adj	  = NEWA (2 * nmst, int);
+		memset (adj_start, 0, (nterms + 1) * sizeof (int));
+		for (i = 0; i < nmst; i++) {
+			emst_len += mst [i].len;
+			++(adj_start [mst [i].p1 + 1]);
+			++(adj_start [mst [i].p2 + 1]);
+		}
+		for (i = 0; i < nterms; i++) {
+			adj_start [i + 1] += adj_start [i];
+		}
+		cluster = NEWA (nterms, int);
+		memcpy (cluster, adj_start, nterms * sizeof (int));
+		for (i = 0; i < nmst; i++) {
+			adj [cluster [mst [i].p1]++] = mst [i].p2;
+			adj [cluster [mst [i].p2]++] = mst [i].p1;
+		}
+
+		ntiles = cluster_tree (nterms,
+				       adj_start,
+				       adj,
+				       tile_size,
+				       cluster);
+		ntiles = make_tiles (nterms,
+				     adj_start,
+				     adj,
+				     ntiles,
+				     cluster,
+				     tile_size / 4,
+				     &tiles);
+
+		/* Parameters for the tiles.  The tiles are solved on	*/
+		/* several threads, so none of them may use threads of	*/
+		/* its own, trace into the user's channels, or write a	*/
+		/* checkpoint.  Targets and bounds for the whole	*/
+		/* instance mean nothing to a tile.			*/
+		tparams = gst_create_param (NULL);
+		gst_copy_param (tparams, params);
+		tparams -> num_threads			= 1;
+		tparams -> print_solve_trace		= NULL;
+		tparams -> detailed_timings_channel	= NULL;
+		tparams -> gap_target			= 1.0;
+		tparams -> upper_bound_target		= -DBL_MAX;
+		tparams -> lower_bound_target		= DBL_MAX;
+		tparams -> initial_upper_bound		= DBL_MAX;
+		gst_set_str_param (tparams, GST_PARAM_CHECKPOINT_FILENAME, NULL);
+		gst_set_str_param (tparams, GST_PARAM_MERGE_CONSTRAINT_FILES, NULL);
+
+		_gst_mutex_init (&(pool.lock));
+		pool.terms	= terms;
+		pool.metric	= metric;
+		pool.params	= tparams;
+
+		run_jobs (&pool, ntiles, tiles, nthreads);
+
+		tree.nfsts	= 0;
+		tree.maxfsts	= nterms;
+		tree.fsts	= NEWA (tree.maxfsts, struct tfst *);
+
+		stitch_tiles (nterms,
+			      terms,
+			      ntiles,
+			      tiles,
+			      cluster,
+			      mst,
+			      metric,
+			      &tree);
+
+		repair_seams (&pool, nterms, &tree, tile_size / 2, nthreads);
+
+		_gst_mutex_destroy (&(pool.lock));
+		gst_free_param (tparams);
+
+		/* Gather up the tree. */
+		len = 0.0;
+		ns = 0;
+		ne = 0;
+		for (i = 0; i < tree.nfsts; i++) {
+			fp = tree.fsts [i];
+			if (NOT fp -> alive) continue;
+			if (sps NE NULL) {
+				memcpy (&sps [2 * ns],
+					fp -> sps,
+					2 * fp -> nsps * sizeof (double));
+			}
+			if (edges NE NULL) {
+				for (j = 0; j < 2 * fp -> nedges; j++) {
+					k = fp -> edges [j];
+					if (k < fp -> nterms) {
+						k = fp -> terms [k];
+					}
+					else {
+						k = nterms + ns + (k - fp -> nterms);
+					}
+					edges [2 * ne + j] = k;
+				}
+			}
+			len += fp -> length;
+			ns += fp -> nsps;
+			ne += fp -> nedges;
+		}
+
+		if (length NE NULL) {
+			*length = len;
+		}
+		if (lower_bound NE NULL) {
+			*lower_bound = STEINER_RATIO_BOUND * emst_len;
+			if ((ntiles EQ 1) AND tiles [0].optimal) {
+				*lower_bound = len;
+			}
+			if (*lower_bound > len) {
+				*lower_bound = len;
+			}
+		}
+		if (nsps NE NULL) {
+			*nsps = ns;
+		}
+		if (nedges NE NULL) {
+			*nedges = ne;
+		}
+
+		for (i = 0; i < tree.nfsts; i++) {
+			free_tfst (tree.fsts [i]);
+		}
+		free ((char *) (tree.fsts));
+		free_jobs (ntiles, tiles);
+		free ((char *) cluster);
+		free ((char *) adj);
+		free ((char *) adj_start);
+		free ((char *) mst);
+	} while (FALSE);
+
+	GST_POSTLUDE
+	return (res);
+}
+
+/*
+ * Cut the MST (given as adjacency lists) into subtrees of at most
+ * MAXSIZE vertices each.  Working from the leaves up, each vertex
+ * keeps as many of its children's subtrees as fit, smallest first,
+ * and the others become clusters of their own.  Returns the number of
+ * clusters, with the cluster of each vertex in CLUSTER.
+ */
+
+	static
+	int
+cluster_tree (
+
+int		n,		/* IN - number of vertices */
+int *		adj_start,	/* IN - start of each adjacency list */
+int *		adj,		/* IN - adjacency lists */
+int		maxsize,	/* IN - maximum cluster size */
+int *		cluster		/* OUT - cluster of each vertex */
+)
+{
+int		i;
+int		j;
+int		k;
+int		v;
+int		w;
+int		nkids;
+int		nclusters;
+int *		order;
+int *		parent;
+int *		size;
+int *		kids;
+bool *		cut;
+
+	order	= NEWA (n, int);
+	parent	= NEWA (n, int);
+	size	= NEWA (n, int);
+	cut	= NEWA (n, bool);
+	kids	= NEWA (n, int);
+
+	/* Breadth-first order from vertex 0. */
+	for (i = 0; i < n; i++) {
+		parent [i]	= -2;
+		cut [i]		= FALSE;
+	}
+	parent [0] = -1;
+	order [0] = 0;
+	k = 1;
+	for (i = 0; i < k; i++) {
+		v = order [i];
+		for (j = adj_start [v]; j < adj_start [v + 1]; j++) {
+			w = adj [j];
+			if (parent [w] NE -2) continue;
+			parent [w] = v;
+			order [k++] = w;
+		}
+	}
+	FATAL_ERROR_IF (k NE n);
+
+	/* Children before parents. */
+	for (i = n - 1; i >= 0; i--) {
+		v = order [i];
+		nkids = 0;
+		for (j = adj_start [v]; j < adj_start [v + 1]; j++) {
+			w = adj [j];
+			if (w EQ parent [v]) continue;
+			/* Insert into kids[], by increasing size. */
+			for (k = nkids++; k > 0; k--) {
+				if (size [kids [k - 1]] <= size [w]) break;
+				kids [k] = kids [k - 1];
+			}
+			kids [k] = w;
+		}
+		size [v] = 1;
+		for (k = 0; k < nkids; k++) {
+			w = kids [k];
+			if (size [v] + size [w] <= maxsize) {
+				size [v] += size [w];
+			}
+			else {
+				cut [w] = TRUE;
+			}
+		}
+	}
+
+	nclusters = 0;
+	for (i = 0; i < n; i++) {
+		v = order [i];
+		if ((parent [v] < 0) OR cut [v]) {
+			cluster [v] = nclusters++;
+		}
+		else {
+			cluster [v] = cluster [parent [v]];
+		}
+	}
+
+	free ((char *) kids);
+	free ((char *) cut);
+	free ((char *) size);
+	free ((char *) parent);
+	free ((char *) order);
+
+	return (nclusters);
+}
+
+/*
+ * Make a tile for each cluster: its own terminals, followed by up to
+ * OVERLAP terminals of neighbouring clusters, nearest (along the MST)
+ * first.  Returns the number of tiles.
+ */
+
+	static
+	int
+make_tiles (
+
+int			n,		/* IN - number of terminals */
+int *			adj_start,	/* IN - start of each adjacency list */
+int *			adj,		/* IN - adjacency lists */
+int			nclusters,	/* IN - number of clusters */
+int *			cluster,	/* IN - cluster of each terminal */
+int			overlap,	/* IN - terminals to add to a tile */
+struct tile_job **	tiles_out	/* OUT - the tiles */
+)
+{
+int			i;
+int			j;
+int			k;
+int			v;
+int			w;
+int			c;
+int			limit;
+int *			first;
+int *			members;
+int *			queue;
+int *			stamp;
+struct tile_job *	tiles;
+struct tile_job *	tp;
+
+	/* List the terminals of each cluster. */
+	first	= NEWA (nclusters + 1, int);
+	members	= NEWA (n, int);
+	memset (first, 0, (nclusters + 1) * sizeof (int));
+	for (i = 0; i < n; i++) {
+		++(first [cluster [i] + 1]);
+	}
+	for (c = 0; c < nclusters; c++) {
+		first [c + 1] += first [c];
+	}
+	for (i = 0; i < n; i++) {
+		members [first [cluster [i]]++] = i;
+	}
+	for (c = nclusters; c > 0; c--) {
+		first [c] = first [c - 1];
+	}
+	first [0] = 0;
+
+	tiles	= NEWA (nclusters, struct tile_job);
+	memset (tiles, 0, nclusters * sizeof (struct tile_job));
+	queue	= NEWA (n, int);
+	stamp	= NEWA (n, int);
+	for (i = 0; i < n; i++) {
+		stamp [i] = -1;
+	}
+
+	for (c = 0; c < nclusters; c++) {
+		k = 0;
+		for (i = first [c]; i < first [c + 1]; i++) {
+			v = members [i];
+			stamp [v] = c;
+			queue [k++] = v;
+		}
+		limit = k + overlap;
+		for (i = 0; (i < k) AND (k < limit); i++) {
+			v = queue [i];
+			for (j = adj_start [v]; j < adj_start [v + 1]; j++) {
+				w = adj [j];
+				if (stamp [w] EQ c) continue;
+				stamp [w] = c;
+				queue [k++] = w;
+				if (k >= limit) break;
+			}
+		}
+		tp = &tiles [c];
+		tp -> nterms	= k;
+		tp -> terms	= NEWA (k, int);
+		memcpy (tp -> terms, queue, k * sizeof (int));
+		tp -> nfsts	= -1;
+	}
+
+	free ((char *) stamp);
+	free ((char *) queue);
+	free ((char *) members);
+	free ((char *) first);
+
+	*tiles_out = tiles;
+
+	return (nclusters);
+}
+
+/*
+ * Solve the given jobs, several at a time.
+ */
+
+	static
+	void
+run_jobs (
+
+struct tile_pool *	pp,		/* IN/OUT - pool of workers */
+int			njobs,		/* IN - number of jobs */
+struct tile_job *	jobs,		/* IN/OUT - jobs to solve */
+int			nthreads	/* IN - number of threads */
+)
+{
+	pp -> next_job	= 0;
+	pp -> njobs	= njobs;
+	pp -> jobs	= jobs;
+
+	if (nthreads > njobs) {
+		nthreads = njobs;
+	}
+	if (nthreads < 1) return;
+
+	_gst_run_workers (nthreads, tile_worker, pp);
+}
+
+/*
+ * Worker thread.  Each worker repeatedly takes the next job from the
+ * pool and solves it.
+ */
+
+	static
+	void
+tile_worker (
+
+int		id,		/* IN - worker number */
+void *		arg		/* IN - the pool */
+)
+{
+int			i;
+struct tile_pool *	pp;
+
+	(void) id;
+
+	pp = (struct tile_pool *) arg;
+
+	for (;;) {
+		_gst_mutex_lock (&(pp -> lock));
+		i = pp -> next_job++;
+		_gst_mutex_unlock (&(pp -> lock));
+		if (i >= pp -> njobs) break;
+		solve_job (pp, &(pp -> jobs [i]));
+	}
+}
+
+/*
+ * Solve a single job exactly, and record the full components of its
+ * solution.  The FSTs of every job are generated in parallel, as is
+ * the backtrack search.  gst_hg_solve() lets only one job at a time
+ * use the branch-and-cut, since the LP solver is not reentrant.
+ */
+
+	static
+	void
+solve_job (
+
+struct tile_pool *	pp,		/* IN - the pool */
+struct tile_job *	jp		/* IN/OUT - job to solve */
+)
+{
+int			i;
+int			j;
+int			e;
+int			n;
+int			nsol;
+int			res;
+int			status;
+int *			sol;
+double *		coords;
+struct full_set *	fsp;
+struct tfst *		fp;
+gst_hg_ptr		H;
+gst_solver_ptr		solver;
+gst_param_ptr		params;
+
+	n = jp -> nterms;
+	params = pp -> params;
+
+	jp -> nfsts	= -1;
+	jp -> fsts	= NULL;
+	jp -> optimal	= FALSE;
+
+	if (n < 2) {
+		jp -> nfsts	= 0;
+		jp -> optimal	= TRUE;
+		return;
+	}
+
+	coords = NEWA (2 * n, double);
+	for (i = 0; i < n; i++) {
+		coords [2*i]	 = pp -> terms [2 * jp -> terms [i]];
+		coords [2*i + 1] = pp -> terms [2 * jp -> terms [i] + 1];
+	}
+
+	H = gst_generate_fsts (n, coords, pp -> metric, params, &res);
+	free ((char *) coords);
+	if (H EQ NULL) return;
+
+	solver = gst_create_solver (H, params, NULL);
+	res = gst_hg_solve (solver, NULL);
+
+	sol = NEWA (H -> num_edges, int);
+	if (	(res EQ 0)
+	    AND (gst_hg_solution (solver, &nsol, sol, NULL, 0) EQ 0)) {
+		gst_get_solver_status (solver, &status);
+		jp -> optimal	= (status EQ GST_STATUS_OPTIMAL);
+		jp -> nfsts	= nsol;
+		jp -> fsts	= NEWA (nsol, struct tfst *);
+		for (i = 0; i < nsol; i++) {
+			e = sol [i];
+			fsp = H -> full_trees [e];
+			fp = NEW (struct tfst);
+			fp -> nterms	= fsp -> terminals -> n;
+			fp -> nsps	= (fsp -> steiners EQ NULL)
+						? 0 : fsp -> steiners -> n;
+			fp -> nedges	= fsp -> nedges;
+			fp -> length	= H -> cost [e];
+			fp -> terms	= NEWA (fp -> nterms, int);
+			fp -> sps	= NEWA (2 * fp -> nsps + 1, double);
+			fp -> edges	= NEWA (2 * fp -> nedges, int);
+			fp -> seam	= FALSE;
+			fp -> alive	= TRUE;
+			for (j = 0; j < fp -> nterms; j++) {
+				fp -> terms [j] = jp -> terms [fsp -> tlist [j]];
+			}
+			for (j = 0; j < fp -> nsps; j++) {
+				fp -> sps [2*j]	    = fsp -> steiners -> a [j].x;
+				fp -> sps [2*j + 1] = fsp -> steiners -> a [j].y;
+			}
+			for (j = 0; j < fp -> nedges; j++) {
+				fp -> edges [2*j]     = fsp -> edges [j].p1;
+				fp -> edges [2*j + 1] = fsp -> edges [j].p2;
+			}
+			jp -> fsts [i] = fp;
+		}
+	}
+	free ((char *) sol);
+
+	gst_free_solver (solver);
+	gst_free_hg (H);
+}
+
+/*
+ * Join the solutions of the tiles into a single tree.  This is
+ * Kruskal's algorithm on the full components, accepting each one
+ * whose terminals are all in different subtrees.  First come the
+ * components having all of their terminals in the tile's own
+ * cluster, which cannot form a cycle.  Next come those that cross
+ * into a neighbouring cluster, shortest per terminal first.  Last
+ * come the MST edges, which connect whatever is left.
+ */
+
+	static
+	void
+stitch_tiles (
+
+int			nterms,		/* IN - number of terminals */
+double *		terms,		/* IN - terminal coordinates */
+int			ntiles,		/* IN - number of tiles */
+struct tile_job *	tiles,		/* IN/OUT - solved tiles */
+int *			cluster,	/* IN - cluster of each terminal */
+struct edge *		mst,		/* IN - the Euclidean MST */
+gst_metric_ptr		metric,		/* IN - metric */
+struct ttree *		tree		/* OUT - the tree */
+)
+{
+int			i;
+int			j;
+int			k;
+int			t;
+int			p1;
+int			p2;
+int			ncross;
+int			naccepted;
+int *			roots;
+int *			order;
+int *			stamp;
+dist_t *		keys;
+bool			ok;
+struct tfst *		fp;
+struct tfst **		cross;
+struct dsuf		sets;
+
+	_gst_dsuf_create (&sets, nterms);
+	for (i = 0; i < nterms; i++) {
+		_gst_dsuf_makeset (&sets, i);
+	}
+	stamp = NEWA (nterms, int);
+	for (i = 0; i < nterms; i++) {
+		stamp [i] = -1;
+	}
+	roots = NEWA (nterms, int);
+	naccepted = 0;
+
+	/* Sort out the components crossing between clusters, and	*/
+	/* drop those covered by another tile.				*/
+	ncross = 0;
+	for (t = 0; t < ntiles; t++) {
+		for (i = 0; i < tiles [t].nfsts; i++) {
+			fp = tiles [t].fsts [i];
+			k = 0;
+			for (j = 0; j < fp -> nterms; j++) {
+				if (cluster [fp -> terms [j]] EQ t) {
+					++k;
+				}
+			}
+			if (k EQ fp -> nterms) continue;
+			if (k > 0) {
+				/* Crosses into a neighbour. */
+				fp -> seam = TRUE;
+				++ncross;
+			}
+			else {
+				/* The neighbour's own tile covers this. */
+				free_tfst (fp);
+				tiles [t].fsts [i] = NULL;
+			}
+		}
+	}
+
+	cross = NEWA (ncross + 1, struct tfst *);
+	keys  = NEWA (ncross + 1, dist_t);
+	ncross = 0;
+	for (t = 0; t < ntiles; t++) {
+		for (i = 0; i < tiles [t].nfsts; i++) {
+			fp = tiles [t].fsts [i];
+			if (fp EQ NULL) continue;
+			tiles [t].fsts [i] = NULL;
+			if (fp -> seam) {
+				keys [ncross]	 = fp -> length / (fp -> nterms - 1);
+				cross [ncross++] = fp;
+				continue;
+			}
+			add_fst (tree, fp);
+			for (j = 1; j < fp -> nterms; j++) {
+				_gst_dsuf_unite (&sets,
+						 _gst_dsuf_find (&sets, fp -> terms [0]),
+						 _gst_dsuf_find (&sets, fp -> terms [j]));
+			}
+			naccepted += fp -> nterms - 1;
+		}
+	}
+
+	/* Components crossing between clusters. */
+	order = _gst_sort_keys (ncross, keys, 1);
+	for (i = 0; i < ncross; i++) {
+		fp = cross [order [i]];
+		ok = TRUE;
+		for (j = 0; j < fp -> nterms; j++) {
+			roots [j] = _gst_dsuf_find (&sets, fp -> terms [j]);
+			if (stamp [roots [j]] EQ i) {
+				ok = FALSE;
+				break;
+			}
+			stamp [roots [j]] = i;
+		}
+		if (NOT ok) {
+			free_tfst (fp);
+			continue;
+		}
+		add_fst (tree, fp);
+		for (j = 1; j < fp -> nterms; j++) {
+			_gst_dsuf_unite (&sets,
+					 _gst_dsuf_find (&sets, roots [0]),
+					 _gst_dsuf_find (&sets, roots [j]));
+		}
+		naccepted += fp -> nterms - 1;
+	}
+	free ((char *) order);
+	free ((char *) keys);
+	free ((char *) cross);
+
+	/* MST edges, shortest first. */
+	if (naccepted < nterms - 1) {
+		keys = NEWA (nterms - 1, dist_t);
+		for (i = 0; i < nterms - 1; i++) {
+			keys [i] = mst [i].len;
+		}
+		order = _gst_sort_keys (nterms - 1, keys, 1);
+		for (i = 0; i < nterms - 1; i++) {
+			if (naccepted >= nterms - 1) break;
+			p1 = mst [order [i]].p1;
+			p2 = mst [order [i]].p2;
+			p1 = _gst_dsuf_find (&sets, p1);
+			p2 = _gst_dsuf_find (&sets, p2);
+			if (p1 EQ p2) continue;
+			_gst_dsuf_unite (&sets, p1, p2);
+			++naccepted;
+
+			p1 = mst [order [i]].p1;
+			p2 = mst [order [i]].p2;
+			fp = NEW (struct tfst);
+			fp -> nterms	= 2;
+			fp -> nsps	= 0;
+			fp -> nedges	= 1;
+			fp -> length	= gst_distance (metric,
+							terms [2*p1],
+							terms [2*p1 + 1],
+							terms [2*p2],
+							terms [2*p2 + 1]);
+			fp -> terms	= NEWA (2, int);
+			fp -> sps	= NEWA (1, double);
+			fp -> edges	= NEWA (2, int);
+			fp -> terms [0]	= p1;
+			fp -> terms [1]	= p2;
+			fp -> edges [0]	= 0;
+			fp -> edges [1]	= 1;
+			fp -> seam	= TRUE;
+			fp -> alive	= TRUE;
+			add_fst (tree, fp);
+		}
+		free ((char *) order);
+		free ((char *) keys);
+	}
+	FATAL_ERROR_IF (naccepted NE nterms - 1);
+
+	free ((char *) roots);
+	free ((char *) stamp);
+	_gst_dsuf_destroy (&sets);
+}
+
+/*
+ * Repair the tree along the seams between the tiles.  Around each
+ * component on a seam we take a window: a connected set of the
+ * tree's components having at most MAXSIZE terminals in all.  Taking
+ * these components out of the tree leaves each of the window's
+ * terminals in a different subtree, so any Steiner tree for the
+ * window's terminals can take their place.  We do so whenever the
+ * SMT for the window is shorter.  Windows share no components, so
+ * they can all be solved at once.
+ */
+
+	static
+	void
+repair_seams (
+
+struct tile_pool *	pp,		/* IN - the pool */
+int			nterms,		/* IN - number of terminals */
+struct ttree *		tree,		/* IN/OUT - the tree */
+int			maxsize,	/* IN - maximum terminals in window */
+int			nthreads	/* IN - number of threads */
+)
+{
+int			i;
+int			j;
+int			nwindows;
+double			len;
+struct tile_job *	windows;
+struct tile_job *	wp;
+
+	if (maxsize < 3) return;
+
+	nwindows = make_repair_jobs (nterms, tree, maxsize, &windows);
+
+	run_jobs (pp, nwindows, windows, nthreads);
+
+	for (i = 0; i < nwindows; i++) {
+		wp = &windows [i];
+		if (wp -> nfsts < 0) continue;
+		len = 0.0;
+		for (j = 0; j < wp -> nfsts; j++) {
+			len += wp -> fsts [j] -> length;
+		}
+		if (len >= wp -> old_length * (1.0 - 1.0e-9)) continue;
+		for (j = 0; j < wp -> nold; j++) {
+			tree -> fsts [wp -> old [j]] -> alive = FALSE;
+		}
+		for (j = 0; j < wp -> nfsts; j++) {
+			wp -> fsts [j] -> seam = TRUE;
+			add_fst (tree, wp -> fsts [j]);
+			wp -> fsts [j] = NULL;
+		}
+	}
+
+	free_jobs (nwindows, windows);
+}
+
+/*
+ * Make the windows for repairing the seams.  Returns the number of
+ * windows.
+ */
+
+	static
+	int
+make_repair_jobs (
+
+int			nterms,		/* IN - number of terminals */
+struct ttree *		tree,		/* IN - the tree */
+int			maxsize,	/* IN - maximum terminals in window */
+struct tile_job **	jobs_out	/* OUT - the windows */
+)
+{
+int			i;
+int			j;
+int			k;
+int			f;
+int			s;
+int			t;
+int			nf;
+int			nt;
+int			nnew;
+int			nwindows;
+int *			start;
+int *			incident;
+int *			stamp;
+int *			wfsts;
+int *			wterms;
+bool *			claimed;
+double			len;
+struct tfst *		fp;
+struct tile_job *	jobs;
+struct tile_job *	wp;
+
+	/* The components at each terminal. */
+	start = NEWA (nterms + 1, int);
+	memset (start, 0, (nterms + 1) * sizeof (int));
+	for (f = 0; f < tree -> nfsts; f++) {
+		fp = tree -> fsts [f];
+		for (j = 0; j < fp -> nterms; j++) {
+			++(start [fp -> terms [j] + 1]);
+		}
+	}
+	for (i = 0; i < nterms; i++) {
+		start [i + 1] += start [i];
+	}
+	incident = NEWA (start [nterms], int);
+	stamp = NEWA (nterms, int);
+	memcpy (stamp, start, nterms * sizeof (int));
+	for (f = 0; f < tree -> nfsts; f++) {
+		fp = tree -> fsts [f];
+		for (j = 0; j < fp -> nterms; j++) {
+			incident [stamp [fp -> terms [j]]++] = f;
+		}
+	}
+	for (i = 0; i < nterms; i++) {
+		stamp [i] = -1;
+	}
+
+	claimed = NEWA (tree -> nfsts, bool);
+	for (f = 0; f < tree -> nfsts; f++) {
+		claimed [f] = FALSE;
+	}
+	wfsts	= NEWA (tree -> nfsts, int);
+	wterms	= NEWA (nterms, int);
+	jobs	= NEWA (tree -> nfsts, struct tile_job);
+	memset (jobs, 0, tree -> nfsts * sizeof (struct tile_job));
+	nwindows = 0;
+
+	for (s = 0; s < tree -> nfsts; s++) {
+		fp = tree -> fsts [s];
+		if (claimed [s] OR NOT fp -> seam) continue;
+		if (fp -> nterms > maxsize) continue;
+
+		/* Grow a window from this component. */
+		nf = 0;
+		nt = 0;
+		claimed [s] = TRUE;
+		wfsts [nf++] = s;
+		len = fp -> length;
+		for (j = 0; j < fp -> nterms; j++) {
+			stamp [fp -> terms [j]] = s;
+			wterms [nt++] = fp -> terms [j];
+		}
+		for (i = 0; i < nt; i++) {
+			t = wterms [i];
+			for (k = start [t]; k < start [t + 1]; k++) {
+				f = incident [k];
+				if (claimed [f]) continue;
+				fp = tree -> fsts [f];
+				nnew = 0;
+				for (j = 0; j < fp -> nterms; j++) {
+					if (stamp [fp -> terms [j]] NE s) {
+						++nnew;
+					}
+				}
+				if (nt + nnew > maxsize) continue;
+				claimed [f] = TRUE;
+				wfsts [nf++] = f;
+				len += fp -> length;
+				for (j = 0; j < fp -> nterms; j++) {
+					if (stamp [fp -> terms [j]] NE s) {
+						stamp [fp -> terms [j]] = s;
+						wterms [nt++] = fp -> terms [j];
+					}
+				}
+			}
+		}
+
+		if (nf < 2) {
+			/* A single component is as good as it gets. */
+			claimed [s] = FALSE;
+			continue;
+		}
+
+		wp = &jobs [nwindows++];
+		wp -> nterms	= nt;
+		wp -> terms	= NEWA (nt, int);
+		memcpy (wp -> terms, wterms, nt * sizeof (int));
+		wp -> nfsts	= -1;
+		wp -> nold	= nf;
+		wp -> old	= NEWA (nf, int);
+		memcpy (wp -> old, wfsts, nf * sizeof (int));
+		wp -> old_length = len;
+	}
+
+	free ((char *) wterms);
+	free ((char *) wfsts);
+	free ((char *) claimed);
+	free ((char *) stamp);
+	free ((char *) incident);
+	free ((char *) start);
+
+	*jobs_out = jobs;
+
+	return (nwindows);
+}
+
+/*
+ * Append a component to the tree.
+ */
+
+	static
+	void
+add_fst (
+
+struct ttree *		tree,		/* IN/OUT - the tree */
+struct tfst *		fp		/* IN - component to add */
+)
+{
+struct tfst **		fsts;
+
+	if (tree -> nfsts >= tree -> maxfsts) {
+		tree -> maxfsts *= 2;
+		fsts = NEWA (tree -> maxfsts, struct tfst *);
+		memcpy (fsts, tree -> fsts, tree -> nfsts * sizeof (fsts [0]));
+		free ((char *) (tree -> fsts));
+		tree -> fsts = fsts;
+	}
+	tree -> fsts [tree -> nfsts++] = fp;
+}
+
+/*
+ * Free up a list of jobs, and whatever is left of their solutions.
+ */
+
+	static
+	void
+free_jobs (
+
+int			njobs,		/* IN - number of jobs */
+struct tile_job *	jobs		/* IN - the jobs */
+)
+{
+int			i;
+int			j;
+struct tile_job *	jp;
+
+	for (i = 0; i < njobs; i++) {
+		jp = &jobs [i];
+		for (j = 0; j < jp -> nfsts; j++) {
+			if (jp -> fsts [j] NE NULL) {
+				free_tfst (jp -> fsts [j]);
+			}
+		}
+		if (jp -> fsts NE NULL) {
+			free ((char *) (jp -> fsts));
+		}
+		if (jp -> old NE NULL) {
+			free ((char *) (jp -> old));
+		}
+		free ((char *) (jp -> terms));
+	}
+	free ((char *) jobs);
+}
+
+/*
+ * Free up a component.
+ */
+
+	static
+	void
+free_tfst (
+
+struct tfst *		fp		/* IN - component to free */
+)
+{
+	free ((char *) (fp -> edges));
+	free ((char *) (fp -> sps));
+	free ((char *) (fp -> terms));
+	free ((char *) fp);
+}
@@ -257,7 +257,9 @@ dist_t			key4;
 
 /*
  * This routine finds all of the MST edges (edges of cardinality 2) and
- * sorts them in increasing order by length.
+ * sorts them in increasing order by length.  Returns NULL if the edges
+ * of cardinality 2 do not span the vertices (as happens with pruned
+ * FSTs, or the blocks of a hypergraph).
  */
 
 	static
@@ -330,7 +332,12 @@ struct dsuf		sets;
 			}
 		} while (h > 1);
 
-		if (n >= cip -> num_verts) {
+		if (n < cip -> num_verts - 1) {
+			/* Too few to span the vertices: no MST. */
+			free ((char *) mst_edges);
+			mst_edges = NULL;
+		}
+		else {
 			/* Remove all non-MST edges from the list. */
 			_gst_dsuf_create (&sets, cip -> num_verts);
 			for (i = 0; i < cip -> num_verts; i++) {
@@ -349,7 +356,12 @@ struct dsuf		sets;
 			}
 			_gst_dsuf_destroy (&sets);
 			n = p1 - mst_edges;
-			FATAL_ERROR_IF (n NE cip -> num_verts - 1);
+			if (n NE cip -> num_verts - 1) {
+				/* The 2-edges do not connect the	*/
+				/* vertices: no MST.			*/
+				free ((char *) mst_edges);
+				return (NULL);
+			}
 			/* Create a properly-sized copy of the edges. */
 			p1 = NEWA (n, int);
 			for (i = 0; i < n; i++) {
@@ -729,7 +741,9 @@ bitmap_t *		used;
 	l = ub_kruskal (edge_list, nedges, used, solver);
 
 	if (l EQ INF_DISTANCE) {
-		return; /* No initial tree found */
+		/* No initial tree found */
+		free ((char *) used);
+		return;
 	}
 
 	/* Copy the list so that we can quickly add an edge	*/
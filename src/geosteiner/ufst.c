@@ -249,7 +249,8 @@ gst_proplist_ptr	plist;
 	T0 = _gst_get_cpu_time ();
 	Tn = T0;
 
-	uinfo.x_order = _gst_heapsort_x (pts);
+	uinfo.x_order = _gst_sort_points_x (pts,
+					     params -> num_threads);
 
 	if (timing NE NULL) {
 		_gst_convert_delta_cpu_time (buf1, &Tn);
@@ -602,6 +603,7 @@ gst_channel_ptr		timing;
 	if (max_fst_size > n) max_fst_size = n;
 	for (size = 2; size <= max_fst_size; size++) {
 		int isize, jsize;
+		if (_gst_fst_generation_stopped ()) break;
 		/* New terminal array size */
 		hfstk.terms = NEWA (size + 1, int);
 		hfstk.S	    = size;
@@ -619,6 +621,7 @@ gst_channel_ptr		timing;
 				bool degree4possible;
 				bool hfsti_changed = TRUE;
 				bool bsd_reusable = FALSE;
+				if (_gst_fst_generation_stopped ()) break;
 				jsize = size - isize;
 
 				/* Setup special degree 4 flag */
@@ -1826,6 +1829,7 @@ struct full_set *	fsp;
 			fsp -> steiners	 = NULL;
 			fsp -> nedges	 = 1;
 			fsp -> edges	 = edges;
+			fsp -> refcount	 = 1;
 
 			*(uip -> hookp) = fsp;
 			uip -> hookp	= &(fsp -> next);
@@ -2091,6 +2095,7 @@ found_ufst:
 	fsp -> steiners		= new_steiners;
 	fsp -> nedges		= nedges;
 	fsp -> edges		= edges;
+	fsp -> refcount		= 1;
 
 	up = NEW (struct ulist);
 
@@ -1 +1,3 @@
+pub mod api;
 pub mod geosteiner;
+pub mod smt;
@@ -0,0 +1,528 @@
+//! Steiner minimal trees under the rectilinear (`L1`), Euclidean (`L2`)
+//! and uniform orientation (`Uniform<LAMBDA>`) metrics.
+//!
+//! The metric is a type parameter, so each instantiation of `smt` is
+//! specialized at compile time.  Tiny instances are solved directly in
+//! Rust, without calling into the C library:
+//!
+//! * up to 2 terminals under every metric,
+//! * up to 3 terminals under `L2` (the same construction as `gst_esmt3`),
+//! * up to 4 terminals under `L1` and `Uniform<2>` (3 terminals as in
+//!   `gst_rsmt3`, 4 terminals by trying every set of at most 2 Steiner
+//!   points on the Hanan grid).
+//!
+//! Everything else goes through `gst_smt`.
+//!
+//! `anytime_smt` instead returns the best tree it can find within a
+//! time limit, reporting each improvement as it goes.
+
+use std::any::Any;
+use std::os::raw::{c_double, c_int, c_void};
+use std::panic::{self, AssertUnwindSafe};
+use std::ptr;
+use std::time::Duration;
+
+use crate::api::{Error, Metric};
+use crate::geosteiner::{Edge, Point};
+
+// Values from geosteiner.h
+const GST_METRIC_L: c_int = 1;
+const GST_METRIC_UNIFORM: c_int = 2;
+
+const HALF_SQRT3: f64 = 0.86602540378443864676;
+
+extern "C" {
+    fn gst_smt(
+        nterms: c_int,
+        terms: *const c_double,
+        length: *mut c_double,
+        nsps: *mut c_int,
+        sps: *mut c_double,
+        nedges: *mut c_int,
+        edges: *mut c_int,
+        status: *mut c_int,
+        metric: *mut c_void,
+        param: *mut c_void,
+    ) -> c_int;
+
+    fn gst_anytime_smt(
+        nterms: c_int,
+        terms: *const c_double,
+        time_limit: c_double,
+        cb_func: Option<AnytimeFunc>,
+        cb_data: *mut c_void,
+        length: *mut c_double,
+        lower_bound: *mut c_double,
+        nsps: *mut c_int,
+        sps: *mut c_double,
+        nedges: *mut c_int,
+        edges: *mut c_int,
+        status: *mut c_int,
+        metric: *mut c_void,
+        param: *mut c_void,
+    ) -> c_int;
+}
+
+type AnytimeFunc = unsafe extern "C" fn(
+    length: c_double,
+    lower_bound: c_double,
+    nsps: c_int,
+    sps: *mut c_double,
+    nedges: c_int,
+    edges: *mut c_int,
+    cb_data: *mut c_void,
+);
+
+// Value from geosteiner.h
+const GST_STATUS_OPTIMAL: c_int = 0;
+
+/// A Steiner minimal tree.  Edge endpoints below the number of
+/// terminals refer to terminals, the others to `steiner_points`.
+#[derive(Clone, Debug)]
+pub struct SteinerTree {
+    pub length: f64,
+    pub steiner_points: Vec<Point>,
+    pub edges: Vec<Edge>,
+}
+
+/// A metric for which Steiner minimal trees can be computed.
+pub trait SmtMetric {
+    /// The metric as given to `gst_create_metric`.
+    const TYPE: i32;
+    const PARAMETER: i32;
+
+    fn distance(p: Point, q: Point) -> f64;
+
+    /// Solves the instance in Rust, if it is small enough.
+    fn solve_small(terms: &[Point]) -> Option<SteinerTree> {
+        small_tree::<Self>(terms)
+    }
+}
+
+/// The rectilinear metric.
+pub struct L1;
+
+/// The Euclidean metric.
+pub struct L2;
+
+/// The uniform orientation metric having `LAMBDA` orientations
+/// (2 is rectilinear, 4 is octilinear).
+pub struct Uniform<const LAMBDA: i32>;
+
+impl SmtMetric for L1 {
+    const TYPE: i32 = GST_METRIC_L;
+    const PARAMETER: i32 = 1;
+
+    fn distance(p: Point, q: Point) -> f64 {
+        (q.x - p.x).abs() + (q.y - p.y).abs()
+    }
+
+    fn solve_small(terms: &[Point]) -> Option<SteinerTree> {
+        match terms.len() {
+            3 => Some(rsmt3(terms)),
+            4 => Some(rsmt4(terms)),
+            _ => small_tree::<Self>(terms),
+        }
+    }
+}
+
+impl SmtMetric for L2 {
+    const TYPE: i32 = GST_METRIC_L;
+    const PARAMETER: i32 = 2;
+
+    fn distance(p: Point, q: Point) -> f64 {
+        (q.x - p.x).hypot(q.y - p.y)
+    }
+
+    fn solve_small(terms: &[Point]) -> Option<SteinerTree> {
+        match terms.len() {
+            3 => Some(esmt3(terms)),
+            _ => small_tree::<Self>(terms),
+        }
+    }
+}
+
+// With 2 orientations we use the rectilinear solver, which is faster
+// and also finds Steiner points of degree 4.
+impl<const LAMBDA: i32> SmtMetric for Uniform<LAMBDA> {
+    const TYPE: i32 = if LAMBDA == 2 { GST_METRIC_L } else { GST_METRIC_UNIFORM };
+    const PARAMETER: i32 = if LAMBDA == 2 { 1 } else { LAMBDA };
+
+    fn distance(p: Point, q: Point) -> f64 {
+        let dx = (q.x - p.x).abs();
+        let dy = (q.y - p.y).abs();
+        match LAMBDA {
+            2 => dx + dy,
+            4 => dx.max(dy) + (std::f64::consts::SQRT_2 - 1.0) * dx.min(dy),
+            _ => {
+                // Split the vector between the two nearest orientations.
+                let omega = std::f64::consts::PI / LAMBDA as f64;
+                let theta = dy.atan2(dx);
+                let phi = theta - (theta / omega).floor() * omega;
+                dx.hypot(dy) * ((omega - phi).sin() + phi.sin()) / omega.sin()
+            }
+        }
+    }
+
+    fn solve_small(terms: &[Point]) -> Option<SteinerTree> {
+        if LAMBDA == 2 { L1::solve_small(terms) } else { small_tree::<Self>(terms) }
+    }
+}
+
+/// Computes a Steiner minimal tree for the given terminals under
+/// metric `M`.
+pub fn smt<M: SmtMetric>(terms: &[Point]) -> Result<SteinerTree, Error> {
+    if let Some(tree) = M::solve_small(terms) {
+        return Ok(tree);
+    }
+    smt_c(terms, M::TYPE, M::PARAMETER)
+}
+
+/// Rectilinear Steiner minimal tree.
+pub fn rsmt(terms: &[Point]) -> Result<SteinerTree, Error> { smt::<L1>(terms) }
+
+/// Euclidean Steiner minimal tree.
+pub fn esmt(terms: &[Point]) -> Result<SteinerTree, Error> { smt::<L2>(terms) }
+
+/// Octilinear Steiner minimal tree.
+pub fn osmt(terms: &[Point]) -> Result<SteinerTree, Error> { smt::<Uniform<4>>(terms) }
+
+/// The outcome of `anytime_smt`: the best tree found, and a lower
+/// bound on the length of a Steiner minimal tree.
+#[derive(Clone, Debug)]
+pub struct AnytimeTree {
+    pub tree: SteinerTree,
+    pub lower_bound: f64,
+    /// The search completed, so `tree` is a Steiner minimal tree.
+    pub optimal: bool,
+}
+
+impl AnytimeTree {
+    /// How far `tree` may be from optimal, in percent of its length.
+    pub fn gap(&self) -> f64 {
+        if self.tree.length > 0.0 {
+            100.0 * (self.tree.length - self.lower_bound) / self.tree.length
+        } else {
+            0.0
+        }
+    }
+}
+
+/// Computes the best Steiner tree it can for the given terminals under
+/// metric `M` within `time_limit` of wall clock time.  A minimum
+/// spanning tree is passed to `on_improve` at once, followed by each
+/// shorter tree or better lower bound as the solver finds it.  To
+/// receive these on another thread, send them down a channel from
+/// `on_improve`.  If `on_improve` panics, it is not called again, and
+/// the panic is resumed once the solver has returned.
+pub fn anytime_smt<M: SmtMetric, F: FnMut(&SteinerTree, f64)>(
+    terms: &[Point],
+    time_limit: Duration,
+    mut on_improve: F,
+) -> Result<AnytimeTree, Error> {
+    if let Some(tree) = M::solve_small(terms) {
+        on_improve(&tree, tree.length);
+        let lower_bound = tree.length;
+        return Ok(AnytimeTree { tree, lower_bound, optimal: true });
+    }
+
+    let metric = Metric::create(M::TYPE, M::PARAMETER)?;
+    let n = terms.len();
+    let mut length = 0.0;
+    let mut lower_bound = 0.0;
+    let mut nsps: c_int = 0;
+    let mut nedges: c_int = 0;
+    let mut status: c_int = 0;
+    let mut sps = vec![Point::new(0.0, 0.0); n.max(2) - 2];
+    let mut edges = vec![0 as c_int; 2 * (2 * n).max(3) - 6];
+    let mut callback = AnytimeCallback { on_improve, panic: None };
+    let res = unsafe {
+        gst_anytime_smt(
+            n as c_int,
+            terms.as_ptr() as *const c_double,
+            time_limit.as_secs_f64(),
+            Some(anytime_trampoline::<F>),
+            &mut callback as *mut AnytimeCallback<F> as *mut c_void,
+            &mut length,
+            &mut lower_bound,
+            &mut nsps,
+            sps.as_mut_ptr() as *mut c_double,
+            &mut nedges,
+            edges.as_mut_ptr(),
+            &mut status,
+            metric.ptr as *mut c_void,
+            ptr::null_mut(),
+        )
+    };
+    if let Some(payload) = callback.panic {
+        panic::resume_unwind(payload);
+    }
+    if res != 0 {
+        return Err(Error { code: res });
+    }
+
+    sps.truncate(nsps as usize);
+    Ok(AnytimeTree {
+        tree: SteinerTree {
+            length,
+            steiner_points: sps,
+            edges: edges[..2 * nedges as usize]
+                .chunks(2)
+                .map(|e| Edge::new(e[0], e[1]))
+                .collect(),
+        },
+        lower_bound,
+        optimal: status == GST_STATUS_OPTIMAL,
+    })
+}
+
+/// The closure given to `anytime_smt`, and the panic it raised, if any.
+/// A panic must not unwind into the C code, so the trampoline catches
+/// it and `anytime_smt` resumes it.
+struct AnytimeCallback<F> {
+    on_improve: F,
+    panic: Option<Box<dyn Any + Send>>,
+}
+
+/// Hands the tree reported by `gst_anytime_smt` to the closure.
+unsafe extern "C" fn anytime_trampoline<F: FnMut(&SteinerTree, f64)>(
+    length: c_double,
+    lower_bound: c_double,
+    nsps: c_int,
+    sps: *mut c_double,
+    nedges: c_int,
+    edges: *mut c_int,
+    cb_data: *mut c_void,
+) {
+    let callback = &mut *(cb_data as *mut AnytimeCallback<F>);
+    if callback.panic.is_some() {
+        return;
+    }
+    let sps = if nsps > 0 { std::slice::from_raw_parts(sps, 2 * nsps as usize) } else { &[] };
+    let edges = if nedges > 0 { std::slice::from_raw_parts(edges, 2 * nedges as usize) } else { &[] };
+    let tree = SteinerTree {
+        length,
+        steiner_points: sps.chunks(2).map(|p| Point::new(p[0], p[1])).collect(),
+        edges: edges.chunks(2).map(|e| Edge::new(e[0], e[1])).collect(),
+    };
+    let on_improve = &mut callback.on_improve;
+    if let Err(payload) = panic::catch_unwind(AssertUnwindSafe(|| on_improve(&tree, lower_bound))) {
+        callback.panic = Some(payload);
+    }
+}
+
+fn smt_c(terms: &[Point], kind: c_int, parameter: c_int) -> Result<SteinerTree, Error> {
+    let metric = Metric::create(kind, parameter)?;
+    let n = terms.len();
+    let mut length = 0.0;
+    let mut nsps: c_int = 0;
+    let mut nedges: c_int = 0;
+    let mut sps = vec![Point::new(0.0, 0.0); n.max(2) - 2];
+    let mut edges = vec![0 as c_int; 2 * (2 * n).max(3) - 6];
+    let res = unsafe {
+        gst_smt(
+            n as c_int,
+            terms.as_ptr() as *const c_double,
+            &mut length,
+            &mut nsps,
+            sps.as_mut_ptr() as *mut c_double,
+            &mut nedges,
+            edges.as_mut_ptr(),
+            ptr::null_mut(),
+            metric.ptr as *mut c_void,
+            ptr::null_mut(),
+        )
+    };
+    if res != 0 {
+        return Err(Error { code: res });
+    }
+
+    sps.truncate(nsps as usize);
+    Ok(SteinerTree {
+        length,
+        steiner_points: sps,
+        edges: edges[..2 * nedges as usize]
+            .chunks(2)
+            .map(|e| Edge::new(e[0], e[1]))
+            .collect(),
+    })
+}
+
+/// Trees of at most 2 terminals.
+fn small_tree<M: SmtMetric + ?Sized>(terms: &[Point]) -> Option<SteinerTree> {
+    match terms.len() {
+        0 | 1 => Some(SteinerTree { length: 0.0, steiner_points: Vec::new(), edges: Vec::new() }),
+        2 => Some(SteinerTree {
+            length: M::distance(terms[0], terms[1]),
+            steiner_points: Vec::new(),
+            edges: vec![Edge::new(0, 1)],
+        }),
+        _ => None,
+    }
+}
+
+/// Rectilinear tree of 3 terminals: the medians of the coordinates
+/// give the only possible Steiner point.
+fn rsmt3(t: &[Point]) -> SteinerTree {
+    let median = |a: f64, b: f64, c: f64| a.max(b).min(a.min(b).max(c));
+    let sp = Point::new(median(t[0].x, t[1].x, t[2].x), median(t[0].y, t[1].y, t[2].y));
+    let length = t[0].x.max(t[1].x).max(t[2].x) - t[0].x.min(t[1].x).min(t[2].x)
+        + t[0].y.max(t[1].y).max(t[2].y) - t[0].y.min(t[1].y).min(t[2].y);
+
+    let same = |p: Point| p.x == sp.x && p.y == sp.y;
+    let (steiner_points, edges) = if same(t[0]) {
+        (vec![], vec![Edge::new(0, 1), Edge::new(0, 2)])
+    } else if same(t[1]) {
+        (vec![], vec![Edge::new(0, 1), Edge::new(1, 2)])
+    } else if same(t[2]) {
+        (vec![], vec![Edge::new(0, 2), Edge::new(1, 2)])
+    } else {
+        (vec![sp], vec![Edge::new(0, 3), Edge::new(1, 3), Edge::new(2, 3)])
+    };
+    SteinerTree { length, steiner_points, edges }
+}
+
+/// Rectilinear tree of 4 terminals.  Some optimal tree has all of its
+/// (at most 2) Steiner points on the Hanan grid, so we try the minimum
+/// spanning trees of the terminals plus every such set of points.
+/// Smaller sets come first, so a Steiner point of degree 2 or less is
+/// never kept.
+fn rsmt4(t: &[Point]) -> SteinerTree {
+    let mut grid = Vec::with_capacity(16);
+    for a in t {
+        for b in t {
+            let p = Point::new(a.x, b.y);
+            let dup = grid.iter().any(|q: &Point| q.x == p.x && q.y == p.y);
+            let term = t.iter().any(|q| q.x == p.x && q.y == p.y);
+            if !dup && !term {
+                grid.push(p);
+            }
+        }
+    }
+
+    let mut pts: Vec<Point> = t.to_vec();
+    let mut best = mst::<L1>(&pts);
+    let mut best_sps: Vec<Point> = Vec::new();
+    for i in 0..grid.len() {
+        pts.truncate(4);
+        pts.push(grid[i]);
+        let tree = mst::<L1>(&pts);
+        if tree.0 < best.0 {
+            best = tree;
+            best_sps = vec![grid[i]];
+        }
+    }
+    for i in 0..grid.len() {
+        for j in i + 1..grid.len() {
+            pts.truncate(4);
+            pts.push(grid[i]);
+            pts.push(grid[j]);
+            let tree = mst::<L1>(&pts);
+            if tree.0 < best.0 {
+                best = tree;
+                best_sps = vec![grid[i], grid[j]];
+            }
+        }
+    }
+
+    SteinerTree { length: best.0, steiner_points: best_sps, edges: best.1 }
+}
+
+/// Minimum spanning tree of a few points (Prim's algorithm).
+fn mst<M: SmtMetric>(pts: &[Point]) -> (f64, Vec<Edge>) {
+    let n = pts.len();
+    let mut in_tree = [false; 8];
+    let mut dist = [f64::INFINITY; 8];
+    let mut from = [0usize; 8];
+    let mut length = 0.0;
+    let mut edges = Vec::with_capacity(n.max(1) - 1);
+
+    let mut v = 0;
+    in_tree[0] = true;
+    for _ in 1..n {
+        for w in 0..n {
+            if !in_tree[w] {
+                let d = M::distance(pts[v], pts[w]);
+                if d < dist[w] {
+                    dist[w] = d;
+                    from[w] = v;
+                }
+            }
+        }
+        v = (0..n).filter(|&w| !in_tree[w]).min_by(|&a, &b| dist[a].total_cmp(&dist[b])).unwrap();
+        in_tree[v] = true;
+        length += dist[v];
+        edges.push(Edge::new(from[v] as i32, v as i32));
+    }
+    (length, edges)
+}
+
+/// Euclidean tree of 3 terminals, constructed exactly as `gst_esmt3`
+/// does.
+fn esmt3(t: &[Point]) -> SteinerTree {
+    let right_turn = |p1: Point, p2: Point, p3: Point| {
+        (p1.x - p2.x) * (p1.y - p3.y) < (p1.y - p2.y) * (p1.x - p3.x)
+    };
+    let left_turn = |p1: Point, p2: Point, p3: Point| {
+        (p1.x - p2.x) * (p1.y - p3.y) > (p1.y - p2.y) * (p1.x - p3.x)
+    };
+    let sqr_dist = |p: Point, q: Point| {
+        let dx = p.x - q.x;
+        let dy = p.y - q.y;
+        dx * dx + dy * dy
+    };
+    let edist = |p: Point, q: Point| (p.x - q.x).abs().hypot((p.y - q.y).abs());
+
+    let pt = t[0];
+    let (a, b, swapped) = if left_turn(t[1], t[2], pt) { (t[1], t[2], false) } else { (t[2], t[1], true) };
+
+    let dx = a.x - b.x;
+    let dy = a.y - b.y;
+    let e = Point::new(b.x + 0.5 * dx - HALF_SQRT3 * dy, b.y + 0.5 * dy + HALF_SQRT3 * dx);
+    let ctr = Point::new((a.x + b.x + e.x) / 3.0, (a.y + b.y + e.y) / 3.0);
+
+    let mst_edges = |x: (i32, i32), y: (i32, i32)| vec![Edge::new(x.0, x.1), Edge::new(y.0, y.1)];
+
+    if right_turn(e, a, pt) {
+        if left_turn(e, b, pt) {
+            if sqr_dist(ctr, pt) > sqr_dist(ctr, e) {
+                // We have a Steiner point
+                let ax = ctr.x - e.x;
+                let ay = ctr.y - e.y;
+                let bx = pt.x - e.x;
+                let by = pt.y - e.y;
+                let bb = bx * bx + by * by;
+                let sp = if bb == 0.0 {
+                    e
+                } else {
+                    let mut lambda = (ax * bx + ay * by) / bb;
+                    lambda += lambda;
+                    Point::new(e.x + lambda * bx, e.y + lambda * by)
+                };
+                return SteinerTree {
+                    length: edist(e, pt),
+                    steiner_points: vec![sp],
+                    edges: vec![Edge::new(0, 3), Edge::new(1, 3), Edge::new(2, 3)],
+                };
+            }
+            // pt is degree 2 terminal in MST
+            return SteinerTree {
+                length: edist(a, pt) + edist(b, pt),
+                steiner_points: vec![],
+                edges: mst_edges((0, 1), (0, 2)),
+            };
+        }
+        // b is degree 2 terminal in MST
+        return SteinerTree {
+            length: edist(a, b) + edist(pt, b),
+            steiner_points: vec![],
+            edges: if swapped { mst_edges((0, 1), (1, 2)) } else { mst_edges((0, 2), (1, 2)) },
+        };
+    }
+    // a is degree 2 terminal in MST
+    SteinerTree {
+        length: edist(b, a) + edist(pt, a),
+        steiner_points: vec![],
+        edges: if !swapped { mst_edges((0, 1), (1, 2)) } else { mst_edges((0, 2), (1, 2)) },
+    }
+}